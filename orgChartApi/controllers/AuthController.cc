@@ -1,27 +1,52 @@
 #include <third_party/libbcrypt/include/bcrypt/BCrypt.hpp>
+#include <openssl/crypto.h>
+#include <cctype>
 #include "AuthController.h"
 #include "../plugins/JwtPlugin.h"
+#include "../utils/utils.h"
 
 using namespace drogon::orm;
 using namespace drogon_model::org_chart;
 
 namespace drogon {
     template<>
-    inline User fromRequest(const HttpRequest &req) {
-        auto jsonPtr = req.getJsonObject();
-        auto json = *jsonPtr;
-        auto user = User(json);
-        return user;
+    inline std::optional<User> fromRequest(const HttpRequest &req) {
+        return fromJsonBody<User>(req);
     }
 }
 
-void AuthController::registerUser(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, User &&pUser) const {
+namespace {
+// The work factor of a "$2b$10$..." hash, -1 if it is not a bcrypt hash
+int hashCost(const std::string &hash) {
+    if (hash.size() < 7 || hash[0] != '$' || hash[3] != '$' || hash[6] != '$' ||
+        !isdigit(static_cast<unsigned char>(hash[4])) || !isdigit(static_cast<unsigned char>(hash[5]))) {
+        return -1;
+    }
+    return (hash[4] - '0') * 10 + (hash[5] - '0');
+}
+}
+
+AuthController::AuthController() {
+    const auto &config = drogon::app().getCustomConfig();
+    bcryptCost = config.get("bcrypt-cost", 12).asInt();
+    auto cacheTtl = config.get("login-cache-ttl", 30).asInt64();
+    auto cacheSize = config.get("login-cache-size", 10000).asUInt64();
+    loginCache = std::make_shared<LoginCache>(std::chrono::seconds{cacheTtl}, cacheSize);
+    pendingRehashes = std::make_shared<PendingRehashes>();
+    rehashQueue = std::make_unique<trantor::ConcurrentTaskQueue>(1, "rehash");
+}
+
+void AuthController::registerUser(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, std::optional<User> &&pUser) const {
     LOG_DEBUG << "registerUser";
+    if (!pUser) {
+        badRequest(std::move(callback), "invalid json body");
+        return;
+    }
     try {
         auto dbClientPtr = drogon::app().getDbClient();
         Mapper<User> mp(dbClientPtr);
 
-        if (!areFieldsValid(pUser)) {
+        if (!areFieldsValid(*pUser)) {
             Json::Value ret{};
             ret["error"] = "missing fields";
             auto resp = HttpResponse::newHttpJsonResponse(ret);
@@ -30,7 +55,7 @@ void AuthController::registerUser(const HttpRequestPtr &req, std::function<void(
             return;
         }
 
-        if (!isUserAvailable(pUser, mp)) {
+        if (!isUserAvailable(*pUser, mp)) {
             Json::Value ret{};
             ret["error"] = "username is taken";
             auto resp = HttpResponse::newHttpJsonResponse(ret);
@@ -39,8 +64,8 @@ void AuthController::registerUser(const HttpRequestPtr &req, std::function<void(
             return;
         }
 
-        auto newUser = pUser;
-        newUser.setPassword(BCrypt::generateHash(newUser.getValueOfPassword()));
+        auto newUser = *pUser;
+        newUser.setPassword(BCrypt::generateHash(newUser.getValueOfPassword(), bcryptCost));
         mp.insertFuture(newUser).get();
 
         auto userWithToken = AuthController::UserWithToken(newUser);
@@ -58,13 +83,17 @@ void AuthController::registerUser(const HttpRequestPtr &req, std::function<void(
     }
 }
 
-void AuthController::loginUser(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, User &&pUser) const {
+void AuthController::loginUser(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, std::optional<User> &&pUser) const {
     LOG_DEBUG << "loginUser";
+    if (!pUser) {
+        badRequest(std::move(callback), "invalid json body");
+        return;
+    }
     try {
         auto dbClientPtr = drogon::app().getDbClient();
         Mapper<User> mp(dbClientPtr);
 
-        if (!areFieldsValid(pUser)) {
+        if (!areFieldsValid(*pUser)) {
             Json::Value ret{};
             ret["error"] = "missing fields";
             auto resp = HttpResponse::newHttpJsonResponse(ret);
@@ -73,7 +102,7 @@ void AuthController::loginUser(const HttpRequestPtr &req, std::function<void(con
             return;
         }
 
-        auto user = mp.findFutureBy(Criteria(User::Cols::_username, CompareOperator::EQ, pUser.getValueOfUsername())).get();
+        auto user = mp.findFutureBy(Criteria(User::Cols::_username, CompareOperator::EQ, pUser->getValueOfUsername())).get();
         if (user.empty()) {
             Json::Value ret{};
             ret["error"] = "user not found";
@@ -83,7 +112,7 @@ void AuthController::loginUser(const HttpRequestPtr &req, std::function<void(con
             return;
         }
 
-        if (!isPasswordValid(pUser.getValueOfPassword(), user[0].getValueOfPassword())) {
+        if (!isPasswordValid(user[0], pUser->getValueOfPassword())) {
             Json::Value ret{};
             ret["error"] = "username and password do not match";
             auto resp = HttpResponse::newHttpJsonResponse(ret);
@@ -107,7 +136,7 @@ void AuthController::loginUser(const HttpRequestPtr &req, std::function<void(con
 }
 
 bool AuthController::areFieldsValid(const User &user) const {
-    return user.getUsername() != nullptr && user.getPassword() != nullptr;
+    return user.getUsername() && user.getPassword();
 }
 
 bool AuthController::isUserAvailable(const User &user, Mapper<User> &mp) const {
@@ -115,13 +144,80 @@ bool AuthController::isUserAvailable(const User &user, Mapper<User> &mp) const {
     return mp.findFutureBy(criteria).get().empty();
 }
 
-bool AuthController::isPasswordValid(const std::string &text, const std::string &hash) const {
-    return BCrypt::validatePassword(text, hash);
+bool AuthController::isPasswordValid(const User &user, const std::string &text) const {
+    const auto &hash = user.getValueOfPassword();
+    // Retries with the same credentials skip bcrypt until the entry expires
+    if (loginCache->contains(user.getValueOfId(), hash, text)) {
+        return true;
+    }
+    if (!BCrypt::validatePassword(text, hash)) {
+        return false;
+    }
+    loginCache->insert(user.getValueOfId(), hash, text);
+    // Stronger hashes are kept, moving them down would weaken them
+    if (hashCost(hash) < bcryptCost) {
+        rehashPassword(user.getValueOfId(), hash, text);
+    }
+    return true;
+}
+
+void AuthController::rehashPassword(int32_t userId, const std::string &hash, const std::string &text) const {
+    {
+        std::lock_guard<std::mutex> lock(pendingRehashes->mutex);
+        if (!pendingRehashes->userIds.insert(userId).second) {
+            return;
+        }
+    }
+    auto cost = bcryptCost;
+    // One copy of the plaintext that moving the task around does not duplicate
+    auto secret = std::make_shared<std::string>(text);
+    std::weak_ptr<LoginCache> weakCache = loginCache;
+    std::weak_ptr<PendingRehashes> weakPending = pendingRehashes;
+    auto done = [userId, weakPending]() {
+        if (auto pending = weakPending.lock()) {
+            std::lock_guard<std::mutex> lock(pending->mutex);
+            pending->userIds.erase(userId);
+        }
+    };
+    // Off the io threads, the login is answered without waiting for it
+    rehashQueue->runTaskInQueue([userId, hash, secret, cost, weakCache, done]() {
+        std::string newHash;
+        try {
+            newHash = BCrypt::generateHash(*secret, cost);
+        } catch (const std::exception &e) {
+            LOG_ERROR << e.what();
+        }
+        // The plaintext is not needed any more, do not leave it in freed memory
+        OPENSSL_cleanse(&(*secret)[0], secret->size());
+        if (newHash.empty()) {
+            done();
+            return;
+        }
+        Mapper<User> mp(drogon::app().getDbClient());
+        // Only the verified hash is replaced, a password changed meanwhile is kept
+        mp.updateBy(
+            {User::Cols::_password},
+            Criteria(User::Cols::_id, CompareOperator::EQ, userId) && Criteria(User::Cols::_password, CompareOperator::EQ, hash),
+            [userId, weakCache, done](const std::size_t count) {
+                if (count > 0) {
+                    if (auto cache = weakCache.lock()) {
+                        cache->erase(userId);
+                    }
+                    LOG_DEBUG << "rehashed password of user " << userId;
+                }
+                done();
+            },
+            [done](const DrogonDbException &e) {
+                LOG_ERROR << e.base().what();
+                done();
+            },
+            newHash);
+    });
 }
 
 AuthController::UserWithToken::UserWithToken(const User &user) {
     auto *jwtPtr = drogon::app().getPlugin<JwtPlugin>();
-    auto jwt = jwtPtr->init();
+    const auto &jwt = jwtPtr->init();
     token = jwt.encode("user_id", user.getValueOfId());
     username = user.getValueOfUsername();
 }
@@ -1,8 +1,14 @@
 #pragma once
 
 #include <drogon/HttpController.h>
+#include <trantor/utils/ConcurrentTaskQueue.h>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <unordered_set>
 #include "../models/User.h"
+#include "../utils/LoginCache.h"
 
 using namespace drogon;
 using namespace drogon::orm;
@@ -15,8 +21,9 @@ class AuthController : public drogon::HttpController<AuthController> {
       ADD_METHOD_TO(AuthController::loginUser, "/auth/login", Post);
     METHOD_LIST_END
 
-    void registerUser(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, User &&pUser) const;
-    void loginUser(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, User &&pUser) const;
+    AuthController();
+    void registerUser(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, std::optional<User> &&pUser) const;
+    void loginUser(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, std::optional<User> &&pUser) const;
 
  private:
     struct UserWithToken {
@@ -29,5 +36,23 @@ class AuthController : public drogon::HttpController<AuthController> {
 
     bool areFieldsValid(const User &user) const;
     bool isUserAvailable(const User &user, Mapper<User> &mp) const;
-    bool isPasswordValid(const std::string &text, const std::string &hash) const;
+    bool isPasswordValid(const User &user, const std::string &text) const;
+    void rehashPassword(int32_t userId, const std::string &hash, const std::string &text) const;
+
+    // The users whose rehash is queued or running, so logins that come in
+    // meanwhile do not queue another one
+    struct PendingRehashes {
+        std::mutex mutex;
+        std::unordered_set<int32_t> userIds;
+    };
+
+    // The work factor of new hashes, weaker hashes are moved to it on login
+    int bcryptCost;
+    // Shared with the rehash callbacks, which may run after the controller is gone.
+    // Any code that writes a user's password must call loginCache->erase(userId)
+    // so the cached login is dropped at once instead of relying on the new hash
+    // to make it miss.
+    std::shared_ptr<LoginCache> loginCache;
+    std::shared_ptr<PendingRehashes> pendingRehashes;
+    std::unique_ptr<trantor::ConcurrentTaskQueue> rehashQueue;
 };
@@ -11,11 +11,8 @@ using namespace drogon_model::org_chart;
 
 namespace drogon {
     template<>
-    inline Department fromRequest(const HttpRequest &req) {
-        auto jsonPtr = req.getJsonObject();
-        auto json = *jsonPtr;
-        auto department = Department(json);
-        return department;
+    inline std::optional<Department> fromRequest(const HttpRequest &req) {
+        return fromJsonBody<Department>(req);
     }
 }  // namespace drogon
 
@@ -33,7 +30,7 @@ void DepartmentsController::get(const HttpRequestPtr &req, std::function<void(co
     mp.orderBy(sortField, sortOrderEnum).offset(offset).limit(limit).findAll(
         [callbackPtr](const std::vector<Department> &departments) {
             Json::Value ret{};
-            for (auto d : departments) {
+            for (const auto &d : departments) {
                 ret.append(d.toJson());
             }
             auto resp = HttpResponse::newHttpJsonResponse(ret);
@@ -78,14 +75,18 @@ void DepartmentsController::getOne(const HttpRequestPtr &req, std::function<void
     });
 }
 
-void DepartmentsController::createOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, Department &&pDepartment) const {
+void DepartmentsController::createOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, std::optional<Department> &&pDepartment) const {
     LOG_DEBUG << "createOne";
+    if (!pDepartment) {
+        badRequest(std::move(callback), "invalid json body");
+        return;
+    }
     auto callbackPtr = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
     auto dbClientPtr = drogon::app().getDbClient();
 
     Mapper<Department> mp(dbClientPtr);
     mp.insert(
-        pDepartment,
+        *pDepartment,
         [callbackPtr](const Department &department) {
             Json::Value ret{};
             ret = department.toJson();
@@ -101,8 +102,12 @@ void DepartmentsController::createOne(const HttpRequestPtr &req, std::function<v
     });
 }
 
-void DepartmentsController::updateOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int departmentId, Department &&pDepartmentDetails) const {
+void DepartmentsController::updateOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int departmentId, std::optional<Department> &&pDepartmentDetails) const {
     LOG_DEBUG << "updateOne departmentId: " << departmentId;
+    if (!pDepartmentDetails) {
+        badRequest(std::move(callback), "invalid json body");
+        return;
+    }
     auto dbClientPtr = drogon::app().getDbClient();
 
     // blocking IO
@@ -118,8 +123,8 @@ void DepartmentsController::updateOne(const HttpRequestPtr &req, std::function<v
         callback(resp);
     }
 
-    if (pDepartmentDetails.getName() != nullptr) {
-        department.setName(pDepartmentDetails.getValueOfName());
+    if (pDepartmentDetails->getName()) {
+        department.setName(pDepartmentDetails->getValueOfName());
     }
 
     auto callbackPtr = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
@@ -181,7 +186,7 @@ void DepartmentsController::getDepartmentPersons(const HttpRequestPtr &req, std:
     }
 
     department.getPersons(dbClientPtr,
-      [callbackPtr](const std::vector<Person> persons) {
+      [callbackPtr](const std::vector<Person> &persons) {
           if (persons.empty()) {
               Json::Value ret{};
               ret["error"] = "resource not found";
@@ -189,11 +194,7 @@ void DepartmentsController::getDepartmentPersons(const HttpRequestPtr &req, std:
               resp->setStatusCode(HttpStatusCode::k404NotFound);
               (*callbackPtr)(resp);
           } else {
-              Json::Value ret{};
-              for (auto p : persons) {
-                  ret.append(p.toJson());
-              }
-              auto resp = HttpResponse::newHttpJsonResponse(ret);
+              auto resp = makeJsonResp(persons);
               resp->setStatusCode(HttpStatusCode::k200OK);
               (*callbackPtr)(resp);
           }
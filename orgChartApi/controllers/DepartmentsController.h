@@ -1,6 +1,7 @@
 #pragma once
 
 #include <drogon/HttpController.h>
+#include <optional>
 #include "../models/Department.h"
 
 using namespace drogon;
@@ -19,8 +20,8 @@ class DepartmentsController : public drogon::HttpController<DepartmentsControlle
 
     void get(const HttpRequestPtr& req, std::function<void(const HttpResponsePtr &)> &&callback) const;
     void getOne(const HttpRequestPtr& req, std::function<void(const HttpResponsePtr &)> &&callback, int pDepartmentId) const;
-    void createOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, Department &&pDepartment) const;
-    void updateOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int pDepartmentId, Department &&pDepartment) const;
+    void createOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, std::optional<Department> &&pDepartment) const;
+    void updateOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int pDepartmentId, std::optional<Department> &&pDepartment) const;
     void deleteOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int pDepartmentId) const;
     void getDepartmentPersons(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int departmentId) const;
 };
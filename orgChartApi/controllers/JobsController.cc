@@ -11,10 +11,8 @@ using namespace drogon_model::org_chart;
 
 namespace drogon {
     template<>
-    inline Job fromRequest(const HttpRequest &req) {
-        auto json = req.getJsonObject();
-        auto job = Job(*json);
-        return job;
+    inline std::optional<Job> fromRequest(const HttpRequest &req) {
+        return fromJsonBody<Job>(req);
     }
 }
 
@@ -25,18 +23,27 @@ void JobsController::get(const HttpRequestPtr &req, std::function<void(const Htt
     auto sortField = req->getOptionalParameter<std::string>("sort_field").value_or("id");
     auto sortOrder = req->getOptionalParameter<std::string>("sort_order").value_or("asc");
     auto sortOrderEnum = sortOrder == "asc" ? SortOrder::ASC : SortOrder::DESC;
+    // Seconds a page is cached for, 0 or less turns the cache off (drogon
+    // itself would read 0 as caching forever)
+    auto cacheTtl = drogon::app().getCustomConfig().get("jobs-cache-ttl", -1).asInt64();
 
     auto callbackPtr = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
     auto dbClientPtr = drogon::app().getDbClient();
     Mapper<Job> mp(dbClientPtr);
     mp.orderBy(sortField, sortOrderEnum).offset(offset).limit(limit).findAll(
-        [callbackPtr](const std::vector<Job> &jobs) {
+        [callbackPtr, cacheTtl](const std::vector<Job> &jobs) {
             Json::Value ret{};
-            for (auto j : jobs) {
+            for (const auto &j : jobs) {
                 ret.append(j.toJson());
             }
             auto resp = HttpResponse::newHttpJsonResponse(ret);
             resp->setStatusCode(HttpStatusCode::k200OK);
+            // cached per path and query until it expires or a job changes
+            if (cacheTtl > 0) {
+                resp->setExpiredTime(cacheTtl);
+                resp->setCacheKeyedByRequest(true);
+                resp->addCacheTag("jobs");
+            }
             (*callbackPtr)(resp);
         },
         [callbackPtr](const DrogonDbException &e) {
@@ -77,15 +84,20 @@ void JobsController::getOne(const HttpRequestPtr &req, std::function<void(const
     });
 }
 
-void JobsController::createOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, Job &&pJob) const {
+void JobsController::createOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, std::optional<Job> &&pJob) const {
     LOG_DEBUG << "createOne";
+    if (!pJob) {
+        badRequest(std::move(callback), "invalid json body");
+        return;
+    }
     auto callbackPtr = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
     auto dbClientPtr = drogon::app().getDbClient();
 
     Mapper<Job> mp(dbClientPtr);
     mp.insert(
-        pJob,
+        *pJob,
         [callbackPtr](const Job &job) {
+            drogon::app().invalidateCachedResponses("jobs");
             Json::Value ret{};
             ret = job.toJson();
             auto resp = HttpResponse::newHttpJsonResponse(ret);
@@ -100,8 +112,12 @@ void JobsController::createOne(const HttpRequestPtr &req, std::function<void(con
     });
 }
 
-void JobsController::updateOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int jobId, Job &&pJobDetails) const {
+void JobsController::updateOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int jobId, std::optional<Job> &&pJobDetails) const {
     LOG_DEBUG << "updateOne jobId: " << jobId;
+    if (!pJobDetails) {
+        badRequest(std::move(callback), "invalid json body");
+        return;
+    }
     auto jsonPtr = req->jsonObject();
     if (!jsonPtr) {
       Json::Value ret{};
@@ -127,8 +143,8 @@ void JobsController::updateOne(const HttpRequestPtr &req, std::function<void(con
         callback(resp);
     }
 
-    if (pJobDetails.getTitle() != nullptr) {
-        job.setTitle(pJobDetails.getValueOfTitle());
+    if (pJobDetails->getTitle()) {
+        job.setTitle(pJobDetails->getValueOfTitle());
     }
 
     auto callbackPtr = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
@@ -136,6 +152,7 @@ void JobsController::updateOne(const HttpRequestPtr &req, std::function<void(con
         job,
         [callbackPtr](const std::size_t count)
         {
+            drogon::app().invalidateCachedResponses("jobs");
             auto resp = HttpResponse::newHttpResponse();
             resp->setStatusCode(HttpStatusCode::k204NoContent);
             (*callbackPtr)(resp);
@@ -159,6 +176,7 @@ void JobsController::deleteOne(const HttpRequestPtr &req, std::function<void(con
     mp.deleteBy(
         Criteria(Job::Cols::_id, CompareOperator::EQ, jobId),
         [callbackPtr](const std::size_t count) {
+            drogon::app().invalidateCachedResponses("jobs");
             auto resp = HttpResponse::newHttpResponse();
             resp->setStatusCode(HttpStatusCode::k204NoContent);
             (*callbackPtr)(resp);
@@ -190,7 +208,7 @@ void JobsController::getJobPersons(const HttpRequestPtr &req, std::function<void
     }
 
     job.getPersons(dbClientPtr,
-        [callbackPtr](const std::vector<Person> persons) {
+        [callbackPtr](const std::vector<Person> &persons) {
            if (persons.empty()) {
               Json::Value ret{};
               ret["error"] = "resource not found";
@@ -198,11 +216,7 @@ void JobsController::getJobPersons(const HttpRequestPtr &req, std::function<void
               resp->setStatusCode(HttpStatusCode::k404NotFound);
               (*callbackPtr)(resp);
           } else {
-              Json::Value ret{};
-              for (auto p : persons) {
-                  ret.append(p.toJson());
-              }
-              auto resp = HttpResponse::newHttpJsonResponse(ret);
+              auto resp = makeJsonResp(persons);
               resp->setStatusCode(HttpStatusCode::k200OK);
               (*callbackPtr)(resp);
           }
@@ -10,14 +10,9 @@ using namespace drogon_model::org_chart;
 
 namespace drogon {
     template<>
-    inline Person fromRequest(const HttpRequest &req) {
-        auto jsonPtr = req.getJsonObject();
-        auto json = *jsonPtr;
-        if (json["department_id"]) json["department_id"] = std::stoi(json["department_id"].asString());
-        if (json["manager_id"]) json["manager_id"] = std::stoi(json["manager_id"].asString());
-        if (json["job_id"]) json["job_id"] = std::stoi(json["job_id"].asString());
-        auto person = Person(json);
-        return person;
+    inline std::optional<Person> fromRequest(const HttpRequest &req) {
+        // The ids may be sent as strings, the reader accepts both.
+        return fromJsonBody<Person>(req);
     }
 }  // namespace drogon
 
@@ -57,14 +52,14 @@ void PersonsController::get(const HttpRequestPtr &req, std::function<void(const
                           return;
                       }
 
-                      Json::Value ret{};
+                      std::vector<PersonDetails> ret;
+                      ret.reserve(result.size());
                       for (auto row : result) {
                           PersonInfo personInfo{row};
-                          PersonDetails personDetails{personInfo};
-                          ret.append(personDetails.toJson());
+                          ret.emplace_back(personInfo);
                       }
 
-                      auto resp = HttpResponse::newHttpJsonResponse(ret);
+                      auto resp = makeJsonResp(ret);
                       resp->setStatusCode(HttpStatusCode::k200OK);
                       (*callbackPtr)(resp);
                    }
@@ -107,8 +102,7 @@ void PersonsController::getOne(const HttpRequestPtr &req, std::function<void(con
                       PersonInfo personInfo{row};
                       PersonDetails personDetails{personInfo};
 
-                      Json::Value ret = personDetails.toJson();
-                      auto resp = HttpResponse::newHttpJsonResponse(ret);
+                      auto resp = makeJsonResp(personDetails);
                       resp->setStatusCode(HttpStatusCode::k200OK);
                       (*callbackPtr)(resp);
                    }
@@ -121,18 +115,20 @@ void PersonsController::getOne(const HttpRequestPtr &req, std::function<void(con
                    };
 }
 
-void PersonsController::createOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, Person &&pPerson) const {
+void PersonsController::createOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, std::optional<Person> &&pPerson) const {
     LOG_DEBUG << "createOne";
+    if (!pPerson) {
+        badRequest(std::move(callback), "invalid json body");
+        return;
+    }
     auto callbackPtr = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
     auto dbClientPtr = drogon::app().getDbClient();
 
     Mapper<Person> mp(dbClientPtr);
     mp.insert(
-        pPerson,
+        *pPerson,
         [callbackPtr](const Person &person) {
-            Json::Value ret{};
-            ret = person.toJson();
-            auto resp = HttpResponse::newHttpJsonResponse(ret);
+            auto resp = makeJsonResp(person);
             resp->setStatusCode(HttpStatusCode::k201Created);
             (*callbackPtr)(resp);
         },
@@ -144,8 +140,12 @@ void PersonsController::createOne(const HttpRequestPtr &req, std::function<void(
     });
 }
 
-void PersonsController::updateOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int personId, Person &&pPerson) const {
+void PersonsController::updateOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int personId, std::optional<Person> &&pPerson) const {
     LOG_DEBUG << "updateOne personId: " << personId;
+    if (!pPerson) {
+        badRequest(std::move(callback), "invalid json body");
+        return;
+    }
     auto dbClientPtr = drogon::app().getDbClient();
 
     // blocking IO
@@ -160,20 +160,20 @@ void PersonsController::updateOne(const HttpRequestPtr &req, std::function<void(
         return;
     }
 
-    if (pPerson.getJobId() != nullptr) {
-      person.setJobId(pPerson.getValueOfJobId());
+    if (pPerson->getJobId()) {
+      person.setJobId(pPerson->getValueOfJobId());
     }
-    if (pPerson.getManagerId() != nullptr) {
-      person.setManagerId(pPerson.getValueOfManagerId());
+    if (pPerson->getManagerId()) {
+      person.setManagerId(pPerson->getValueOfManagerId());
     }
-    if (pPerson.getDepartmentId() != nullptr) {
-      person.setDepartmentId(pPerson.getValueOfDepartmentId());
+    if (pPerson->getDepartmentId()) {
+      person.setDepartmentId(pPerson->getValueOfDepartmentId());
     }
-    if (pPerson.getFirstName() != nullptr) {
-      person.setFirstName(pPerson.getValueOfFirstName());
+    if (pPerson->getFirstName()) {
+      person.setFirstName(pPerson->getValueOfFirstName());
     }
-    if (pPerson.getLastName() != nullptr) {
-      person.setLastName(pPerson.getValueOfLastName());
+    if (pPerson->getLastName()) {
+      person.setLastName(pPerson->getValueOfLastName());
     }
 
     auto callbackPtr = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
@@ -239,11 +239,7 @@ void PersonsController::getDirectReports(const HttpRequestPtr &req, std::functio
              resp->setStatusCode(HttpStatusCode::k404NotFound);
              (*callbackPtr)(resp);
           } else {
-             Json::Value ret{};
-             for (auto p : persons) {
-                 ret.append(p.toJson());
-             }
-             auto resp = HttpResponse::newHttpJsonResponse(ret);
+             auto resp = makeJsonResp(persons);
              resp->setStatusCode(HttpStatusCode::k200OK);
              (*callbackPtr)(resp);
           }
@@ -261,28 +257,10 @@ PersonsController::PersonDetails::PersonDetails(const PersonInfo &personInfo) {
     first_name = personInfo.getValueOfFirstName();
     last_name = personInfo.getValueOfLastName();
     hire_date = personInfo.getValueOfHireDate();
-    Json::Value managerJson{};
-    managerJson["id"] = personInfo.getValueOfManagerId();
-    managerJson["full_name"] = personInfo.getValueOfManagerFullName();
-    this->manager = managerJson;
-    Json::Value departmentJson{};
-    departmentJson["id"] = personInfo.getValueOfDepartmentId();
-    departmentJson["name"] = personInfo.getValueOfDepartmentName();
-    this->department = departmentJson;
-    Json::Value jobJson{};
-    jobJson["id"] = personInfo.getValueOfJobId();
-    jobJson["title"] = personInfo.getValueOfJobTitle();
-    this->job = jobJson;
-}
-
-auto PersonsController::PersonDetails::toJson() -> Json::Value {
-    Json::Value ret{};
-    ret["id"] = id;
-    ret["first_name"] = first_name;
-    ret["last_name"] = last_name;
-    ret["hire_date"] = hire_date.toDbStringLocal();
-    ret["manager"] = manager;
-    ret["department"] = department;
-    ret["job"] = job;
-    return ret;
+    manager.id = personInfo.getValueOfManagerId();
+    manager.full_name = personInfo.getValueOfManagerFullName();
+    department.id = personInfo.getValueOfDepartmentId();
+    department.name = personInfo.getValueOfDepartmentName();
+    job.id = personInfo.getValueOfJobId();
+    job.title = personInfo.getValueOfJobTitle();
 }
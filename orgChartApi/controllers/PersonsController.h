@@ -1,6 +1,8 @@
 #pragma once
 
 #include <drogon/HttpController.h>
+#include <drogon/orm/JsonSerializer.h>
+#include <optional>
 #include <string>
 #include "../models/Person.h"
 #include "../models/PersonInfo.h"
@@ -21,22 +23,60 @@ class PersonsController : public drogon::HttpController<PersonsController> {
 
     void get(const HttpRequestPtr& req, std::function<void(const HttpResponsePtr &)> &&callback) const;
     void getOne(const HttpRequestPtr& req, std::function<void(const HttpResponsePtr &)> &&callback, int pPersonId) const;
-    void createOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, Person &&pPerson) const;
-    void updateOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int pPersonId, Person &&pPerson) const;
+    void createOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, std::optional<Person> &&pPerson) const;
+    void updateOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int pPersonId, std::optional<Person> &&pPerson) const;
     void deleteOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int pPersonId) const;
     void getDirectReports(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int pPersonId) const;
 
  private:
+    // Written by drogon::orm::toJsonText(), the members are listed in the
+    // order Json::Value objects are written.
     struct PersonDetails {
+        struct ManagerRef {
+            int id;
+            std::string full_name;
+            static constexpr auto jsonFields() {
+                return drogon::orm::makeJsonFields(
+                    drogon::orm::makeJsonField("full_name", &ManagerRef::full_name),
+                    drogon::orm::makeJsonField("id", &ManagerRef::id));
+            }
+        };
+        struct DepartmentRef {
+            int id;
+            std::string name;
+            static constexpr auto jsonFields() {
+                return drogon::orm::makeJsonFields(
+                    drogon::orm::makeJsonField("id", &DepartmentRef::id),
+                    drogon::orm::makeJsonField("name", &DepartmentRef::name));
+            }
+        };
+        struct JobRef {
+            int id;
+            std::string title;
+            static constexpr auto jsonFields() {
+                return drogon::orm::makeJsonFields(
+                    drogon::orm::makeJsonField("id", &JobRef::id),
+                    drogon::orm::makeJsonField("title", &JobRef::title));
+            }
+        };
         int id;
         std::string first_name;
         std::string last_name;
         trantor::Date hire_date;
-        Json::Value manager;
-        Json::Value department;
-        Json::Value job;
+        ManagerRef manager;
+        DepartmentRef department;
+        JobRef job;
         PersonDetails() {}
         explicit PersonDetails(const PersonInfo &personInfo);
-        Json::Value toJson();
+        static constexpr auto jsonFields() {
+            return drogon::orm::makeJsonFields(
+                drogon::orm::makeJsonField("department", &PersonDetails::department),
+                drogon::orm::makeJsonField("first_name", &PersonDetails::first_name),
+                drogon::orm::makeJsonField("hire_date", &PersonDetails::hire_date),
+                drogon::orm::makeJsonField("id", &PersonDetails::id),
+                drogon::orm::makeJsonField("job", &PersonDetails::job),
+                drogon::orm::makeJsonField("last_name", &PersonDetails::last_name),
+                drogon::orm::makeJsonField("manager", &PersonDetails::manager));
+        }
     };
 };
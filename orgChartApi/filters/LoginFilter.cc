@@ -17,7 +17,7 @@ void LoginFilter::doFilter(const HttpRequestPtr &req, FilterCallback &&fcb, Filt
 
         auto token = req->getHeader("Authorization").substr(7);
         auto *jwtPtr = drogon::app().getPlugin<JwtPlugin>();
-        auto jwt = jwtPtr->init();
+        const auto &jwt = jwtPtr->init();
         auto decoded = jwt.decode(token);
         auto userId = stoi(decoded.get_payload_claim("user_id").as_string());
         fccb();
@@ -35,11 +35,11 @@ Department::Department(const Row &r, const ssize_t indexOffset) noexcept
     {
         if(!r["id"].isNull())
         {
-            id_=std::make_shared<int32_t>(r["id"].as<int32_t>());
+            id_.emplace(r["id"].as<int32_t>());
         }
         if(!r["name"].isNull())
         {
-            name_=std::make_shared<std::string>(r["name"].as<std::string>());
+            name_.emplace(r["name"].as<std::string>());
         }
     }
     else
@@ -54,17 +54,66 @@ Department::Department(const Row &r, const ssize_t indexOffset) noexcept
         index = offset + 0;
         if(!r[index].isNull())
         {
-            id_=std::make_shared<int32_t>(r[index].as<int32_t>());
+            id_.emplace(r[index].as<int32_t>());
         }
         index = offset + 1;
         if(!r[index].isNull())
         {
-            name_=std::make_shared<std::string>(r[index].as<std::string>());
+            name_.emplace(r[index].as<std::string>());
         }
     }
 
 }
 
+Department::ColumnIndexes Department::columnIndexes(const Result &r)
+{
+    ColumnIndexes indexes;
+    indexes.fill(-1);
+    for(Result::RowSizeType i = 0; i < r.columns(); ++i)
+    {
+        const char *name = r.columnName(i);
+        for(size_t j = 0; j < metaData_.size(); ++j)
+        {
+            if(indexes[j] < 0 && metaData_[j].colName_ == name)
+            {
+                indexes[j] = (ssize_t)i;
+                break;
+            }
+        }
+    }
+    return indexes;
+}
+
+Department::Department(const Row &r, const ColumnIndexes &indexes) noexcept
+{
+    ssize_t index;
+    index = indexes[0];
+    if(index >= 0 && !r[(size_t)index].isNull())
+    {
+        id_.emplace(r[(size_t)index].as<int32_t>());
+    }
+    index = indexes[1];
+    if(index >= 0 && !r[(size_t)index].isNull())
+    {
+        name_.emplace(r[(size_t)index].as<std::string>());
+    }
+}
+
+Department::View::View(const Row &r, const ColumnIndexes &indexes) noexcept
+{
+    ssize_t index;
+    index = indexes[0];
+    if(index >= 0 && !r[(size_t)index].isNull())
+    {
+        id.emplace(r[(size_t)index].as<int32_t>());
+    }
+    index = indexes[1];
+    if(index >= 0 && !r[(size_t)index].isNull())
+    {
+        name.emplace(r[(size_t)index].as<string_view>());
+    }
+}
+
 Department::Department(const Json::Value &pJson, const std::vector<std::string> &pMasqueradingVector) noexcept(false)
 {
     if(pMasqueradingVector.size() != 2)
@@ -77,7 +126,7 @@ Department::Department(const Json::Value &pJson, const std::vector<std::string>
         dirtyFlag_[0] = true;
         if(!pJson[pMasqueradingVector[0]].isNull())
         {
-            id_=std::make_shared<int32_t>((int32_t)pJson[pMasqueradingVector[0]].asInt64());
+            id_.emplace((int32_t)pJson[pMasqueradingVector[0]].asInt64());
         }
     }
     if(!pMasqueradingVector[1].empty() && pJson.isMember(pMasqueradingVector[1]))
@@ -85,7 +134,7 @@ Department::Department(const Json::Value &pJson, const std::vector<std::string>
         dirtyFlag_[1] = true;
         if(!pJson[pMasqueradingVector[1]].isNull())
         {
-            name_=std::make_shared<std::string>(pJson[pMasqueradingVector[1]].asString());
+            name_.emplace(pJson[pMasqueradingVector[1]].asString());
         }
     }
 }
@@ -97,7 +146,7 @@ Department::Department(const Json::Value &pJson) noexcept(false)
         dirtyFlag_[0]=true;
         if(!pJson["id"].isNull())
         {
-            id_=std::make_shared<int32_t>((int32_t)pJson["id"].asInt64());
+            id_.emplace((int32_t)pJson["id"].asInt64());
         }
     }
     if(pJson.isMember("name"))
@@ -105,7 +154,7 @@ Department::Department(const Json::Value &pJson) noexcept(false)
         dirtyFlag_[1]=true;
         if(!pJson["name"].isNull())
         {
-            name_=std::make_shared<std::string>(pJson["name"].asString());
+            name_.emplace(pJson["name"].asString());
         }
     }
 }
@@ -122,7 +171,7 @@ void Department::updateByMasqueradedJson(const Json::Value &pJson,
     {
         if(!pJson[pMasqueradingVector[0]].isNull())
         {
-            id_=std::make_shared<int32_t>((int32_t)pJson[pMasqueradingVector[0]].asInt64());
+            id_.emplace((int32_t)pJson[pMasqueradingVector[0]].asInt64());
         }
     }
     if(!pMasqueradingVector[1].empty() && pJson.isMember(pMasqueradingVector[1]))
@@ -130,7 +179,7 @@ void Department::updateByMasqueradedJson(const Json::Value &pJson,
         dirtyFlag_[1] = true;
         if(!pJson[pMasqueradingVector[1]].isNull())
         {
-            name_=std::make_shared<std::string>(pJson[pMasqueradingVector[1]].asString());
+            name_.emplace(pJson[pMasqueradingVector[1]].asString());
         }
     }
 }
@@ -141,7 +190,7 @@ void Department::updateByJson(const Json::Value &pJson) noexcept(false)
     {
         if(!pJson["id"].isNull())
         {
-            id_=std::make_shared<int32_t>((int32_t)pJson["id"].asInt64());
+            id_.emplace((int32_t)pJson["id"].asInt64());
         }
     }
     if(pJson.isMember("name"))
@@ -149,7 +198,7 @@ void Department::updateByJson(const Json::Value &pJson) noexcept(false)
         dirtyFlag_[1] = true;
         if(!pJson["name"].isNull())
         {
-            name_=std::make_shared<std::string>(pJson["name"].asString());
+            name_.emplace(pJson["name"].asString());
         }
     }
 }
@@ -161,13 +210,13 @@ const int32_t &Department::getValueOfId() const noexcept
         return *id_;
     return defaultValue;
 }
-const std::shared_ptr<int32_t> &Department::getId() const noexcept
+const drogon::optional<int32_t> &Department::getId() const noexcept
 {
     return id_;
 }
 void Department::setId(const int32_t &pId) noexcept
 {
-    id_ = std::make_shared<int32_t>(pId);
+    id_.emplace(pId);
     dirtyFlag_[0] = true;
 }
 const typename Department::PrimaryKeyType & Department::getPrimaryKey() const
@@ -183,18 +232,18 @@ const std::string &Department::getValueOfName() const noexcept
         return *name_;
     return defaultValue;
 }
-const std::shared_ptr<std::string> &Department::getName() const noexcept
+const drogon::optional<std::string> &Department::getName() const noexcept
 {
     return name_;
 }
 void Department::setName(const std::string &pName) noexcept
 {
-    name_ = std::make_shared<std::string>(pName);
+    name_.emplace(pName);
     dirtyFlag_[1] = true;
 }
 void Department::setName(std::string &&pName) noexcept
 {
-    name_ = std::make_shared<std::string>(std::move(pName));
+    name_.emplace(std::move(pName));
     dirtyFlag_[1] = true;
 }
 
@@ -498,7 +547,7 @@ void Department::getPersons(const DbClientPtr &clientPtr,
                    {
                        ret.emplace_back(Person(row));
                    }
-                   rcb(ret);
+                   rcb(std::move(ret));
                }
                >> ecb;
 }
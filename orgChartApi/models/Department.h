@@ -11,6 +11,9 @@
 #include <drogon/orm/Field.h>
 #include <drogon/orm/SqlBinder.h>
 #include <drogon/orm/Mapper.h>
+#include <drogon/orm/JsonSerializer.h>
+#include <drogon/utils/optional.h>
+#include <drogon/utils/string_view.h>
 #ifdef __cpp_impl_coroutine
 #include <drogon/orm/CoroMapper.h>
 #endif
@@ -20,6 +23,7 @@
 #include <string>
 #include <memory>
 #include <vector>
+#include <array>
 #include <tuple>
 #include <stdint.h>
 #include <iostream>
@@ -64,6 +68,24 @@ class Department
      */
     explicit Department(const drogon::orm::Row &r, const ssize_t indexOffset = 0) noexcept;
 
+    /// The numbers of the columns of this model in a query result, -1 for the columns not in it
+    using ColumnIndexes = std::array<ssize_t, 2>;
+
+    /**
+     * @brief Find the columns of this model in a query result by their names.
+     * @note The indexes are found once and reused for every row of the result,
+     * which is faster than an offset of -1 when the SQL does not select all
+     * columns by an asterisk.
+     */
+    static ColumnIndexes columnIndexes(const drogon::orm::Result &r);
+
+    /**
+     * @brief constructor
+     * @param r One row of records in the SQL query result.
+     * @param indexes The indexes of the columns in the result, see columnIndexes().
+     */
+    Department(const drogon::orm::Row &r, const ColumnIndexes &indexes) noexcept;
+
     /**
      * @brief constructor
      * @param pJson The json object to construct a new instance.
@@ -99,16 +121,16 @@ class Department
     /**  For column id  */
     ///Get the value of the column id, returns the default value if the column is null
     const int32_t &getValueOfId() const noexcept;
-    ///Return a shared_ptr object pointing to the column const value, or an empty shared_ptr object if the column is null
-    const std::shared_ptr<int32_t> &getId() const noexcept;
+    ///Return the optional value of the column, which is empty if the column is null
+    const drogon::optional<int32_t> &getId() const noexcept;
     ///Set the value of the column id
     void setId(const int32_t &pId) noexcept;
 
     /**  For column name  */
     ///Get the value of the column name, returns the default value if the column is null
     const std::string &getValueOfName() const noexcept;
-    ///Return a shared_ptr object pointing to the column const value, or an empty shared_ptr object if the column is null
-    const std::shared_ptr<std::string> &getName() const noexcept;
+    ///Return the optional value of the column, which is empty if the column is null
+    const drogon::optional<std::string> &getName() const noexcept;
     ///Set the value of the column name
     void setName(const std::string &pName) noexcept;
     void setName(std::string &&pName) noexcept;
@@ -119,6 +141,35 @@ class Department
 
     Json::Value toJson() const;
     Json::Value toMasqueradedJson(const std::vector<std::string> &pMasqueradingVector) const;
+    ///The descriptors of the fields, for drogon::orm::toJsonText() and drogon::orm::fromJsonText()
+    static constexpr auto jsonFields()
+    {
+        return drogon::orm::makeJsonFields(
+            &Department::dirtyFlag_,
+            drogon::orm::makeJsonField("id", &Department::id_, 0),
+            drogon::orm::makeJsonField("name", &Department::name_, 1));
+    }
+
+    /**
+     * @brief The values of a row of the table, with the strings borrowed from
+     * the query result instead of copied.
+     * @note A view must not outlive the result it is read from.
+     */
+    struct View
+    {
+        View(const drogon::orm::Row &r, const ColumnIndexes &indexes) noexcept;
+
+        drogon::optional<int32_t> id;
+        drogon::optional<drogon::string_view> name;
+
+        ///The descriptors of the fields, for drogon::orm::toJsonText()
+        static constexpr auto jsonFields()
+        {
+            return drogon::orm::makeJsonFields(
+                drogon::orm::makeJsonField("id", &View::id, 0),
+                drogon::orm::makeJsonField("name", &View::name, 1));
+        }
+    };
     /// Relationship interfaces
     void getPersons(const drogon::orm::DbClientPtr &clientPtr,
                     const std::function<void(std::vector<Person>)> &rcb,
@@ -134,8 +185,8 @@ class Department
     void updateArgs(drogon::orm::internal::SqlBinder &binder) const;
     ///For mysql or sqlite3
     void updateId(const uint64_t id);
-    std::shared_ptr<int32_t> id_;
-    std::shared_ptr<std::string> name_;
+    drogon::optional<int32_t> id_;
+    drogon::optional<std::string> name_;
     struct MetaData
     {
         const std::string colName_;
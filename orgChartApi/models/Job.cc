@@ -35,11 +35,11 @@ Job::Job(const Row &r, const ssize_t indexOffset) noexcept
     {
         if(!r["id"].isNull())
         {
-            id_=std::make_shared<int32_t>(r["id"].as<int32_t>());
+            id_.emplace(r["id"].as<int32_t>());
         }
         if(!r["title"].isNull())
         {
-            title_=std::make_shared<std::string>(r["title"].as<std::string>());
+            title_.emplace(r["title"].as<std::string>());
         }
     }
     else
@@ -54,17 +54,66 @@ Job::Job(const Row &r, const ssize_t indexOffset) noexcept
         index = offset + 0;
         if(!r[index].isNull())
         {
-            id_=std::make_shared<int32_t>(r[index].as<int32_t>());
+            id_.emplace(r[index].as<int32_t>());
         }
         index = offset + 1;
         if(!r[index].isNull())
         {
-            title_=std::make_shared<std::string>(r[index].as<std::string>());
+            title_.emplace(r[index].as<std::string>());
         }
     }
 
 }
 
+Job::ColumnIndexes Job::columnIndexes(const Result &r)
+{
+    ColumnIndexes indexes;
+    indexes.fill(-1);
+    for(Result::RowSizeType i = 0; i < r.columns(); ++i)
+    {
+        const char *name = r.columnName(i);
+        for(size_t j = 0; j < metaData_.size(); ++j)
+        {
+            if(indexes[j] < 0 && metaData_[j].colName_ == name)
+            {
+                indexes[j] = (ssize_t)i;
+                break;
+            }
+        }
+    }
+    return indexes;
+}
+
+Job::Job(const Row &r, const ColumnIndexes &indexes) noexcept
+{
+    ssize_t index;
+    index = indexes[0];
+    if(index >= 0 && !r[(size_t)index].isNull())
+    {
+        id_.emplace(r[(size_t)index].as<int32_t>());
+    }
+    index = indexes[1];
+    if(index >= 0 && !r[(size_t)index].isNull())
+    {
+        title_.emplace(r[(size_t)index].as<std::string>());
+    }
+}
+
+Job::View::View(const Row &r, const ColumnIndexes &indexes) noexcept
+{
+    ssize_t index;
+    index = indexes[0];
+    if(index >= 0 && !r[(size_t)index].isNull())
+    {
+        id.emplace(r[(size_t)index].as<int32_t>());
+    }
+    index = indexes[1];
+    if(index >= 0 && !r[(size_t)index].isNull())
+    {
+        title.emplace(r[(size_t)index].as<string_view>());
+    }
+}
+
 Job::Job(const Json::Value &pJson, const std::vector<std::string> &pMasqueradingVector) noexcept(false)
 {
     if(pMasqueradingVector.size() != 2)
@@ -77,7 +126,7 @@ Job::Job(const Json::Value &pJson, const std::vector<std::string> &pMasquerading
         dirtyFlag_[0] = true;
         if(!pJson[pMasqueradingVector[0]].isNull())
         {
-            id_=std::make_shared<int32_t>((int32_t)pJson[pMasqueradingVector[0]].asInt64());
+            id_.emplace((int32_t)pJson[pMasqueradingVector[0]].asInt64());
         }
     }
     if(!pMasqueradingVector[1].empty() && pJson.isMember(pMasqueradingVector[1]))
@@ -85,7 +134,7 @@ Job::Job(const Json::Value &pJson, const std::vector<std::string> &pMasquerading
         dirtyFlag_[1] = true;
         if(!pJson[pMasqueradingVector[1]].isNull())
         {
-            title_=std::make_shared<std::string>(pJson[pMasqueradingVector[1]].asString());
+            title_.emplace(pJson[pMasqueradingVector[1]].asString());
         }
     }
 }
@@ -97,7 +146,7 @@ Job::Job(const Json::Value &pJson) noexcept(false)
         dirtyFlag_[0]=true;
         if(!pJson["id"].isNull())
         {
-            id_=std::make_shared<int32_t>((int32_t)pJson["id"].asInt64());
+            id_.emplace((int32_t)pJson["id"].asInt64());
         }
     }
     if(pJson.isMember("title"))
@@ -105,7 +154,7 @@ Job::Job(const Json::Value &pJson) noexcept(false)
         dirtyFlag_[1]=true;
         if(!pJson["title"].isNull())
         {
-            title_=std::make_shared<std::string>(pJson["title"].asString());
+            title_.emplace(pJson["title"].asString());
         }
     }
 }
@@ -122,7 +171,7 @@ void Job::updateByMasqueradedJson(const Json::Value &pJson,
     {
         if(!pJson[pMasqueradingVector[0]].isNull())
         {
-            id_=std::make_shared<int32_t>((int32_t)pJson[pMasqueradingVector[0]].asInt64());
+            id_.emplace((int32_t)pJson[pMasqueradingVector[0]].asInt64());
         }
     }
     if(!pMasqueradingVector[1].empty() && pJson.isMember(pMasqueradingVector[1]))
@@ -130,7 +179,7 @@ void Job::updateByMasqueradedJson(const Json::Value &pJson,
         dirtyFlag_[1] = true;
         if(!pJson[pMasqueradingVector[1]].isNull())
         {
-            title_=std::make_shared<std::string>(pJson[pMasqueradingVector[1]].asString());
+            title_.emplace(pJson[pMasqueradingVector[1]].asString());
         }
     }
 }
@@ -141,7 +190,7 @@ void Job::updateByJson(const Json::Value &pJson) noexcept(false)
     {
         if(!pJson["id"].isNull())
         {
-            id_=std::make_shared<int32_t>((int32_t)pJson["id"].asInt64());
+            id_.emplace((int32_t)pJson["id"].asInt64());
         }
     }
     if(pJson.isMember("title"))
@@ -149,7 +198,7 @@ void Job::updateByJson(const Json::Value &pJson) noexcept(false)
         dirtyFlag_[1] = true;
         if(!pJson["title"].isNull())
         {
-            title_=std::make_shared<std::string>(pJson["title"].asString());
+            title_.emplace(pJson["title"].asString());
         }
     }
 }
@@ -161,13 +210,13 @@ const int32_t &Job::getValueOfId() const noexcept
         return *id_;
     return defaultValue;
 }
-const std::shared_ptr<int32_t> &Job::getId() const noexcept
+const drogon::optional<int32_t> &Job::getId() const noexcept
 {
     return id_;
 }
 void Job::setId(const int32_t &pId) noexcept
 {
-    id_ = std::make_shared<int32_t>(pId);
+    id_.emplace(pId);
     dirtyFlag_[0] = true;
 }
 const typename Job::PrimaryKeyType & Job::getPrimaryKey() const
@@ -183,18 +232,18 @@ const std::string &Job::getValueOfTitle() const noexcept
         return *title_;
     return defaultValue;
 }
-const std::shared_ptr<std::string> &Job::getTitle() const noexcept
+const drogon::optional<std::string> &Job::getTitle() const noexcept
 {
     return title_;
 }
 void Job::setTitle(const std::string &pTitle) noexcept
 {
-    title_ = std::make_shared<std::string>(pTitle);
+    title_.emplace(pTitle);
     dirtyFlag_[1] = true;
 }
 void Job::setTitle(std::string &&pTitle) noexcept
 {
-    title_ = std::make_shared<std::string>(std::move(pTitle));
+    title_.emplace(std::move(pTitle));
     dirtyFlag_[1] = true;
 }
 
@@ -498,7 +547,7 @@ void Job::getPersons(const DbClientPtr &clientPtr,
                    {
                        ret.emplace_back(Person(row));
                    }
-                   rcb(ret);
+                   rcb(std::move(ret));
                }
                >> ecb;
 }
@@ -11,6 +11,9 @@
 #include <drogon/orm/Field.h>
 #include <drogon/orm/SqlBinder.h>
 #include <drogon/orm/Mapper.h>
+#include <drogon/orm/JsonSerializer.h>
+#include <drogon/utils/optional.h>
+#include <drogon/utils/string_view.h>
 #ifdef __cpp_impl_coroutine
 #include <drogon/orm/CoroMapper.h>
 #endif
@@ -20,6 +23,7 @@
 #include <string>
 #include <memory>
 #include <vector>
+#include <array>
 #include <tuple>
 #include <stdint.h>
 #include <iostream>
@@ -71,6 +75,24 @@ class Person
      */
     explicit Person(const drogon::orm::Row &r, const ssize_t indexOffset = 0) noexcept;
 
+    /// The numbers of the columns of this model in a query result, -1 for the columns not in it
+    using ColumnIndexes = std::array<ssize_t, 7>;
+
+    /**
+     * @brief Find the columns of this model in a query result by their names.
+     * @note The indexes are found once and reused for every row of the result,
+     * which is faster than an offset of -1 when the SQL does not select all
+     * columns by an asterisk.
+     */
+    static ColumnIndexes columnIndexes(const drogon::orm::Result &r);
+
+    /**
+     * @brief constructor
+     * @param r One row of records in the SQL query result.
+     * @param indexes The indexes of the columns in the result, see columnIndexes().
+     */
+    Person(const drogon::orm::Row &r, const ColumnIndexes &indexes) noexcept;
+
     /**
      * @brief constructor
      * @param pJson The json object to construct a new instance.
@@ -106,40 +128,40 @@ class Person
     /**  For column id  */
     ///Get the value of the column id, returns the default value if the column is null
     const int32_t &getValueOfId() const noexcept;
-    ///Return a shared_ptr object pointing to the column const value, or an empty shared_ptr object if the column is null
-    const std::shared_ptr<int32_t> &getId() const noexcept;
+    ///Return the optional value of the column, which is empty if the column is null
+    const drogon::optional<int32_t> &getId() const noexcept;
     ///Set the value of the column id
     void setId(const int32_t &pId) noexcept;
 
     /**  For column job_id  */
     ///Get the value of the column job_id, returns the default value if the column is null
     const int32_t &getValueOfJobId() const noexcept;
-    ///Return a shared_ptr object pointing to the column const value, or an empty shared_ptr object if the column is null
-    const std::shared_ptr<int32_t> &getJobId() const noexcept;
+    ///Return the optional value of the column, which is empty if the column is null
+    const drogon::optional<int32_t> &getJobId() const noexcept;
     ///Set the value of the column job_id
     void setJobId(const int32_t &pJobId) noexcept;
 
     /**  For column department_id  */
     ///Get the value of the column department_id, returns the default value if the column is null
     const int32_t &getValueOfDepartmentId() const noexcept;
-    ///Return a shared_ptr object pointing to the column const value, or an empty shared_ptr object if the column is null
-    const std::shared_ptr<int32_t> &getDepartmentId() const noexcept;
+    ///Return the optional value of the column, which is empty if the column is null
+    const drogon::optional<int32_t> &getDepartmentId() const noexcept;
     ///Set the value of the column department_id
     void setDepartmentId(const int32_t &pDepartmentId) noexcept;
 
     /**  For column manager_id  */
     ///Get the value of the column manager_id, returns the default value if the column is null
     const int32_t &getValueOfManagerId() const noexcept;
-    ///Return a shared_ptr object pointing to the column const value, or an empty shared_ptr object if the column is null
-    const std::shared_ptr<int32_t> &getManagerId() const noexcept;
+    ///Return the optional value of the column, which is empty if the column is null
+    const drogon::optional<int32_t> &getManagerId() const noexcept;
     ///Set the value of the column manager_id
     void setManagerId(const int32_t &pManagerId) noexcept;
 
     /**  For column first_name  */
     ///Get the value of the column first_name, returns the default value if the column is null
     const std::string &getValueOfFirstName() const noexcept;
-    ///Return a shared_ptr object pointing to the column const value, or an empty shared_ptr object if the column is null
-    const std::shared_ptr<std::string> &getFirstName() const noexcept;
+    ///Return the optional value of the column, which is empty if the column is null
+    const drogon::optional<std::string> &getFirstName() const noexcept;
     ///Set the value of the column first_name
     void setFirstName(const std::string &pFirstName) noexcept;
     void setFirstName(std::string &&pFirstName) noexcept;
@@ -147,8 +169,8 @@ class Person
     /**  For column last_name  */
     ///Get the value of the column last_name, returns the default value if the column is null
     const std::string &getValueOfLastName() const noexcept;
-    ///Return a shared_ptr object pointing to the column const value, or an empty shared_ptr object if the column is null
-    const std::shared_ptr<std::string> &getLastName() const noexcept;
+    ///Return the optional value of the column, which is empty if the column is null
+    const drogon::optional<std::string> &getLastName() const noexcept;
     ///Set the value of the column last_name
     void setLastName(const std::string &pLastName) noexcept;
     void setLastName(std::string &&pLastName) noexcept;
@@ -156,8 +178,8 @@ class Person
     /**  For column hire_date  */
     ///Get the value of the column hire_date, returns the default value if the column is null
     const ::trantor::Date &getValueOfHireDate() const noexcept;
-    ///Return a shared_ptr object pointing to the column const value, or an empty shared_ptr object if the column is null
-    const std::shared_ptr<::trantor::Date> &getHireDate() const noexcept;
+    ///Return the optional value of the column, which is empty if the column is null
+    const drogon::optional<::trantor::Date> &getHireDate() const noexcept;
     ///Set the value of the column hire_date
     void setHireDate(const ::trantor::Date &pHireDate) noexcept;
 
@@ -167,6 +189,50 @@ class Person
 
     Json::Value toJson() const;
     Json::Value toMasqueradedJson(const std::vector<std::string> &pMasqueradingVector) const;
+    ///The descriptors of the fields, for drogon::orm::toJsonText() and drogon::orm::fromJsonText()
+    static constexpr auto jsonFields()
+    {
+        return drogon::orm::makeJsonFields(
+            &Person::dirtyFlag_,
+            drogon::orm::makeJsonField("department_id", &Person::departmentId_, 2),
+            drogon::orm::makeJsonField("first_name", &Person::firstName_, 4),
+            drogon::orm::makeJsonField("hire_date", &Person::hireDate_, 6, drogon::orm::JsonFormat::Date),
+            drogon::orm::makeJsonField("id", &Person::id_, 0),
+            drogon::orm::makeJsonField("job_id", &Person::jobId_, 1),
+            drogon::orm::makeJsonField("last_name", &Person::lastName_, 5),
+            drogon::orm::makeJsonField("manager_id", &Person::managerId_, 3));
+    }
+
+    /**
+     * @brief The values of a row of the table, with the strings borrowed from
+     * the query result instead of copied.
+     * @note A view must not outlive the result it is read from.
+     */
+    struct View
+    {
+        View(const drogon::orm::Row &r, const ColumnIndexes &indexes) noexcept;
+
+        drogon::optional<int32_t> id;
+        drogon::optional<int32_t> jobId;
+        drogon::optional<int32_t> departmentId;
+        drogon::optional<int32_t> managerId;
+        drogon::optional<drogon::string_view> firstName;
+        drogon::optional<drogon::string_view> lastName;
+        drogon::optional<::trantor::Date> hireDate;
+
+        ///The descriptors of the fields, for drogon::orm::toJsonText()
+        static constexpr auto jsonFields()
+        {
+            return drogon::orm::makeJsonFields(
+                drogon::orm::makeJsonField("department_id", &View::departmentId, 2),
+                drogon::orm::makeJsonField("first_name", &View::firstName, 4),
+                drogon::orm::makeJsonField("hire_date", &View::hireDate, 6, drogon::orm::JsonFormat::Date),
+                drogon::orm::makeJsonField("id", &View::id, 0),
+                drogon::orm::makeJsonField("job_id", &View::jobId, 1),
+                drogon::orm::makeJsonField("last_name", &View::lastName, 5),
+                drogon::orm::makeJsonField("manager_id", &View::managerId, 3));
+        }
+    };
     /// Relationship interfaces
     void getDepartment(const drogon::orm::DbClientPtr &clientPtr,
                        const std::function<void(Department)> &rcb,
@@ -188,13 +254,13 @@ class Person
     void updateArgs(drogon::orm::internal::SqlBinder &binder) const;
     ///For mysql or sqlite3
     void updateId(const uint64_t id);
-    std::shared_ptr<int32_t> id_;
-    std::shared_ptr<int32_t> jobId_;
-    std::shared_ptr<int32_t> departmentId_;
-    std::shared_ptr<int32_t> managerId_;
-    std::shared_ptr<std::string> firstName_;
-    std::shared_ptr<std::string> lastName_;
-    std::shared_ptr<::trantor::Date> hireDate_;
+    drogon::optional<int32_t> id_;
+    drogon::optional<int32_t> jobId_;
+    drogon::optional<int32_t> departmentId_;
+    drogon::optional<int32_t> managerId_;
+    drogon::optional<std::string> firstName_;
+    drogon::optional<std::string> lastName_;
+    drogon::optional<::trantor::Date> hireDate_;
     struct MetaData
     {
         const std::string colName_;
@@ -13,39 +13,39 @@ PersonInfo::PersonInfo(const Row &r, const ssize_t indexOffset) noexcept
     {
         if(!r["id"].isNull())
         {
-            id_=std::make_shared<int32_t>(r["id"].as<int32_t>());
+            id_.emplace(r["id"].as<int32_t>());
         }
         if(!r["job_id"].isNull())
         {
-            jobId_=std::make_shared<int32_t>(r["job_id"].as<int32_t>());
+            jobId_.emplace(r["job_id"].as<int32_t>());
         }
         if(!r["job_title"].isNull())
         {
-            jobTitle_=std::make_shared<std::string>(r["job_title"].as<std::string>());
+            jobTitle_.emplace(r["job_title"].as<std::string>());
         }
         if(!r["department_id"].isNull())
         {
-            departmentId_=std::make_shared<int32_t>(r["department_id"].as<int32_t>());
+            departmentId_.emplace(r["department_id"].as<int32_t>());
         }
         if(!r["department_name"].isNull())
         {
-            departmentName_=std::make_shared<std::string>(r["department_name"].as<std::string>());
+            departmentName_.emplace(r["department_name"].as<std::string>());
         }
         if(!r["manager_id"].isNull())
         {
-            managerId_=std::make_shared<int32_t>(r["manager_id"].as<int32_t>());
+            managerId_.emplace(r["manager_id"].as<int32_t>());
         }
         if(!r["manager_full_name"].isNull())
         {
-            managerFullName_=std::make_shared<std::string>(r["manager_full_name"].as<std::string>());
+            managerFullName_.emplace(r["manager_full_name"].as<std::string>());
         }
         if(!r["first_name"].isNull())
         {
-            firstName_=std::make_shared<std::string>(r["first_name"].as<std::string>());
+            firstName_.emplace(r["first_name"].as<std::string>());
         }
         if(!r["last_name"].isNull())
         {
-            lastName_=std::make_shared<std::string>(r["last_name"].as<std::string>());
+            lastName_.emplace(r["last_name"].as<std::string>());
         }
         if(!r["hire_date"].isNull())
         {
@@ -54,7 +54,7 @@ PersonInfo::PersonInfo(const Row &r, const ssize_t indexOffset) noexcept
             memset(&stm,0,sizeof(stm));
             strptime(daysStr.c_str(),"%Y-%m-%d",&stm);
             time_t t = mktime(&stm);
-            hireDate_=std::make_shared<::trantor::Date>(t*1000000);
+            hireDate_.emplace(t*1000000);
         }
     }
     else
@@ -69,32 +69,32 @@ PersonInfo::PersonInfo(const Row &r, const ssize_t indexOffset) noexcept
         index = offset + 0;
         if(!r[index].isNull())
         {
-            id_=std::make_shared<int32_t>(r[index].as<int32_t>());
+            id_.emplace(r[index].as<int32_t>());
         }
         index = offset + 1;
         if(!r[index].isNull())
         {
-            jobId_=std::make_shared<int32_t>(r[index].as<int32_t>());
+            jobId_.emplace(r[index].as<int32_t>());
         }
         index = offset + 2;
         if(!r[index].isNull())
         {
-            departmentId_=std::make_shared<int32_t>(r[index].as<int32_t>());
+            departmentId_.emplace(r[index].as<int32_t>());
         }
         index = offset + 3;
         if(!r[index].isNull())
         {
-            managerId_=std::make_shared<int32_t>(r[index].as<int32_t>());
+            managerId_.emplace(r[index].as<int32_t>());
         }
         index = offset + 4;
         if(!r[index].isNull())
         {
-            firstName_=std::make_shared<std::string>(r[index].as<std::string>());
+            firstName_.emplace(r[index].as<std::string>());
         }
         index = offset + 5;
         if(!r[index].isNull())
         {
-            lastName_=std::make_shared<std::string>(r[index].as<std::string>());
+            lastName_.emplace(r[index].as<std::string>());
         }
         index = offset + 6;
         if(!r[index].isNull())
@@ -104,22 +104,22 @@ PersonInfo::PersonInfo(const Row &r, const ssize_t indexOffset) noexcept
             memset(&stm,0,sizeof(stm));
             strptime(daysStr.c_str(),"%Y-%m-%d",&stm);
             time_t t = mktime(&stm);
-            hireDate_=std::make_shared<::trantor::Date>(t*1000000);
+            hireDate_.emplace(t*1000000);
         }
         index = offset + 7;
         if(!r[index].isNull())
         {
-            jobTitle_=std::make_shared<std::string>(r[index].as<std::string>());
+            jobTitle_.emplace(r[index].as<std::string>());
         }
         index = offset + 8;
         if(!r[index].isNull())
         {
-            departmentName_=std::make_shared<std::string>(r[index].as<std::string>());
+            departmentName_.emplace(r[index].as<std::string>());
         }
         index = offset + 9;
         if(!r[index].isNull())
         {
-            managerFullName_=std::make_shared<std::string>(r[index].as<std::string>());
+            managerFullName_.emplace(r[index].as<std::string>());
         }
     }
 
@@ -132,7 +132,7 @@ const int32_t &PersonInfo::getValueOfId() const noexcept
         return *id_;
     return defaultValue;
 }
-const std::shared_ptr<int32_t> &PersonInfo::getId() const noexcept
+const drogon::optional<int32_t> &PersonInfo::getId() const noexcept
 {
     return id_;
 }
@@ -144,7 +144,7 @@ const int32_t &PersonInfo::getValueOfJobId() const noexcept
         return *jobId_;
     return defaultValue;
 }
-const std::shared_ptr<int32_t> &PersonInfo::getJobId() const noexcept
+const drogon::optional<int32_t> &PersonInfo::getJobId() const noexcept
 {
     return jobId_;
 }
@@ -156,7 +156,7 @@ const std::string &PersonInfo::getValueOfJobTitle() const noexcept
         return *jobTitle_;
     return defaultValue;
 }
-const std::shared_ptr<std::string> &PersonInfo::getJobTitle() const noexcept
+const drogon::optional<std::string> &PersonInfo::getJobTitle() const noexcept
 {
     return jobTitle_;
 }
@@ -168,7 +168,7 @@ const int32_t &PersonInfo::getValueOfDepartmentId() const noexcept
         return *departmentId_;
     return defaultValue;
 }
-const std::shared_ptr<int32_t> &PersonInfo::getDepartmentId() const noexcept
+const drogon::optional<int32_t> &PersonInfo::getDepartmentId() const noexcept
 {
     return departmentId_;
 }
@@ -180,7 +180,7 @@ const std::string &PersonInfo::getValueOfDepartmentName() const noexcept
         return *departmentName_;
     return defaultValue;
 }
-const std::shared_ptr<std::string> &PersonInfo::getDepartmentName() const noexcept
+const drogon::optional<std::string> &PersonInfo::getDepartmentName() const noexcept
 {
     return departmentName_;
 }
@@ -192,7 +192,7 @@ const int32_t &PersonInfo::getValueOfManagerId() const noexcept
         return *managerId_;
     return defaultValue;
 }
-const std::shared_ptr<int32_t> &PersonInfo::getManagerId() const noexcept
+const drogon::optional<int32_t> &PersonInfo::getManagerId() const noexcept
 {
     return managerId_;
 }
@@ -204,7 +204,7 @@ const std::string &PersonInfo::getValueOfManagerFullName() const noexcept
         return *managerFullName_;
     return defaultValue;
 }
-const std::shared_ptr<std::string> &PersonInfo::getManagerFullName() const noexcept
+const drogon::optional<std::string> &PersonInfo::getManagerFullName() const noexcept
 {
     return managerFullName_;
 }
@@ -216,7 +216,7 @@ const std::string &PersonInfo::getValueOfFirstName() const noexcept
         return *firstName_;
     return defaultValue;
 }
-const std::shared_ptr<std::string> &PersonInfo::getFirstName() const noexcept
+const drogon::optional<std::string> &PersonInfo::getFirstName() const noexcept
 {
     return firstName_;
 }
@@ -228,7 +228,7 @@ const std::string &PersonInfo::getValueOfLastName() const noexcept
         return *lastName_;
     return defaultValue;
 }
-const std::shared_ptr<std::string> &PersonInfo::getLastName() const noexcept
+const drogon::optional<std::string> &PersonInfo::getLastName() const noexcept
 {
     return lastName_;
 }
@@ -240,7 +240,7 @@ const ::trantor::Date &PersonInfo::getValueOfHireDate() const noexcept
         return *hireDate_;
     return defaultValue;
 }
-const std::shared_ptr<::trantor::Date> &PersonInfo::getHireDate() const noexcept
+const drogon::optional<::trantor::Date> &PersonInfo::getHireDate() const noexcept
 {
     return hireDate_;
 }
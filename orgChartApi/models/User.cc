@@ -36,15 +36,15 @@ User::User(const Row &r, const ssize_t indexOffset) noexcept
     {
         if(!r["id"].isNull())
         {
-            id_=std::make_shared<int32_t>(r["id"].as<int32_t>());
+            id_.emplace(r["id"].as<int32_t>());
         }
         if(!r["username"].isNull())
         {
-            username_=std::make_shared<std::string>(r["username"].as<std::string>());
+            username_.emplace(r["username"].as<std::string>());
         }
         if(!r["password"].isNull())
         {
-            password_=std::make_shared<std::string>(r["password"].as<std::string>());
+            password_.emplace(r["password"].as<std::string>());
         }
     }
     else
@@ -59,22 +59,81 @@ User::User(const Row &r, const ssize_t indexOffset) noexcept
         index = offset + 0;
         if(!r[index].isNull())
         {
-            id_=std::make_shared<int32_t>(r[index].as<int32_t>());
+            id_.emplace(r[index].as<int32_t>());
         }
         index = offset + 1;
         if(!r[index].isNull())
         {
-            username_=std::make_shared<std::string>(r[index].as<std::string>());
+            username_.emplace(r[index].as<std::string>());
         }
         index = offset + 2;
         if(!r[index].isNull())
         {
-            password_=std::make_shared<std::string>(r[index].as<std::string>());
+            password_.emplace(r[index].as<std::string>());
         }
     }
 
 }
 
+User::ColumnIndexes User::columnIndexes(const Result &r)
+{
+    ColumnIndexes indexes;
+    indexes.fill(-1);
+    for(Result::RowSizeType i = 0; i < r.columns(); ++i)
+    {
+        const char *name = r.columnName(i);
+        for(size_t j = 0; j < metaData_.size(); ++j)
+        {
+            if(indexes[j] < 0 && metaData_[j].colName_ == name)
+            {
+                indexes[j] = (ssize_t)i;
+                break;
+            }
+        }
+    }
+    return indexes;
+}
+
+User::User(const Row &r, const ColumnIndexes &indexes) noexcept
+{
+    ssize_t index;
+    index = indexes[0];
+    if(index >= 0 && !r[(size_t)index].isNull())
+    {
+        id_.emplace(r[(size_t)index].as<int32_t>());
+    }
+    index = indexes[1];
+    if(index >= 0 && !r[(size_t)index].isNull())
+    {
+        username_.emplace(r[(size_t)index].as<std::string>());
+    }
+    index = indexes[2];
+    if(index >= 0 && !r[(size_t)index].isNull())
+    {
+        password_.emplace(r[(size_t)index].as<std::string>());
+    }
+}
+
+User::View::View(const Row &r, const ColumnIndexes &indexes) noexcept
+{
+    ssize_t index;
+    index = indexes[0];
+    if(index >= 0 && !r[(size_t)index].isNull())
+    {
+        id.emplace(r[(size_t)index].as<int32_t>());
+    }
+    index = indexes[1];
+    if(index >= 0 && !r[(size_t)index].isNull())
+    {
+        username.emplace(r[(size_t)index].as<string_view>());
+    }
+    index = indexes[2];
+    if(index >= 0 && !r[(size_t)index].isNull())
+    {
+        password.emplace(r[(size_t)index].as<string_view>());
+    }
+}
+
 User::User(const Json::Value &pJson, const std::vector<std::string> &pMasqueradingVector) noexcept(false)
 {
     if(pMasqueradingVector.size() != 3)
@@ -87,7 +146,7 @@ User::User(const Json::Value &pJson, const std::vector<std::string> &pMasqueradi
         dirtyFlag_[0] = true;
         if(!pJson[pMasqueradingVector[0]].isNull())
         {
-            id_=std::make_shared<int32_t>((int32_t)pJson[pMasqueradingVector[0]].asInt64());
+            id_.emplace((int32_t)pJson[pMasqueradingVector[0]].asInt64());
         }
     }
     if(!pMasqueradingVector[1].empty() && pJson.isMember(pMasqueradingVector[1]))
@@ -95,7 +154,7 @@ User::User(const Json::Value &pJson, const std::vector<std::string> &pMasqueradi
         dirtyFlag_[1] = true;
         if(!pJson[pMasqueradingVector[1]].isNull())
         {
-            username_=std::make_shared<std::string>(pJson[pMasqueradingVector[1]].asString());
+            username_.emplace(pJson[pMasqueradingVector[1]].asString());
         }
     }
     if(!pMasqueradingVector[2].empty() && pJson.isMember(pMasqueradingVector[2]))
@@ -103,7 +162,7 @@ User::User(const Json::Value &pJson, const std::vector<std::string> &pMasqueradi
         dirtyFlag_[2] = true;
         if(!pJson[pMasqueradingVector[2]].isNull())
         {
-            password_=std::make_shared<std::string>(pJson[pMasqueradingVector[2]].asString());
+            password_.emplace(pJson[pMasqueradingVector[2]].asString());
         }
     }
 }
@@ -115,7 +174,7 @@ User::User(const Json::Value &pJson) noexcept(false)
         dirtyFlag_[0]=true;
         if(!pJson["id"].isNull())
         {
-            id_=std::make_shared<int32_t>((int32_t)pJson["id"].asInt64());
+            id_.emplace((int32_t)pJson["id"].asInt64());
         }
     }
     if(pJson.isMember("username"))
@@ -123,7 +182,7 @@ User::User(const Json::Value &pJson) noexcept(false)
         dirtyFlag_[1]=true;
         if(!pJson["username"].isNull())
         {
-            username_=std::make_shared<std::string>(pJson["username"].asString());
+            username_.emplace(pJson["username"].asString());
         }
     }
     if(pJson.isMember("password"))
@@ -131,7 +190,7 @@ User::User(const Json::Value &pJson) noexcept(false)
         dirtyFlag_[2]=true;
         if(!pJson["password"].isNull())
         {
-            password_=std::make_shared<std::string>(pJson["password"].asString());
+            password_.emplace(pJson["password"].asString());
         }
     }
 }
@@ -148,7 +207,7 @@ void User::updateByMasqueradedJson(const Json::Value &pJson,
     {
         if(!pJson[pMasqueradingVector[0]].isNull())
         {
-            id_=std::make_shared<int32_t>((int32_t)pJson[pMasqueradingVector[0]].asInt64());
+            id_.emplace((int32_t)pJson[pMasqueradingVector[0]].asInt64());
         }
     }
     if(!pMasqueradingVector[1].empty() && pJson.isMember(pMasqueradingVector[1]))
@@ -156,7 +215,7 @@ void User::updateByMasqueradedJson(const Json::Value &pJson,
         dirtyFlag_[1] = true;
         if(!pJson[pMasqueradingVector[1]].isNull())
         {
-            username_=std::make_shared<std::string>(pJson[pMasqueradingVector[1]].asString());
+            username_.emplace(pJson[pMasqueradingVector[1]].asString());
         }
     }
     if(!pMasqueradingVector[2].empty() && pJson.isMember(pMasqueradingVector[2]))
@@ -164,7 +223,7 @@ void User::updateByMasqueradedJson(const Json::Value &pJson,
         dirtyFlag_[2] = true;
         if(!pJson[pMasqueradingVector[2]].isNull())
         {
-            password_=std::make_shared<std::string>(pJson[pMasqueradingVector[2]].asString());
+            password_.emplace(pJson[pMasqueradingVector[2]].asString());
         }
     }
 }
@@ -175,7 +234,7 @@ void User::updateByJson(const Json::Value &pJson) noexcept(false)
     {
         if(!pJson["id"].isNull())
         {
-            id_=std::make_shared<int32_t>((int32_t)pJson["id"].asInt64());
+            id_.emplace((int32_t)pJson["id"].asInt64());
         }
     }
     if(pJson.isMember("username"))
@@ -183,7 +242,7 @@ void User::updateByJson(const Json::Value &pJson) noexcept(false)
         dirtyFlag_[1] = true;
         if(!pJson["username"].isNull())
         {
-            username_=std::make_shared<std::string>(pJson["username"].asString());
+            username_.emplace(pJson["username"].asString());
         }
     }
     if(pJson.isMember("password"))
@@ -191,7 +250,7 @@ void User::updateByJson(const Json::Value &pJson) noexcept(false)
         dirtyFlag_[2] = true;
         if(!pJson["password"].isNull())
         {
-            password_=std::make_shared<std::string>(pJson["password"].asString());
+            password_.emplace(pJson["password"].asString());
         }
     }
 }
@@ -203,13 +262,13 @@ const int32_t &User::getValueOfId() const noexcept
         return *id_;
     return defaultValue;
 }
-const std::shared_ptr<int32_t> &User::getId() const noexcept
+const drogon::optional<int32_t> &User::getId() const noexcept
 {
     return id_;
 }
 void User::setId(const int32_t &pId) noexcept
 {
-    id_ = std::make_shared<int32_t>(pId);
+    id_.emplace(pId);
     dirtyFlag_[0] = true;
 }
 const typename User::PrimaryKeyType & User::getPrimaryKey() const
@@ -225,18 +284,18 @@ const std::string &User::getValueOfUsername() const noexcept
         return *username_;
     return defaultValue;
 }
-const std::shared_ptr<std::string> &User::getUsername() const noexcept
+const drogon::optional<std::string> &User::getUsername() const noexcept
 {
     return username_;
 }
 void User::setUsername(const std::string &pUsername) noexcept
 {
-    username_ = std::make_shared<std::string>(pUsername);
+    username_.emplace(pUsername);
     dirtyFlag_[1] = true;
 }
 void User::setUsername(std::string &&pUsername) noexcept
 {
-    username_ = std::make_shared<std::string>(std::move(pUsername));
+    username_.emplace(std::move(pUsername));
     dirtyFlag_[1] = true;
 }
 
@@ -247,18 +306,18 @@ const std::string &User::getValueOfPassword() const noexcept
         return *password_;
     return defaultValue;
 }
-const std::shared_ptr<std::string> &User::getPassword() const noexcept
+const drogon::optional<std::string> &User::getPassword() const noexcept
 {
     return password_;
 }
 void User::setPassword(const std::string &pPassword) noexcept
 {
-    password_ = std::make_shared<std::string>(pPassword);
+    password_.emplace(pPassword);
     dirtyFlag_[2] = true;
 }
 void User::setPassword(std::string &&pPassword) noexcept
 {
-    password_ = std::make_shared<std::string>(std::move(pPassword));
+    password_.emplace(std::move(pPassword));
     dirtyFlag_[2] = true;
 }
 
@@ -1,28 +1,222 @@
 #include <drogon/drogon.h>
+#include <array>
+#include <cctype>
+#include <openssl/crypto.h>
+#include <openssl/sha.h>
+#include <stdexcept>
 #include <utility>
 #include "Jwt.h"
 
+namespace {
+using Traits = jwt::traits::open_source_parsers_jsoncpp;
+
+// The header jwt-cpp writes for this api, with the members sorted by name
+const std::string header = R"({"alg":"HS256","typ":"JWS"})";
+const char base64UrlChars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+// base64url without padding, as used by jwt-cpp
+void appendBase64Url(std::string &out, const unsigned char *data, size_t length) {
+    size_t i = 0;
+    for (; i + 3 <= length; i += 3) {
+        uint32_t n = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+        out += base64UrlChars[(n >> 18) & 0x3f];
+        out += base64UrlChars[(n >> 12) & 0x3f];
+        out += base64UrlChars[(n >> 6) & 0x3f];
+        out += base64UrlChars[n & 0x3f];
+    }
+    if (i + 1 == length) {
+        uint32_t n = data[i] << 16;
+        out += base64UrlChars[(n >> 18) & 0x3f];
+        out += base64UrlChars[(n >> 12) & 0x3f];
+    } else if (i + 2 == length) {
+        uint32_t n = (data[i] << 16) | (data[i + 1] << 8);
+        out += base64UrlChars[(n >> 18) & 0x3f];
+        out += base64UrlChars[(n >> 12) & 0x3f];
+        out += base64UrlChars[(n >> 6) & 0x3f];
+    }
+}
+
+// Sextet of each base64url character, 64 for characters outside the alphabet
+const auto base64UrlValues = [] {
+    std::array<unsigned char, 256> values;
+    values.fill(64);
+    for (unsigned char i = 0; i < 64; ++i) {
+        values[static_cast<unsigned char>(base64UrlChars[i])] = i;
+    }
+    return values;
+}();
+
+// Decode base64url without padding, throws like jwt-cpp's decoder on bad input
+auto decodeBase64Url(const std::string &in) -> std::string {
+    if (in.size() % 4 == 1) {
+        throw std::runtime_error("Invalid input: incorrect total size");
+    }
+    std::string out;
+    out.reserve(in.size() / 4 * 3 + 2);
+    uint32_t bits = 0;
+    unsigned count = 0;
+    unsigned char invalid = 0;
+    for (auto c : in) {
+        auto value = base64UrlValues[static_cast<unsigned char>(c)];
+        invalid |= value;
+        bits = (bits << 6) | (value & 0x3f);
+        if (++count == 4) {
+            out += static_cast<char>(bits >> 16);
+            out += static_cast<char>(bits >> 8);
+            out += static_cast<char>(bits);
+            bits = 0;
+            count = 0;
+        }
+    }
+    if (invalid & 64) {
+        throw std::runtime_error("Invalid input: not within alphabet");
+    }
+    if (count == 2) {
+        out += static_cast<char>(bits >> 4);
+    } else if (count == 3) {
+        out += static_cast<char>(bits >> 10);
+        out += static_cast<char>(bits >> 2);
+    }
+    return out;
+}
+
+auto newDigest(const unsigned char *key, unsigned char pad) -> std::shared_ptr<EVP_MD_CTX> {
+    std::shared_ptr<EVP_MD_CTX> ctx(EVP_MD_CTX_new(), EVP_MD_CTX_free);
+    unsigned char block[SHA256_CBLOCK];
+    for (size_t i = 0; i < sizeof(block); ++i) {
+        block[i] = key[i] ^ pad;
+    }
+    if (!ctx || !EVP_DigestInit_ex(ctx.get(), EVP_sha256(), nullptr) ||
+        !EVP_DigestUpdate(ctx.get(), block, sizeof(block))) {
+        throw std::runtime_error("failed to initialize HS256 key");
+    }
+    OPENSSL_cleanse(block, sizeof(block));
+    return ctx;
+}
+
+// Names that can be written into the payload without escaping
+auto isPlainName(const std::string &name) -> bool {
+    if (name.empty()) {
+        return false;
+    }
+    for (auto c : name) {
+        if (!isalnum(static_cast<unsigned char>(c)) && c != '_' && c != '-') {
+            return false;
+        }
+    }
+    return true;
+}
+}  // namespace
+
+Hs256::Hs256(const std::string &secret) {
+    // Keys longer than a block are hashed first, shorter ones are padded with zeros
+    unsigned char key[SHA256_CBLOCK] = {0};
+    if (secret.size() > sizeof(key)) {
+        SHA256(reinterpret_cast<const unsigned char *>(secret.data()), secret.size(), key);
+    } else {
+        std::copy(secret.begin(), secret.end(), key);
+    }
+    inner = newDigest(key, 0x36);
+    outer = newDigest(key, 0x5c);
+    OPENSSL_cleanse(key, sizeof(key));
+}
+
+auto Hs256::mac(const char *data, size_t length, unsigned char *out) const -> bool {
+    std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)> ctx(EVP_MD_CTX_new(), EVP_MD_CTX_free);
+    unsigned int size = 0;
+    return ctx &&
+        EVP_MD_CTX_copy_ex(ctx.get(), inner.get()) &&
+        EVP_DigestUpdate(ctx.get(), data, length) &&
+        EVP_DigestFinal_ex(ctx.get(), out, &size) &&
+        EVP_MD_CTX_copy_ex(ctx.get(), outer.get()) &&
+        EVP_DigestUpdate(ctx.get(), out, size) &&
+        EVP_DigestFinal_ex(ctx.get(), out, &size);
+}
+
+auto Hs256::sign(const std::string &data, std::error_code &ec) const -> std::string {
+    ec.clear();
+    unsigned char out[macLength];
+    if (!mac(data.data(), data.size(), out)) {
+        ec = jwt::error::signature_generation_error::hmac_failed;
+        return {};
+    }
+    return std::string(reinterpret_cast<const char *>(out), sizeof(out));
+}
+
+void Hs256::verify(const std::string &data, const std::string &signature, std::error_code &ec) const {
+    ec.clear();
+    unsigned char out[macLength];
+    if (!mac(data.data(), data.size(), out)) {
+        ec = jwt::error::signature_verification_error::invalid_signature;
+        return;
+    }
+    if (signature.size() != sizeof(out) || CRYPTO_memcmp(signature.data(), out, sizeof(out)) != 0) {
+        ec = jwt::error::signature_verification_error::invalid_signature;
+    }
+}
+
 Jwt::Jwt(const std::string &secret, const int sessionTime, const std::string &issuer) :
-  secret{std::move(secret)}, sessionTime{sessionTime}, issuer{std::move(issuer)} {}
+  hs256{secret},
+  verifier{jwt::verify<Traits>().allow_algorithm(hs256).with_issuer(issuer)},
+  sessionTime{sessionTime},
+  issuer{issuer},
+  issuerJson{Traits::serialize(Json::Value(issuer))} {
+    appendBase64Url(headerPrefix, reinterpret_cast<const unsigned char *>(header.data()), header.size());
+    headerPrefix += '.';
+}
+
+auto Jwt::encode(const std::string &field, const int value) const -> std::string {
+    // The claims are written in the order jwt-cpp would write them: exp, iat,
+    // iss and then the field, so the field has to sort after "iss".
+    if (!isPlainName(field) || field <= "iss") {
+        return encodeWithClaims(field, value);
+    }
+    auto time = std::chrono::system_clock::now();
+    auto issuedAt = std::chrono::system_clock::to_time_t(time);
+    auto expiresAt = std::chrono::duration_cast<std::chrono::seconds>((time + std::chrono::seconds{sessionTime}).time_since_epoch()).count();
+
+    std::string payload;
+    payload.reserve(64 + issuerJson.size() + field.size());
+    payload += "{\"exp\":";
+    payload += std::to_string(expiresAt);
+    payload += ",\"iat\":";
+    payload += std::to_string(issuedAt);
+    payload += ",\"iss\":";
+    payload += issuerJson;
+    payload += ",\"";
+    payload += field;
+    payload += "\":\"";
+    payload += std::to_string(value);
+    payload += "\"}";
+
+    std::string token;
+    token.reserve(headerPrefix.size() + (payload.size() + 2) / 3 * 4 + 1 + (Hs256::macLength + 2) / 3 * 4);
+    token += headerPrefix;
+    appendBase64Url(token, reinterpret_cast<const unsigned char *>(payload.data()), payload.size());
+    unsigned char signature[Hs256::macLength];
+    if (!hs256.mac(token.data(), token.size(), signature)) {
+        throw jwt::error::signature_generation_exception(jwt::error::signature_generation_error::hmac_failed);
+    }
+    token += '.';
+    appendBase64Url(token, signature, sizeof(signature));
+    return token;
+}
 
-auto Jwt::encode(const std::string &field, const int value) -> std::string {
+auto Jwt::encodeWithClaims(const std::string &field, const int value) const -> std::string {
     auto time = std::chrono::system_clock::now();
     auto expiresAt = std::chrono::duration_cast<std::chrono::seconds>((time + std::chrono::seconds{sessionTime}).time_since_epoch()).count();
-    auto token = jwt::create()
+    auto token = jwt::create<Traits>()
         .set_issuer(issuer)
         .set_type("JWS")
         .set_issued_at(time)
         .set_expires_at(std::chrono::system_clock::from_time_t(expiresAt))
-        .set_payload_claim(field, jwt::claim(std::to_string(value)))
-        .sign(jwt::algorithm::hs256{secret});
+        .set_payload_claim(field, jwt::basic_claim<Traits>(std::to_string(value)))
+        .sign(hs256);
     return token;
 }
 
-auto Jwt::decode(const std::string& token) -> jwt::decoded_jwt<jwt::traits::kazuho_picojson> {
-    auto verifier = jwt::verify()
-        .allow_algorithm(jwt::algorithm::hs256{secret})
-        .with_issuer(issuer);
-    auto decoded = jwt::decode(token);
+auto Jwt::decode(const std::string& token) const -> jwt::decoded_jwt<jwt::traits::open_source_parsers_jsoncpp> {
+    auto decoded = jwt::decode<Traits>(token, decodeBase64Url);
     verifier.verify(decoded);
     return decoded;
 }
@@ -1,16 +1,47 @@
 #pragma once
 
-#include <jwt-cpp/jwt.h>
+#include <jwt-cpp/traits/open-source-parsers-jsoncpp/traits.h>
+#include <openssl/evp.h>
+#include <memory>
 #include <string>
+#include <system_error>
+
+/// HMAC-SHA256 for jwt-cpp with the key schedule done once: the hash states
+/// after the inner and outer padded keys are kept and copied for each token.
+/// It can be given wherever jwt-cpp takes an algorithm, e.g.
+/// jwt::create().sign(hs256) or jwt::verify().allow_algorithm(hs256).
+class Hs256 {
+ public:
+    static constexpr size_t macLength = 32;
+
+    explicit Hs256(const std::string &secret);
+    auto sign(const std::string &data, std::error_code &ec) const -> std::string;
+    void verify(const std::string &data, const std::string &signature, std::error_code &ec) const;
+    auto name() const -> std::string { return "HS256"; }
+    /// Write the MAC of data to out, which holds macLength bytes.
+    auto mac(const char *data, size_t length, unsigned char *out) const -> bool;
+
+ private:
+    // Shared and never modified after construction, jwt-cpp copies the
+    // algorithms it is given.
+    std::shared_ptr<EVP_MD_CTX> inner;
+    std::shared_ptr<EVP_MD_CTX> outer;
+};
 
 class Jwt {
  public:
     Jwt(const std::string &secret, const int sessionTime, const std::string &issuer);
-    auto encode(const std::string &field, const int value) -> std::string;
-    auto decode(const std::string& token) -> jwt::decoded_jwt<jwt::traits::kazuho_picojson>;
+    auto encode(const std::string &field, const int value) const -> std::string;
+    auto decode(const std::string& token) const -> jwt::decoded_jwt<jwt::traits::open_source_parsers_jsoncpp>;
 
  private:
-    std::string secret;
+    auto encodeWithClaims(const std::string &field, const int value) const -> std::string;
+
+    Hs256 hs256;
+    jwt::verifier<jwt::default_clock, jwt::traits::open_source_parsers_jsoncpp> verifier;
     int sessionTime;
     std::string issuer;
+    // The base64url encoded header followed by a dot, and the issuer as a json string
+    std::string headerPrefix;
+    std::string issuerJson;
 };
@@ -5,17 +5,16 @@ using namespace drogon;
 
 void JwtPlugin::initAndStart(const Json::Value &config) {
     LOG_DEBUG << "JWT initialized and Start";
-    this->config = config;
+    auto secret = config.get("secret", "secret").asString();
+    auto sessionTime = config.get("sessionTime", 3600).asInt();
+    auto issuer = config.get("issuer", "auth0").asString();
+    jwt = std::make_unique<Jwt>(secret, sessionTime, issuer);
 }
 
 void JwtPlugin::shutdown() {
     LOG_DEBUG << "JWT shuut down";
 }
 
-auto JwtPlugin::init() -> Jwt {
-    auto secret = config.get("secret", "secret").asString();
-    auto sessionTime = config.get("sessionTime", 3600).asInt();
-    auto issuer = config.get("issuer", "auth0").asString();
-    Jwt jwt(secret, sessionTime, issuer);
-    return jwt;
+auto JwtPlugin::init() const -> const Jwt & {
+    return *jwt;
 }
@@ -1,14 +1,16 @@
 #pragma once
 
 #include <drogon/plugins/Plugin.h>
+#include <memory>
 #include "Jwt.h"
 
 class JwtPlugin : public drogon::Plugin<JwtPlugin> {
  public:
     virtual void initAndStart(const Json::Value &config) override;
     virtual void shutdown() override;
-    auto init() -> Jwt;
+    auto init() const -> const Jwt &;
 
  private:
-    Json::Value config;
+    // Built once, the signing key schedule and verifier are reused for every token
+    std::unique_ptr<Jwt> jwt;
 };
@@ -0,0 +1,53 @@
+#include <drogon/drogon_test.h>
+#include <third_party/libbcrypt/include/bcrypt/bcrypt.h>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// The batch must give the same hashes as one bcrypt_hashpw() call per password
+DROGON_TEST(BcryptBatchMatchesSingle)
+{
+    std::mt19937 rng(49);
+    const char *prefixes[] = {"$2a$", "$2b$", "$2x$", "$2y$"};
+    for (int count = 0; count <= 9; ++count) {
+        std::vector<std::string> passwords;
+        std::vector<std::string> salts;
+        for (int i = 0; i < count; ++i) {
+            // 8-bit characters, some passwords longer than the 72 bytes bcrypt uses
+            std::string password(rng() % 80, '\0');
+            for (auto &c : password) {
+                c = static_cast<char>(rng() % 255 + 1);
+            }
+            passwords.push_back(password);
+            // Mixed costs split the groups of lanes
+            char salt[BCRYPT_HASHSIZE];
+            REQUIRE(bcrypt_gensalt(4 + static_cast<int>(rng() % 2), salt) == 0);
+            std::string setting = salt;
+            setting.replace(0, 4, prefixes[rng() % 4]);
+            salts.push_back(setting);
+        }
+        if (count == 6) {
+            salts[2] = "$2a$99$invalid";
+        }
+
+        std::vector<const char *> passwds;
+        std::vector<const char *> settings;
+        for (int i = 0; i < count; ++i) {
+            passwds.push_back(passwords[i].c_str());
+            settings.push_back(salts[i].c_str());
+        }
+        std::unique_ptr<char[][BCRYPT_HASHSIZE]> hashes(new char[count][BCRYPT_HASHSIZE]);
+        auto ret = bcrypt_hashpw_batch(count, passwds.data(), settings.data(), hashes.get());
+        CHECK((ret != 0) == (count == 6));
+
+        for (int i = 0; i < count; ++i) {
+            char hash[BCRYPT_HASHSIZE];
+            if (bcrypt_hashpw(passwds[i], settings[i], hash) == 0) {
+                CHECK(std::string(hashes[i]) == hash);
+            } else {
+                CHECK(hashes[i][0] == '*');
+            }
+        }
+    }
+}
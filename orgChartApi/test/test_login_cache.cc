@@ -0,0 +1,62 @@
+#include <drogon/drogon_test.h>
+#include <utils/LoginCache.h>
+#include <chrono>
+#include <string>
+#include <thread>
+
+DROGON_TEST(LoginCacheBinding)
+{
+    LoginCache cache(std::chrono::seconds{60}, 8);
+    const std::string hash = "$2b$10$abcdefghijklmnopqrstuuABCDEFGHIJKLMNOPQRSTUVWXYZ01234";
+    CHECK(cache.contains(1, hash, "secret") == false);
+    cache.insert(1, hash, "secret");
+    CHECK(cache.contains(1, hash, "secret") == true);
+    // Every part of the login must match
+    CHECK(cache.contains(1, hash, "Secret") == false);
+    CHECK(cache.contains(2, hash, "secret") == false);
+    CHECK(cache.contains(1, hash + "x", "secret") == false);
+    CHECK(cache.contains(1, hash, "secret") == true);
+}
+
+DROGON_TEST(LoginCacheExpiry)
+{
+    LoginCache cache(std::chrono::seconds{1}, 8);
+    cache.insert(1, "hash", "secret");
+    CHECK(cache.contains(1, "hash", "secret") == true);
+    std::this_thread::sleep_for(std::chrono::milliseconds{1100});
+    CHECK(cache.contains(1, "hash", "secret") == false);
+}
+
+DROGON_TEST(LoginCacheEviction)
+{
+    LoginCache cache(std::chrono::seconds{60}, 2);
+    cache.insert(1, "hash", "one");
+    cache.insert(2, "hash", "two");
+    // Inserting a user again makes it the newest
+    cache.insert(1, "hash", "one");
+    cache.insert(3, "hash", "three");
+    CHECK(cache.contains(2, "hash", "two") == false);
+    CHECK(cache.contains(1, "hash", "one") == true);
+    CHECK(cache.contains(3, "hash", "three") == true);
+}
+
+DROGON_TEST(LoginCacheErase)
+{
+    LoginCache cache(std::chrono::seconds{60}, 8);
+    cache.insert(1, "hash", "secret");
+    cache.insert(2, "hash", "secret");
+    cache.erase(1);
+    cache.erase(3);
+    CHECK(cache.contains(1, "hash", "secret") == false);
+    CHECK(cache.contains(2, "hash", "secret") == true);
+}
+
+DROGON_TEST(LoginCacheDisabled)
+{
+    LoginCache noTtl(std::chrono::seconds{0}, 8);
+    noTtl.insert(1, "hash", "secret");
+    CHECK(noTtl.contains(1, "hash", "secret") == false);
+    LoginCache noSize(std::chrono::seconds{60}, 0);
+    noSize.insert(1, "hash", "secret");
+    CHECK(noSize.contains(1, "hash", "secret") == false);
+}
@@ -1,6 +1,8 @@
 #include <drogon/drogon.h>
 
 using namespace drogon;
+// HTTP/1.1: wrk -c 100 -t 4 -d 30s http://127.0.0.1:7770/
+// HTTP/2:   h2load -c 10 -m 100 -n 1000000 http://127.0.0.1:7770/
 int main()
 {
     app()
@@ -8,6 +10,7 @@ int main()
         .setLogLevel(trantor::Logger::kWarn)
         .addListener("0.0.0.0", 7770)
         .setThreadNum(0)
+        .enableHttp2()
         .registerSyncAdvice([](const HttpRequestPtr &req) -> HttpResponsePtr {
             const auto &path = req->path();
             if (path.length() == 1 && path[0] == '/')
@@ -673,6 +673,37 @@ class DROGON_EXPORT HttpAppFramework : public trantor::NonCopyable
     /// Get the number of threads for IO event loops
     virtual size_t getThreadNum() const = 0;
 
+    /// Pin the IO threads to CPUs
+    /**
+     * @param enable If true, the IO thread with index i is pinned to the CPU
+     * with index (i % the number of CPUs). Disabled by default.
+     *
+     * @note
+     * Only supported on Linux.
+     * This operation can be performed by an option in the configuration file.
+     */
+    virtual HttpAppFramework &enableCpuAffinity(bool enable = true) = 0;
+
+    /// Return true if the IO threads are pinned to CPUs.
+    virtual bool isCpuAffinityEnabled() const = 0;
+
+    /// Use io_uring in the IO event loops
+    /**
+     * @param enable If true, the IO event loops wait for events with io_uring
+     * instead of epoll, and data of connections is received by the kernel
+     * into buffers shared with the loops, which saves a read() system call
+     * per request. Disabled by default.
+     *
+     * @note
+     * Only supported on Linux 5.11+ (6.0+ for receiving data), epoll is used
+     * otherwise.
+     * This operation can be performed by an option in the configuration file.
+     */
+    virtual HttpAppFramework &enableIoUring(bool enable = true) = 0;
+
+    /// Return true if io_uring is enabled for the IO event loops.
+    virtual bool isIoUringEnabled() const = 0;
+
     /// Set the global cert file and private key file for https
     /// These options can be configured in the configuration file.
     virtual HttpAppFramework &setSSLFiles(const std::string &certPath,
@@ -697,6 +728,11 @@ class DROGON_EXPORT HttpAppFramework : public trantor::NonCopyable
      * method is used.
      * @param useOldTLS If true, the TLS1.0/1.1 are enabled for HTTPS
      * connections.
+     * @param cpuSteering If true, a new connection is accepted by the IO
+     * thread with the index of the CPU which receives it (modulo the number
+     * of IO threads), instead of by the kernel's hash of the address. It works
+     * with enableCpuAffinity() to keep the processing of a connection on one
+     * core. Only supported on Linux.
      *
      * @note
      * This operation can be performed by an option in the configuration file.
@@ -709,7 +745,8 @@ class DROGON_EXPORT HttpAppFramework : public trantor::NonCopyable
         const std::string &keyFile = "",
         bool useOldTLS = false,
         const std::vector<std::pair<std::string, std::string>> &sslConfCmds =
-            {}) = 0;
+            {},
+        bool cpuSteering = false) = 0;
 
     /// Enable sessions supporting.
     /**
@@ -939,6 +976,39 @@ class DROGON_EXPORT HttpAppFramework : public trantor::NonCopyable
     /// Return true if gzip is enabled.
     virtual bool isGzipEnabled() const = 0;
 
+    /// Enable HTTP/2.
+    /**
+     * @param enable if the parameter is true, clients can use HTTP/2 by ALPN
+     * on HTTPS listeners, and by prior knowledge or the h2c upgrade on other
+     * listeners.
+     * The default value is false.
+     *
+     * @note
+     * This operation can be performed by an option in the configuration file.
+     * The HTTPS listeners must be added after HTTP/2 is enabled.
+     */
+    virtual HttpAppFramework &enableHttp2(bool enable = true) = 0;
+
+    /// Return true if HTTP/2 is enabled.
+    virtual bool isHttp2Enabled() const = 0;
+
+    /// Set the settings of HTTP/2 connections.
+    /**
+     * @param maxConcurrentStreams The maximum number of streams a client can
+     * open at the same time on a connection. The default value is 100.
+     * @param initialWindowSize The flow-control window in bytes of each
+     * stream and of the connection for request bodies. The default value is
+     * 65535.
+     * @param maxFrameSize The maximum size in bytes of frames received from
+     * clients, between 16384 and 16777215. The default value is 16384.
+     *
+     * @note
+     * This operation can be performed by an option in the configuration file.
+     */
+    virtual HttpAppFramework &setHttp2Settings(size_t maxConcurrentStreams,
+                                               size_t initialWindowSize,
+                                               size_t maxFrameSize) = 0;
+
     /// Enable brotli compression.
     /**
      * @param useBrotli if the parameter is true, use brotli to compress the
@@ -1231,14 +1301,32 @@ class DROGON_EXPORT HttpAppFramework : public trantor::NonCopyable
      */
     virtual bool isUnicodeEscapingUsedInJson() const noexcept = 0;
 
+    /**
+     * @brief Enable or disable parsing the json bodies of requests into a
+     * buffer owned by the tree (Json::Document). It takes fewer allocations,
+     * but the values must be copied out of the tree, not moved or swapped, if
+     * they outlive it. Disabled by default, it has no effect if jsoncpp does
+     * not provide Json::Document.
+     *
+     * @note
+     * This operation can be performed by an option in the configuration file.
+     */
+    virtual HttpAppFramework &enableBufferedJsonBody(bool enable) noexcept = 0;
+
+    /// Return true if the json bodies of requests are parsed into a buffer.
+    virtual bool isBufferedJsonBodyEnabled() const noexcept = 0;
+
     /**
      * @brief Set the float precision in Json string of HTTP requests or
      * responses with json content.
      *
      * @param precision The maximum digits length.
-     * @param precisionType Must be "significant" or "decimal", defaults to
-     * "significant" that means setting max number of significant digits in
-     * string, "decimal" means setting max number of digits after "." in string
+     * @param precisionType Must be "significant", "decimal" or "shortest",
+     * defaults to "significant" that means setting max number of significant
+     * digits in string, "decimal" means setting max number of digits after "."
+     * in string, "shortest" means writing the shortest string that reads back
+     * as the same number and ignores the precision (if jsoncpp supports it,
+     * it is the same as "significant" otherwise)
      * @return HttpAppFramework&
      */
     virtual HttpAppFramework &setFloatPrecisionInJson(
@@ -1370,6 +1458,16 @@ class DROGON_EXPORT HttpAppFramework : public trantor::NonCopyable
      */
     virtual const ExceptionHandler &getExceptionHandler() const = 0;
 
+    /**
+     * @brief Drop the cached responses of HttpController handlers that carry
+     * the given tag (see HttpResponse::addCacheTag()). Handlers that modify a
+     * resource call this so that the cached reads of it are not served stale.
+     *
+     * @note The cache of each IO thread is purged in its own event loop, so the
+     * entries of other threads are dropped asynchronously.
+     */
+    virtual void invalidateCachedResponses(const std::string &tag) = 0;
+
     /**
      * @brief Adds a new custom extension to MIME type mapping
      */
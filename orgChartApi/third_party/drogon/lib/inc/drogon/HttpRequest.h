@@ -336,6 +336,10 @@ class DROGON_EXPORT HttpRequest
     /**
      * The content type of the request must be 'application/json',
      * otherwise the method returns an empty shared_ptr object.
+     * @note If buffered json bodies are enabled (see
+     * HttpAppFramework::enableBufferedJsonBody()), the tree is allocated from
+     * the buffer of a document owned by the returned pointer. Copy the values
+     * instead of moving them out of the tree if they must outlive it.
      */
     virtual const std::shared_ptr<Json::Value> &jsonObject() const = 0;
 
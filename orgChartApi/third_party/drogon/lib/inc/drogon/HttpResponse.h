@@ -22,6 +22,7 @@
 #include <json/json.h>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace drogon
 {
@@ -298,6 +299,30 @@ class DROGON_EXPORT HttpResponse
         return expiredTime();
     }
 
+    /// Cache the response separately for each request path and query.
+    /**
+     * By default a response cached by its expiration time (see
+     * setExpiredTime()) is reused for every request handled by the same
+     * handler. Enable this for handlers whose responses depend on the path
+     * parameters or on the query string.
+     */
+    virtual void setCacheKeyedByRequest(bool on) = 0;
+
+    /// Return true if the response is cached per request path and query.
+    virtual bool cacheKeyedByRequest() const = 0;
+
+    /// Add a tag to the response cache entry.
+    /**
+     * A response cached by its expiration time (see setExpiredTime()) is
+     * dropped before it expires when
+     * HttpAppFramework::invalidateCachedResponses() is called with one of its
+     * tags.
+     */
+    virtual void addCacheTag(const std::string &tag) = 0;
+
+    /// Get the tags added by the above method.
+    virtual const std::vector<std::string> &cacheTags() const = 0;
+
     /// Get the json object from the server response.
     /// If the response is not in json format, then a empty shared_ptr is
     /// retured.
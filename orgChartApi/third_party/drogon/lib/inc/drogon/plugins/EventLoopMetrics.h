@@ -0,0 +1,84 @@
+/**
+ *
+ *  @file EventLoopMetrics.h
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#pragma once
+
+#include <drogon/exports.h>
+#include <drogon/plugins/Plugin.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace trantor
+{
+class EventLoop;
+}
+
+namespace drogon
+{
+namespace plugin
+{
+/**
+ * @brief This plugin exports the statistics of the event loops of the
+ * application (see trantor::EventLoopStats) in the Prometheus text format.
+ *
+ * The json configuration is as follows:
+ *
+ * @code
+   {
+      "name": "drogon::plugin::EventLoopMetrics",
+      "dependencies": [],
+      "config": {
+            "path": "/metrics/event_loops"
+      }
+   }
+   @endcode
+ *
+ * path: The path of the metrics, "/metrics/event_loops" by default.
+ *
+ * The statistics are recorded from the start of the plugin. Recording can be
+ * switched on and off at any time with trantor::EventLoop::enableStats().
+ * Every loop is labeled by its index, the main loop is labeled "main".
+ *
+ * Enable the plugin by adding the configuration to the list of plugins in the
+ * configuration file.
+ *
+ */
+class DROGON_EXPORT EventLoopMetrics : public drogon::Plugin<EventLoopMetrics>
+{
+  public:
+    EventLoopMetrics()
+    {
+    }
+    /// This method must be called by drogon to initialize and start the plugin.
+    /// It must be implemented by the user.
+    void initAndStart(const Json::Value &config) override;
+
+    /// This method must be called by drogon to shutdown the plugin.
+    /// It must be implemented by the user.
+    void shutdown() override;
+
+    /**
+     * @brief Render the statistics of event loops in the Prometheus text
+     * format.
+     *
+     * @param loops The loops and their labels.
+     */
+    static std::string render(
+        const std::vector<std::pair<std::string, const trantor::EventLoop *>>
+            &loops);
+};
+
+}  // namespace plugin
+}  // namespace drogon
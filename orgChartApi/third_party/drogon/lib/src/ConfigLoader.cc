@@ -138,6 +138,31 @@ ConfigLoader::ConfigLoader(Json::Value &&data)
 ConfigLoader::~ConfigLoader()
 {
 }
+static bool toLogLevel(const std::string &name,
+                       trantor::Logger::LogLevel &level)
+{
+    if (name == "TRACE")
+    {
+        level = trantor::Logger::kTrace;
+    }
+    else if (name == "DEBUG")
+    {
+        level = trantor::Logger::kDebug;
+    }
+    else if (name == "INFO")
+    {
+        level = trantor::Logger::kInfo;
+    }
+    else if (name == "WARN")
+    {
+        level = trantor::Logger::kWarn;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
 static void loadLogSetting(const Json::Value &log)
 {
     if (!log)
@@ -149,22 +174,22 @@ static void loadLogSetting(const Json::Value &log)
         auto logSize = log.get("log_size_limit", 100000000).asUInt64();
         HttpAppFrameworkImpl::instance().setLogPath(logPath, baseName, logSize);
     }
+    trantor::Logger::LogLevel level;
     auto logLevel = log.get("log_level", "DEBUG").asString();
-    if (logLevel == "TRACE")
-    {
-        trantor::Logger::setLogLevel(trantor::Logger::kTrace);
-    }
-    else if (logLevel == "DEBUG")
+    if (toLogLevel(logLevel, level))
     {
-        trantor::Logger::setLogLevel(trantor::Logger::kDebug);
+        trantor::Logger::setLogLevel(level);
     }
-    else if (logLevel == "INFO")
+    auto &moduleLevels = log["module_log_levels"];
+    for (auto iter = moduleLevels.begin(); iter != moduleLevels.end(); ++iter)
     {
-        trantor::Logger::setLogLevel(trantor::Logger::kInfo);
-    }
-    else if (logLevel == "WARN")
-    {
-        trantor::Logger::setLogLevel(trantor::Logger::kWarn);
+        if (!toLogLevel(iter->asString(), level))
+        {
+            std::cerr << "Invalid log level of module " << iter.name() << ": "
+                      << iter->asString() << std::endl;
+            exit(1);
+        }
+        trantor::Logger::setModuleLogLevel(iter.name(), level);
     }
 }
 static void loadControllers(const Json::Value &controllers)
@@ -242,6 +267,8 @@ static void loadApp(const Json::Value &app)
     if (threadsNum < 1)
         threadsNum = 1;
     drogon::app().setThreadNum(threadsNum);
+    drogon::app().enableCpuAffinity(app.get("cpu_affinity", false).asBool());
+    drogon::app().enableIoUring(app.get("io_uring", false).asBool());
     // session
     auto enableSession = app.get("enable_session", false).asBool();
     auto timeout = app.get("session_timeout", 0).asUInt64();
@@ -379,12 +406,21 @@ static void loadApp(const Json::Value &app)
     auto unicodeEscaping =
         app.get("enable_unicode_escaping_in_json", true).asBool();
     drogon::app().setUnicodeEscapingInJson(unicodeEscaping);
+    drogon::app().enableBufferedJsonBody(
+        app.get("buffered_json_body", false).asBool());
     auto &precision = app["float_precision_in_json"];
     if (!precision.isNull())
     {
         auto precisionLength = precision.get("precision", 0).asUInt64();
         auto precisionType =
             precision.get("precision_type", "significant").asString();
+#ifndef JSON_HAS_STREAM_WRITER_APPEND
+        if (precisionType == "shortest")
+        {
+            LOG_WARN << "The jsoncpp lib does not support the \"shortest\" "
+                        "precision type, \"significant\" is used instead";
+        }
+#endif
         drogon::app().setFloatPrecisionInJson(precisionLength, precisionType);
     }
     // log
@@ -413,6 +449,12 @@ static void loadApp(const Json::Value &app)
     drogon::app().enableGzip(useGzip);
     auto useBr = app.get("use_brotli", false).asBool();
     drogon::app().enableBrotli(useBr);
+    auto &http2 = app["http2"];
+    drogon::app().enableHttp2(http2.get("enabled", false).asBool());
+    drogon::app().setHttp2Settings(
+        http2.get("max_concurrent_streams", 100).asUInt64(),
+        http2.get("initial_window_size", 65535).asUInt64(),
+        http2.get("max_frame_size", 16384).asUInt64());
     auto staticFilesCacheTime = app.get("static_files_cache_time", 5).asInt();
     drogon::app().setStaticFilesCacheTime(staticFilesCacheTime);
     loadControllers(app["simple_controllers_map"]);
@@ -587,6 +629,7 @@ static void loadListeners(const Json::Value &listeners)
         auto cert = listener.get("cert", "").asString();
         auto key = listener.get("key", "").asString();
         auto useOldTLS = listener.get("use_old_tls", false).asBool();
+        auto cpuSteering = listener.get("cpu_steering", false).asBool();
         std::vector<std::pair<std::string, std::string>> sslConfCmds;
         if (listener.isMember("ssl_conf"))
         {
@@ -604,7 +647,7 @@ static void loadListeners(const Json::Value &listeners)
         }
         LOG_TRACE << "Add listener:" << addr << ":" << port;
         drogon::app().addListener(
-            addr, port, useSSL, cert, key, useOldTLS, sslConfCmds);
+            addr, port, useSSL, cert, key, useOldTLS, sslConfCmds, cpuSteering);
     }
 }
 static void loadSSL(const Json::Value &sslConf)
@@ -0,0 +1,174 @@
+/**
+ *
+ *  @file EventLoopMetrics.cc
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#include <drogon/drogon.h>
+#include <drogon/plugins/EventLoopMetrics.h>
+#include <trantor/net/EventLoop.h>
+#include <stdio.h>
+
+using namespace drogon;
+using namespace drogon::plugin;
+
+namespace
+{
+struct Metric
+{
+    const char *name;
+    const char *help;
+    const trantor::LatencyHistogram trantor::EventLoopStats::*histogram;
+    // The histograms of durations are in nanoseconds, they are exported in
+    // seconds.
+    bool seconds;
+};
+
+const Metric metrics[] = {
+    {"drogon_event_loop_busy_seconds",
+     "Time of each loop iteration spent handling events and queued tasks.",
+     &trantor::EventLoopStats::busyTime,
+     true},
+    {"drogon_event_loop_poll_seconds",
+     "Time of each loop iteration spent waiting for events.",
+     &trantor::EventLoopStats::pollTime,
+     true},
+    {"drogon_event_loop_active_channels",
+     "Number of active channels returned by each poll.",
+     &trantor::EventLoopStats::activeChannels,
+     false},
+    {"drogon_event_loop_callback_seconds",
+     "Duration of event callbacks and queued tasks.",
+     &trantor::EventLoopStats::callbackTime,
+     true},
+    {"drogon_event_loop_queue_lag_seconds",
+     "Time queued tasks waited before the loop started running them.",
+     &trantor::EventLoopStats::queueLag,
+     true},
+    {"drogon_event_loop_queue_length",
+     "Number of queued tasks run at once.",
+     &trantor::EventLoopStats::queueLength,
+     false},
+    {"drogon_event_loop_timer_lateness_seconds",
+     "Delay between the expiration of timers and their callbacks.",
+     &trantor::EventLoopStats::timerLateness,
+     true},
+};
+
+const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+
+void appendSample(std::string &text,
+                  const char *name,
+                  const char *suffix,
+                  const std::string &loop,
+                  const char *quantile,
+                  double value)
+{
+    char buf[64];
+    text.append(name).append(suffix).append("{loop=\"").append(loop);
+    if (quantile)
+        text.append("\",quantile=\"").append(quantile);
+    snprintf(buf, sizeof(buf), "\"} %.9g\n", value);
+    text.append(buf);
+}
+}  // namespace
+
+void EventLoopMetrics::initAndStart(const Json::Value &config)
+{
+    auto path = config.get("path", "/metrics/event_loops").asString();
+    trantor::EventLoop::enableStats();
+    app().registerHandler(
+        path,
+        [](const HttpRequestPtr &,
+           std::function<void(const HttpResponsePtr &)> &&callback) {
+            std::vector<std::pair<std::string, const trantor::EventLoop *>>
+                loops;
+            for (size_t i = 0; i < app().getThreadNum(); ++i)
+            {
+                loops.emplace_back(std::to_string(i), app().getIOLoop(i));
+            }
+            loops.emplace_back("main", app().getLoop());
+            auto resp = HttpResponse::newHttpResponse();
+            resp->setContentTypeCodeAndCustomString(
+                CT_TEXT_PLAIN, "text/plain; version=0.0.4");
+            resp->setBody(render(loops));
+            callback(resp);
+        },
+        {Get});
+}
+
+void EventLoopMetrics::shutdown()
+{
+    trantor::EventLoop::enableStats(false);
+}
+
+std::string EventLoopMetrics::render(
+    const std::vector<std::pair<std::string, const trantor::EventLoop *>>
+        &loops)
+{
+    std::string text;
+    char quantileLabel[16];
+    for (auto &metric : metrics)
+    {
+        auto scale = metric.seconds ? 1e-9 : 1.0;
+        text.append("# HELP ")
+            .append(metric.name)
+            .append(" ")
+            .append(metric.help)
+            .append("\n# TYPE ")
+            .append(metric.name)
+            .append(" summary\n");
+        for (auto &loop : loops)
+        {
+            auto &histogram = loop.second->stats().*metric.histogram;
+            for (auto quantile : quantiles)
+            {
+                snprintf(quantileLabel, sizeof(quantileLabel), "%g", quantile);
+                appendSample(text,
+                             metric.name,
+                             "",
+                             loop.first,
+                             quantileLabel,
+                             histogram.percentile(quantile * 100) * scale);
+            }
+            appendSample(text,
+                         metric.name,
+                         "_sum",
+                         loop.first,
+                         nullptr,
+                         histogram.sum() * scale);
+            appendSample(text,
+                         metric.name,
+                         "_count",
+                         loop.first,
+                         nullptr,
+                         static_cast<double>(histogram.count()));
+        }
+        text.append("# HELP ")
+            .append(metric.name)
+            .append("_max The maximum of ")
+            .append(metric.name)
+            .append(".\n# TYPE ")
+            .append(metric.name)
+            .append("_max gauge\n");
+        for (auto &loop : loops)
+        {
+            auto &histogram = loop.second->stats().*metric.histogram;
+            appendSample(text,
+                         metric.name,
+                         "_max",
+                         loop.first,
+                         nullptr,
+                         histogram.max() * scale);
+        }
+    }
+    return text;
+}
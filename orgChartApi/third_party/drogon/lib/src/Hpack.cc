@@ -0,0 +1,550 @@
+/**
+ *
+ *  Hpack.cc
+ *  An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#include "Hpack.h"
+#include <algorithm>
+
+using namespace drogon;
+
+namespace
+{
+struct HuffmanCode
+{
+    uint32_t code;
+    uint8_t bits;
+};
+
+// rfc7541 Appendix B, the last one is EOS.
+const HuffmanCode huffmanTable[257] = {
+    {0x1ff8, 13}, {0x7fffd8, 23}, {0xfffffe2, 28}, {0xfffffe3, 28},
+    {0xfffffe4, 28}, {0xfffffe5, 28}, {0xfffffe6, 28}, {0xfffffe7, 28},
+    {0xfffffe8, 28}, {0xffffea, 24}, {0x3ffffffc, 30}, {0xfffffe9, 28},
+    {0xfffffea, 28}, {0x3ffffffd, 30}, {0xfffffeb, 28}, {0xfffffec, 28},
+    {0xfffffed, 28}, {0xfffffee, 28}, {0xfffffef, 28}, {0xffffff0, 28},
+    {0xffffff1, 28}, {0xffffff2, 28}, {0x3ffffffe, 30}, {0xffffff3, 28},
+    {0xffffff4, 28}, {0xffffff5, 28}, {0xffffff6, 28}, {0xffffff7, 28},
+    {0xffffff8, 28}, {0xffffff9, 28}, {0xffffffa, 28}, {0xffffffb, 28},
+    {0x14, 6}, {0x3f8, 10}, {0x3f9, 10}, {0xffa, 12},
+    {0x1ff9, 13}, {0x15, 6}, {0xf8, 8}, {0x7fa, 11},
+    {0x3fa, 10}, {0x3fb, 10}, {0xf9, 8}, {0x7fb, 11},
+    {0xfa, 8}, {0x16, 6}, {0x17, 6}, {0x18, 6},
+    {0x0, 5}, {0x1, 5}, {0x2, 5}, {0x19, 6},
+    {0x1a, 6}, {0x1b, 6}, {0x1c, 6}, {0x1d, 6},
+    {0x1e, 6}, {0x1f, 6}, {0x5c, 7}, {0xfb, 8},
+    {0x7ffc, 15}, {0x20, 6}, {0xffb, 12}, {0x3fc, 10},
+    {0x1ffa, 13}, {0x21, 6}, {0x5d, 7}, {0x5e, 7},
+    {0x5f, 7}, {0x60, 7}, {0x61, 7}, {0x62, 7},
+    {0x63, 7}, {0x64, 7}, {0x65, 7}, {0x66, 7},
+    {0x67, 7}, {0x68, 7}, {0x69, 7}, {0x6a, 7},
+    {0x6b, 7}, {0x6c, 7}, {0x6d, 7}, {0x6e, 7},
+    {0x6f, 7}, {0x70, 7}, {0x71, 7}, {0x72, 7},
+    {0xfc, 8}, {0x73, 7}, {0xfd, 8}, {0x1ffb, 13},
+    {0x7fff0, 19}, {0x1ffc, 13}, {0x3ffc, 14}, {0x22, 6},
+    {0x7ffd, 15}, {0x3, 5}, {0x23, 6}, {0x4, 5},
+    {0x24, 6}, {0x5, 5}, {0x25, 6}, {0x26, 6},
+    {0x27, 6}, {0x6, 5}, {0x74, 7}, {0x75, 7},
+    {0x28, 6}, {0x29, 6}, {0x2a, 6}, {0x7, 5},
+    {0x2b, 6}, {0x76, 7}, {0x2c, 6}, {0x8, 5},
+    {0x9, 5}, {0x2d, 6}, {0x77, 7}, {0x78, 7},
+    {0x79, 7}, {0x7a, 7}, {0x7b, 7}, {0x7ffe, 15},
+    {0x7fc, 11}, {0x3ffd, 14}, {0x1ffd, 13}, {0xffffffc, 28},
+    {0xfffe6, 20}, {0x3fffd2, 22}, {0xfffe7, 20}, {0xfffe8, 20},
+    {0x3fffd3, 22}, {0x3fffd4, 22}, {0x3fffd5, 22}, {0x7fffd9, 23},
+    {0x3fffd6, 22}, {0x7fffda, 23}, {0x7fffdb, 23}, {0x7fffdc, 23},
+    {0x7fffdd, 23}, {0x7fffde, 23}, {0xffffeb, 24}, {0x7fffdf, 23},
+    {0xffffec, 24}, {0xffffed, 24}, {0x3fffd7, 22}, {0x7fffe0, 23},
+    {0xffffee, 24}, {0x7fffe1, 23}, {0x7fffe2, 23}, {0x7fffe3, 23},
+    {0x7fffe4, 23}, {0x1fffdc, 21}, {0x3fffd8, 22}, {0x7fffe5, 23},
+    {0x3fffd9, 22}, {0x7fffe6, 23}, {0x7fffe7, 23}, {0xffffef, 24},
+    {0x3fffda, 22}, {0x1fffdd, 21}, {0xfffe9, 20}, {0x3fffdb, 22},
+    {0x3fffdc, 22}, {0x7fffe8, 23}, {0x7fffe9, 23}, {0x1fffde, 21},
+    {0x7fffea, 23}, {0x3fffdd, 22}, {0x3fffde, 22}, {0xfffff0, 24},
+    {0x1fffdf, 21}, {0x3fffdf, 22}, {0x7fffeb, 23}, {0x7fffec, 23},
+    {0x1fffe0, 21}, {0x1fffe1, 21}, {0x3fffe0, 22}, {0x1fffe2, 21},
+    {0x7fffed, 23}, {0x3fffe1, 22}, {0x7fffee, 23}, {0x7fffef, 23},
+    {0xfffea, 20}, {0x3fffe2, 22}, {0x3fffe3, 22}, {0x3fffe4, 22},
+    {0x7ffff0, 23}, {0x3fffe5, 22}, {0x3fffe6, 22}, {0x7ffff1, 23},
+    {0x3ffffe0, 26}, {0x3ffffe1, 26}, {0xfffeb, 20}, {0x7fff1, 19},
+    {0x3fffe7, 22}, {0x7ffff2, 23}, {0x3fffe8, 22}, {0x1ffffec, 25},
+    {0x3ffffe2, 26}, {0x3ffffe3, 26}, {0x3ffffe4, 26}, {0x7ffffde, 27},
+    {0x7ffffdf, 27}, {0x3ffffe5, 26}, {0xfffff1, 24}, {0x1ffffed, 25},
+    {0x7fff2, 19}, {0x1fffe3, 21}, {0x3ffffe6, 26}, {0x7ffffe0, 27},
+    {0x7ffffe1, 27}, {0x3ffffe7, 26}, {0x7ffffe2, 27}, {0xfffff2, 24},
+    {0x1fffe4, 21}, {0x1fffe5, 21}, {0x3ffffe8, 26}, {0x3ffffe9, 26},
+    {0xffffffd, 28}, {0x7ffffe3, 27}, {0x7ffffe4, 27}, {0x7ffffe5, 27},
+    {0xfffec, 20}, {0xfffff3, 24}, {0xfffed, 20}, {0x1fffe6, 21},
+    {0x3fffe9, 22}, {0x1fffe7, 21}, {0x1fffe8, 21}, {0x7ffff3, 23},
+    {0x3fffea, 22}, {0x3fffeb, 22}, {0x1ffffee, 25}, {0x1ffffef, 25},
+    {0xfffff4, 24}, {0xfffff5, 24}, {0x3ffffea, 26}, {0x7ffff4, 23},
+    {0x3ffffeb, 26}, {0x7ffffe6, 27}, {0x3ffffec, 26}, {0x3ffffed, 26},
+    {0x7ffffe7, 27}, {0x7ffffe8, 27}, {0x7ffffe9, 27}, {0x7ffffea, 27},
+    {0x7ffffeb, 27}, {0xffffffe, 28}, {0x7ffffec, 27}, {0x7ffffed, 27},
+    {0x7ffffee, 27}, {0x7ffffef, 27}, {0x7fffff0, 27}, {0x3ffffee, 26},
+    {0x3fffffff, 30},
+};
+
+// The Huffman code of HPACK is canonical, so a symbol can be found by its
+// code length and its offset from the first code of that length.
+struct HuffmanDecodeTable
+{
+    HuffmanDecodeTable()
+    {
+        for (uint16_t i = 0; i < 257; ++i)
+        {
+            symbols[i] = i;
+        }
+        std::sort(symbols, symbols + 257, [](uint16_t a, uint16_t b) {
+            return huffmanTable[a].bits < huffmanTable[b].bits ||
+                   (huffmanTable[a].bits == huffmanTable[b].bits && a < b);
+        });
+        for (uint16_t i = 0; i < 257; ++i)
+        {
+            auto &entry = huffmanTable[symbols[i]];
+            if (count[entry.bits]++ == 0)
+            {
+                firstCode[entry.bits] = entry.code;
+                firstIndex[entry.bits] = i;
+            }
+        }
+    }
+    uint32_t firstCode[31]{0};
+    uint16_t firstIndex[31]{0};
+    uint16_t count[31]{0};
+    uint16_t symbols[257];
+};
+
+const HeaderField staticTable[] = {
+    {"", ""},
+    {":authority", ""},
+    {":method", "GET"},
+    {":method", "POST"},
+    {":path", "/"},
+    {":path", "/index.html"},
+    {":scheme", "http"},
+    {":scheme", "https"},
+    {":status", "200"},
+    {":status", "204"},
+    {":status", "206"},
+    {":status", "304"},
+    {":status", "400"},
+    {":status", "404"},
+    {":status", "500"},
+    {"accept-charset", ""},
+    {"accept-encoding", "gzip, deflate"},
+    {"accept-language", ""},
+    {"accept-ranges", ""},
+    {"accept", ""},
+    {"access-control-allow-origin", ""},
+    {"age", ""},
+    {"allow", ""},
+    {"authorization", ""},
+    {"cache-control", ""},
+    {"content-disposition", ""},
+    {"content-encoding", ""},
+    {"content-language", ""},
+    {"content-length", ""},
+    {"content-location", ""},
+    {"content-range", ""},
+    {"content-type", ""},
+    {"cookie", ""},
+    {"date", ""},
+    {"etag", ""},
+    {"expect", ""},
+    {"expires", ""},
+    {"from", ""},
+    {"host", ""},
+    {"if-match", ""},
+    {"if-modified-since", ""},
+    {"if-none-match", ""},
+    {"if-range", ""},
+    {"if-unmodified-since", ""},
+    {"last-modified", ""},
+    {"link", ""},
+    {"location", ""},
+    {"max-forwards", ""},
+    {"proxy-authenticate", ""},
+    {"proxy-authorization", ""},
+    {"range", ""},
+    {"referer", ""},
+    {"refresh", ""},
+    {"retry-after", ""},
+    {"server", ""},
+    {"set-cookie", ""},
+    {"strict-transport-security", ""},
+    {"transfer-encoding", ""},
+    {"user-agent", ""},
+    {"vary", ""},
+    {"via", ""},
+    {"www-authenticate", ""}};
+constexpr size_t staticTableSize = 61;
+constexpr size_t entryOverhead = 32;
+
+inline size_t entrySize(const HeaderField &field)
+{
+    return field.first.length() + field.second.length() + entryOverhead;
+}
+}  // namespace
+
+void hpack::encodeInteger(uint64_t value,
+                          uint8_t prefixBits,
+                          uint8_t firstByte,
+                          std::string &output)
+{
+    uint64_t maxPrefix = (1u << prefixBits) - 1;
+    if (value < maxPrefix)
+    {
+        output.push_back(static_cast<char>(firstByte | value));
+        return;
+    }
+    output.push_back(static_cast<char>(firstByte | maxPrefix));
+    value -= maxPrefix;
+    while (value >= 128)
+    {
+        output.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    output.push_back(static_cast<char>(value));
+}
+
+bool hpack::decodeInteger(const uint8_t *&p,
+                          const uint8_t *end,
+                          uint8_t prefixBits,
+                          uint64_t &value)
+{
+    if (p >= end)
+        return false;
+    uint64_t maxPrefix = (1u << prefixBits) - 1;
+    value = *p++ & maxPrefix;
+    if (value < maxPrefix)
+        return true;
+    unsigned int shift = 0;
+    while (p < end)
+    {
+        // Larger values are never valid lengths or indices.
+        if (shift > 28)
+            return false;
+        uint8_t byte = *p++;
+        value += static_cast<uint64_t>(byte & 0x7f) << shift;
+        shift += 7;
+        if ((byte & 0x80) == 0)
+            return true;
+    }
+    return false;
+}
+
+size_t hpack::huffmanEncodedLength(const std::string &str)
+{
+    size_t bits = 0;
+    for (auto c : str)
+    {
+        bits += huffmanTable[static_cast<uint8_t>(c)].bits;
+    }
+    return (bits + 7) / 8;
+}
+
+void hpack::huffmanEncode(const std::string &str, std::string &output)
+{
+    uint64_t bitBuffer = 0;
+    unsigned int bitCount = 0;
+    for (auto c : str)
+    {
+        auto &entry = huffmanTable[static_cast<uint8_t>(c)];
+        bitBuffer = (bitBuffer << entry.bits) | entry.code;
+        bitCount += entry.bits;
+        while (bitCount >= 8)
+        {
+            bitCount -= 8;
+            output.push_back(static_cast<char>(bitBuffer >> bitCount));
+        }
+        bitBuffer &= (1u << bitCount) - 1;
+    }
+    if (bitCount > 0)
+    {
+        // Pad with the most significant bits of EOS.
+        output.push_back(static_cast<char>((bitBuffer << (8 - bitCount)) |
+                                           (0xff >> bitCount)));
+    }
+}
+
+bool hpack::huffmanDecode(const uint8_t *data,
+                          size_t length,
+                          std::string &output)
+{
+    static const HuffmanDecodeTable table;
+    uint32_t code = 0;
+    unsigned int bits = 0;
+    for (size_t i = 0; i < length; ++i)
+    {
+        for (int shift = 7; shift >= 0; --shift)
+        {
+            code = (code << 1) | ((data[i] >> shift) & 1);
+            if (++bits > 30)
+                return false;
+            if (code - table.firstCode[bits] < table.count[bits])
+            {
+                auto symbol =
+                    table.symbols[table.firstIndex[bits] + code -
+                                  table.firstCode[bits]];
+                if (symbol == 256)
+                    return false;
+                output.push_back(static_cast<char>(symbol));
+                code = 0;
+                bits = 0;
+            }
+        }
+    }
+    // The padding must be shorter than 8 bits and be a prefix of EOS.
+    return bits < 8 && code == (1u << bits) - 1;
+}
+
+HpackDecoder::Status HpackDecoder::decode(const char *data,
+                                          size_t length,
+                                          std::vector<HeaderField> &fields,
+                                          size_t maxHeaderListSize)
+{
+    auto p = reinterpret_cast<const uint8_t *>(data);
+    auto end = p + length;
+    size_t listSize = 0;
+    auto addField = [&](const HeaderField &field) {
+        listSize += entrySize(field);
+        if (listSize > maxHeaderListSize)
+            return false;
+        fields.push_back(field);
+        return true;
+    };
+    while (p < end)
+    {
+        uint8_t byte = *p;
+        uint64_t index;
+        if (byte & 0x80)
+        {
+            // Indexed header field
+            if (!hpack::decodeInteger(p, end, 7, index))
+                return Status::kCompressionError;
+            auto entry = getEntry(index);
+            if (!entry)
+                return Status::kCompressionError;
+            if (!addField(*entry))
+                return Status::kHeaderListTooLarge;
+        }
+        else if ((byte & 0xe0) == 0x20)
+        {
+            // Dynamic table size update
+            uint64_t size;
+            if (!hpack::decodeInteger(p, end, 5, size) ||
+                size > tableSizeLimit_)
+                return Status::kCompressionError;
+            maxTableSize_ = static_cast<size_t>(size);
+            evictEntries(maxTableSize_);
+        }
+        else
+        {
+            // Literal header field, with incremental indexing (01xxxxxx),
+            // without indexing (0000xxxx) or never indexed (0001xxxx).
+            bool indexing = (byte & 0xc0) == 0x40;
+            if (!hpack::decodeInteger(p, end, indexing ? 6 : 4, index))
+                return Status::kCompressionError;
+            HeaderField field;
+            if (index > 0)
+            {
+                auto entry = getEntry(index);
+                if (!entry)
+                    return Status::kCompressionError;
+                field.first = entry->first;
+            }
+            else if (!decodeString(p, end, field.first))
+            {
+                return Status::kCompressionError;
+            }
+            if (!decodeString(p, end, field.second))
+                return Status::kCompressionError;
+            if (!addField(field))
+                return Status::kHeaderListTooLarge;
+            if (indexing)
+                addEntry(std::move(field));
+        }
+    }
+    return Status::kOk;
+}
+
+bool HpackDecoder::decodeString(const uint8_t *&p,
+                                const uint8_t *end,
+                                std::string &str)
+{
+    if (p >= end)
+        return false;
+    bool huffman = (*p & 0x80) != 0;
+    uint64_t length;
+    if (!hpack::decodeInteger(p, end, 7, length) ||
+        length > static_cast<uint64_t>(end - p))
+        return false;
+    auto len = static_cast<size_t>(length);
+    if (huffman)
+    {
+        str.reserve(len * 8 / 5);
+        if (!hpack::huffmanDecode(p, len, str))
+            return false;
+    }
+    else
+    {
+        str.assign(reinterpret_cast<const char *>(p), len);
+    }
+    p += len;
+    return true;
+}
+
+const HeaderField *HpackDecoder::getEntry(uint64_t index) const
+{
+    if (index == 0)
+        return nullptr;
+    if (index <= staticTableSize)
+        return &staticTable[index];
+    index -= staticTableSize + 1;
+    if (index >= table_.size())
+        return nullptr;
+    return &table_[static_cast<size_t>(index)];
+}
+
+void HpackDecoder::addEntry(HeaderField &&field)
+{
+    auto size = entrySize(field);
+    if (size > maxTableSize_)
+    {
+        // An entry larger than the table empties it (rfc7541-4.4).
+        evictEntries(0);
+        return;
+    }
+    evictEntries(maxTableSize_ - size);
+    tableSize_ += size;
+    table_.push_front(std::move(field));
+}
+
+void HpackDecoder::evictEntries(size_t maxSize)
+{
+    while (tableSize_ > maxSize)
+    {
+        tableSize_ -= entrySize(table_.back());
+        table_.pop_back();
+    }
+}
+
+void HpackEncoder::setMaxTableSize(size_t size)
+{
+    // The dynamic table of the encoder never exceeds the default size.
+    size = (std::min)(size, static_cast<size_t>(4096));
+    if (size != maxTableSize_)
+    {
+        maxTableSize_ = size;
+        evictEntries(size);
+        tableSizeUpdated_ = true;
+    }
+}
+
+void HpackEncoder::encode(const std::vector<HeaderField> &fields,
+                          std::string &output)
+{
+    if (tableSizeUpdated_)
+    {
+        hpack::encodeInteger(maxTableSize_, 5, 0x20, output);
+        tableSizeUpdated_ = false;
+    }
+    for (auto &field : fields)
+    {
+        size_t nameIndex = 0;
+        size_t fieldIndex = 0;
+        for (size_t i = 1; i <= staticTableSize; ++i)
+        {
+            if (staticTable[i].first == field.first)
+            {
+                if (nameIndex == 0)
+                    nameIndex = i;
+                if (staticTable[i].second == field.second)
+                {
+                    fieldIndex = i;
+                    break;
+                }
+            }
+        }
+        for (size_t i = 0; fieldIndex == 0 && i < table_.size(); ++i)
+        {
+            if (table_[i].first == field.first)
+            {
+                if (nameIndex == 0)
+                    nameIndex = i + staticTableSize + 1;
+                if (table_[i].second == field.second)
+                    fieldIndex = i + staticTableSize + 1;
+            }
+        }
+        if (fieldIndex > 0)
+        {
+            hpack::encodeInteger(fieldIndex, 7, 0x80, output);
+            continue;
+        }
+        // Values that change in every response are not indexed, and cookies
+        // are never indexed by intermediaries either.
+        if (field.first == "set-cookie")
+        {
+            hpack::encodeInteger(nameIndex, 4, 0x10, output);
+        }
+        else if (field.first == "content-length" || field.first == "date")
+        {
+            hpack::encodeInteger(nameIndex, 4, 0x00, output);
+        }
+        else
+        {
+            hpack::encodeInteger(nameIndex, 6, 0x40, output);
+            addEntry(field);
+        }
+        if (nameIndex == 0)
+            encodeString(field.first, output);
+        encodeString(field.second, output);
+    }
+}
+
+void HpackEncoder::encodeString(const std::string &str, std::string &output)
+{
+    auto length = hpack::huffmanEncodedLength(str);
+    if (length < str.length())
+    {
+        hpack::encodeInteger(length, 7, 0x80, output);
+        hpack::huffmanEncode(str, output);
+    }
+    else
+    {
+        hpack::encodeInteger(str.length(), 7, 0x00, output);
+        output.append(str);
+    }
+}
+
+void HpackEncoder::addEntry(const HeaderField &field)
+{
+    auto size = entrySize(field);
+    if (size > maxTableSize_)
+    {
+        evictEntries(0);
+        return;
+    }
+    evictEntries(maxTableSize_ - size);
+    tableSize_ += size;
+    table_.push_front(field);
+}
+
+void HpackEncoder::evictEntries(size_t maxSize)
+{
+    while (tableSize_ > maxSize)
+    {
+        tableSize_ -= entrySize(table_.back());
+        table_.pop_back();
+    }
+}
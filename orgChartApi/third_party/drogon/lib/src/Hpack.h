@@ -0,0 +1,109 @@
+/**
+ *
+ *  Hpack.h
+ *  An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#pragma once
+
+#include <trantor/utils/NonCopyable.h>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace drogon
+{
+using HeaderField = std::pair<std::string, std::string>;
+
+/**
+ * @brief The HPACK (rfc7541) decoder of a HTTP/2 connection.
+ */
+class HpackDecoder : public trantor::NonCopyable
+{
+  public:
+    enum class Status
+    {
+        kOk,
+        kCompressionError,
+        // The decoded fields are larger than the given limit, counted like
+        // SETTINGS_MAX_HEADER_LIST_SIZE (rfc7540-6.5.2).
+        kHeaderListTooLarge
+    };
+
+    /// Decode a complete header block. The decoding stops as soon as the
+    /// fields exceed maxHeaderListSize, so a small block can't be expanded
+    /// into a huge header list.
+    Status decode(const char *data,
+                  size_t length,
+                  std::vector<HeaderField> &fields,
+                  size_t maxHeaderListSize);
+
+  private:
+    bool decodeString(const uint8_t *&p,
+                      const uint8_t *end,
+                      std::string &str);
+    const HeaderField *getEntry(uint64_t index) const;
+    void addEntry(HeaderField &&field);
+    void evictEntries(size_t maxSize);
+
+    std::deque<HeaderField> table_;
+    size_t tableSize_{0};
+    size_t maxTableSize_{4096};
+    // The SETTINGS_HEADER_TABLE_SIZE value, the default one is announced.
+    const size_t tableSizeLimit_{4096};
+};
+
+/**
+ * @brief The HPACK (rfc7541) encoder of a HTTP/2 connection.
+ */
+class HpackEncoder : public trantor::NonCopyable
+{
+  public:
+    /// Encode the fields as a header block and append it to the output.
+    void encode(const std::vector<HeaderField> &fields, std::string &output);
+
+    /// Set the SETTINGS_HEADER_TABLE_SIZE value announced by the peer.
+    void setMaxTableSize(size_t size);
+
+  private:
+    void encodeString(const std::string &str, std::string &output);
+    void addEntry(const HeaderField &field);
+    void evictEntries(size_t maxSize);
+
+    std::deque<HeaderField> table_;
+    size_t tableSize_{0};
+    size_t maxTableSize_{4096};
+    bool tableSizeUpdated_{false};
+};
+
+namespace hpack
+{
+/// Append the HPACK integer representation with an N-bit prefix.
+void encodeInteger(uint64_t value,
+                   uint8_t prefixBits,
+                   uint8_t firstByte,
+                   std::string &output);
+
+/// Decode an integer with an N-bit prefix, return false if it is malformed.
+bool decodeInteger(const uint8_t *&p,
+                   const uint8_t *end,
+                   uint8_t prefixBits,
+                   uint64_t &value);
+
+void huffmanEncode(const std::string &str, std::string &output);
+size_t huffmanEncodedLength(const std::string &str);
+bool huffmanDecode(const uint8_t *data, size_t length, std::string &output);
+}  // namespace hpack
+
+}  // namespace drogon
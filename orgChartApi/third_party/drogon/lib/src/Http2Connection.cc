@@ -0,0 +1,944 @@
+/**
+ *
+ *  Http2Connection.cc
+ *  An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#include "Http2Connection.h"
+#include "HttpAppFrameworkImpl.h"
+#include "HttpRequestImpl.h"
+#include "HttpResponseImpl.h"
+#include <drogon/utils/Utilities.h>
+#include <trantor/utils/Logger.h>
+#include <algorithm>
+#include <fstream>
+
+using namespace drogon;
+
+namespace
+{
+enum FrameType : uint8_t
+{
+    kData = 0x0,
+    kHeaders = 0x1,
+    kPriority = 0x2,
+    kRstStream = 0x3,
+    kSettings = 0x4,
+    kPushPromise = 0x5,
+    kPing = 0x6,
+    kGoAway = 0x7,
+    kWindowUpdate = 0x8,
+    kContinuation = 0x9
+};
+
+enum FrameFlag : uint8_t
+{
+    kEndStream = 0x1,
+    kAck = 0x1,
+    kEndHeaders = 0x4,
+    kPadded = 0x8,
+    kPriorityFlag = 0x20
+};
+
+enum ErrorCode : uint32_t
+{
+    kNoError = 0x0,
+    kProtocolError = 0x1,
+    kInternalError = 0x2,
+    kFlowControlError = 0x3,
+    kStreamClosed = 0x5,
+    kFrameSizeError = 0x6,
+    kRefusedStream = 0x7,
+    kCompressionError = 0x9,
+    kEnhanceYourCalm = 0xb
+};
+
+enum SettingId : uint16_t
+{
+    kHeaderTableSize = 0x1,
+    kEnablePush = 0x2,
+    kMaxConcurrentStreams = 0x3,
+    kInitialWindowSize = 0x4,
+    kMaxFrameSize = 0x5,
+    kMaxHeaderListSize = 0x6
+};
+
+constexpr size_t frameHeaderLength = 9;
+constexpr size_t defaultWindowSize = 65535;
+constexpr int64_t maxWindowSize = 0x7fffffff;
+constexpr size_t minFrameSize = 16384;
+constexpr size_t maxFrameSize = 16777215;
+constexpr size_t maxHeaderBlockLength = 256 * 1024;
+// The decoded header fields, the same limit as the header of HTTP/1.x
+constexpr size_t maxHeaderListSize = 64 * 1024;
+
+inline uint32_t readUint32(const char *p)
+{
+    auto bytes = reinterpret_cast<const uint8_t *>(p);
+    return (static_cast<uint32_t>(bytes[0]) << 24) |
+           (static_cast<uint32_t>(bytes[1]) << 16) |
+           (static_cast<uint32_t>(bytes[2]) << 8) | bytes[3];
+}
+
+inline uint16_t readUint16(const char *p)
+{
+    auto bytes = reinterpret_cast<const uint8_t *>(p);
+    return static_cast<uint16_t>((bytes[0] << 8) | bytes[1]);
+}
+
+inline bool isConnectionSpecificHeader(const std::string &name)
+{
+    return name == "connection" || name == "keep-alive" ||
+           name == "proxy-connection" || name == "transfer-encoding" ||
+           name == "upgrade";
+}
+
+// Convert the header rendered for HTTP/1.1 to header fields, return the
+// position after the header.
+const char *parseHeaderFields(const char *begin,
+                              const char *end,
+                              std::vector<HeaderField> &fields)
+{
+    static const char crlf[] = "\r\n";
+    // The status line, e.g. "HTTP/1.1 200 OK"
+    auto lineEnd = std::search(begin, end, crlf, crlf + 2);
+    auto codeBegin = std::find(begin, lineEnd, ' ');
+    if (codeBegin != lineEnd)
+        ++codeBegin;
+    fields.emplace_back(":status",
+                        std::string(codeBegin,
+                                    std::find(codeBegin, lineEnd, ' ')));
+    while (lineEnd != end)
+    {
+        begin = lineEnd + 2;
+        lineEnd = std::search(begin, end, crlf, crlf + 2);
+        if (lineEnd == begin)
+            return lineEnd == end ? end : lineEnd + 2;
+        auto colon = std::find(begin, lineEnd, ':');
+        if (colon == lineEnd)
+            continue;
+        std::string name(begin, colon);
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        if (isConnectionSpecificHeader(name))
+            continue;
+        auto valueBegin = colon + 1;
+        while (valueBegin != lineEnd && *valueBegin == ' ')
+            ++valueBegin;
+        fields.emplace_back(std::move(name), std::string(valueBegin, lineEnd));
+    }
+    return end;
+}
+}  // namespace
+
+const std::string &Http2Connection::clientPreface()
+{
+    static const std::string preface{"PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n"};
+    return preface;
+}
+
+Http2Connection::Http2Connection(const trantor::TcpConnectionPtr &conn,
+                                 RequestCallback &&callback)
+    : conn_(conn), requestCallback_(std::move(callback))
+{
+    auto &app = HttpAppFrameworkImpl::instance();
+    maxConcurrentStreams_ = app.http2MaxConcurrentStreams();
+    initialWindowSize_ =
+        (std::min)(app.http2InitialWindowSize(),
+                   static_cast<size_t>(maxWindowSize));
+    maxFrameSize_ = (std::max)(minFrameSize,
+                               (std::min)(app.http2MaxFrameSize(),
+                                          maxFrameSize));
+}
+
+void Http2Connection::start()
+{
+    writeFrameHeader(24, kSettings, 0, 0);
+    output_.appendInt16(kMaxConcurrentStreams);
+    output_.appendInt32(static_cast<uint32_t>(maxConcurrentStreams_));
+    output_.appendInt16(kInitialWindowSize);
+    output_.appendInt32(static_cast<uint32_t>(initialWindowSize_));
+    output_.appendInt16(kMaxFrameSize);
+    output_.appendInt32(static_cast<uint32_t>(maxFrameSize_));
+    output_.appendInt16(kMaxHeaderListSize);
+    output_.appendInt32(static_cast<uint32_t>(maxHeaderListSize));
+    // The window of the connection can only be changed by WINDOW_UPDATE.
+    if (initialWindowSize_ > defaultWindowSize)
+    {
+        writeWindowUpdate(0, initialWindowSize_ - defaultWindowSize);
+    }
+    flush();
+    auto iter = streams_.find(1);
+    if (iter != streams_.end())
+    {
+        dispatchRequest(iter);
+    }
+}
+
+bool Http2Connection::upgrade(const HttpRequestImplPtr &req,
+                              const std::string &settings)
+{
+    auto payload = utils::base64Decode(settings);
+    if (payload.length() % 6 != 0 ||
+        applySettings(payload.data(), payload.length()) != kNoError)
+    {
+        return false;
+    }
+    // The request which upgrades the connection is half-closed (remote).
+    req->setVersion(Version::kHttp2);
+    lastStreamId_ = 1;
+    auto iter = streams_.emplace(1, Stream(req, peerInitialWindowSize_)).first;
+    iter->second.remoteClosed = true;
+    return true;
+}
+
+void Http2Connection::onMessage(trantor::MsgBuffer *buf)
+{
+    if (closed_)
+    {
+        buf->retrieveAll();
+        return;
+    }
+    if (!prefaceReceived_)
+    {
+        auto &preface = clientPreface();
+        auto length = (std::min)(buf->readableBytes(), preface.length());
+        if (memcmp(buf->peek(), preface.data(), length) != 0)
+        {
+            goAway(kProtocolError);
+            buf->retrieveAll();
+            return;
+        }
+        if (length < preface.length())
+            return;
+        buf->retrieve(length);
+        prefaceReceived_ = true;
+    }
+    // Frames are written to the output buffer and sent all at once.
+    processing_ = true;
+    while (buf->readableBytes() >= frameHeaderLength)
+    {
+        auto p = buf->peek();
+        size_t length = (static_cast<uint8_t>(p[0]) << 16) |
+                        (static_cast<uint8_t>(p[1]) << 8) |
+                        static_cast<uint8_t>(p[2]);
+        if (length > maxFrameSize_)
+        {
+            goAway(kFrameSizeError);
+            break;
+        }
+        if (buf->readableBytes() < frameHeaderLength + length)
+            break;
+        auto streamId = readUint32(p + 5) & 0x7fffffff;
+        auto ok = processFrame(static_cast<uint8_t>(p[3]),
+                               static_cast<uint8_t>(p[4]),
+                               streamId,
+                               p + frameHeaderLength,
+                               length);
+        buf->retrieve(frameHeaderLength + length);
+        if (!ok)
+            break;
+    }
+    processing_ = false;
+    if (closed_)
+    {
+        buf->retrieveAll();
+        return;
+    }
+    flush();
+}
+
+bool Http2Connection::processFrame(uint8_t type,
+                                   uint8_t flags,
+                                   uint32_t streamId,
+                                   const char *payload,
+                                   size_t length)
+{
+    // A header block must not be interleaved with other frames.
+    if (headerStreamId_ != 0 && type != kContinuation)
+    {
+        goAway(kProtocolError);
+        return false;
+    }
+    switch (type)
+    {
+        case kData:
+            return onDataFrame(flags, streamId, payload, length);
+        case kHeaders:
+            return onHeadersFrame(flags, streamId, payload, length);
+        case kPriority:
+            if (streamId == 0)
+            {
+                goAway(kProtocolError);
+                return false;
+            }
+            if (length != 5)
+            {
+                resetStream(streamId, kFrameSizeError);
+            }
+            return true;
+        case kRstStream:
+        {
+            if (streamId == 0 || streamId > lastStreamId_)
+            {
+                goAway(kProtocolError);
+                return false;
+            }
+            if (length != 4)
+            {
+                goAway(kFrameSizeError);
+                return false;
+            }
+            auto iter = streams_.find(streamId);
+            if (iter != streams_.end())
+                eraseStream(iter);
+            return true;
+        }
+        case kSettings:
+            if (streamId != 0)
+            {
+                goAway(kProtocolError);
+                return false;
+            }
+            return onSettingsFrame(flags, payload, length);
+        case kPing:
+            if (streamId != 0)
+            {
+                goAway(kProtocolError);
+                return false;
+            }
+            if (length != 8)
+            {
+                goAway(kFrameSizeError);
+                return false;
+            }
+            if ((flags & kAck) == 0)
+            {
+                writeFrameHeader(8, kPing, kAck, 0);
+                output_.append(payload, 8);
+            }
+            return true;
+        case kGoAway:
+            // The client closes the connection when it gets the responses
+            // of its streams.
+            if (streamId != 0)
+            {
+                goAway(kProtocolError);
+                return false;
+            }
+            return true;
+        case kWindowUpdate:
+            return onWindowUpdateFrame(streamId, payload, length);
+        case kContinuation:
+            if (streamId == 0 || streamId != headerStreamId_)
+            {
+                goAway(kProtocolError);
+                return false;
+            }
+            if (headerBlock_.length() + length > maxHeaderBlockLength)
+            {
+                goAway(kEnhanceYourCalm);
+                return false;
+            }
+            headerBlock_.append(payload, length);
+            if (flags & kEndHeaders)
+                return onHeaderBlock();
+            return true;
+        case kPushPromise:
+            // Clients can't push streams.
+            goAway(kProtocolError);
+            return false;
+        default:
+            // Frames of unknown types are ignored (rfc7540-4.1).
+            return true;
+    }
+}
+
+bool Http2Connection::onDataFrame(uint8_t flags,
+                                  uint32_t streamId,
+                                  const char *payload,
+                                  size_t length)
+{
+    if (streamId == 0)
+    {
+        goAway(kProtocolError);
+        return false;
+    }
+    // Flow control applies to the entire frame, including the padding.
+    unackedLength_ += length;
+    if (unackedLength_ >= initialWindowSize_ / 2)
+    {
+        writeWindowUpdate(0, unackedLength_);
+        unackedLength_ = 0;
+    }
+    size_t offset = 0;
+    size_t padding = 0;
+    if (flags & kPadded)
+    {
+        if (length == 0)
+        {
+            goAway(kProtocolError);
+            return false;
+        }
+        padding = static_cast<uint8_t>(payload[0]);
+        offset = 1;
+    }
+    if (offset + padding > length)
+    {
+        goAway(kProtocolError);
+        return false;
+    }
+    auto iter = streams_.find(streamId);
+    if (iter == streams_.end())
+    {
+        if (streamId > lastStreamId_)
+        {
+            goAway(kProtocolError);
+            return false;
+        }
+        // The stream has been reset or responded, drop the data.
+        return true;
+    }
+    auto &stream = iter->second;
+    if (stream.remoteClosed)
+    {
+        resetStream(streamId, kStreamClosed);
+        eraseStream(iter);
+        return true;
+    }
+    auto dataLength = length - offset - padding;
+    if (stream.request->bodyLength() + dataLength >
+        HttpAppFrameworkImpl::instance().getClientMaxBodySize())
+    {
+        auto resp = HttpResponse::newHttpResponse();
+        resp->setStatusCode(k413RequestEntityTooLarge);
+        sendResponse(streamId, resp, false);
+        return true;
+    }
+    stream.request->appendToBody(payload + offset, dataLength);
+    if ((flags & kEndStream) == 0)
+    {
+        stream.unackedLength += length;
+        if (stream.unackedLength >= initialWindowSize_ / 2)
+        {
+            writeWindowUpdate(streamId, stream.unackedLength);
+            stream.unackedLength = 0;
+        }
+        return true;
+    }
+    stream.remoteClosed = true;
+    dispatchRequest(iter);
+    return true;
+}
+
+bool Http2Connection::onHeadersFrame(uint8_t flags,
+                                     uint32_t streamId,
+                                     const char *payload,
+                                     size_t length)
+{
+    // Streams initiated by clients use odd numbers.
+    if (streamId == 0 || (streamId & 1) == 0)
+    {
+        goAway(kProtocolError);
+        return false;
+    }
+    size_t offset = 0;
+    size_t padding = 0;
+    if (flags & kPadded)
+    {
+        if (length == 0)
+        {
+            goAway(kProtocolError);
+            return false;
+        }
+        padding = static_cast<uint8_t>(payload[0]);
+        offset = 1;
+    }
+    if (flags & kPriorityFlag)
+    {
+        offset += 5;
+    }
+    if (offset + padding > length)
+    {
+        goAway(kProtocolError);
+        return false;
+    }
+    headerStreamId_ = streamId;
+    headerEndStream_ = (flags & kEndStream) != 0;
+    headerBlock_.assign(payload + offset, length - offset - padding);
+    if (flags & kEndHeaders)
+        return onHeaderBlock();
+    return true;
+}
+
+bool Http2Connection::onHeaderBlock()
+{
+    auto streamId = headerStreamId_;
+    headerStreamId_ = 0;
+    headerFields_.clear();
+    // The block is always decoded to keep the dynamic table in sync, a
+    // block that is not decoded completely fails the connection.
+    auto status = decoder_.decode(headerBlock_.data(),
+                                  headerBlock_.length(),
+                                  headerFields_,
+                                  maxHeaderListSize);
+    if (status != HpackDecoder::Status::kOk)
+    {
+        goAway(status == HpackDecoder::Status::kHeaderListTooLarge
+                   ? kEnhanceYourCalm
+                   : kCompressionError);
+        return false;
+    }
+    auto iter = streams_.find(streamId);
+    if (iter != streams_.end())
+    {
+        // Trailers, they must end the stream.
+        if (iter->second.remoteClosed || !headerEndStream_)
+        {
+            resetStream(streamId,
+                        iter->second.remoteClosed ? kStreamClosed
+                                                  : kProtocolError);
+            eraseStream(iter);
+            return true;
+        }
+        iter->second.remoteClosed = true;
+        dispatchRequest(iter);
+        return true;
+    }
+    if (streamId <= lastStreamId_)
+    {
+        // The stream has been reset or responded.
+        return true;
+    }
+    lastStreamId_ = streamId;
+    // Reset streams count until their handlers respond, or a client could
+    // start any number of handlers by opening and resetting streams.
+    if (streams_.size() + resetStreams_.size() >= maxConcurrentStreams_)
+    {
+        resetStream(streamId, kRefusedStream);
+        return true;
+    }
+    auto req = makeRequest(headerFields_);
+    if (!req)
+    {
+        resetStream(streamId, kProtocolError);
+        return true;
+    }
+    iter =
+        streams_.emplace(streamId, Stream(req, peerInitialWindowSize_)).first;
+    if (headerEndStream_)
+    {
+        iter->second.remoteClosed = true;
+        dispatchRequest(iter);
+    }
+    return true;
+}
+
+HttpRequestImplPtr Http2Connection::makeRequest(
+    const std::vector<HeaderField> &fields)
+{
+    auto req = std::make_shared<HttpRequestImpl>(conn_->getLoop());
+    req->setVersion(Version::kHttp2);
+    req->setPeerAddr(conn_->peerAddr());
+    req->setLocalAddr(conn_->localAddr());
+    req->setCreationDate(trantor::Date::date());
+    req->setSecure(conn_->isSSLConnection());
+    bool hasMethod = false;
+    bool hasPath = false;
+    bool hasRegularField = false;
+    const std::string *authority = nullptr;
+    for (auto &field : fields)
+    {
+        auto &name = field.first;
+        auto &value = field.second;
+        if (!name.empty() && name[0] == ':')
+        {
+            // Pseudo-header fields must precede regular ones.
+            if (hasRegularField)
+                return nullptr;
+            if (name == ":method")
+            {
+                if (!req->setMethod(value.data(),
+                                    value.data() + value.length()))
+                    return nullptr;
+                hasMethod = true;
+            }
+            else if (name == ":path")
+            {
+                if (value.empty())
+                    return nullptr;
+                auto end = value.data() + value.length();
+                auto query = std::find(value.data(), end, '?');
+                req->setPath(value.data(), query);
+                if (query != end)
+                    req->setQuery(query + 1, end);
+                hasPath = true;
+            }
+            else if (name == ":authority")
+            {
+                authority = &value;
+            }
+            else if (name != ":scheme")
+            {
+                return nullptr;
+            }
+            continue;
+        }
+        hasRegularField = true;
+        if (name == "connection")
+            return nullptr;
+        // Parsed like the header lines of HTTP/1.x, so the cookies are too.
+        headerLine_.assign(name).append(": ").append(value);
+        req->addHeader(headerLine_.data(),
+                       headerLine_.data() + name.length(),
+                       headerLine_.data() + headerLine_.length());
+    }
+    if (!hasMethod || !hasPath)
+        return nullptr;
+    if (authority && req->getHeaderBy("host").empty())
+    {
+        req->addHeader("host", *authority);
+    }
+    return req;
+}
+
+void Http2Connection::dispatchRequest(StreamMap::iterator iter)
+{
+    // The stream may be closed by the callback, don't use the iterator after
+    // this call.
+    iter->second.dispatched = true;
+    auto req = iter->second.request;
+    requestCallback_(shared_from_this(), req, iter->first);
+}
+
+bool Http2Connection::onSettingsFrame(uint8_t flags,
+                                      const char *payload,
+                                      size_t length)
+{
+    if (flags & kAck)
+    {
+        if (length != 0)
+        {
+            goAway(kFrameSizeError);
+            return false;
+        }
+        return true;
+    }
+    if (length % 6 != 0)
+    {
+        goAway(kFrameSizeError);
+        return false;
+    }
+    auto errorCode = applySettings(payload, length);
+    if (errorCode != kNoError)
+    {
+        goAway(errorCode);
+        return false;
+    }
+    writeFrameHeader(0, kSettings, kAck, 0);
+    sendPendingData();
+    return true;
+}
+
+uint32_t Http2Connection::applySettings(const char *payload, size_t length)
+{
+    for (size_t i = 0; i + 6 <= length; i += 6)
+    {
+        auto id = readUint16(payload + i);
+        auto value = readUint32(payload + i + 2);
+        switch (id)
+        {
+            case kHeaderTableSize:
+                encoder_.setMaxTableSize(value);
+                break;
+            case kEnablePush:
+                if (value > 1)
+                    return kProtocolError;
+                break;
+            case kInitialWindowSize:
+            {
+                if (value > maxWindowSize)
+                    return kFlowControlError;
+                // The change applies to the windows of all streams.
+                auto delta = static_cast<int64_t>(value) -
+                             peerInitialWindowSize_;
+                for (auto &stream : streams_)
+                {
+                    stream.second.sendWindow += delta;
+                }
+                peerInitialWindowSize_ = value;
+                break;
+            }
+            case kMaxFrameSize:
+                if (value < minFrameSize || value > maxFrameSize)
+                    return kProtocolError;
+                peerMaxFrameSize_ = value;
+                break;
+            default:
+                break;
+        }
+    }
+    return kNoError;
+}
+
+bool Http2Connection::onWindowUpdateFrame(uint32_t streamId,
+                                          const char *payload,
+                                          size_t length)
+{
+    if (length != 4)
+    {
+        goAway(kFrameSizeError);
+        return false;
+    }
+    auto increment = readUint32(payload) & 0x7fffffff;
+    if (streamId == 0)
+    {
+        if (increment == 0)
+        {
+            goAway(kProtocolError);
+            return false;
+        }
+        sendWindow_ += increment;
+        if (sendWindow_ > maxWindowSize)
+        {
+            goAway(kFlowControlError);
+            return false;
+        }
+    }
+    else
+    {
+        auto iter = streams_.find(streamId);
+        if (iter == streams_.end())
+            return true;
+        auto &stream = iter->second;
+        stream.sendWindow += increment;
+        if (increment == 0 || stream.sendWindow > maxWindowSize)
+        {
+            resetStream(streamId,
+                        increment == 0 ? kProtocolError : kFlowControlError);
+            eraseStream(iter);
+            return true;
+        }
+    }
+    sendPendingData();
+    return true;
+}
+
+void Http2Connection::sendResponse(uint32_t streamId,
+                                   const HttpResponsePtr &resp,
+                                   bool isHeadMethod)
+{
+    getLoop()->assertInLoopThread();
+    auto iter = streams_.find(streamId);
+    if (iter == streams_.end())
+    {
+        // The handler of a reset stream is done, its slot is free again.
+        resetStreams_.erase(streamId);
+        return;
+    }
+    if (closed_ || iter->second.responded || !conn_->connected())
+        return;
+    auto &stream = iter->second;
+    stream.responded = true;
+    auto respImplPtr = static_cast<HttpResponseImpl *>(resp.get());
+    // The header rendered for HTTP/1.1 is converted to header fields, so the
+    // cached responses are shared by all connections.
+    responseFields_.clear();
+    const char *bodyBegin;
+    const char *bodyEnd;
+    trantor::MsgBuffer header;
+    if (respImplPtr->expiredTime() >= 0)
+    {
+        stream.rendered = respImplPtr->renderToBuffer();
+        bodyEnd = stream.rendered->peek() + stream.rendered->readableBytes();
+        bodyBegin = parseHeaderFields(stream.rendered->peek(),
+                                      bodyEnd,
+                                      responseFields_);
+    }
+    else
+    {
+        respImplPtr->renderHeaderToBuffer(header);
+        parseHeaderFields(header.peek(),
+                          header.peek() + header.readableBytes(),
+                          responseFields_);
+        bodyBegin = respImplPtr->getBodyData();
+        bodyEnd = bodyBegin + respImplPtr->getBodyLength();
+        stream.response = resp;
+    }
+    if (!isHeadMethod)
+    {
+        auto &sendfileName = respImplPtr->sendfileName();
+        stream.data = bodyBegin;
+        stream.length = bodyEnd - bodyBegin;
+        if (!sendfileName.empty())
+        {
+            // There is no sendfile() for frames, the range is read in pieces
+            // as the flow control windows allow.
+            auto &range = respImplPtr->sendfileRange();
+            stream.file = std::make_unique<std::ifstream>(
+                utils::toNativePath(sendfileName), std::ios::binary);
+            stream.file->seekg(range.first);
+            stream.length = *stream.file ? range.second : 0;
+        }
+    }
+
+    responseBlock_.clear();
+    encoder_.encode(responseFields_, responseBlock_);
+    bool endStream = stream.length == 0;
+    size_t offset = 0;
+    do
+    {
+        auto length =
+            (std::min)(responseBlock_.length() - offset, peerMaxFrameSize_);
+        uint8_t flags = 0;
+        if (offset + length == responseBlock_.length())
+            flags |= kEndHeaders;
+        if (offset == 0 && endStream)
+            flags |= kEndStream;
+        writeFrameHeader(length,
+                         offset == 0 ? kHeaders : kContinuation,
+                         flags,
+                         streamId);
+        output_.append(responseBlock_.data() + offset, length);
+        offset += length;
+    } while (offset < responseBlock_.length());
+
+    if (endStream || sendData(streamId, stream))
+    {
+        closeStream(iter);
+    }
+    flush();
+}
+
+bool Http2Connection::sendData(uint32_t streamId, Stream &stream)
+{
+    while (stream.offset < stream.length)
+    {
+        auto window = (std::min)(sendWindow_, stream.sendWindow);
+        if (window <= 0)
+            return false;
+        auto length = (std::min)({stream.length - stream.offset,
+                                  static_cast<size_t>(window),
+                                  peerMaxFrameSize_});
+        auto data = stream.data + stream.offset;
+        if (stream.file)
+        {
+            fileChunk_.resize(length);
+            stream.file->read(&fileChunk_[0], length);
+            if (static_cast<size_t>(stream.file->gcount()) != length)
+            {
+                // The file is shorter than the range, the stream can't be
+                // completed. It counts as closed by the client so that
+                // closeStream() doesn't reset it again.
+                LOG_ERROR << "Failed to read the file of stream " << streamId;
+                resetStream(streamId, kInternalError);
+                stream.remoteClosed = true;
+                return true;
+            }
+            data = fileChunk_.data();
+        }
+        bool last = stream.offset + length == stream.length;
+        writeFrameHeader(length, kData, last ? kEndStream : 0, streamId);
+        output_.append(data, length);
+        stream.offset += length;
+        sendWindow_ -= length;
+        stream.sendWindow -= length;
+    }
+    return true;
+}
+
+void Http2Connection::sendPendingData()
+{
+    for (auto iter = streams_.begin(); iter != streams_.end();)
+    {
+        if (sendWindow_ <= 0)
+            break;
+        if (iter->second.responded && sendData(iter->first, iter->second))
+        {
+            iter = closeStream(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+    flush();
+}
+
+Http2Connection::StreamMap::iterator Http2Connection::closeStream(
+    StreamMap::iterator iter)
+{
+    // The response is complete before the request, the client should stop
+    // sending it (rfc7540-8.1).
+    if (!iter->second.remoteClosed)
+    {
+        resetStream(iter->first, kNoError);
+    }
+    return streams_.erase(iter);
+}
+
+void Http2Connection::eraseStream(StreamMap::iterator iter)
+{
+    if (iter->second.dispatched && !iter->second.responded)
+        resetStreams_.insert(iter->first);
+    streams_.erase(iter);
+}
+
+void Http2Connection::resetStream(uint32_t streamId, uint32_t errorCode)
+{
+    writeFrameHeader(4, kRstStream, 0, streamId);
+    output_.appendInt32(errorCode);
+}
+
+void Http2Connection::goAway(uint32_t errorCode)
+{
+    LOG_DEBUG << "HTTP/2 connection error " << errorCode << " from "
+              << conn_->peerAddr().toIpPort();
+    writeFrameHeader(8, kGoAway, 0, 0);
+    output_.appendInt32(lastStreamId_);
+    output_.appendInt32(errorCode);
+    conn_->send(output_);
+    output_.retrieveAll();
+    streams_.clear();
+    resetStreams_.clear();
+    closed_ = true;
+    conn_->shutdown();
+}
+
+void Http2Connection::writeFrameHeader(size_t length,
+                                       uint8_t type,
+                                       uint8_t flags,
+                                       uint32_t streamId)
+{
+    char header[frameHeaderLength] = {static_cast<char>(length >> 16),
+                                      static_cast<char>(length >> 8),
+                                      static_cast<char>(length),
+                                      static_cast<char>(type),
+                                      static_cast<char>(flags),
+                                      static_cast<char>(streamId >> 24),
+                                      static_cast<char>(streamId >> 16),
+                                      static_cast<char>(streamId >> 8),
+                                      static_cast<char>(streamId)};
+    output_.append(header, frameHeaderLength);
+}
+
+void Http2Connection::writeWindowUpdate(uint32_t streamId, size_t increment)
+{
+    writeFrameHeader(4, kWindowUpdate, 0, streamId);
+    output_.appendInt32(static_cast<uint32_t>(increment));
+}
+
+void Http2Connection::flush()
+{
+    if (processing_ || output_.readableBytes() == 0)
+        return;
+    conn_->send(output_);
+    output_.retrieveAll();
+}
@@ -0,0 +1,167 @@
+/**
+ *
+ *  Http2Connection.h
+ *  An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#pragma once
+
+#include "Hpack.h"
+#include "impl_forwards.h"
+#include <trantor/net/TcpConnection.h>
+#include <trantor/utils/MsgBuffer.h>
+#include <trantor/utils/NonCopyable.h>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace drogon
+{
+/**
+ * @brief The server side of a HTTP/2 (rfc7540) connection. Requests of
+ * streams are passed to the request callback as soon as they are complete,
+ * and responses are sent on their streams in any order.
+ */
+class Http2Connection : public trantor::NonCopyable,
+                        public std::enable_shared_from_this<Http2Connection>
+{
+  public:
+    using RequestCallback = std::function<void(const Http2ConnectionPtr &,
+                                               const HttpRequestImplPtr &,
+                                               uint32_t streamId)>;
+
+    Http2Connection(const trantor::TcpConnectionPtr &conn,
+                    RequestCallback &&callback);
+
+    /// Send the connection preface of the server.
+    void start();
+
+    /// Take over a HTTP/1.1 connection upgraded to h2c, the request is
+    /// handled as stream 1 with the settings of the HTTP2-Settings header.
+    bool upgrade(const HttpRequestImplPtr &req, const std::string &settings);
+
+    void onMessage(trantor::MsgBuffer *buf);
+
+    void sendResponse(uint32_t streamId,
+                      const HttpResponsePtr &resp,
+                      bool isHeadMethod);
+
+    trantor::EventLoop *getLoop() const
+    {
+        return conn_->getLoop();
+    }
+
+    /// The connection preface sent by clients.
+    static const std::string &clientPreface();
+
+  private:
+    struct Stream
+    {
+        Stream(const HttpRequestImplPtr &req, int64_t window)
+            : request(req), sendWindow(window)
+        {
+        }
+        HttpRequestImplPtr request;
+        int64_t sendWindow;
+        size_t unackedLength{0};
+        bool remoteClosed{false};
+        bool dispatched{false};
+        bool responded{false};
+        // The body being sent, the response or the rendered buffer owns it.
+        HttpResponsePtr response;
+        std::shared_ptr<trantor::MsgBuffer> rendered;
+        // A sendfile range is read from the file as it is sent.
+        std::unique_ptr<std::ifstream> file;
+        const char *data{nullptr};
+        size_t length{0};
+        size_t offset{0};
+    };
+    using StreamMap = std::unordered_map<uint32_t, Stream>;
+
+    bool processFrame(uint8_t type,
+                      uint8_t flags,
+                      uint32_t streamId,
+                      const char *payload,
+                      size_t length);
+    bool onDataFrame(uint8_t flags,
+                     uint32_t streamId,
+                     const char *payload,
+                     size_t length);
+    bool onHeadersFrame(uint8_t flags,
+                        uint32_t streamId,
+                        const char *payload,
+                        size_t length);
+    bool onHeaderBlock();
+    bool onSettingsFrame(uint8_t flags, const char *payload, size_t length);
+    // Return the error code of invalid settings, 0 if they are applied.
+    uint32_t applySettings(const char *payload, size_t length);
+    bool onWindowUpdateFrame(uint32_t streamId,
+                             const char *payload,
+                             size_t length);
+    HttpRequestImplPtr makeRequest(const std::vector<HeaderField> &fields);
+    void dispatchRequest(StreamMap::iterator iter);
+
+    // Return false if the stream is blocked by flow control.
+    bool sendData(uint32_t streamId, Stream &stream);
+    void sendPendingData();
+    StreamMap::iterator closeStream(StreamMap::iterator iter);
+    // Drop a stream that is not responded, e.g. reset by the client.
+    void eraseStream(StreamMap::iterator iter);
+    void resetStream(uint32_t streamId, uint32_t errorCode);
+    void goAway(uint32_t errorCode);
+    void writeFrameHeader(size_t length,
+                          uint8_t type,
+                          uint8_t flags,
+                          uint32_t streamId);
+    void writeWindowUpdate(uint32_t streamId, size_t increment);
+    void flush();
+
+    trantor::TcpConnectionPtr conn_;
+    RequestCallback requestCallback_;
+    HpackDecoder decoder_;
+    HpackEncoder encoder_;
+    StreamMap streams_;
+    // Streams dropped while their handlers were running, they count as
+    // concurrent streams until the handlers respond.
+    std::unordered_set<uint32_t> resetStreams_;
+    trantor::MsgBuffer output_;
+
+    // Settings of the server
+    size_t maxConcurrentStreams_;
+    size_t initialWindowSize_;
+    size_t maxFrameSize_;
+    // Settings of the client
+    int64_t peerInitialWindowSize_{65535};
+    size_t peerMaxFrameSize_{16384};
+
+    int64_t sendWindow_{65535};
+    size_t unackedLength_{0};
+    uint32_t lastStreamId_{0};
+    // The header block being received in HEADERS and CONTINUATION frames.
+    uint32_t headerStreamId_{0};
+    bool headerEndStream_{false};
+    std::string headerBlock_;
+    std::vector<HeaderField> headerFields_;
+    std::string headerLine_;
+    std::vector<HeaderField> responseFields_;
+    std::string responseBlock_;
+    std::string fileChunk_;
+
+    bool prefaceReceived_{false};
+    bool processing_{false};
+    bool closed_{false};
+};
+
+}  // namespace drogon
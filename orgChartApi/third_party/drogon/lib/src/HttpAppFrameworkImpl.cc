@@ -15,6 +15,7 @@
 #include "HttpAppFrameworkImpl.h"
 #include "HttpRequestImpl.h"
 #include "HttpClientImpl.h"
+#include "HttpDate.h"
 #include "HttpResponseImpl.h"
 #include "HttpUtils.h"
 #include "WebSocketConnectionImpl.h"
@@ -360,11 +361,18 @@ HttpAppFramework &HttpAppFrameworkImpl::addListener(
     const std::string &certFile,
     const std::string &keyFile,
     bool useOldTLS,
-    const std::vector<std::pair<std::string, std::string>> &sslConfCmds)
+    const std::vector<std::pair<std::string, std::string>> &sslConfCmds,
+    bool cpuSteering)
 {
     assert(!running_);
-    listenerManagerPtr_->addListener(
-        ip, port, useSSL, certFile, keyFile, useOldTLS, sslConfCmds);
+    listenerManagerPtr_->addListener(ip,
+                                     port,
+                                     useSSL,
+                                     certFile,
+                                     keyFile,
+                                     useOldTLS,
+                                     sslConfCmds,
+                                     cpuSteering);
     return *this;
 }
 HttpAppFramework &HttpAppFrameworkImpl::setMaxConnectionNum(
@@ -558,6 +566,13 @@ void HttpAppFrameworkImpl::run()
     // A fast database client instance should be created in the main event
     // loop, so put the main loop into ioLoops.
     ioLoops.push_back(getLoop());
+    if (enableDateHeader_)
+    {
+        for (auto loop : ioLoops)
+        {
+            loop->runInLoop([loop]() { HttpDate::startUpdating(loop); });
+        }
+    }
     dbClientManagerPtr_->createDbClients(ioLoops);
     redisClientManagerPtr_->createRedisClients(ioLoops);
     if (useSession_)
@@ -1125,6 +1140,11 @@ HttpAppFramework &HttpAppFrameworkImpl::setupFileLogger()
     return *this;
 }
 
+void HttpAppFrameworkImpl::invalidateCachedResponses(const std::string &tag)
+{
+    httpCtrlsRouterPtr_->invalidateCachedResponses(tag);
+}
+
 HttpAppFramework &HttpAppFrameworkImpl::registerCustomExtensionMime(
     const std::string &ext,
     const std::string &mime)
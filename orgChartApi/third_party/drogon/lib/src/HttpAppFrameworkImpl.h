@@ -59,13 +59,32 @@ class HttpAppFrameworkImpl final : public HttpAppFramework
         const std::string &certFile,
         const std::string &keyFile,
         bool useOldTLS,
-        const std::vector<std::pair<std::string, std::string>> &sslConfCmds)
-        override;
+        const std::vector<std::pair<std::string, std::string>> &sslConfCmds,
+        bool cpuSteering) override;
     HttpAppFramework &setThreadNum(size_t threadNum) override;
     size_t getThreadNum() const override
     {
         return threadNum_;
     }
+    HttpAppFramework &enableCpuAffinity(bool enable) override
+    {
+        cpuAffinity_ = enable;
+        return *this;
+    }
+    bool isCpuAffinityEnabled() const override
+    {
+        return cpuAffinity_;
+    }
+    HttpAppFramework &enableIoUring(bool enable) override
+    {
+        ioUring_ = enable;
+        trantor::EventLoop::enableIoUring(enable);
+        return *this;
+    }
+    bool isIoUringEnabled() const override
+    {
+        return ioUring_;
+    }
     HttpAppFramework &setSSLConfigCommands(
         const std::vector<std::pair<std::string, std::string>> &sslConfCmds)
         override;
@@ -297,6 +316,36 @@ class HttpAppFrameworkImpl final : public HttpAppFramework
     {
         return useGzip_;
     }
+    HttpAppFramework &enableHttp2(bool enable) override
+    {
+        useHttp2_ = enable;
+        return *this;
+    }
+    bool isHttp2Enabled() const override
+    {
+        return useHttp2_;
+    }
+    HttpAppFramework &setHttp2Settings(size_t maxConcurrentStreams,
+                                       size_t initialWindowSize,
+                                       size_t maxFrameSize) override
+    {
+        http2MaxConcurrentStreams_ = maxConcurrentStreams;
+        http2InitialWindowSize_ = initialWindowSize;
+        http2MaxFrameSize_ = maxFrameSize;
+        return *this;
+    }
+    size_t http2MaxConcurrentStreams() const
+    {
+        return http2MaxConcurrentStreams_;
+    }
+    size_t http2InitialWindowSize() const
+    {
+        return http2InitialWindowSize_;
+    }
+    size_t http2MaxFrameSize() const
+    {
+        return http2MaxFrameSize_;
+    }
     HttpAppFramework &enableBrotli(bool useBrotli) override
     {
         useBrotli_ = useBrotli;
@@ -414,6 +463,15 @@ class HttpAppFrameworkImpl final : public HttpAppFramework
     {
         return usingUnicodeEscaping_;
     }
+    HttpAppFramework &enableBufferedJsonBody(bool enable) noexcept override
+    {
+        useBufferedJsonBody_ = enable;
+        return *this;
+    }
+    bool isBufferedJsonBodyEnabled() const noexcept override
+    {
+        return useBufferedJsonBody_;
+    }
     HttpAppFramework &setFloatPrecisionInJson(
         unsigned int precision,
         const std::string &precisionType) noexcept override
@@ -547,6 +605,8 @@ class HttpAppFrameworkImpl final : public HttpAppFramework
         return exceptionHandler_;
     }
 
+    void invalidateCachedResponses(const std::string &tag) override;
+
     HttpAppFramework &registerCustomExtensionMime(
         const std::string &ext,
         const std::string &mime) override;
@@ -598,6 +658,8 @@ class HttpAppFrameworkImpl final : public HttpAppFramework
     std::atomic_bool running_{false};
 
     size_t threadNum_{1};
+    bool cpuAffinity_{false};
+    bool ioUring_{false};
 #ifndef _WIN32
     std::vector<std::string> libFilePaths_;
     std::string libFileOutputPath_;
@@ -625,7 +687,12 @@ class HttpAppFrameworkImpl final : public HttpAppFramework
     bool useSendfile_{true};
     bool useGzip_{true};
     bool useBrotli_{false};
+    bool useHttp2_{false};
+    size_t http2MaxConcurrentStreams_{100};
+    size_t http2InitialWindowSize_{65535};
+    size_t http2MaxFrameSize_{16384};
     bool usingUnicodeEscaping_{true};
+    bool useBufferedJsonBody_{false};
     std::pair<unsigned int, std::string> floatPrecisionInJson_{0,
                                                                "significant"};
     bool usingCustomErrorHandler_{false};
@@ -25,6 +25,45 @@
 
 using namespace drogon;
 
+namespace
+{
+// Bounds the memory used by handlers whose responses vary with the query.
+constexpr size_t maxCachedResponsesPerHandler = 1024;
+
+// Responses shared by all the requests of a handler are cached with an empty
+// key, the others with the request path and query.
+std::string makeCacheKey(const HttpRequestImplPtr &req)
+{
+    auto &query = req->query();
+    if (query.empty())
+        return req->path();
+    std::string key;
+    key.reserve(req->path().length() + query.length() + 1);
+    key.append(req->path()).append(1, '?').append(query);
+    return key;
+}
+
+template <typename Cache>
+void removeExpiredResponses(Cache &responseCache)
+{
+    auto now = trantor::Date::now();
+    for (auto iter = responseCache.begin(); iter != responseCache.end();)
+    {
+        auto &responsePtr = iter->second;
+        if (responsePtr->expiredTime() != 0 &&
+            !(now < responsePtr->creationDate().after(
+                        static_cast<double>(responsePtr->expiredTime()))))
+        {
+            iter = responseCache.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+}
+}  // namespace
+
 void HttpControllersRouter::doWhenNoHandlerFound(
     const HttpRequestImplPtr &req,
     std::function<void(const HttpResponsePtr &)> &&callback)
@@ -42,8 +81,9 @@ void HttpControllersRouter::doWhenNoHandlerFound(
 }
 
 void HttpControllersRouter::init(
-    const std::vector<trantor::EventLoop *> & /*ioLoops*/)
+    const std::vector<trantor::EventLoop *> &ioLoops)
 {
+    ioLoops_ = ioLoops;
     auto initFilters = [](auto &binders) {
         for (auto &binder : binders)
         {
@@ -71,6 +111,68 @@ void HttpControllersRouter::init(
     }
 }
 
+void HttpControllersRouter::invalidateCachedResponses(const std::string &tag)
+{
+    {
+        std::lock_guard<std::mutex> lock(tagGenerationsMutex_);
+        tagGenerations_[tag] = ++cacheGeneration_;
+    }
+    // Every IO thread owns its cache, so purge each one in its own loop.
+    for (auto *loop : ioLoops_)
+    {
+        loop->runInLoop([this, tag]() { dropCachedResponses(tag); });
+    }
+}
+
+bool HttpControllersRouter::isTagInvalidatedSince(
+    const std::vector<std::string> &tags,
+    uint64_t generation)
+{
+    if (tags.empty())
+        return false;
+    std::lock_guard<std::mutex> lock(tagGenerationsMutex_);
+    for (auto &tag : tags)
+    {
+        auto iter = tagGenerations_.find(tag);
+        if (iter != tagGenerations_.end() && iter->second > generation)
+            return true;
+    }
+    return false;
+}
+
+void HttpControllersRouter::dropCachedResponses(const std::string &tag)
+{
+    auto dropFromBinders = [&tag](const auto &binders) {
+        for (auto &binder : binders)
+        {
+            if (!binder)
+                continue;
+            auto &responseCache = *(binder->responseCache_);
+            for (auto iter = responseCache.begin();
+                 iter != responseCache.end();)
+            {
+                auto &tags = iter->second->cacheTags();
+                if (std::find(tags.begin(), tags.end(), tag) != tags.end())
+                {
+                    iter = responseCache.erase(iter);
+                }
+                else
+                {
+                    ++iter;
+                }
+            }
+        }
+    };
+    for (auto &router : ctrlVector_)
+    {
+        dropFromBinders(router.binders_);
+    }
+    for (auto &p : ctrlMap_)
+    {
+        dropFromBinders(p.second.binders_);
+    }
+}
+
 std::vector<std::tuple<std::string, HttpMethod, std::string>>
 HttpControllersRouter::getHandlersInfo() const
 {
@@ -116,7 +218,7 @@ void HttpControllersRouter::addHttpRegex(
     binderInfo->binderPtr_ = binder;
     drogon::app().getLoop()->queueInLoop([binderInfo]() {
         // Recreate this with the correct number of threads.
-        binderInfo->responseCache_ = IOThreadStorage<HttpResponsePtr>();
+        binderInfo->responseCache_ = IOThreadStorage<ResponseCache>();
     });
     {
         for (auto &router : ctrlVector_)
@@ -384,7 +486,7 @@ void HttpControllersRouter::addHttpPath(
     binderInfo->queryParametersPlaces_ = std::move(parametersPlaces);
     drogon::app().getLoop()->queueInLoop([binderInfo]() {
         // Recreate this with the correct number of threads.
-        binderInfo->responseCache_ = IOThreadStorage<HttpResponsePtr>();
+        binderInfo->responseCache_ = IOThreadStorage<ResponseCache>();
     });
     bool routingRequiresRegex = (originPath != pathParameterPattern);
     HttpControllerRouterItem *existingRouterItemPtr = nullptr;
@@ -618,22 +720,31 @@ void HttpControllersRouter::doControllerHandler(
     const std::smatch &matchResult,
     std::function<void(const HttpResponsePtr &)> &&callback)
 {
-    auto &responsePtr = *(ctrlBinderPtr->responseCache_);
-    if (responsePtr)
+    auto &responseCache = *(ctrlBinderPtr->responseCache_);
+    if (!responseCache.empty())
     {
-        if (responsePtr->expiredTime() == 0 ||
-            (trantor::Date::now() <
-             responsePtr->creationDate().after(
-                 static_cast<double>(responsePtr->expiredTime()))))
+        auto iter = responseCache.find(std::string{});
+        if (iter == responseCache.end())
         {
-            // use cached response!
-            LOG_TRACE << "Use cached response";
-            invokeCallback(callback, req, responsePtr);
-            return;
+            iter = responseCache.find(makeCacheKey(req));
         }
-        else
+        if (iter != responseCache.end())
         {
-            responsePtr.reset();
+            auto &responsePtr = iter->second;
+            if (responsePtr->expiredTime() == 0 ||
+                (trantor::Date::now() <
+                 responsePtr->creationDate().after(
+                     static_cast<double>(responsePtr->expiredTime()))))
+            {
+                // use cached response!
+                LOG_TRACE << "Use cached response";
+                invokeCallback(callback, req, responsePtr);
+                return;
+            }
+            else
+            {
+                responseCache.erase(iter);
+            }
         }
     }
 
@@ -673,25 +784,45 @@ void HttpControllersRouter::doControllerHandler(
             }
         }
     }
+    auto generation = cacheGeneration_.load();
     ctrlBinderPtr->binderPtr_->handleHttpRequest(
         params,
         req,
-        [this, req, ctrlBinderPtr, callback = std::move(callback)](
+        [this, req, ctrlBinderPtr, generation, callback = std::move(callback)](
             const HttpResponsePtr &resp) {
             if (resp->expiredTime() >= 0 && resp->statusCode() != k404NotFound)
             {
                 // cache the response;
                 static_cast<HttpResponseImpl *>(resp.get())->makeHeaderString();
+                auto cacheResponse = [this,
+                                      resp,
+                                      ctrlBinderPtr,
+                                      generation,
+                                      key = resp->cacheKeyedByRequest()
+                                                ? makeCacheKey(req)
+                                                : std::string{}]() mutable {
+                    // Checked in the loop that purges this cache, so an
+                    // invalidation either skips the entry or drops it later.
+                    if (isTagInvalidatedSince(resp->cacheTags(), generation))
+                        return;
+                    auto &responseCache = *(ctrlBinderPtr->responseCache_);
+                    if (responseCache.size() >= maxCachedResponsesPerHandler)
+                    {
+                        removeExpiredResponses(responseCache);
+                        if (responseCache.size() >=
+                            maxCachedResponsesPerHandler)
+                            return;
+                    }
+                    responseCache[std::move(key)] = resp;
+                };
                 auto loop = req->getLoop();
                 if (loop->isInLoopThread())
                 {
-                    ctrlBinderPtr->responseCache_.setThreadData(resp);
+                    cacheResponse();
                 }
                 else
                 {
-                    req->getLoop()->queueInLoop([resp, &ctrlBinderPtr]() {
-                        ctrlBinderPtr->responseCache_.setThreadData(resp);
-                    });
+                    loop->queueInLoop(std::move(cacheResponse));
                 }
             }
             invokeCallback(callback, req, resp);
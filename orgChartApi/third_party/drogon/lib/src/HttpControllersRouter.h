@@ -73,9 +73,21 @@ class HttpControllersRouter : public trantor::NonCopyable
                std::function<void(const HttpResponsePtr &)> &&callback);
     std::vector<std::tuple<std::string, HttpMethod, std::string>>
     getHandlersInfo() const;
+    void invalidateCachedResponses(const std::string &tag);
 
   private:
     StaticFileRouter &fileRouter_;
+    std::vector<trantor::EventLoop *> ioLoops_;
+    // Each invalidation gets the next generation, which is recorded for its
+    // tag. A response is not cached if one of its tags was invalidated after
+    // its request started, or it would bring back a stale entry.
+    std::atomic<uint64_t> cacheGeneration_{0};
+    std::mutex tagGenerationsMutex_;
+    std::unordered_map<std::string, uint64_t> tagGenerations_;
+    bool isTagInvalidatedSince(const std::vector<std::string> &tags,
+                               uint64_t generation);
+    // Cached responses of a handler, keyed by the request path and query.
+    using ResponseCache = std::unordered_map<std::string, HttpResponsePtr>;
     struct CtrlBinder
     {
         internal::HttpBinderBasePtr binderPtr_;
@@ -84,7 +96,7 @@ class HttpControllersRouter : public trantor::NonCopyable
         std::vector<std::shared_ptr<HttpFilterBase>> filters_;
         std::vector<size_t> parameterPlaces_;
         std::vector<std::pair<std::string, size_t>> queryParametersPlaces_;
-        IOThreadStorage<HttpResponsePtr> responseCache_;
+        IOThreadStorage<ResponseCache> responseCache_;
         bool isCORS_{false};
     };
     using CtrlBinderPtr = std::shared_ptr<CtrlBinder>;
@@ -128,6 +140,7 @@ class HttpControllersRouter : public trantor::NonCopyable
         const HttpRequestImplPtr &req,
         const std::smatch &matchResult,
         std::function<void(const HttpResponsePtr &)> &&callback);
+    void dropCachedResponses(const std::string &tag);
     void invokeCallback(
         const std::function<void(const HttpResponsePtr &)> &callback,
         const HttpRequestImplPtr &req,
@@ -0,0 +1,73 @@
+/**
+ *
+ *  @file HttpDate.cc
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#include "HttpDate.h"
+#include <drogon/utils/Utilities.h>
+#include <string.h>
+
+using namespace drogon;
+
+namespace
+{
+struct DateCache
+{
+    int64_t second{-1};
+    bool updatedByLoop{false};
+    char date[HttpDate::kLength + 1];
+};
+
+DateCache &dateCache()
+{
+    static thread_local DateCache cache;
+    return cache;
+}
+
+void update(DateCache &cache, const trantor::Date &now)
+{
+    cache.second = now.secondsSinceEpoch();
+    memcpy(cache.date, utils::getHttpFullDate(now), HttpDate::kLength);
+}
+
+void updateEverySecond(trantor::EventLoop *loop)
+{
+    auto now = trantor::Date::now();
+    update(dateCache(), now);
+    loop->runAt(trantor::Date((now.secondsSinceEpoch() + 1) *
+                              MICRO_SECONDS_PRE_SEC),
+                [loop]() { updateEverySecond(loop); });
+}
+}  // namespace
+
+void HttpDate::startUpdating(trantor::EventLoop *loop)
+{
+    loop->assertInLoopThread();
+    auto &cache = dateCache();
+    if (cache.updatedByLoop)
+        return;
+    cache.updatedByLoop = true;
+    updateEverySecond(loop);
+}
+
+const char *HttpDate::now(int64_t &second)
+{
+    auto &cache = dateCache();
+    if (!cache.updatedByLoop)
+    {
+        auto now = trantor::Date::now();
+        if (now.secondsSinceEpoch() != cache.second)
+            update(cache, now);
+    }
+    second = cache.second;
+    return cache.date;
+}
@@ -0,0 +1,46 @@
+/**
+ *
+ *  @file HttpDate.h
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#pragma once
+
+#include <trantor/net/EventLoop.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace drogon
+{
+/**
+ * @brief The value of the Date header of responses (RFC 7231), which is
+ * formatted once per second for each thread. In the event loops of the
+ * framework it is updated by a timer at the start of every second, so
+ * rendering responses doesn't read the clock.
+ */
+class HttpDate
+{
+  public:
+    static constexpr size_t kLength = 29;
+
+    /**
+     * @brief Update the date of the current thread by a timer of the loop
+     * from now on. It must be called in the thread of the loop.
+     */
+    static void startUpdating(trantor::EventLoop *loop);
+
+    /**
+     * @brief Return the date of the current second, which has kLength
+     * characters, and set the second since the epoch.
+     */
+    static const char *now(int64_t &second);
+};
+}  // namespace drogon
@@ -36,13 +36,33 @@ void HttpRequestImpl::parseJson() const
         static std::once_flag once;
         static Json::CharReaderBuilder builder;
         std::call_once(once, []() { builder["collectComments"] = false; });
-        jsonPtr_ = std::make_shared<Json::Value>();
         JSONCPP_STRING errs;
         std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
-        if (!reader->parse(input.data(),
-                           input.data() + input.size(),
-                           jsonPtr_.get(),
-                           &errs))
+        auto parse = [&]() {
+            return reader->parse(input.data(),
+                                 input.data() + input.size(),
+                                 jsonPtr_.get(),
+                                 &errs);
+        };
+        bool parsed;
+#ifdef JSON_HAS_DOCUMENT
+        if (app().isBufferedJsonBodyEnabled())
+        {
+            // The tree lives in the buffer of a document owned by jsonPtr_,
+            // it is freed at once with the tree.
+            auto document = std::make_shared<Json::Document>();
+            jsonPtr_ =
+                std::shared_ptr<Json::Value>(document, &document->root());
+            Json::Document::Scope scope(*document);
+            parsed = parse();
+        }
+        else
+#endif
+        {
+            jsonPtr_ = std::make_shared<Json::Value>();
+            parsed = parse();
+        }
+        if (!parsed)
         {
             LOG_DEBUG << errs;
             jsonPtr_.reset();
@@ -374,7 +394,41 @@ void HttpRequestImpl::addHeader(const char *start,
                                 const char *colon,
                                 const char *end)
 {
+#if __cplusplus >= 201703L | defined _WIN32
+    if (!spareHeaderNodes_.empty())
+    {
+        auto node = std::move(spareHeaderNodes_.back());
+        spareHeaderNodes_.pop_back();
+        node.key().assign(start, colon);
+        if (parseHeader(node.key(), node.mapped(), colon, end))
+        {
+            auto result = headers_.insert(std::move(node));
+            if (!result.inserted)
+            {
+                spareHeaderNodes_.emplace_back(std::move(result.node));
+            }
+        }
+        else
+        {
+            spareHeaderNodes_.emplace_back(std::move(node));
+        }
+        return;
+    }
+#endif
     std::string field(start, colon);
+    std::string value;
+    if (parseHeader(field, value, colon, end))
+    {
+        headers_.emplace(std::move(field), std::move(value));
+    }
+}
+
+// Return false if the header is not kept in the header map.
+bool HttpRequestImpl::parseHeader(std::string &field,
+                                  std::string &value,
+                                  const char *colon,
+                                  const char *end)
+{
     // Field name is case-insensitive.so we transform it to lower;(rfc2616-4.2)
     std::transform(field.begin(), field.end(), field.begin(), ::tolower);
     ++colon;
@@ -382,7 +436,7 @@ void HttpRequestImpl::addHeader(const char *start,
     {
         ++colon;
     }
-    std::string value(colon, end);
+    value.assign(colon, end);
     while (!value.empty() && isspace(value[value.size() - 1]))
     {
         value.resize(value.size() - 1);
@@ -466,8 +520,9 @@ void HttpRequestImpl::addHeader(const char *start,
             default:
                 break;
         }
-        headers_.emplace(std::move(field), std::move(value));
+        return true;
     }
+    return false;
 }
 
 HttpRequestPtr HttpRequest::newHttpRequest()
@@ -500,7 +555,19 @@ HttpRequestPtr HttpRequest::newHttpJsonRequest(const Json::Value &data)
             builder["emitUTF8"] = true;
         }
         auto &precision = app().getFloatPrecisionInJson();
-        if (precision.first != 0)
+        if (precision.second == "shortest")
+        {
+#ifdef JSON_HAS_STREAM_WRITER_APPEND
+            // The fewest digits that read back as the same numbers, the
+            // precision is not used.
+            builder["precisionType"] = "shortest";
+#else
+            // Not supported by this jsoncpp, the same as "significant".
+            if (precision.first != 0)
+                builder["precision"] = precision.first;
+#endif
+        }
+        else if (precision.first != 0)
         {
             builder["precision"] = precision.first;
             builder["precisionType"] = precision.second;
@@ -565,6 +632,10 @@ const char *HttpRequestImpl::versionString() const
             result = "HTTP/1.1";
             break;
 
+        case Version::kHttp2:
+            result = "HTTP/2";
+            break;
+
         default:
             break;
     }
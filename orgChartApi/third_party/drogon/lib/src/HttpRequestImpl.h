@@ -28,6 +28,7 @@
 #include <string>
 #include <thread>
 #include <unordered_map>
+#include <vector>
 #include <assert.h>
 #include <stdio.h>
 
@@ -47,7 +48,16 @@ class HttpRequestImpl : public HttpRequest
         method_ = Invalid;
         version_ = Version::kUnknown;
         flagForParsingJson_ = false;
+#if __cplusplus >= 201703L | defined _WIN32
+        // Keep the nodes of the headers, along with the capacity of their
+        // strings, for the next request parsed on this connection.
+        while (!headers_.empty())
+        {
+            spareHeaderNodes_.emplace_back(headers_.extract(headers_.begin()));
+        }
+#else
         headers_.clear();
+#endif
         cookies_.clear();
         flagForParsingParameters_ = false;
         path_.clear();
@@ -512,6 +522,10 @@ class HttpRequestImpl : public HttpRequest
     }
     void createTmpFile();
     void parseJson() const;
+    bool parseHeader(std::string &field,
+                     std::string &value,
+                     const char *colon,
+                     const char *end);
     mutable bool flagForParsingParameters_{false};
     mutable bool flagForParsingJson_{false};
     HttpMethod method_{Invalid};
@@ -521,6 +535,10 @@ class HttpRequestImpl : public HttpRequest
     string_view matchedPathPattern_{""};
     std::string query_;
     std::unordered_map<std::string, std::string> headers_;
+#if __cplusplus >= 201703L | defined _WIN32
+    std::vector<std::unordered_map<std::string, std::string>::node_type>
+        spareHeaderNodes_;
+#endif
     std::unordered_map<std::string, std::string> cookies_;
     mutable std::unordered_map<std::string, std::string> parameters_;
     mutable std::shared_ptr<Json::Value> jsonPtr_;
@@ -74,6 +74,20 @@ class HttpRequestParser : public trantor::NonCopyable,
     {
         websockConnPtr_ = conn;
     }
+    const Http2ConnectionPtr &http2Conn() const
+    {
+        return http2ConnPtr_;
+    }
+    void setHttp2Connection(const Http2ConnectionPtr &conn)
+    {
+        http2ConnPtr_ = conn;
+    }
+    // Nothing of the first request is parsed yet.
+    bool atConnectionStart() const
+    {
+        return requestsCounter_ == 0 &&
+               status_ == HttpRequestParseStatus::kExpectMethod;
+    }
     // to support request pipelining(rfc2616-8.1.2.2)
     void pushRequestToPipelining(const HttpRequestPtr &req);
     HttpRequestPtr getFirstRequest() const;
@@ -137,6 +151,7 @@ class HttpRequestParser : public trantor::NonCopyable,
     HttpRequestImplPtr request_;
     bool firstRequest_{true};
     WebSocketConnectionImplPtr websockConnPtr_;
+    Http2ConnectionPtr http2ConnPtr_;
     std::deque<std::pair<HttpRequestPtr, std::pair<HttpResponsePtr, bool>>>
         requestPipelining_;
     size_t requestsCounter_{0};
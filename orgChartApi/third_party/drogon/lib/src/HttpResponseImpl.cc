@@ -14,6 +14,7 @@
 
 #include "HttpResponseImpl.h"
 #include "HttpAppFrameworkImpl.h"
+#include "HttpDate.h"
 #include "HttpUtils.h"
 #include <drogon/HttpViewData.h>
 #include <drogon/IOThreadStorage.h>
@@ -21,6 +22,7 @@
 #include <fstream>
 #include <memory>
 #include <cstdio>
+#include <sstream>
 #include <string>
 #include <sys/stat.h>
 #include <trantor/utils/Logger.h>
@@ -30,8 +32,6 @@ using namespace drogon;
 
 namespace drogon
 {
-// "Fri, 23 Aug 2019 12:58:03 GMT" length = 29
-static const size_t httpFullDateStringLength = 29;
 static inline void doResponseCreateAdvices(
     const HttpResponseImplPtr &responsePtr)
 {
@@ -95,6 +95,10 @@ const char *HttpResponseImpl::versionString() const
             result = "HTTP/1.1";
             break;
 
+        case Version::kHttp2:
+            result = "HTTP/2";
+            break;
+
         default:
             break;
     }
@@ -118,14 +122,36 @@ void HttpResponseImpl::generateBodyFromJson() const
             builder["emitUTF8"] = true;
         }
         auto &precision = app().getFloatPrecisionInJson();
-        if (precision.first != 0)
+        if (precision.second == "shortest")
+        {
+#ifdef JSON_HAS_STREAM_WRITER_APPEND
+            // The fewest digits that read back as the same numbers, the
+            // precision is not used.
+            builder["precisionType"] = "shortest";
+#else
+            // Not supported by this jsoncpp, the same as "significant".
+            if (precision.first != 0)
+                builder["precision"] = precision.first;
+#endif
+        }
+        else if (precision.first != 0)
         {
             builder["precision"] = precision.first;
             builder["precisionType"] = precision.second;
         }
     });
-    bodyPtr_ = std::make_shared<HttpMessageStringBody>(
-        writeString(builder, *jsonPtr_));
+    // Writers keep no state between documents, reuse one per thread.
+    static thread_local std::unique_ptr<Json::StreamWriter> writer(
+        builder.newStreamWriter());
+#ifdef JSON_HAS_STREAM_WRITER_APPEND
+    std::string body;
+    writer->append(*jsonPtr_, &body);
+    bodyPtr_ = std::make_shared<HttpMessageStringBody>(std::move(body));
+#else
+    std::ostringstream body;
+    writer->write(*jsonPtr_, &body);
+    bodyPtr_ = std::make_shared<HttpMessageStringBody>(body.str());
+#endif
 }
 
 HttpResponsePtr HttpResponse::newNotFoundResponse()
@@ -506,6 +532,12 @@ void HttpResponseImpl::renderToBuffer(trantor::MsgBuffer &buffer)
         return;
     }
 
+    renderHeaderToBuffer(buffer);
+    if (bodyPtr_)
+        buffer.append(bodyPtr_->data(), bodyPtr_->length());
+}
+void HttpResponseImpl::renderHeaderToBuffer(trantor::MsgBuffer &buffer)
+{
     if (!fullHeaderString_)
     {
         makeHeaderString(buffer);
@@ -528,17 +560,15 @@ void HttpResponseImpl::renderToBuffer(trantor::MsgBuffer &buffer)
     if (!passThrough_ &&
         drogon::HttpAppFrameworkImpl::instance().sendDateHeader())
     {
+        int64_t second;
         buffer.append("date: ");
-        buffer.append(utils::getHttpFullDate(trantor::Date::date()),
-                      httpFullDateStringLength);
+        buffer.append(HttpDate::now(second), HttpDate::kLength);
         buffer.append("\r\n\r\n");
     }
     else
     {
         buffer.append("\r\n");
     }
-    if (bodyPtr_)
-        buffer.append(bodyPtr_->data(), bodyPtr_->length());
 }
 std::shared_ptr<trantor::MsgBuffer> HttpResponseImpl::renderToBuffer()
 {
@@ -549,22 +579,17 @@ std::shared_ptr<trantor::MsgBuffer> HttpResponseImpl::renderToBuffer()
         {
             if (datePos_ != static_cast<size_t>(-1))
             {
-                auto now = trantor::Date::now();
-                bool isDateChanged =
-                    ((now.microSecondsSinceEpoch() / MICRO_SECONDS_PRE_SEC) !=
-                     httpStringDate_);
+                int64_t second;
+                auto newDate = HttpDate::now(second);
                 assert(httpString_);
-                if (isDateChanged)
+                if (second != httpStringDate_)
                 {
-                    httpStringDate_ =
-                        now.microSecondsSinceEpoch() / MICRO_SECONDS_PRE_SEC;
-                    auto newDate = utils::getHttpFullDate(now);
-
+                    httpStringDate_ = second;
                     httpString_ =
                         std::make_shared<trantor::MsgBuffer>(*httpString_);
                     memcpy((void *)&(*httpString_)[datePos_],
                            newDate,
-                           httpFullDateStringLength);
+                           HttpDate::kLength);
                     return httpString_;
                 }
 
@@ -600,12 +625,13 @@ std::shared_ptr<trantor::MsgBuffer> HttpResponseImpl::renderToBuffer()
     if (!passThrough_ &&
         drogon::HttpAppFrameworkImpl::instance().sendDateHeader())
     {
+        int64_t second;
         httpString->append("date: ");
         auto datePos = httpString->readableBytes();
-        httpString->append(utils::getHttpFullDate(trantor::Date::date()),
-                           httpFullDateStringLength);
+        httpString->append(HttpDate::now(second), HttpDate::kLength);
         httpString->append("\r\n\r\n");
         datePos_ = datePos;
+        httpStringDate_ = second;
     }
     else
     {
@@ -627,38 +653,7 @@ std::shared_ptr<trantor::MsgBuffer> HttpResponseImpl::
     renderHeaderForHeadMethod()
 {
     auto httpString = std::make_shared<trantor::MsgBuffer>(256);
-    if (!fullHeaderString_)
-    {
-        makeHeaderString(*httpString);
-    }
-    else
-    {
-        httpString->append(*fullHeaderString_);
-    }
-
-    // output cookies
-    if (!cookies_.empty())
-    {
-        for (auto it = cookies_.begin(); it != cookies_.end(); ++it)
-        {
-            httpString->append(it->second.cookieString());
-        }
-    }
-
-    // output Date header
-    if (!passThrough_ &&
-        drogon::HttpAppFrameworkImpl::instance().sendDateHeader())
-    {
-        httpString->append("date: ");
-        httpString->append(utils::getHttpFullDate(trantor::Date::date()),
-                           httpFullDateStringLength);
-        httpString->append("\r\n\r\n");
-    }
-    else
-    {
-        httpString->append("\r\n");
-    }
-
+    renderHeaderToBuffer(*httpString);
     return httpString;
 }
 
@@ -793,6 +788,8 @@ void HttpResponseImpl::swap(HttpResponseImpl &that) noexcept
     fullHeaderString_.swap(that.fullHeaderString_);
     httpString_.swap(that.httpString_);
     swap(datePos_, that.datePos_);
+    swap(cacheKeyedByRequest_, that.cacheKeyedByRequest_);
+    cacheTags_.swap(that.cacheTags_);
     swap(jsonParsingErrorPtr_, that.jsonParsingErrorPtr_);
 }
 
@@ -809,6 +806,8 @@ void HttpResponseImpl::clear()
     bodyPtr_.reset();
     jsonPtr_.reset();
     expriedTime_ = -1;
+    cacheKeyedByRequest_ = false;
+    cacheTags_.clear();
     datePos_ = std::string::npos;
     flagForParsingContentType_ = false;
     flagForParsingJson_ = false;
@@ -27,6 +27,7 @@
 #include <string>
 #include <atomic>
 #include <unordered_map>
+#include <vector>
 
 namespace drogon
 {
@@ -223,6 +224,8 @@ class DROGON_EXPORT HttpResponseImpl : public HttpResponse
     }
     std::shared_ptr<trantor::MsgBuffer> renderToBuffer();
     void renderToBuffer(trantor::MsgBuffer &buffer);
+    // Render the status line and the headers without the body.
+    void renderHeaderToBuffer(trantor::MsgBuffer &buffer);
     std::shared_ptr<trantor::MsgBuffer> renderHeaderForHeadMethod();
     void clear() override;
 
@@ -241,6 +244,26 @@ class DROGON_EXPORT HttpResponseImpl : public HttpResponse
         return expriedTime_;
     }
 
+    void setCacheKeyedByRequest(bool on) override
+    {
+        cacheKeyedByRequest_ = on;
+    }
+
+    bool cacheKeyedByRequest() const override
+    {
+        return cacheKeyedByRequest_;
+    }
+
+    void addCacheTag(const std::string &tag) override
+    {
+        cacheTags_.push_back(tag);
+    }
+
+    const std::vector<std::string> &cacheTags() const override
+    {
+        return cacheTags_;
+    }
+
     const char *getBodyData() const override
     {
         if (!flagForSerializingJson_ && jsonPtr_)
@@ -438,6 +461,8 @@ class DROGON_EXPORT HttpResponseImpl : public HttpResponse
     bool closeConnection_{false};
     mutable std::shared_ptr<HttpMessageBody> bodyPtr_;
     ssize_t expriedTime_{-1};
+    bool cacheKeyedByRequest_{false};
+    std::vector<std::string> cacheTags_;
     std::string sendfileName_;
     SendfileRange sendfileRange_{0, 0};
 
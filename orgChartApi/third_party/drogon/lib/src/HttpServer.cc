@@ -13,6 +13,7 @@
  */
 
 #include "HttpServer.h"
+#include "Http2Connection.h"
 #include "HttpRequestImpl.h"
 #include "HttpRequestParser.h"
 #include "HttpAppFrameworkImpl.h"
@@ -38,6 +39,10 @@ using namespace drogon;
 using namespace trantor;
 namespace drogon
 {
+// Pipelined responses with smaller bodies are copied into one buffer, larger
+// bodies are written by writev() along with the pending data.
+static constexpr size_t minVectoredBodyLength = 16 * 1024;
+
 static HttpResponsePtr getCompressedResponse(const HttpRequestImplPtr &req,
                                              const HttpResponsePtr &response,
                                              bool isHeadMethod)
@@ -125,6 +130,20 @@ static bool isWebSocket(const HttpRequestImplPtr &req)
     return false;
 }
 
+static bool isHttp2Upgrade(const HttpRequestImplPtr &req)
+{
+    // Upgrade: h2c is only allowed on plain connections (rfc7540-3.2).
+    if (req->isOnSecureConnection() ||
+        req->getHeaderBy("http2-settings").empty())
+        return false;
+    auto upgradeField = req->getHeaderBy("upgrade");
+    std::transform(upgradeField.begin(),
+                   upgradeField.end(),
+                   upgradeField.begin(),
+                   tolower);
+    return upgradeField == "h2c";
+}
+
 static void defaultHttpAsyncCallback(
     const HttpRequestPtr &,
     std::function<void(const HttpResponsePtr &resp)> &&callback)
@@ -189,6 +208,22 @@ void HttpServer::stop()
 {
     server_.stop();
 }
+void HttpServer::enableSSL(
+    const std::string &certPath,
+    const std::string &keyPath,
+    bool useOldTLS,
+    const std::vector<std::pair<std::string, std::string>> &sslConfCmds)
+{
+    if (HttpAppFrameworkImpl::instance().isHttp2Enabled())
+    {
+        server_.enableSSL(
+            certPath, keyPath, useOldTLS, sslConfCmds, {"h2", "http/1.1"});
+    }
+    else
+    {
+        server_.enableSSL(certPath, keyPath, useOldTLS, sslConfCmds);
+    }
+}
 void HttpServer::onConnection(const TcpConnectionPtr &conn)
 {
     if (conn->connected())
@@ -197,6 +232,14 @@ void HttpServer::onConnection(const TcpConnectionPtr &conn)
         parser->reset();
         conn->setContext(parser);
         connectionCallback_(conn);
+        if (conn->isSSLConnection() &&
+            HttpAppFrameworkImpl::instance().isHttp2Enabled() &&
+            conn->applicationProtocol() == "h2")
+        {
+            auto http2Conn = newHttp2Connection(conn);
+            parser->setHttp2Connection(http2Conn);
+            http2Conn->start();
+        }
     }
     else if (conn->disconnected())
     {
@@ -229,8 +272,30 @@ void HttpServer::onMessage(const TcpConnectionPtr &conn, MsgBuffer *buf)
         // Websocket payload
         requestParser->webSocketConn()->onNewMessage(conn, buf);
     }
+    else if (requestParser->http2Conn())
+    {
+        requestParser->http2Conn()->onMessage(buf);
+    }
     else
     {
+        if (requestParser->atConnectionStart() &&
+            HttpAppFrameworkImpl::instance().isHttp2Enabled())
+        {
+            // HTTP/2 with prior knowledge starts with the connection preface.
+            auto &preface = Http2Connection::clientPreface();
+            auto length = (std::min)(buf->readableBytes(), preface.length());
+            if (memcmp(buf->peek(), preface.data(), length) == 0)
+            {
+                if (length == preface.length())
+                {
+                    auto http2Conn = newHttp2Connection(conn);
+                    requestParser->setHttp2Connection(http2Conn);
+                    http2Conn->start();
+                    http2Conn->onMessage(buf);
+                }
+                return;
+            }
+        }
         auto &requests = requestParser->getRequestBuffer();
         while (buf->readableBytes() > 0)
         {
@@ -254,6 +319,13 @@ void HttpServer::onMessage(const TcpConnectionPtr &conn, MsgBuffer *buf)
                     trantor::Date::date());
                 requestParser->requestImpl()->setSecure(
                     conn->isSSLConnection());
+                if (HttpAppFrameworkImpl::instance().isHttp2Enabled() &&
+                    requests.empty() && requestParser->emptyPipelining() &&
+                    isHttp2Upgrade(requestParser->requestImpl()) &&
+                    upgradeToHttp2(conn, requestParser, buf))
+                {
+                    return;
+                }
                 if (requestParser->firstReq() &&
                     isWebSocket(requestParser->requestImpl()))
                 {
@@ -547,6 +619,110 @@ void HttpServer::onRequests(
     }
 }
 
+Http2ConnectionPtr HttpServer::newHttp2Connection(const TcpConnectionPtr &conn)
+{
+    return std::make_shared<Http2Connection>(
+        conn,
+        [this](const Http2ConnectionPtr &http2Conn,
+               const HttpRequestImplPtr &req,
+               uint32_t streamId) {
+            onHttp2Request(http2Conn, req, streamId);
+        });
+}
+
+bool HttpServer::upgradeToHttp2(
+    const TcpConnectionPtr &conn,
+    const std::shared_ptr<HttpRequestParser> &requestParser,
+    MsgBuffer *buf)
+{
+    auto req = requestParser->requestImpl();
+    auto http2Conn = newHttp2Connection(conn);
+    if (!http2Conn->upgrade(req, req->getHeaderBy("http2-settings")))
+    {
+        // Invalid settings, go on with HTTP/1.1.
+        return false;
+    }
+    conn->send(
+        "HTTP/1.1 101 Switching Protocols\r\nconnection: Upgrade\r\n"
+        "upgrade: h2c\r\n\r\n");
+    requestParser->setHttp2Connection(http2Conn);
+    requestParser->reset();
+    http2Conn->start();
+    if (buf->readableBytes() > 0)
+    {
+        http2Conn->onMessage(buf);
+    }
+    return true;
+}
+
+void HttpServer::onHttp2Request(const Http2ConnectionPtr &http2Conn,
+                                const HttpRequestImplPtr &req,
+                                uint32_t streamId)
+{
+    // Streams are independent, so responses are sent as soon as they are
+    // ready instead of in the order of requests.
+    bool isHeadMethod = (req->method() == Head);
+    if (isHeadMethod)
+    {
+        req->setMethod(Get);
+    }
+    for (auto &advice : syncAdvices_)
+    {
+        auto resp = advice(req);
+        if (resp)
+        {
+            http2Conn->sendResponse(streamId,
+                                    getCompressedResponse(req,
+                                                          resp,
+                                                          isHeadMethod),
+                                    isHeadMethod);
+            return;
+        }
+    }
+    httpAsyncCallback_(
+        req,
+        [this, http2Conn, req, streamId, isHeadMethod](
+            const HttpResponsePtr &response) {
+            if (!response)
+                return;
+            for (auto &advice : preSendingAdvices_)
+            {
+                advice(req, response);
+            }
+            auto newResp = getCompressedResponse(req, response, isHeadMethod);
+            auto loop = http2Conn->getLoop();
+            if (loop->isInLoopThread())
+            {
+                http2Conn->sendResponse(streamId, newResp, isHeadMethod);
+            }
+            else
+            {
+                loop->queueInLoop(
+                    [http2Conn, streamId, newResp, isHeadMethod]() {
+                        http2Conn->sendResponse(streamId,
+                                                newResp,
+                                                isHeadMethod);
+                    });
+            }
+        });
+}
+
+void HttpServer::sendHeaderAndBody(const TcpConnectionPtr &conn,
+                                   HttpResponseImpl *respImplPtr)
+{
+    trantor::MsgBuffer header(256);
+    respImplPtr->renderHeaderToBuffer(header);
+    auto bodyLength = respImplPtr->getBodyLength();
+    if (bodyLength == 0)
+    {
+        conn->send(std::move(header));
+        return;
+    }
+    // The body is not copied unless it can't be written immediately.
+    conn->send({{header.peek(), header.readableBytes()},
+                {respImplPtr->getBodyData(), bodyLength}});
+}
+
 void HttpServer::sendResponse(const TcpConnectionPtr &conn,
                               const HttpResponsePtr &response,
                               bool isHeadMethod)
@@ -555,8 +731,16 @@ void HttpServer::sendResponse(const TcpConnectionPtr &conn,
     auto respImplPtr = static_cast<HttpResponseImpl *>(response.get());
     if (!isHeadMethod)
     {
-        auto httpString = respImplPtr->renderToBuffer();
-        conn->send(httpString);
+        if (respImplPtr->expiredTime() >= 0)
+        {
+            // The cached response is rendered with its body only once.
+            auto httpString = respImplPtr->renderToBuffer();
+            conn->send(httpString);
+        }
+        else
+        {
+            sendHeaderAndBody(conn, respImplPtr);
+        }
         const std::string &sendfileName = respImplPtr->sendfileName();
         if (!sendfileName.empty())
         {
@@ -598,7 +782,27 @@ void HttpServer::sendResponses(
         if (!resp.second)
         {
             // Not HEAD method
-            respImplPtr->renderToBuffer(buffer);
+            if (respImplPtr->expiredTime() >= 0)
+            {
+                respImplPtr->renderToBuffer(buffer);
+            }
+            else
+            {
+                respImplPtr->renderHeaderToBuffer(buffer);
+                auto bodyLength = respImplPtr->getBodyLength();
+                if (bodyLength >= minVectoredBodyLength)
+                {
+                    // Flush the pending responses with this body instead of
+                    // copying it into the buffer.
+                    conn->send({{buffer.peek(), buffer.readableBytes()},
+                                {respImplPtr->getBodyData(), bodyLength}});
+                    buffer.retrieveAll();
+                }
+                else if (bodyLength > 0)
+                {
+                    buffer.append(respImplPtr->getBodyData(), bodyLength);
+                }
+            }
             const std::string &sendfileName = respImplPtr->sendfileName();
             if (!sendfileName.empty())
             {
@@ -611,8 +815,7 @@ void HttpServer::sendResponses(
         }
         else
         {
-            auto httpString = respImplPtr->renderHeaderForHeadMethod();
-            buffer.append(httpString->peek(), httpString->readableBytes());
+            respImplPtr->renderHeaderToBuffer(buffer);
         }
         if (respImplPtr->ifCloseConnection())
         {
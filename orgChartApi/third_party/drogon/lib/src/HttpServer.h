@@ -70,6 +70,10 @@ class HttpServer : trantor::NonCopyable
     {
         server_.kickoffIdleConnections(timeout);
     }
+    void setReusePortCpuSteering(size_t groupSize)
+    {
+        server_.setReusePortCpuSteering(groupSize);
+    }
     trantor::EventLoop *getLoop()
     {
         return server_.getLoop();
@@ -85,10 +89,7 @@ class HttpServer : trantor::NonCopyable
         const std::string &certPath,
         const std::string &keyPath,
         bool useOldTLS,
-        const std::vector<std::pair<std::string, std::string>> &sslConfCmds)
-    {
-        server_.enableSSL(certPath, keyPath, useOldTLS, sslConfCmds);
-    }
+        const std::vector<std::pair<std::string, std::string>> &sslConfCmds);
 
     const trantor::InetAddress &address() const
     {
@@ -101,9 +102,18 @@ class HttpServer : trantor::NonCopyable
     void onRequests(const trantor::TcpConnectionPtr &,
                     const std::vector<HttpRequestImplPtr> &,
                     const std::shared_ptr<HttpRequestParser> &);
+    Http2ConnectionPtr newHttp2Connection(const trantor::TcpConnectionPtr &);
+    bool upgradeToHttp2(const trantor::TcpConnectionPtr &,
+                        const std::shared_ptr<HttpRequestParser> &,
+                        trantor::MsgBuffer *);
+    void onHttp2Request(const Http2ConnectionPtr &http2Conn,
+                        const HttpRequestImplPtr &req,
+                        uint32_t streamId);
     void sendResponse(const trantor::TcpConnectionPtr &,
                       const HttpResponsePtr &,
                       bool isHeadMethod);
+    void sendHeaderAndBody(const trantor::TcpConnectionPtr &conn,
+                           HttpResponseImpl *respImplPtr);
     void sendResponses(
         const trantor::TcpConnectionPtr &conn,
         const std::vector<std::pair<HttpResponsePtr, bool>> &responses,
@@ -59,7 +59,8 @@ void ListenerManager::addListener(
     const std::string &certFile,
     const std::string &keyFile,
     bool useOldTLS,
-    const std::vector<std::pair<std::string, std::string>> &sslConfCmds)
+    const std::vector<std::pair<std::string, std::string>> &sslConfCmds,
+    bool cpuSteering)
 {
 #ifndef OpenSSL_FOUND
     if (useSSL)
@@ -67,8 +68,20 @@ void ListenerManager::addListener(
         LOG_ERROR << "Can't use SSL without OpenSSL found in your system";
     }
 #endif
-    listeners_.emplace_back(
-        ip, port, useSSL, certFile, keyFile, useOldTLS, sslConfCmds);
+#ifndef __linux__
+    if (cpuSteering)
+    {
+        LOG_ERROR << "CPU steering of listeners is only supported on Linux";
+    }
+#endif
+    listeners_.emplace_back(ip,
+                            port,
+                            useSSL,
+                            certFile,
+                            keyFile,
+                            useOldTLS,
+                            sslConfCmds,
+                            cpuSteering);
 }
 
 std::vector<trantor::EventLoop *> ListenerManager::createListeners(
@@ -97,6 +110,10 @@ std::vector<trantor::EventLoop *> ListenerManager::createListeners(
     {
         LOG_TRACE << "thread num=" << threadNum;
         auto loopThreadPtr = std::make_shared<EventLoopThread>("DrogonIoLoop");
+        if (HttpAppFrameworkImpl::instance().isCpuAffinityEnabled())
+        {
+            loopThreadPtr->setCpuAffinity(i);
+        }
         listeningloopThreads_.push_back(loopThreadPtr);
         ioLoops_.push_back(loopThreadPtr->getLoop());
         for (auto const &listener : listeners_)
@@ -161,6 +178,13 @@ std::vector<trantor::EventLoop *> ListenerManager::createListeners(
                 serverPtr->enableSSL(cert, key, listener.useOldTLS_, cmds);
 #endif
             }
+            if (listener.cpuSteering_)
+            {
+                // Every IO thread listens on its own socket, the i-th socket
+                // of the group is the one of the i-th thread because threads
+                // start listening in order.
+                serverPtr->setReusePortCpuSteering(threadNum);
+            }
             serverPtr->setHttpAsyncCallback(httpCallback);
             serverPtr->setNewWebsocketCallback(webSocketCallback);
             serverPtr->setConnectionCallback(connectionCallback);
@@ -170,6 +194,10 @@ std::vector<trantor::EventLoop *> ListenerManager::createListeners(
         }
     }
 #else
+    if (HttpAppFrameworkImpl::instance().isCpuAffinityEnabled())
+    {
+        LOG_ERROR << "CPU affinity of IO threads is only supported on Linux";
+    }
 
     ioLoopThreadPoolPtr_ = std::make_shared<EventLoopThreadPool>(threadNum);
     if (!listeners_.empty())
@@ -234,6 +262,14 @@ void ListenerManager::startListening()
     for (auto &loopThread : listeningloopThreads_)
     {
         loopThread->run();
+#ifdef __linux__
+        // Wait for the sockets of the thread to listen, so the sockets join
+        // their SO_REUSEPORT groups in the order of threads.
+        std::promise<int> pro;
+        auto f = pro.get_future();
+        loopThread->getLoop()->queueInLoop([&pro]() { pro.set_value(1); });
+        (void)f.get();
+#endif
     }
 }
 
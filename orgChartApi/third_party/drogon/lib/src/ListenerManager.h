@@ -37,7 +37,8 @@ class ListenerManager : public trantor::NonCopyable
                      const std::string &keyFile = "",
                      bool useOldTLS = false,
                      const std::vector<std::pair<std::string, std::string>>
-                         &sslConfCmds = {});
+                         &sslConfCmds = {},
+                     bool cpuSteering = false);
     std::vector<trantor::EventLoop *> createListeners(
         const HttpAsyncCallback &httpCallback,
         const WebSocketNewAsyncCallback &webSocketCallback,
@@ -71,14 +72,16 @@ class ListenerManager : public trantor::NonCopyable
             const std::string &certFile,
             const std::string &keyFile,
             bool useOldTLS,
-            const std::vector<std::pair<std::string, std::string>> &sslConfCmds)
+            const std::vector<std::pair<std::string, std::string>> &sslConfCmds,
+            bool cpuSteering)
             : ip_(ip),
               port_(port),
               useSSL_(useSSL),
               certFile_(certFile),
               keyFile_(keyFile),
               useOldTLS_(useOldTLS),
-              sslConfCmds_(sslConfCmds)
+              sslConfCmds_(sslConfCmds),
+              cpuSteering_(cpuSteering)
         {
         }
         std::string ip_;
@@ -88,6 +91,7 @@ class ListenerManager : public trantor::NonCopyable
         std::string keyFile_;
         bool useOldTLS_;
         std::vector<std::pair<std::string, std::string>> sslConfCmds_;
+        bool cpuSteering_;
     };
     std::vector<ListenerInfo> listeners_;
     std::vector<std::shared_ptr<HttpServer>> servers_;
@@ -25,6 +25,8 @@ class HttpResponseImpl;
 using HttpResponseImplPtr = std::shared_ptr<HttpResponseImpl>;
 class WebSocketConnectionImpl;
 using WebSocketConnectionImplPtr = std::shared_ptr<WebSocketConnectionImpl>;
+class Http2Connection;
+using Http2ConnectionPtr = std::shared_ptr<Http2Connection>;
 class HttpRequestParser;
 class StaticFileRouter;
 class HttpControllersRouter;
@@ -983,6 +983,92 @@ void doTest(const HttpClientPtr &client, std::shared_ptr<test::Case> TEST_CTX)
                             CHECK(resp->getStatusCode() == k404NotFound);
                         });
 
+    // This API caches one response per query string
+    req = HttpRequest::newHttpRequest();
+    req->setMethod(drogon::Get);
+    req->setPath("/api/v1/ApiTest/cacheTestKeyed");
+    req->setParameter("value", "foo");
+    client->sendRequest(req,
+                        [req, TEST_CTX](ReqResult result,
+                                        const HttpResponsePtr &resp) {
+                            REQUIRE(result == ReqResult::Ok);
+                            CHECK(resp->getStatusCode() == k200OK);
+                            CHECK(resp->body() == "foo");
+                        });
+
+    req = HttpRequest::newHttpRequest();
+    req->setMethod(drogon::Get);
+    req->setPath("/api/v1/ApiTest/cacheTestKeyed");
+    req->setParameter("value", "bar");
+    client->sendRequest(req,
+                        [req, TEST_CTX](ReqResult result,
+                                        const HttpResponsePtr &resp) {
+                            REQUIRE(result == ReqResult::Ok);
+                            CHECK(resp->getStatusCode() == k200OK);
+                            CHECK(resp->body() == "bar");
+                        });
+
+    // The cached response of this API is dropped by cacheTestInvalidate, so
+    // the API is called again after it. The HTTPS test also pokes these APIs,
+    // thus only the first and the last responses are compared.
+    auto firstTaggedBody = std::make_shared<std::string>();
+    req = HttpRequest::newHttpRequest();
+    req->setMethod(drogon::Get);
+    req->setPath("/api/v1/ApiTest/cacheTestTagged");
+    client->sendRequest(req,
+                        [req, firstTaggedBody, TEST_CTX](
+                            ReqResult result, const HttpResponsePtr &resp) {
+                            REQUIRE(result == ReqResult::Ok);
+                            CHECK(resp->getStatusCode() == k200OK);
+                            *firstTaggedBody = std::string(resp->body());
+                        });
+
+    req = HttpRequest::newHttpRequest();
+    req->setMethod(drogon::Post);
+    req->setPath("/api/v1/ApiTest/cacheTestInvalidate");
+    client->sendRequest(req,
+                        [req, TEST_CTX](ReqResult result,
+                                        const HttpResponsePtr &resp) {
+                            REQUIRE(result == ReqResult::Ok);
+                            CHECK(resp->getStatusCode() == k200OK);
+                        });
+
+    req = HttpRequest::newHttpRequest();
+    req->setMethod(drogon::Get);
+    req->setPath("/api/v1/ApiTest/cacheTestTagged");
+    client->sendRequest(req,
+                        [req, firstTaggedBody, TEST_CTX](
+                            ReqResult result, const HttpResponsePtr &resp) {
+                            REQUIRE(result == ReqResult::Ok);
+                            CHECK(resp->getStatusCode() == k200OK);
+                            CHECK(resp->body() != *firstTaggedBody);
+                        });
+
+    // This API invalidates its own tag before it responds, so its responses
+    // are never cached.
+    auto firstInvalidatedBody = std::make_shared<std::string>();
+    req = HttpRequest::newHttpRequest();
+    req->setMethod(drogon::Get);
+    req->setPath("/api/v1/ApiTest/cacheTestInvalidated");
+    client->sendRequest(req,
+                        [req, firstInvalidatedBody, TEST_CTX](
+                            ReqResult result, const HttpResponsePtr &resp) {
+                            REQUIRE(result == ReqResult::Ok);
+                            CHECK(resp->getStatusCode() == k200OK);
+                            *firstInvalidatedBody = std::string(resp->body());
+                        });
+
+    req = HttpRequest::newHttpRequest();
+    req->setMethod(drogon::Get);
+    req->setPath("/api/v1/ApiTest/cacheTestInvalidated");
+    client->sendRequest(req,
+                        [req, firstInvalidatedBody, TEST_CTX](
+                            ReqResult result, const HttpResponsePtr &resp) {
+                            REQUIRE(result == ReqResult::Ok);
+                            CHECK(resp->getStatusCode() == k200OK);
+                            CHECK(resp->body() != *firstInvalidatedBody);
+                        });
+
 #if defined(__cpp_impl_coroutine)
     sync_wait([client, TEST_CTX]() -> Task<> {
         // Test coroutine requests
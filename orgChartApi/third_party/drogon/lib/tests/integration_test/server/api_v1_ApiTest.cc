@@ -508,3 +508,58 @@ void ApiTest::cacheTestRegex(
     callback(resp);
     callCount++;
 }
+
+void ApiTest::cacheTestKeyed(
+    const HttpRequestPtr &req,
+    std::function<void(const HttpResponsePtr &)> &&callback)
+{
+    auto resp = HttpResponse::newHttpResponse();
+    resp->setBody(req->getParameter("value"));
+    resp->setContentTypeCode(CT_TEXT_PLAIN);
+    // Expire after a millennia, cached once per query string
+    resp->setExpiredTime(31536000000);
+    resp->setCacheKeyedByRequest(true);
+    callback(resp);
+}
+
+static std::mutex taggedCacheApiMtx;
+void ApiTest::cacheTestTagged(
+    const HttpRequestPtr &req,
+    std::function<void(const HttpResponsePtr &)> &&callback)
+{
+    std::unique_lock<std::mutex> lk(taggedCacheApiMtx);
+    static size_t callCount = 0;
+
+    auto resp = HttpResponse::newHttpResponse();
+    resp->setBody(std::to_string(callCount));
+    resp->setContentTypeCode(CT_TEXT_PLAIN);
+    // Expire after a millennia, unless invalidated
+    resp->setExpiredTime(31536000000);
+    resp->addCacheTag("tagged");
+    callback(resp);
+    callCount++;
+}
+
+void ApiTest::cacheTestInvalidate(
+    const HttpRequestPtr &req,
+    std::function<void(const HttpResponsePtr &)> &&callback)
+{
+    app().invalidateCachedResponses("tagged");
+    callback(HttpResponse::newHttpResponse());
+}
+
+static std::atomic<size_t> invalidatedCacheApiCount{0};
+void ApiTest::cacheTestInvalidated(
+    const HttpRequestPtr &req,
+    std::function<void(const HttpResponsePtr &)> &&callback)
+{
+    auto resp = HttpResponse::newHttpResponse();
+    resp->setBody(std::to_string(invalidatedCacheApiCount++));
+    resp->setContentTypeCode(CT_TEXT_PLAIN);
+    resp->setExpiredTime(31536000000);
+    resp->addCacheTag("invalidated");
+    // The tag is invalidated while the request is handled, so this response
+    // is out of date and must not be cached.
+    app().invalidateCachedResponses("invalidated");
+    callback(resp);
+}
@@ -42,6 +42,10 @@ class ApiTest : public drogon::HttpController<ApiTest>
     ADD_METHOD_VIA_REGEX(ApiTest::cacheTestRegex,
                          "/cacheTestRegex/[a-y]+",
                          Get);
+    METHOD_ADD(ApiTest::cacheTestKeyed, "/cacheTestKeyed", Get);
+    METHOD_ADD(ApiTest::cacheTestTagged, "/cacheTestTagged", Get);
+    METHOD_ADD(ApiTest::cacheTestInvalidate, "/cacheTestInvalidate", Post);
+    METHOD_ADD(ApiTest::cacheTestInvalidated, "/cacheTestInvalidated", Get);
     METHOD_LIST_END
 
     void get(const HttpRequestPtr &req,
@@ -85,6 +89,18 @@ class ApiTest : public drogon::HttpController<ApiTest>
     void cacheTestRegex(
         const HttpRequestPtr &req,
         std::function<void(const HttpResponsePtr &)> &&callback);
+    void cacheTestKeyed(
+        const HttpRequestPtr &req,
+        std::function<void(const HttpResponsePtr &)> &&callback);
+    void cacheTestTagged(
+        const HttpRequestPtr &req,
+        std::function<void(const HttpResponsePtr &)> &&callback);
+    void cacheTestInvalidate(
+        const HttpRequestPtr &req,
+        std::function<void(const HttpResponsePtr &)> &&callback);
+    void cacheTestInvalidated(
+        const HttpRequestPtr &req,
+        std::function<void(const HttpResponsePtr &)> &&callback);
 
   public:
     ApiTest()
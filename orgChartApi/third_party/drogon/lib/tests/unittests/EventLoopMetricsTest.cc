@@ -0,0 +1,37 @@
+#include <drogon/plugins/EventLoopMetrics.h>
+#include <drogon/drogon_test.h>
+#include <trantor/net/EventLoopThread.h>
+#include <future>
+#include <string>
+
+using namespace drogon;
+
+DROGON_TEST(EventLoopMetricsTest)
+{
+    trantor::EventLoopThread loopThread;
+    loopThread.run();
+    auto loop = loopThread.getLoop();
+    trantor::EventLoop::enableStats();
+    // The loop checks whether stats are enabled at the start of each
+    // iteration, run timers until one of them is recorded.
+    for (int i = 0; i < 100 && loop->stats().callbackTime.count() == 0; ++i)
+    {
+        std::promise<void> done;
+        loop->runAfter(0.001, [&done]() { done.set_value(); });
+        done.get_future().wait();
+    }
+    trantor::EventLoop::enableStats(false);
+
+    auto text = plugin::EventLoopMetrics::render({{"0", loop}});
+    CHECK(text.find("# TYPE drogon_event_loop_busy_seconds summary\n") !=
+          std::string::npos);
+    CHECK(text.find("drogon_event_loop_busy_seconds{loop=\"0\",quantile="
+                    "\"0.99\"} ") != std::string::npos);
+    CHECK(text.find("drogon_event_loop_queue_length_count{loop=\"0\"} ") !=
+          std::string::npos);
+    CHECK(text.find("# TYPE drogon_event_loop_timer_lateness_seconds_max "
+                    "gauge\n") != std::string::npos);
+    // The callbacks were recorded.
+    CHECK(text.find("drogon_event_loop_callback_seconds_count{loop=\"0\"} "
+                    "0\n") == std::string::npos);
+}
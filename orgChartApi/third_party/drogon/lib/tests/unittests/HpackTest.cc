@@ -0,0 +1,140 @@
+#include <drogon/drogon_test.h>
+#include "../../lib/src/Hpack.h"
+
+using namespace drogon;
+
+constexpr size_t maxListSize = 64 * 1024;
+
+static std::string fromHex(const std::string &hex)
+{
+    std::string result;
+    for (size_t i = 0; i + 1 < hex.length(); i += 2)
+    {
+        result.push_back(
+            static_cast<char>(std::stoi(hex.substr(i, 2), nullptr, 16)));
+    }
+    return result;
+}
+
+DROGON_TEST(HpackInteger)
+{
+    // rfc7541 C.1
+    std::string out;
+    hpack::encodeInteger(10, 5, 0, out);
+    CHECK(out == fromHex("0a"));
+    out.clear();
+    hpack::encodeInteger(1337, 5, 0, out);
+    CHECK(out == fromHex("1f9a0a"));
+
+    uint64_t value = 0;
+    auto p = reinterpret_cast<const uint8_t *>(out.data());
+    CHECK(hpack::decodeInteger(p, p + out.length(), 5, value));
+    CHECK(value == 1337);
+
+    // Truncated integer
+    p = reinterpret_cast<const uint8_t *>(out.data());
+    CHECK(hpack::decodeInteger(p, p + 2, 5, value) == false);
+}
+
+DROGON_TEST(HpackHuffman)
+{
+    std::string out;
+    hpack::huffmanEncode("www.example.com", out);
+    CHECK(out == fromHex("f1e3c2e5f23a6ba0ab90f4ff"));
+    CHECK(hpack::huffmanEncodedLength("www.example.com") == 12);
+
+    std::string decoded;
+    CHECK(hpack::huffmanDecode(reinterpret_cast<const uint8_t *>(out.data()),
+                               out.length(),
+                               decoded));
+    CHECK(decoded == "www.example.com");
+}
+
+DROGON_TEST(HpackDecodeRequests)
+{
+    // rfc7541 C.4, requests with Huffman coding on one connection
+    HpackDecoder decoder;
+    std::vector<HeaderField> fields;
+    CHECK(decoder.decode(fromHex("828684418cf1e3c2e5f23a6ba0ab90f4ff").data(),
+                         17,
+                         fields,
+                         maxListSize) == HpackDecoder::Status::kOk);
+    CHECK(fields.size() == 4);
+    CHECK(fields[0] == HeaderField(":method", "GET"));
+    CHECK(fields[1] == HeaderField(":scheme", "http"));
+    CHECK(fields[2] == HeaderField(":path", "/"));
+    CHECK(fields[3] == HeaderField(":authority", "www.example.com"));
+
+    fields.clear();
+    CHECK(decoder.decode(fromHex("828684be5886a8eb10649cbf").data(),
+                         12,
+                         fields,
+                         maxListSize) == HpackDecoder::Status::kOk);
+    CHECK(fields.size() == 5);
+    CHECK(fields[3] == HeaderField(":authority", "www.example.com"));
+    CHECK(fields[4] == HeaderField("cache-control", "no-cache"));
+
+    fields.clear();
+    auto block =
+        fromHex("828785bf408825a849e95ba97d7f8925a849e95bb8e8b4bf");
+    CHECK(decoder.decode(block.data(), block.length(), fields, maxListSize) ==
+          HpackDecoder::Status::kOk);
+    CHECK(fields.size() == 5);
+    CHECK(fields[1] == HeaderField(":scheme", "https"));
+    CHECK(fields[2] == HeaderField(":path", "/index.html"));
+    CHECK(fields[4] == HeaderField("custom-key", "custom-value"));
+
+    // Index out of the tables
+    fields.clear();
+    CHECK(decoder.decode(fromHex("ff00").data(), 2, fields, maxListSize) ==
+          HpackDecoder::Status::kCompressionError);
+}
+
+DROGON_TEST(HpackHeaderListSize)
+{
+    // One large field added to the dynamic table, then referenced by one
+    // byte many times: a small block expanding to a huge header list.
+    HpackDecoder decoder;
+    std::string value(3000, 'v');
+    // Literal with indexing and a new name "x"
+    auto block = fromHex("400178");
+    std::string length;
+    hpack::encodeInteger(value.length(), 7, 0, length);
+    block += length;
+    block += value;
+    block.append(1000, static_cast<char>(0xbe));  // index 62, the new entry
+    std::vector<HeaderField> fields;
+    CHECK(decoder.decode(block.data(), block.length(), fields, maxListSize) ==
+          HpackDecoder::Status::kHeaderListTooLarge);
+    // 3033 bytes per field, so 21 of them fit in the limit
+    CHECK(fields.size() == 21);
+
+    HpackDecoder other;
+    fields.clear();
+    CHECK(other.decode(block.data(),
+                       3 + length.length() + value.length() + 20,
+                       fields,
+                       maxListSize) == HpackDecoder::Status::kOk);
+    CHECK(fields.size() == 21);
+}
+
+DROGON_TEST(HpackRoundTrip)
+{
+    HpackEncoder encoder;
+    HpackDecoder decoder;
+    std::vector<HeaderField> fields{{":status", "200"},
+                                    {"content-type", "text/html"},
+                                    {"set-cookie", "id=1"},
+                                    {"x-custom", "some value"}};
+    for (int i = 0; i < 2; ++i)
+    {
+        std::string block;
+        encoder.encode(fields, block);
+        std::vector<HeaderField> decoded;
+        CHECK(decoder.decode(block.data(),
+                             block.length(),
+                             decoded,
+                             maxListSize) == HpackDecoder::Status::kOk);
+        CHECK(decoded == fields);
+    }
+}
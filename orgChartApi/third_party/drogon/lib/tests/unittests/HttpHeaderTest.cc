@@ -1,6 +1,7 @@
 #include <drogon/drogon_test.h>
 #include <drogon/HttpRequest.h>
 #include <drogon/HttpResponse.h>
+#include "../../lib/src/HttpRequestImpl.h"
 #include "../../lib/src/HttpResponseImpl.h"
 
 using namespace drogon;
@@ -15,6 +16,33 @@ DROGON_TEST(HttpHeaderRequest)
     req->removeHeader("Abc");
     CHECK(req->getHeader("abc") == "");
 }
+DROGON_TEST(HttpHeaderRequestReset)
+{
+    HttpRequestImpl req(nullptr);
+    auto addHeader = [&req](const std::string &line) {
+        auto colon = line.find(':');
+        req.addHeader(line.data(),
+                      line.data() + colon,
+                      line.data() + line.size());
+    };
+    addHeader("Host: example.com");
+    addHeader("X-Long-Header: a fairly long header value for the test");
+    addHeader("Cookie: id=1");
+    CHECK(req.getHeader("host") == "example.com");
+    CHECK(req.getCookie("id") == "1");
+
+    req.reset();
+    CHECK(req.headers().empty());
+    CHECK(req.cookies().empty());
+
+    addHeader("Accept:  */*  ");
+    addHeader("Cookie: id=2");
+    addHeader("accept: text/html");
+    CHECK(req.headers().size() == 1);
+    CHECK(req.getHeader("Accept") == "*/*");
+    CHECK(req.getHeader("host") == "");
+    CHECK(req.getCookie("id") == "2");
+}
 DROGON_TEST(HttpHeaderResponse)
 {
     auto resp = std::dynamic_pointer_cast<HttpResponseImpl>(
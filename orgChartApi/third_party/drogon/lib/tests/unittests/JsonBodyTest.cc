@@ -0,0 +1,54 @@
+#include <drogon/drogon_test.h>
+#include <drogon/HttpAppFramework.h>
+#include <drogon/HttpRequest.h>
+
+using namespace drogon;
+
+namespace
+{
+HttpRequestPtr newJsonRequest()
+{
+    auto req = HttpRequest::newHttpRequest();
+    req->setContentTypeCode(CT_APPLICATION_JSON);
+    req->setBody(
+        R"({"name":"a name too long for the short string buffer",)"
+        R"("tags":["first tag of the request","second tag of the request"]})");
+    return req;
+}
+}  // namespace
+
+DROGON_TEST(JsonBodyMovedOutOfRequest)
+{
+    // The members of the default tree can be moved out of the request.
+    Json::Value name;
+    Json::Value tags;
+    {
+        auto req = newJsonRequest();
+        auto &json = req->getJsonObject();
+        REQUIRE(json != nullptr);
+        name = std::move((*json)["name"]);
+        (*json)["tags"].swap(tags);
+    }
+    CHECK(name.asString() == "a name too long for the short string buffer");
+    REQUIRE(tags.size() == 2);
+    CHECK(tags[1].asString() == "second tag of the request");
+}
+
+DROGON_TEST(JsonBodyCopiedOutOfBufferedRequest)
+{
+    // The members of a buffered tree must be copied out of it.
+    app().enableBufferedJsonBody(true);
+    Json::Value name;
+    Json::Value tags;
+    {
+        auto req = newJsonRequest();
+        auto &json = req->getJsonObject();
+        REQUIRE(json != nullptr);
+        name = (*json)["name"];
+        tags = (*json)["tags"];
+    }
+    app().enableBufferedJsonBody(false);
+    CHECK(name.asString() == "a name too long for the short string buffer");
+    REQUIRE(tags.size() == 2);
+    CHECK(tags[0].asString() == "first tag of the request");
+}
@@ -0,0 +1,196 @@
+#include <drogon/orm/JsonSerializer.h>
+#include <drogon/drogon_test.h>
+#include <drogon/utils/optional.h>
+#include <drogon/utils/string_view.h>
+#include <json/json.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace drogon::orm;
+
+namespace
+{
+// Like a model generated by drogon_ctl
+class Item
+{
+  public:
+    static constexpr auto jsonFields()
+    {
+        return makeJsonFields(&Item::dirtyFlag_,
+                              makeJsonField("count", &Item::count_, 1),
+                              makeJsonField("id", &Item::id_, 0),
+                              makeJsonField("name", &Item::name_, 2),
+                              makeJsonField("ratio", &Item::ratio_, 3));
+    }
+    std::shared_ptr<int32_t> id_;
+    std::shared_ptr<uint64_t> count_;
+    std::shared_ptr<std::string> name_;
+    std::shared_ptr<double> ratio_;
+    bool dirtyFlag_[4] = {false};
+};
+
+struct Owner
+{
+    struct Tag
+    {
+        int id;
+        std::string label;
+        static constexpr auto jsonFields()
+        {
+            return makeJsonFields(makeJsonField("id", &Tag::id),
+                                  makeJsonField("label", &Tag::label));
+        }
+    };
+    bool active{false};
+    std::vector<Tag> tags;
+    Tag main;
+    static constexpr auto jsonFields()
+    {
+        return makeJsonFields(makeJsonField("active", &Owner::active),
+                              makeJsonField("main", &Owner::main),
+                              makeJsonField("tags", &Owner::tags));
+    }
+};
+
+// Like the view of a model generated by drogon_ctl
+struct ItemView
+{
+    drogon::optional<int32_t> id;
+    drogon::optional<drogon::string_view> name;
+    static constexpr auto jsonFields()
+    {
+        return makeJsonFields(makeJsonField("id", &ItemView::id),
+                              makeJsonField("name", &ItemView::name));
+    }
+};
+
+struct OptionalItem
+{
+    drogon::optional<uint64_t> count;
+    drogon::optional<std::string> name;
+    static constexpr auto jsonFields()
+    {
+        return makeJsonFields(makeJsonField("count", &OptionalItem::count),
+                              makeJsonField("name", &OptionalItem::name));
+    }
+};
+
+std::string writeJson(const Json::Value &value, bool escapeUnicode)
+{
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    builder["emitUTF8"] = !escapeUnicode;
+    return Json::writeString(builder, value);
+}
+}  // namespace
+
+DROGON_TEST(JsonSerializerTest)
+{
+    Item item;
+    item.id_ = std::make_shared<int32_t>(-42);
+    item.name_ = std::make_shared<std::string>(
+        "a \"quoted\"\\ name\n\t\x01 \xc3\xa9 \xf0\x9f\x98\x80");
+    Json::Value json;
+    json["id"] = -42;
+    json["count"] = Json::Value();
+    json["name"] = *item.name_;
+    json["ratio"] = Json::Value();
+    CHECK(toJsonText(item) == writeJson(json, true));
+    CHECK(toJsonText(item, false) == writeJson(json, false));
+
+    SUBSECTION(Read)
+    {
+        Item read;
+        std::string err;
+        CHECK(fromJsonText(toJsonText(item), read, err));
+        CHECK(err.empty());
+        REQUIRE(read.id_ != nullptr);
+        CHECK(*read.id_ == -42);
+        REQUIRE(read.name_ != nullptr);
+        CHECK(*read.name_ == *item.name_);
+        CHECK(read.count_ == nullptr);
+        CHECK(read.dirtyFlag_[0]);
+        CHECK(read.dirtyFlag_[1]);
+        CHECK(read.dirtyFlag_[2]);
+        CHECK(read.dirtyFlag_[3]);
+    }
+
+    SUBSECTION(Members)
+    {
+        Item read;
+        std::string err;
+        CHECK(fromJsonText(" {\"other\": [1, {\"a\": null}, \"x\\\"\"],"
+                           " \"count\": \"18446744073709551615\","
+                           " \"ratio\": 0.5e1, \"n\\u0061me\": \"\\ud83d"
+                           "\\ude00\"} ",
+                           read,
+                           err));
+        REQUIRE(read.count_ != nullptr);
+        CHECK(*read.count_ == 18446744073709551615ULL);
+        REQUIRE(read.ratio_ != nullptr);
+        CHECK(*read.ratio_ == 5.0);
+        REQUIRE(read.name_ != nullptr);
+        CHECK(*read.name_ == "\xf0\x9f\x98\x80");
+        CHECK(read.id_ == nullptr);
+        CHECK(!read.dirtyFlag_[0]);
+        CHECK(read.dirtyFlag_[1]);
+    }
+
+    SUBSECTION(Errors)
+    {
+        Item read;
+        std::string err;
+        CHECK(!fromJsonText("{\"id\": 1.5}", read, err));
+        CHECK(err == "integer expected at offset 8");
+        CHECK(!fromJsonText("{\"id\": 2147483648}", read, err));
+        CHECK(!fromJsonText("{\"name\": 1}", read, err));
+        CHECK(!fromJsonText("{\"id\": 1,}", read, err));
+        CHECK(!fromJsonText("{\"id\": 1} x", read, err));
+        CHECK(!fromJsonText("{\"name\": \"\\ud800\"}", read, err));
+        CHECK(!fromJsonText("[]", read, err));
+        CHECK(err == "object expected at offset 0");
+    }
+
+    SUBSECTION(Optional)
+    {
+        std::string name = "a \"view\"";
+        ItemView view;
+        view.name = drogon::string_view(name);
+        CHECK(toJsonText(view) == "{\"id\":null,\"name\":\"a \\\"view\\\"\"}");
+        view.id = 7;
+        view.name.reset();
+        CHECK(toJsonText(view) == "{\"id\":7,\"name\":null}");
+        OptionalItem read;
+        read.count = 1;
+        std::string err;
+        CHECK(fromJsonText("{\"count\": null, \"name\": \"x\"}", read, err));
+        CHECK(!read.count);
+        REQUIRE(read.name);
+        CHECK(*read.name == "x");
+        CHECK(toJsonText(read) == "{\"count\":null,\"name\":\"x\"}");
+        CHECK(!fromJsonText("{\"count\": -1}", read, err));
+    }
+
+    SUBSECTION(Nested)
+    {
+        Owner owner;
+        owner.active = true;
+        owner.main = {1, "main"};
+        owner.tags = {{2, "two"}, {3, "three"}};
+        auto text = toJsonText(owner);
+        CHECK(text ==
+              "{\"active\":true,\"main\":{\"id\":1,\"label\":\"main\"},"
+              "\"tags\":[{\"id\":2,\"label\":\"two\"},{\"id\":3,\"label\":"
+              "\"three\"}]}");
+        Owner read;
+        std::string err;
+        CHECK(fromJsonText(text, read, err));
+        CHECK(read.active);
+        CHECK(read.main.label == "main");
+        REQUIRE(read.tags.size() == 2);
+        CHECK(read.tags[1].id == 3);
+        CHECK(toJsonText(std::vector<Owner>{read, read}) ==
+              "[" + text + "," + text + "]");
+    }
+}
@@ -0,0 +1,642 @@
+/**
+ *
+ *  @file JsonSerializer.h
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#pragma once
+
+#include <drogon/exports.h>
+#include <drogon/utils/optional.h>
+#include <drogon/utils/string_view.h>
+#include <trantor/utils/Date.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace drogon
+{
+namespace orm
+{
+/**
+ * @brief How the value of a field is represented in json, when its C++ type
+ * is not enough to tell.
+ */
+enum class JsonFormat
+{
+    Default,
+    /// A trantor::Date read from a date without a time of day, "2021-04-01".
+    /// Dates are otherwise read from "2021-04-01 12:00:00[.000000]".
+    Date
+};
+
+/**
+ * @brief The descriptor of a field of a class, mapping a json member to a
+ * data member.
+ *
+ * The type of the data member may be bool, an arithmetic type, std::string,
+ * std::vector<char> (base64 encoded in json), trantor::Date, a class with its
+ * own jsonFields(), a std::vector of one of them, or a drogon::optional or a
+ * std::shared_ptr to one of them, which is null in json when it is empty.
+ * Fields of type drogon::string_view can be written but not read.
+ */
+template <typename Model, typename T>
+struct JsonField
+{
+    const char *name;
+    size_t length;
+    T Model::*member;
+    /// The index of the field in the dirty flags of the model.
+    size_t index;
+    JsonFormat format;
+};
+
+template <typename Model, typename T, size_t N>
+constexpr JsonField<Model, T> makeJsonField(const char (&name)[N],
+                                            T Model::*member,
+                                            size_t index = 0,
+                                            JsonFormat format =
+                                                JsonFormat::Default)
+{
+    return JsonField<Model, T>{name, N - 1, member, index, format};
+}
+
+/**
+ * @brief The descriptors of all the fields of a class, returned by its static
+ * constexpr jsonFields() method.
+ *
+ * Fields are written in the order of the descriptors. Models generated by
+ * drogon_ctl list them in the alphabetical order of their names, the order in
+ * which Json::Value objects are written, so that toJsonText(model) is the
+ * same as writing model.toJson().
+ */
+template <typename DirtyFlags, typename... Fields>
+struct JsonFields
+{
+    /// The dirty flags of the model, set for the fields read from json, or
+    /// nullptr.
+    DirtyFlags dirtyFlags;
+    std::tuple<Fields...> fields;
+};
+
+template <typename Model, size_t N, typename... Fields>
+constexpr JsonFields<bool (Model::*)[N], Fields...> makeJsonFields(
+    bool (Model::*dirtyFlags)[N],
+    Fields... fields)
+{
+    return JsonFields<bool (Model::*)[N], Fields...>{
+        dirtyFlags, std::tuple<Fields...>(fields...)};
+}
+
+template <typename... Fields>
+constexpr JsonFields<std::nullptr_t, Fields...> makeJsonFields(
+    Fields... fields)
+{
+    return JsonFields<std::nullptr_t, Fields...>{
+        nullptr, std::tuple<Fields...>(fields...)};
+}
+
+/**
+ * @brief Write json text straight into a string, without building a
+ * Json::Value first.
+ *
+ * The text is the same as the one written by drogon for a Json::Value (no
+ * indentation, doubles in their shortest form when the json library supports
+ * it).
+ */
+class DROGON_EXPORT JsonTextWriter
+{
+  public:
+    /**
+     * @param escapeUnicode Write the characters out of the ASCII range as
+     * \\u escapes, see HttpAppFramework::setUnicodeEscapingInJson().
+     */
+    explicit JsonTextWriter(std::string &text, bool escapeUnicode = true)
+        : text_(text), escapeUnicode_(escapeUnicode)
+    {
+    }
+
+    void writeNull()
+    {
+        text_.append("null", 4);
+    }
+    void write(bool value)
+    {
+        if (value)
+            text_.append("true", 4);
+        else
+            text_.append("false", 5);
+    }
+    void write(int64_t value);
+    void write(uint64_t value);
+    void write(double value);
+    void write(const char *str, size_t length);
+    void write(const std::string &value)
+    {
+        write(value.data(), value.length());
+    }
+    void write(const std::vector<char> &value);
+    void write(const trantor::Date &value);
+
+    void startObject()
+    {
+        text_ += '{';
+    }
+    /// Write the name of a member, after a comma unless it is the first one.
+    void writeName(const char *name, size_t length, bool first)
+    {
+        if (!first)
+            text_ += ',';
+        write(name, length);
+        text_ += ':';
+    }
+    void endObject()
+    {
+        text_ += '}';
+    }
+    void startArray()
+    {
+        text_ += '[';
+    }
+    void writeSeparator()
+    {
+        text_ += ',';
+    }
+    void endArray()
+    {
+        text_ += ']';
+    }
+
+  private:
+    std::string &text_;
+    bool escapeUnicode_;
+};
+
+/**
+ * @brief Read json text straight into values, without building a Json::Value
+ * first.
+ *
+ * All the read methods skip the leading white spaces and return false with an
+ * error message on a syntax error or a value of an unexpected type. Integers
+ * are also read from strings of digits, as some clients send them.
+ */
+class DROGON_EXPORT JsonTextReader
+{
+  public:
+    explicit JsonTextReader(string_view text)
+        : begin_(text.data()),
+          pos_(text.data()),
+          end_(text.data() + text.length())
+    {
+    }
+
+    bool startObject();
+    /**
+     * @brief Read the name of the next member of an object.
+     *
+     * @return false at the end of the object or on an error.
+     * @note The name is valid until the next call.
+     */
+    bool nextMember(string_view &name);
+    bool startArray();
+    /// Return false at the end of the array or on an error.
+    bool nextElement();
+    /// Read a null if it is the next value.
+    bool readNull();
+    bool read(bool &value);
+    bool read(int64_t &value);
+    bool read(uint64_t &value);
+    bool read(double &value);
+    bool read(std::string &value);
+    bool read(std::vector<char> &value);
+    bool read(trantor::Date &value, JsonFormat format);
+    /// Skip the next value, whatever its type.
+    bool skipValue();
+    /// Check that only white spaces remain.
+    bool finish();
+
+    bool failed() const
+    {
+        return !error_.empty();
+    }
+    const std::string &error() const
+    {
+        return error_;
+    }
+    /// Fail with the message, unless a previous error was recorded.
+    bool fail(const char *message);
+
+  private:
+    bool skipSpaces();
+    bool readStringContent(std::string &value);
+    bool readMagnitude(uint64_t &magnitude, bool &negative);
+    bool skipNumber();
+    bool skipString();
+    bool skipValue(int depth);
+
+    const char *begin_;
+    const char *pos_;
+    const char *end_;
+    std::string error_;
+    std::string name_;
+    bool firstMember_{false};
+    bool firstElement_{false};
+};
+
+namespace internal
+{
+template <typename T>
+struct HasJsonFields
+{
+    template <typename U>
+    static std::true_type test(decltype(U::jsonFields()) *);
+    template <typename U>
+    static std::false_type test(...);
+    static constexpr bool value = decltype(test<T>(nullptr))::value;
+};
+
+template <typename Desc>
+struct JsonFieldCount;
+template <typename DirtyFlags, typename... Fields>
+struct JsonFieldCount<JsonFields<DirtyFlags, Fields...>>
+    : std::integral_constant<size_t, sizeof...(Fields)>
+{
+};
+
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value &&
+                            !std::is_same<T, bool>::value &&
+                            std::is_signed<T>::value,
+                        void>::type
+writeValue(JsonTextWriter &writer, const T &value)
+{
+    writer.write(static_cast<int64_t>(value));
+}
+
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value &&
+                            !std::is_same<T, bool>::value &&
+                            std::is_unsigned<T>::value,
+                        void>::type
+writeValue(JsonTextWriter &writer, const T &value)
+{
+    writer.write(static_cast<uint64_t>(value));
+}
+
+template <typename T>
+typename std::enable_if<std::is_floating_point<T>::value, void>::type
+writeValue(JsonTextWriter &writer, const T &value)
+{
+    writer.write(static_cast<double>(value));
+}
+
+inline void writeValue(JsonTextWriter &writer, const bool &value)
+{
+    writer.write(value);
+}
+
+inline void writeValue(JsonTextWriter &writer, const std::string &value)
+{
+    writer.write(value);
+}
+
+inline void writeValue(JsonTextWriter &writer, const string_view &value)
+{
+    writer.write(value.data(), value.length());
+}
+
+inline void writeValue(JsonTextWriter &writer, const std::vector<char> &value)
+{
+    writer.write(value);
+}
+
+inline void writeValue(JsonTextWriter &writer, const trantor::Date &value)
+{
+    writer.write(value);
+}
+
+template <typename T>
+typename std::enable_if<HasJsonFields<T>::value, void>::type writeValue(
+    JsonTextWriter &writer,
+    const T &value);
+template <typename T>
+void writeValue(JsonTextWriter &writer, const optional<T> &value);
+template <typename T>
+void writeValue(JsonTextWriter &writer, const std::shared_ptr<T> &value);
+template <typename T>
+void writeValue(JsonTextWriter &writer, const std::vector<T> &values);
+
+template <typename T>
+void writeValue(JsonTextWriter &writer, const optional<T> &value)
+{
+    if (value)
+        writeValue(writer, *value);
+    else
+        writer.writeNull();
+}
+
+template <typename T>
+void writeValue(JsonTextWriter &writer, const std::shared_ptr<T> &value)
+{
+    if (value)
+        writeValue(writer, *value);
+    else
+        writer.writeNull();
+}
+
+template <typename T>
+void writeValue(JsonTextWriter &writer, const std::vector<T> &values)
+{
+    writer.startArray();
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        if (i > 0)
+            writer.writeSeparator();
+        writeValue(writer, values[i]);
+    }
+    writer.endArray();
+}
+
+template <size_t I, typename Model, typename Desc>
+typename std::enable_if<(I == JsonFieldCount<Desc>::value), void>::type
+writeMembers(JsonTextWriter &, const Model &, const Desc &)
+{
+}
+
+template <size_t I, typename Model, typename Desc>
+typename std::enable_if<(I < JsonFieldCount<Desc>::value), void>::type
+writeMembers(JsonTextWriter &writer, const Model &model, const Desc &desc)
+{
+    const auto &field = std::get<I>(desc.fields);
+    writer.writeName(field.name, field.length, I == 0);
+    writeValue(writer, model.*field.member);
+    writeMembers<I + 1>(writer, model, desc);
+}
+
+template <typename T>
+typename std::enable_if<HasJsonFields<T>::value, void>::type writeValue(
+    JsonTextWriter &writer,
+    const T &value)
+{
+    constexpr auto desc = T::jsonFields();
+    writer.startObject();
+    writeMembers<0>(writer, value, desc);
+    writer.endObject();
+}
+
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value &&
+                            !std::is_same<T, bool>::value &&
+                            std::is_signed<T>::value,
+                        bool>::type
+readValue(JsonTextReader &reader, T &value, JsonFormat)
+{
+    int64_t v;
+    if (!reader.read(v))
+        return false;
+    if (v < static_cast<int64_t>((std::numeric_limits<T>::min)()) ||
+        v > static_cast<int64_t>((std::numeric_limits<T>::max)()))
+        return reader.fail("integer out of range");
+    value = static_cast<T>(v);
+    return true;
+}
+
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value &&
+                            !std::is_same<T, bool>::value &&
+                            std::is_unsigned<T>::value,
+                        bool>::type
+readValue(JsonTextReader &reader, T &value, JsonFormat)
+{
+    uint64_t v;
+    if (!reader.read(v))
+        return false;
+    if (v > static_cast<uint64_t>((std::numeric_limits<T>::max)()))
+        return reader.fail("integer out of range");
+    value = static_cast<T>(v);
+    return true;
+}
+
+template <typename T>
+typename std::enable_if<std::is_floating_point<T>::value, bool>::type
+readValue(JsonTextReader &reader, T &value, JsonFormat)
+{
+    double v;
+    if (!reader.read(v))
+        return false;
+    value = static_cast<T>(v);
+    return true;
+}
+
+inline bool readValue(JsonTextReader &reader, bool &value, JsonFormat)
+{
+    return reader.read(value);
+}
+
+inline bool readValue(JsonTextReader &reader, std::string &value, JsonFormat)
+{
+    return reader.read(value);
+}
+
+inline bool readValue(JsonTextReader &reader,
+                      std::vector<char> &value,
+                      JsonFormat)
+{
+    return reader.read(value);
+}
+
+inline bool readValue(JsonTextReader &reader,
+                      trantor::Date &value,
+                      JsonFormat format)
+{
+    return reader.read(value, format);
+}
+
+template <typename T>
+typename std::enable_if<HasJsonFields<T>::value, bool>::type readValue(
+    JsonTextReader &reader,
+    T &value,
+    JsonFormat);
+template <typename T>
+bool readValue(JsonTextReader &reader, optional<T> &value, JsonFormat format);
+template <typename T>
+bool readValue(JsonTextReader &reader,
+               std::shared_ptr<T> &value,
+               JsonFormat format);
+template <typename T>
+bool readValue(JsonTextReader &reader,
+               std::vector<T> &values,
+               JsonFormat format);
+
+template <typename T>
+bool readValue(JsonTextReader &reader, optional<T> &value, JsonFormat format)
+{
+    if (reader.readNull())
+    {
+        value.reset();
+        return true;
+    }
+    T v{};
+    if (!readValue(reader, v, format))
+        return false;
+    value = std::move(v);
+    return true;
+}
+
+template <typename T>
+bool readValue(JsonTextReader &reader,
+               std::shared_ptr<T> &value,
+               JsonFormat format)
+{
+    if (reader.readNull())
+    {
+        value.reset();
+        return true;
+    }
+    auto v = std::make_shared<T>();
+    if (!readValue(reader, *v, format))
+        return false;
+    value = std::move(v);
+    return true;
+}
+
+template <typename T>
+bool readValue(JsonTextReader &reader,
+               std::vector<T> &values,
+               JsonFormat format)
+{
+    if (!reader.startArray())
+        return false;
+    values.clear();
+    while (reader.nextElement())
+    {
+        values.emplace_back();
+        if (!readValue(reader, values.back(), format))
+            return false;
+    }
+    return !reader.failed();
+}
+
+template <typename Model, size_t N>
+void markDirty(Model &model, bool (Model::*dirtyFlags)[N], size_t index)
+{
+    if (index < N)
+        (model.*dirtyFlags)[index] = true;
+}
+
+template <typename Model>
+void markDirty(Model &, std::nullptr_t, size_t)
+{
+}
+
+template <size_t I, typename Model, typename Desc>
+typename std::enable_if<(I == JsonFieldCount<Desc>::value), bool>::type
+readMember(JsonTextReader &reader, string_view, Model &, const Desc &)
+{
+    // Unknown members are ignored, like Model(const Json::Value &) does.
+    return reader.skipValue();
+}
+
+template <size_t I, typename Model, typename Desc>
+typename std::enable_if<(I < JsonFieldCount<Desc>::value), bool>::type
+readMember(JsonTextReader &reader,
+           string_view name,
+           Model &model,
+           const Desc &desc)
+{
+    const auto &field = std::get<I>(desc.fields);
+    if (name.length() == field.length &&
+        memcmp(name.data(), field.name, field.length) == 0)
+    {
+        markDirty(model, desc.dirtyFlags, field.index);
+        return readValue(reader, model.*field.member, field.format);
+    }
+    return readMember<I + 1>(reader, name, model, desc);
+}
+
+template <typename T>
+typename std::enable_if<HasJsonFields<T>::value, bool>::type readValue(
+    JsonTextReader &reader,
+    T &value,
+    JsonFormat)
+{
+    constexpr auto desc = T::jsonFields();
+    if (!reader.startObject())
+        return false;
+    string_view name;
+    while (reader.nextMember(name))
+    {
+        if (!readMember<0>(reader, name, value, desc))
+            return false;
+    }
+    return !reader.failed();
+}
+}  // namespace internal
+
+/**
+ * @brief Append the json text of a value to a string.
+ *
+ * The value is an object of a class with a static constexpr jsonFields()
+ * method returning its field descriptors (see makeJsonFields()), like the
+ * models generated by drogon_ctl, or a std::vector of such objects.
+ *
+ * @param escapeUnicode Write the characters out of the ASCII range as \\u
+ * escapes, usually app().isUnicodeEscapingUsedInJson().
+ */
+template <typename T>
+void appendJsonText(std::string &text,
+                    const T &value,
+                    bool escapeUnicode = true)
+{
+    JsonTextWriter writer(text, escapeUnicode);
+    internal::writeValue(writer, value);
+}
+
+/// Return the json text of a value, see appendJsonText().
+template <typename T>
+std::string toJsonText(const T &value, bool escapeUnicode = true)
+{
+    std::string text;
+    appendJsonText(text, value, escapeUnicode);
+    return text;
+}
+
+/**
+ * @brief Read a value from json text.
+ *
+ * Members without a descriptor are ignored. The dirty flags of the fields
+ * found in the text are set, as Model(const Json::Value &) does, and a null
+ * member resets its field.
+ *
+ * @param err The error message, when the text is not valid json or a member
+ * does not have the type of its field.
+ * @return false on an error, in which case the value is partially read.
+ */
+template <typename T>
+bool fromJsonText(string_view text, T &value, std::string &err)
+{
+    JsonTextReader reader(text);
+    if (internal::readValue(reader, value, JsonFormat::Default) &&
+        reader.finish())
+        return true;
+    err = reader.error();
+    return false;
+}
+
+}  // namespace orm
+}  // namespace drogon
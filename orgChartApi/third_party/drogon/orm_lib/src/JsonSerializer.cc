@@ -0,0 +1,746 @@
+/**
+ *
+ *  @file JsonSerializer.cc
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#include <drogon/orm/JsonSerializer.h>
+#include <drogon/utils/Utilities.h>
+#include <json/json.h>
+#include <locale>
+#include <sstream>
+#include <string.h>
+#include <time.h>
+
+using namespace drogon::orm;
+
+namespace
+{
+const char hexDigits[] = "0123456789abcdef";
+
+// The maximum nesting of the values skipped by the reader, the default stack
+// limit of the json library.
+const int maxDepth = 1000;
+
+char *formatUInt(uint64_t value, char *end)
+{
+    do
+    {
+        *--end = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    return end;
+}
+
+void appendHex(std::string &text, unsigned int codepoint)
+{
+    char buf[6] = {'\\',
+                   'u',
+                   hexDigits[(codepoint >> 12) & 0xf],
+                   hexDigits[(codepoint >> 8) & 0xf],
+                   hexDigits[(codepoint >> 4) & 0xf],
+                   hexDigits[codepoint & 0xf]};
+    text.append(buf, sizeof(buf));
+}
+
+// Decode the UTF-8 character at s, leaving s on its last byte. Invalid
+// sequences are read as the replacement character, the same as the json
+// library does.
+unsigned int decodeUtf8(const char *&s, const char *end)
+{
+    const unsigned int replacement = 0xFFFD;
+    auto byte = [s](size_t i) {
+        return static_cast<unsigned int>(static_cast<unsigned char>(s[i]));
+    };
+    unsigned int first = byte(0);
+    if (first < 0x80)
+        return first;
+    if (first < 0xE0)
+    {
+        if (end - s < 2)
+            return replacement;
+        unsigned int c = ((first & 0x1F) << 6) | (byte(1) & 0x3F);
+        s += 1;
+        return c < 0x80 ? replacement : c;
+    }
+    if (first < 0xF0)
+    {
+        if (end - s < 3)
+            return replacement;
+        unsigned int c = ((first & 0x0F) << 12) | ((byte(1) & 0x3F) << 6) |
+                         (byte(2) & 0x3F);
+        s += 2;
+        if (c >= 0xD800 && c <= 0xDFFF)
+            return replacement;
+        return c < 0x800 ? replacement : c;
+    }
+    if (first < 0xF8)
+    {
+        if (end - s < 4)
+            return replacement;
+        unsigned int c = ((first & 0x07) << 18) | ((byte(1) & 0x3F) << 12) |
+                         ((byte(2) & 0x3F) << 6) | (byte(3) & 0x3F);
+        s += 3;
+        return c < 0x10000 ? replacement : c;
+    }
+    return replacement;
+}
+
+void appendUtf8(std::string &text, unsigned int codepoint)
+{
+    if (codepoint < 0x80)
+    {
+        text += static_cast<char>(codepoint);
+    }
+    else if (codepoint < 0x800)
+    {
+        text += static_cast<char>(0xC0 | (codepoint >> 6));
+        text += static_cast<char>(0x80 | (codepoint & 0x3F));
+    }
+    else if (codepoint < 0x10000)
+    {
+        text += static_cast<char>(0xE0 | (codepoint >> 12));
+        text += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+        text += static_cast<char>(0x80 | (codepoint & 0x3F));
+    }
+    else
+    {
+        text += static_cast<char>(0xF0 | (codepoint >> 18));
+        text += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+        text += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+        text += static_cast<char>(0x80 | (codepoint & 0x3F));
+    }
+}
+
+int hexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+}  // namespace
+
+void JsonTextWriter::write(int64_t value)
+{
+    char buf[24];
+    char *end = buf + sizeof(buf);
+    char *begin;
+    if (value < 0)
+    {
+        begin = formatUInt(0 - static_cast<uint64_t>(value), end);
+        *--begin = '-';
+    }
+    else
+    {
+        begin = formatUInt(static_cast<uint64_t>(value), end);
+    }
+    text_.append(begin, end);
+}
+
+void JsonTextWriter::write(uint64_t value)
+{
+    char buf[24];
+    char *end = buf + sizeof(buf);
+    text_.append(formatUInt(value, end), end);
+}
+
+void JsonTextWriter::write(double value)
+{
+#ifdef JSON_HAS_STREAM_WRITER_APPEND
+    text_.append(Json::valueToString(value,
+                                     17,
+                                     Json::PrecisionType::shortestRoundTrip));
+#else
+    text_.append(Json::valueToString(value));
+#endif
+}
+
+void JsonTextWriter::write(const char *str, size_t length)
+{
+    text_ += '"';
+    const char *end = str + length;
+    const char *run = str;
+    for (const char *c = str; c < end; ++c)
+    {
+        auto ch = static_cast<unsigned char>(*c);
+        if (ch >= 0x20 && ch != '"' && ch != '\\' &&
+            (ch < 0x80 || !escapeUnicode_))
+            continue;
+        text_.append(run, c);
+        switch (ch)
+        {
+            case '"':
+                text_.append("\\\"", 2);
+                break;
+            case '\\':
+                text_.append("\\\\", 2);
+                break;
+            case '\b':
+                text_.append("\\b", 2);
+                break;
+            case '\f':
+                text_.append("\\f", 2);
+                break;
+            case '\n':
+                text_.append("\\n", 2);
+                break;
+            case '\r':
+                text_.append("\\r", 2);
+                break;
+            case '\t':
+                text_.append("\\t", 2);
+                break;
+            default:
+                if (ch < 0x80)
+                {
+                    appendHex(text_, ch);
+                }
+                else
+                {
+                    auto codepoint = decodeUtf8(c, end);
+                    if (codepoint < 0x10000)
+                    {
+                        appendHex(text_, codepoint);
+                    }
+                    else
+                    {
+                        // Encode the 20 bits as a surrogate pair.
+                        codepoint -= 0x10000;
+                        appendHex(text_, 0xD800 + ((codepoint >> 10) & 0x3FF));
+                        appendHex(text_, 0xDC00 + (codepoint & 0x3FF));
+                    }
+                }
+                break;
+        }
+        run = c + 1;
+    }
+    text_.append(run, end);
+    text_ += '"';
+}
+
+void JsonTextWriter::write(const std::vector<char> &value)
+{
+    text_ += '"';
+    text_.append(drogon::utils::base64Encode(
+        reinterpret_cast<const unsigned char *>(value.data()),
+        static_cast<unsigned int>(value.size())));
+    text_ += '"';
+}
+
+void JsonTextWriter::write(const trantor::Date &value)
+{
+    write(value.toDbStringLocal());
+}
+
+bool JsonTextReader::fail(const char *message)
+{
+    if (error_.empty())
+    {
+        error_ = message;
+        error_.append(" at offset ").append(std::to_string(pos_ - begin_));
+    }
+    return false;
+}
+
+bool JsonTextReader::skipSpaces()
+{
+    while (pos_ < end_ && (*pos_ == ' ' || *pos_ == '\n' || *pos_ == '\r' ||
+                           *pos_ == '\t'))
+        ++pos_;
+    return pos_ < end_;
+}
+
+bool JsonTextReader::startObject()
+{
+    if (failed())
+        return false;
+    if (!skipSpaces() || *pos_ != '{')
+        return fail("object expected");
+    ++pos_;
+    firstMember_ = true;
+    return true;
+}
+
+bool JsonTextReader::nextMember(string_view &name)
+{
+    if (failed())
+        return false;
+    if (!skipSpaces())
+        return fail("unexpected end of text");
+    if (*pos_ == '}')
+    {
+        ++pos_;
+        firstMember_ = false;
+        return false;
+    }
+    if (firstMember_)
+    {
+        firstMember_ = false;
+    }
+    else if (*pos_ == ',')
+    {
+        ++pos_;
+        skipSpaces();
+    }
+    else
+    {
+        return fail("',' or '}' expected");
+    }
+    if (pos_ == end_ || *pos_ != '"')
+        return fail("member name expected");
+    ++pos_;
+    // Names are usually plain, read them in place.
+    const char *start = pos_;
+    while (pos_ < end_ && *pos_ != '"' && *pos_ != '\\')
+        ++pos_;
+    if (pos_ < end_ && *pos_ == '"')
+    {
+        name = string_view(start, static_cast<size_t>(pos_ - start));
+        ++pos_;
+    }
+    else
+    {
+        pos_ = start;
+        name_.clear();
+        if (!readStringContent(name_))
+            return false;
+        name = string_view(name_.data(), name_.length());
+    }
+    if (!skipSpaces() || *pos_ != ':')
+        return fail("':' expected");
+    ++pos_;
+    return true;
+}
+
+bool JsonTextReader::startArray()
+{
+    if (failed())
+        return false;
+    if (!skipSpaces() || *pos_ != '[')
+        return fail("array expected");
+    ++pos_;
+    firstElement_ = true;
+    return true;
+}
+
+bool JsonTextReader::nextElement()
+{
+    if (failed())
+        return false;
+    if (!skipSpaces())
+        return fail("unexpected end of text");
+    if (*pos_ == ']')
+    {
+        ++pos_;
+        firstElement_ = false;
+        return false;
+    }
+    if (firstElement_)
+    {
+        firstElement_ = false;
+        return true;
+    }
+    if (*pos_ != ',')
+        return fail("',' or ']' expected");
+    ++pos_;
+    return true;
+}
+
+bool JsonTextReader::readNull()
+{
+    if (failed() || !skipSpaces())
+        return false;
+    if (end_ - pos_ >= 4 && memcmp(pos_, "null", 4) == 0)
+    {
+        pos_ += 4;
+        return true;
+    }
+    return false;
+}
+
+bool JsonTextReader::read(bool &value)
+{
+    if (failed())
+        return false;
+    skipSpaces();
+    if (end_ - pos_ >= 4 && memcmp(pos_, "true", 4) == 0)
+    {
+        pos_ += 4;
+        value = true;
+        return true;
+    }
+    if (end_ - pos_ >= 5 && memcmp(pos_, "false", 5) == 0)
+    {
+        pos_ += 5;
+        value = false;
+        return true;
+    }
+    return fail("boolean expected");
+}
+
+bool JsonTextReader::readMagnitude(uint64_t &magnitude, bool &negative)
+{
+    if (failed())
+        return false;
+    skipSpaces();
+    bool quoted = pos_ < end_ && *pos_ == '"';
+    if (quoted)
+        ++pos_;
+    negative = pos_ < end_ && *pos_ == '-';
+    if (negative)
+        ++pos_;
+    if (pos_ == end_ || !isDigit(*pos_))
+        return fail("integer expected");
+    // Leading zeros are not valid json, but are harmless in strings.
+    if (!quoted && *pos_ == '0' && end_ - pos_ > 1 && isDigit(pos_[1]))
+        return fail("integer expected");
+    magnitude = 0;
+    while (pos_ < end_ && isDigit(*pos_))
+    {
+        auto digit = static_cast<uint64_t>(*pos_ - '0');
+        if (magnitude > ((std::numeric_limits<uint64_t>::max)() - digit) / 10)
+            return fail("integer out of range");
+        magnitude = magnitude * 10 + digit;
+        ++pos_;
+    }
+    if (quoted)
+    {
+        if (pos_ == end_ || *pos_ != '"')
+            return fail("integer expected");
+        ++pos_;
+    }
+    else if (pos_ < end_ && (*pos_ == '.' || *pos_ == 'e' || *pos_ == 'E'))
+    {
+        return fail("integer expected");
+    }
+    return true;
+}
+
+bool JsonTextReader::read(int64_t &value)
+{
+    uint64_t magnitude;
+    bool negative;
+    if (!readMagnitude(magnitude, negative))
+        return false;
+    const auto limit =
+        static_cast<uint64_t>((std::numeric_limits<int64_t>::max)());
+    if (negative)
+    {
+        if (magnitude > limit + 1)
+            return fail("integer out of range");
+        value = magnitude == limit + 1
+                    ? (std::numeric_limits<int64_t>::min)()
+                    : -static_cast<int64_t>(magnitude);
+    }
+    else
+    {
+        if (magnitude > limit)
+            return fail("integer out of range");
+        value = static_cast<int64_t>(magnitude);
+    }
+    return true;
+}
+
+bool JsonTextReader::read(uint64_t &value)
+{
+    uint64_t magnitude;
+    bool negative;
+    if (!readMagnitude(magnitude, negative))
+        return false;
+    if (negative && magnitude != 0)
+        return fail("integer out of range");
+    value = magnitude;
+    return true;
+}
+
+bool JsonTextReader::skipNumber()
+{
+    if (pos_ < end_ && *pos_ == '-')
+        ++pos_;
+    if (pos_ == end_ || !isDigit(*pos_))
+        return fail("number expected");
+    if (*pos_ == '0')
+    {
+        ++pos_;
+    }
+    else
+    {
+        while (pos_ < end_ && isDigit(*pos_))
+            ++pos_;
+    }
+    if (pos_ < end_ && *pos_ == '.')
+    {
+        ++pos_;
+        if (pos_ == end_ || !isDigit(*pos_))
+            return fail("number expected");
+        while (pos_ < end_ && isDigit(*pos_))
+            ++pos_;
+    }
+    if (pos_ < end_ && (*pos_ == 'e' || *pos_ == 'E'))
+    {
+        ++pos_;
+        if (pos_ < end_ && (*pos_ == '+' || *pos_ == '-'))
+            ++pos_;
+        if (pos_ == end_ || !isDigit(*pos_))
+            return fail("number expected");
+        while (pos_ < end_ && isDigit(*pos_))
+            ++pos_;
+    }
+    return true;
+}
+
+bool JsonTextReader::read(double &value)
+{
+    if (failed())
+        return false;
+    skipSpaces();
+    const char *start = pos_;
+    if (!skipNumber())
+        return false;
+    // Read it in the classic locale, whatever the locale of the
+    // application.
+    std::istringstream stream(
+        std::string(start, static_cast<size_t>(pos_ - start)));
+    stream.imbue(std::locale::classic());
+    if (!(stream >> value))
+    {
+        pos_ = start;
+        return fail("number out of range");
+    }
+    return true;
+}
+
+bool JsonTextReader::readStringContent(std::string &value)
+{
+    for (;;)
+    {
+        const char *run = pos_;
+        while (pos_ < end_ && *pos_ != '"' && *pos_ != '\\')
+            ++pos_;
+        value.append(run, pos_);
+        if (pos_ == end_)
+            return fail("missing '\"'");
+        if (*pos_++ == '"')
+            return true;
+        if (pos_ == end_)
+            return fail("missing '\"'");
+        switch (*pos_++)
+        {
+            case '"':
+                value += '"';
+                break;
+            case '\\':
+                value += '\\';
+                break;
+            case '/':
+                value += '/';
+                break;
+            case 'b':
+                value += '\b';
+                break;
+            case 'f':
+                value += '\f';
+                break;
+            case 'n':
+                value += '\n';
+                break;
+            case 'r':
+                value += '\r';
+                break;
+            case 't':
+                value += '\t';
+                break;
+            case 'u':
+            {
+                auto readHex4 = [this](unsigned int &unit) {
+                    if (end_ - pos_ < 4)
+                        return false;
+                    unit = 0;
+                    for (int i = 0; i < 4; ++i)
+                    {
+                        int digit = hexValue(*pos_++);
+                        if (digit < 0)
+                            return false;
+                        unit = (unit << 4) | static_cast<unsigned int>(digit);
+                    }
+                    return true;
+                };
+                unsigned int codepoint;
+                if (!readHex4(codepoint))
+                    return fail("invalid unicode escape");
+                if (codepoint >= 0xDC00 && codepoint <= 0xDFFF)
+                    return fail("invalid unicode surrogate");
+                if (codepoint >= 0xD800 && codepoint <= 0xDBFF)
+                {
+                    unsigned int low;
+                    if (end_ - pos_ < 2 || pos_[0] != '\\' || pos_[1] != 'u')
+                        return fail("invalid unicode surrogate");
+                    pos_ += 2;
+                    if (!readHex4(low) || low < 0xDC00 || low > 0xDFFF)
+                        return fail("invalid unicode surrogate");
+                    codepoint =
+                        0x10000 + ((codepoint & 0x3FF) << 10) + (low & 0x3FF);
+                }
+                appendUtf8(value, codepoint);
+                break;
+            }
+            default:
+                return fail("invalid escape sequence");
+        }
+    }
+}
+
+bool JsonTextReader::read(std::string &value)
+{
+    if (failed())
+        return false;
+    if (!skipSpaces() || *pos_ != '"')
+        return fail("string expected");
+    ++pos_;
+    value.clear();
+    return readStringContent(value);
+}
+
+bool JsonTextReader::read(std::vector<char> &value)
+{
+    std::string str;
+    if (!read(str))
+        return false;
+    value = drogon::utils::base64DecodeToVector(str);
+    return true;
+}
+
+bool JsonTextReader::read(trantor::Date &value, JsonFormat format)
+{
+    std::string str;
+    if (!read(str))
+        return false;
+    // The same conversions as the json constructors of the models.
+    struct tm stm;
+    memset(&stm, 0, sizeof(stm));
+    if (format == JsonFormat::Date)
+    {
+        if (!strptime(str.c_str(), "%Y-%m-%d", &stm))
+            return fail("date expected");
+        value = trantor::Date(static_cast<int64_t>(mktime(&stm)) * 1000000);
+        return true;
+    }
+    auto p = strptime(str.c_str(), "%Y-%m-%d %H:%M:%S", &stm);
+    if (!p)
+        return fail("date expected");
+    int64_t decimals = 0;
+    if (*p == '.')
+    {
+        int digits = 0;
+        while (isDigit(*++p) && digits < 6)
+        {
+            decimals = decimals * 10 + (*p - '0');
+            ++digits;
+        }
+        for (; digits < 6; ++digits)
+            decimals *= 10;
+    }
+    value = trantor::Date(static_cast<int64_t>(mktime(&stm)) * 1000000 +
+                          decimals);
+    return true;
+}
+
+bool JsonTextReader::skipString()
+{
+    ++pos_;
+    while (pos_ < end_)
+    {
+        char c = *pos_++;
+        if (c == '"')
+            return true;
+        if (c == '\\')
+        {
+            if (pos_ == end_)
+                break;
+            if (*pos_++ == 'u')
+            {
+                for (int i = 0; i < 4; ++i)
+                {
+                    if (pos_ == end_ || hexValue(*pos_++) < 0)
+                        return fail("invalid unicode escape");
+                }
+            }
+        }
+    }
+    return fail("missing '\"'");
+}
+
+bool JsonTextReader::skipValue()
+{
+    return skipValue(0);
+}
+
+bool JsonTextReader::skipValue(int depth)
+{
+    if (failed())
+        return false;
+    if (!skipSpaces())
+        return fail("value expected");
+    if (depth >= maxDepth)
+        return fail("too many nested values");
+    switch (*pos_)
+    {
+        case '{':
+        {
+            startObject();
+            string_view name;
+            while (nextMember(name))
+            {
+                if (!skipValue(depth + 1))
+                    return false;
+            }
+            return !failed();
+        }
+        case '[':
+            startArray();
+            while (nextElement())
+            {
+                if (!skipValue(depth + 1))
+                    return false;
+            }
+            return !failed();
+        case '"':
+            return skipString();
+        case 't':
+        case 'f':
+        {
+            bool value;
+            return read(value);
+        }
+        case 'n':
+            return readNull() || fail("value expected");
+        default:
+            return skipNumber();
+    }
+}
+
+bool JsonTextReader::finish()
+{
+    if (failed())
+        return false;
+    if (skipSpaces())
+        return fail("unexpected text after the value");
+    return true;
+}
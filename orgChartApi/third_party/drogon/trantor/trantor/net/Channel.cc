@@ -25,6 +25,7 @@
 #else
 #include <poll.h>
 #endif
+#include <errno.h>
 #include <iostream>
 namespace trantor
 {
@@ -50,6 +51,25 @@ void Channel::update()
     loop_->updateChannel(this);
 }
 
+ssize_t Channel::takeReceivedBytes()
+{
+    if (receivedBytes_ > 0)
+    {
+        auto n = static_cast<ssize_t>(receivedBytes_);
+        receivedBytes_ = 0;
+        return n;
+    }
+    if (recvErrno_ != 0)
+    {
+        errno = recvErrno_;
+        return -1;
+    }
+    if (recvEof_)
+        return 0;
+    errno = EAGAIN;
+    return -1;
+}
+
 void Channel::handleEvent()
 {
     // LOG_TRACE<<"revents_="<<revents_;
@@ -15,6 +15,7 @@
 #pragma once
 
 #include <trantor/utils/Logger.h>
+#include <trantor/utils/MsgBuffer.h>
 #include <trantor/utils/NonCopyable.h>
 #include <trantor/exports.h>
 #include <functional>
@@ -272,6 +273,54 @@ class TRANTOR_EXPORT Channel : NonCopyable
         tied_ = true;
     }
 
+    /**
+     * @brief Let the poller receive data into the buffer on behalf of the
+     * channel, if the poller is able to (the io_uring poller). In that case
+     * the read callback is called after data is received into the buffer, and
+     * takeReceivedBytes() should be used instead of reading the socket.
+     *
+     * @param buffer The buffer must be valid until the channel is removed,
+     * nullptr disables receiving by the poller. It takes effect when the
+     * events of the channel are updated.
+     */
+    void setRecvBuffer(MsgBuffer *buffer)
+    {
+        recvBuffer_ = buffer;
+    }
+
+    /**
+     * @brief Check whether data of the socket is received by the poller.
+     */
+    bool isReceivingByPoller() const
+    {
+        return receivingByPoller_;
+    }
+
+    /**
+     * @brief Return the result of receiving by the poller since the last
+     * call, like the read() system call does.
+     *
+     * @return ssize_t The number of bytes appended to the buffer, 0 if the
+     * peer closed the connection, -1 with errno set on errors (EAGAIN if
+     * nothing is received).
+     */
+    ssize_t takeReceivedBytes();
+
+    /**
+     * @brief Return the data received by the poller after the receive buffer
+     * is set to nullptr and before receiving by the poller stops. The data
+     * comes before anything read from the socket and should be consumed
+     * first.
+     *
+     * @return MsgBuffer* nullptr if there is no such data.
+     */
+    MsgBuffer *pendingRecvBuffer()
+    {
+        if (pendingRecvBuffer_ && pendingRecvBuffer_->readableBytes() > 0)
+            return pendingRecvBuffer_.get();
+        return nullptr;
+    }
+
     static const int kNoneEvent;
     static const int kReadEvent;
     static const int kWriteEvent;
@@ -281,6 +330,7 @@ class TRANTOR_EXPORT Channel : NonCopyable
     friend class EpollPoller;
     friend class KQueue;
     friend class PollPoller;
+    friend class IoUringPoller;
     void update();
     void handleEvent();
     void handleEventSafely();
@@ -311,5 +361,12 @@ class TRANTOR_EXPORT Channel : NonCopyable
     EventCallback eventCallback_;
     std::weak_ptr<void> tie_;
     bool tied_;
+    // Set by the poller which receives data on behalf of the channel.
+    MsgBuffer *recvBuffer_{nullptr};
+    std::unique_ptr<MsgBuffer> pendingRecvBuffer_;
+    bool receivingByPoller_{false};
+    size_t receivedBytes_{0};
+    bool recvEof_{false};
+    int recvErrno_{0};
 };
 }  // namespace trantor
@@ -62,6 +62,13 @@ const int kPollTimeMs = 10000;
 #endif
 thread_local EventLoop *t_loopInThisThread = nullptr;
 
+inline int64_t nowInNanoseconds()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
 EventLoop::EventLoop()
     : looping_(false),
       threadId_(std::this_thread::get_id()),
@@ -70,6 +77,7 @@ EventLoop::EventLoop()
       currentActiveChannel_(nullptr),
       eventHandling_(false),
       timerQueue_(new TimerQueue(this)),
+      stats_(new EventLoopStats),
 #ifdef __linux__
       wakeupFd_(createEventfd()),
       wakeupChannelPtr_(new Channel(this, wakeupFd_)),
@@ -149,6 +157,23 @@ EventLoop *EventLoop::getEventLoopOfCurrentThread()
 {
     return t_loopInThisThread;
 }
+void EventLoop::enableIoUring(bool enable)
+{
+    Poller::enableIoUring(enable);
+}
+std::atomic<bool> &EventLoop::statsFlag()
+{
+    static std::atomic<bool> flag{false};
+    return flag;
+}
+void EventLoop::enableStats(bool enable)
+{
+    statsFlag().store(enable, std::memory_order_relaxed);
+}
+void EventLoop::resetStats()
+{
+    runInLoop([this]() { stats_->reset(); });
+}
 void EventLoop::updateChannel(Channel *channel)
 {
     assert(channel->ownerLoop() == this);
@@ -186,14 +211,29 @@ void EventLoop::loop()
     looping_.store(true, std::memory_order_release);
     quit_.store(false, std::memory_order_release);
 
+    int64_t lastTime = 0;
     while (!quit_.load(std::memory_order_acquire))
     {
+        recordingStats_ = statsEnabled();
+        if (recordingStats_ && lastTime == 0)
+            lastTime = nowInNanoseconds();
         activeChannels_.clear();
 #ifdef __linux__
         poller_->poll(kPollTimeMs, &activeChannels_);
 #else
         poller_->poll(static_cast<int>(timerQueue_->getTimeout()),
                       &activeChannels_);
+#endif
+        int64_t pollEndTime = 0;
+        if (recordingStats_)
+        {
+            pollEndTime = nowInNanoseconds();
+            stats_->pollTime.record(
+                static_cast<uint64_t>(pollEndTime - lastTime));
+            stats_->activeChannels.record(activeChannels_.size());
+            lastTime = pollEndTime;
+        }
+#ifndef __linux__
         timerQueue_->processTimers();
 #endif
         // TODO sort channel by priority
@@ -204,11 +244,28 @@ void EventLoop::loop()
         {
             currentActiveChannel_ = *it;
             currentActiveChannel_->handleEvent();
+            if (recordingStats_)
+            {
+                auto now = nowInNanoseconds();
+                stats_->callbackTime.record(
+                    static_cast<uint64_t>(now - lastTime));
+                lastTime = now;
+            }
         }
         currentActiveChannel_ = NULL;
         eventHandling_ = false;
         // std::cout << "looping" << endl;
-        doRunInLoopFuncs();
+        if (recordingStats_)
+        {
+            doRunInLoopFuncsWithStats(lastTime);
+            stats_->busyTime.record(
+                static_cast<uint64_t>(lastTime - pollEndTime));
+        }
+        else
+        {
+            lastTime = 0;
+            doRunInLoopFuncs();
+        }
     }
     looping_.store(false, std::memory_order_release);
 }
@@ -221,6 +278,12 @@ void EventLoop::abortNotInLoopThread()
 void EventLoop::queueInLoop(const Func &cb)
 {
     funcs_.enqueue(cb);
+    // Set after the function is queued, see doRunInLoopFuncsWithStats().
+    if (statsEnabled() && queuedTime_.load(std::memory_order_relaxed) == 0)
+    {
+        int64_t expected = 0;
+        queuedTime_.compare_exchange_strong(expected, nowInNanoseconds());
+    }
     if (!isInLoopThread() || !looping_.load(std::memory_order_acquire))
     {
         wakeup();
@@ -229,6 +292,12 @@ void EventLoop::queueInLoop(const Func &cb)
 void EventLoop::queueInLoop(Func &&cb)
 {
     funcs_.enqueue(std::move(cb));
+    // Set after the function is queued, see doRunInLoopFuncsWithStats().
+    if (statsEnabled() && queuedTime_.load(std::memory_order_relaxed) == 0)
+    {
+        int64_t expected = 0;
+        queuedTime_.compare_exchange_strong(expected, nowInNanoseconds());
+    }
     if (!isInLoopThread() || !looping_.load(std::memory_order_acquire))
     {
         wakeup();
@@ -299,6 +368,42 @@ void EventLoop::doRunInLoopFuncs()
     }
     callingFuncs_ = false;
 }
+void EventLoop::doRunInLoopFuncsWithStats(int64_t &lastTime)
+{
+    auto queuedTime = queuedTime_.exchange(0);
+    if (queuedTime != 0 && !funcs_.empty())
+        stats_->queueLag.record(static_cast<uint64_t>(
+            (std::max)(lastTime - queuedTime, int64_t{0})));
+    uint64_t length = 0;
+    callingFuncs_ = true;
+    while (!funcs_.empty())
+    {
+        Func func;
+        while (funcs_.dequeue(func))
+        {
+            func();
+            auto now = nowInNanoseconds();
+            stats_->callbackTime.record(static_cast<uint64_t>(now - lastTime));
+            lastTime = now;
+            ++length;
+        }
+    }
+    callingFuncs_ = false;
+    // The functions queued while running the queue have been run, so the time
+    // is cleared, unless a function is queued meanwhile, which may have found
+    // the time set and not set it.
+    if (queuedTime_.load(std::memory_order_relaxed) != 0)
+    {
+        queuedTime_.store(0);
+        if (!funcs_.empty())
+        {
+            int64_t expected = 0;
+            queuedTime_.compare_exchange_strong(expected, nowInNanoseconds());
+        }
+    }
+    if (length > 0)
+        stats_->queueLength.record(length);
+}
 void EventLoop::wakeup()
 {
     // if (!looping_)
@@ -16,6 +16,7 @@
 // Author: Tao An
 
 #pragma once
+#include <trantor/net/EventLoopStats.h>
 #include <trantor/utils/NonCopyable.h>
 #include <trantor/utils/Date.h>
 #include <trantor/utils/LockFreeQueue.h>
@@ -115,6 +116,50 @@ class TRANTOR_EXPORT EventLoop : NonCopyable
      */
     static EventLoop *getEventLoopOfCurrentThread();
 
+    /**
+     * @brief Use the io_uring poller in event loops created after calling
+     * this method, if the kernel supports it (Linux 5.11+). Otherwise epoll
+     * is used. The io_uring poller also receives data of TCP connections
+     * without system calls per read (Linux 6.0+).
+     *
+     * @param enable
+     */
+    static void enableIoUring(bool enable = true);
+
+    /**
+     * @brief Enable or disable recording the statistics of all event loops.
+     * It can be called at any time, the loops start or stop recording in
+     * their next iteration. The statistics are disabled by default.
+     *
+     * @param enable
+     */
+    static void enableStats(bool enable = true);
+
+    /**
+     * @brief Return true if the statistics of event loops are recorded.
+     */
+    static bool statsEnabled()
+    {
+        return statsFlag().load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the statistics of the event loop. They can be read from any
+     * thread.
+     *
+     * @return const EventLoopStats&
+     */
+    const EventLoopStats &stats() const
+    {
+        return *stats_;
+    }
+
+    /**
+     * @brief Reset the statistics of the event loop, in the thread of the
+     * loop.
+     */
+    void resetStats();
+
     /**
      * @brief Run the function f in the thread of the event loop.
      *
@@ -296,6 +341,8 @@ class TRANTOR_EXPORT EventLoop : NonCopyable
     void runOnQuit(const Func &cb);
 
   private:
+    friend class TimerQueue;
+    static std::atomic<bool> &statsFlag();
     void abortNotInLoopThread();
     void wakeup();
     void wakeupRead();
@@ -312,6 +359,11 @@ class TRANTOR_EXPORT EventLoop : NonCopyable
     std::unique_ptr<TimerQueue> timerQueue_;
     MpscQueue<Func> funcsOnQuit_;
     bool callingFuncs_{false};
+    std::unique_ptr<EventLoopStats> stats_;
+    bool recordingStats_{false};
+    // The time when the first function was queued since the queued functions
+    // were run last time, 0 if not recorded.
+    std::atomic<int64_t> queuedTime_{0};
 #ifdef __linux__
     int wakeupFd_;
     std::unique_ptr<Channel> wakeupChannelPtr_;
@@ -322,6 +374,7 @@ class TRANTOR_EXPORT EventLoop : NonCopyable
 #endif
 
     void doRunInLoopFuncs();
+    void doRunInLoopFuncsWithStats(int64_t &lastTime);
 #ifdef _WIN32
     size_t index_{size_t(-1)};
 #else
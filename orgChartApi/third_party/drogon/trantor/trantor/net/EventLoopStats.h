@@ -0,0 +1,62 @@
+/**
+ *
+ *  @file EventLoopStats.h
+ *  @author An Tao
+ *
+ *  Public header file in trantor lib.
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the License file.
+ *
+ *
+ */
+
+#pragma once
+#include <trantor/utils/LatencyHistogram.h>
+#include <trantor/utils/NonCopyable.h>
+#include <trantor/exports.h>
+
+namespace trantor
+{
+/**
+ * @brief The statistics of an event loop. They are recorded by the loop when
+ * EventLoop::enableStats() is called, and they can be read from any thread.
+ *
+ * The durations are in nanoseconds. The busy ratio of a loop is
+ * busyTime.sum() / (busyTime.sum() + pollTime.sum()).
+ */
+struct TRANTOR_EXPORT EventLoopStats : public NonCopyable
+{
+    /// The time of each iteration of the loop spent out of the poller, i.e.
+    /// handling events and running queued functions.
+    LatencyHistogram busyTime;
+    /// The time of each iteration of the loop spent waiting in the poller.
+    LatencyHistogram pollTime;
+    /// The number of active channels returned by each poll.
+    LatencyHistogram activeChannels;
+    /// The time taken by each event callback and each queued function.
+    LatencyHistogram callbackTime;
+    /// The time the first function queued by queueInLoop() waited before the
+    /// loop started running the queued functions.
+    LatencyHistogram queueLag;
+    /// The number of queued functions run at once, i.e. the length of the
+    /// queue.
+    LatencyHistogram queueLength;
+    /// The delay between the expiration time of a timer and the time when its
+    /// callback is called.
+    LatencyHistogram timerLateness;
+
+    void reset()
+    {
+        busyTime.reset();
+        pollTime.reset();
+        activeChannels.reset();
+        callbackTime.reset();
+        queueLag.reset();
+        queueLength.reset();
+        timerLateness.reset();
+    }
+};
+
+}  // namespace trantor
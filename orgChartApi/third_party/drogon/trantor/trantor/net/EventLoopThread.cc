@@ -16,6 +16,8 @@
 #include <trantor/utils/Logger.h>
 #ifdef __linux__
 #include <sys/prctl.h>
+#include <pthread.h>
+#include <sched.h>
 #endif
 
 using namespace trantor;
@@ -70,3 +72,29 @@ void EventLoopThread::run()
         (void)f.get();
     });
 }
+
+bool EventLoopThread::setCpuAffinity(size_t cpu)
+{
+#ifdef __linux__
+    auto cpuNum = std::thread::hardware_concurrency();
+    if (cpuNum == 0)
+        return false;
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(cpu % cpuNum, &cpuSet);
+    auto ret = pthread_setaffinity_np(thread_.native_handle(),
+                                      sizeof(cpuSet),
+                                      &cpuSet);
+    if (ret != 0)
+    {
+        LOG_ERROR << "Failed to pin the thread " << loopThreadName_
+                  << " to CPU " << cpu % cpuNum << ", error: " << ret;
+        return false;
+    }
+    return true;
+#else
+    (void)cpu;
+    LOG_WARN << "Setting CPU affinity is not supported on this platform";
+    return false;
+#endif
+}
@@ -58,6 +58,15 @@ class TRANTOR_EXPORT EventLoopThread : NonCopyable
      */
     void run();
 
+    /**
+     * @brief Pin the thread to a CPU.
+     *
+     * @param cpu The index of the CPU, it is taken modulo the number of CPUs.
+     * @return true if the affinity is set successfully.
+     * @note Only supported on Linux, false is returned on other platforms.
+     */
+    bool setCpuAffinity(size_t cpu);
+
   private:
     EventLoop *loop_;
     std::string loopThreadName_;
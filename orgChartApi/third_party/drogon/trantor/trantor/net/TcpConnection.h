@@ -22,6 +22,8 @@
 #include <memory>
 #include <functional>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace trantor
 {
@@ -30,7 +32,8 @@ TRANTOR_EXPORT std::shared_ptr<SSLContext> newSSLServerContext(
     const std::string &certPath,
     const std::string &keyPath,
     bool useOldTLS = false,
-    const std::vector<std::pair<std::string, std::string>> &sslConfCmds = {});
+    const std::vector<std::pair<std::string, std::string>> &sslConfCmds = {},
+    const std::vector<std::string> &alpnProtocols = {});
 /**
  * @brief This class represents a TCP connection.
  *
@@ -56,6 +59,17 @@ class TRANTOR_EXPORT TcpConnection
     virtual void send(const std::shared_ptr<std::string> &msgPtr) = 0;
     virtual void send(const std::shared_ptr<MsgBuffer> &msgPtr) = 0;
 
+    /**
+     * @brief Send the data in several memory blocks to the peer in order.
+     * When the connection is not encrypted, the blocks are written by one
+     * writev() call and only the bytes that can't be written immediately are
+     * copied into the sending buffer.
+     *
+     * @param buffers The addresses and lengths of the memory blocks.
+     */
+    virtual void send(
+        const std::vector<std::pair<const char *, size_t>> &buffers) = 0;
+
     /**
      * @brief Send a file to the peer.
      *
@@ -233,6 +247,15 @@ class TRANTOR_EXPORT TcpConnection
      */
     virtual bool isSSLConnection() const = 0;
 
+    /**
+     * @brief Get the application protocol negotiated by ALPN on the SSL
+     * connection.
+     *
+     * @return std::string The protocol name, empty if no protocol was
+     * negotiated.
+     */
+    virtual std::string applicationProtocol() const = 0;
+
     /**
      * @brief Start the SSL encryption on the connection (as a client).
      *
@@ -45,6 +45,11 @@ TcpServer::~TcpServer()
     LOG_TRACE << "TcpServer::~TcpServer [" << serverName_ << "] destructing";
 }
 
+void TcpServer::setReusePortCpuSteering(size_t groupSize)
+{
+    acceptorPtr_->setReusePortCpuSteering(groupSize);
+}
+
 void TcpServer::newConnection(int sockfd, const InetAddress &peer)
 {
     LOG_TRACE << "new connection:fd=" << sockfd
@@ -209,11 +214,13 @@ void TcpServer::enableSSL(
     const std::string &certPath,
     const std::string &keyPath,
     bool useOldTLS,
-    const std::vector<std::pair<std::string, std::string>> &sslConfCmds)
+    const std::vector<std::pair<std::string, std::string>> &sslConfCmds,
+    const std::vector<std::string> &alpnProtocols)
 {
 #ifdef USE_OPENSSL
     /* Create a new OpenSSL context */
-    sslCtxPtr_ = newSSLServerContext(certPath, keyPath, useOldTLS, sslConfCmds);
+    sslCtxPtr_ = newSSLServerContext(
+        certPath, keyPath, useOldTLS, sslConfCmds, alpnProtocols);
 #else
     // When not using OpenSSL, using `void` here will
     // work around the unused parameter warnings without overhead.
@@ -221,6 +228,7 @@ void TcpServer::enableSSL(
     (void)keyPath;
     (void)useOldTLS;
     (void)sslConfCmds;
+    (void)alpnProtocols;
 
     LOG_FATAL << "OpenSSL is not found in your system!";
     abort();
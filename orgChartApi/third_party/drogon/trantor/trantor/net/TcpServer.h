@@ -181,6 +181,18 @@ class TRANTOR_EXPORT TcpServer : NonCopyable
         return loopPoolPtr_->getLoops();
     }
 
+    /**
+     * @brief Steer new connections among the listening sockets sharing the
+     * port by SO_REUSEPORT, the connection is accepted by the socket of index
+     * (CPU handling the connection % groupSize) in the order they start
+     * listening. It works best when the threads of the acceptors are pinned
+     * to the CPUs with the same indices (see EventLoopThread::setCpuAffinity).
+     *
+     * @param groupSize The number of sockets listening on the port.
+     * @note Linux only, the option is attached to the whole group of sockets.
+     */
+    void setReusePortCpuSteering(size_t groupSize);
+
     /**
      * @brief An idle connection is a connection that has no read or write, kick
      * off it after timeout seconds.
@@ -204,6 +216,8 @@ class TRANTOR_EXPORT TcpServer : NonCopyable
      * server.
      * @param sslConfCmds The commands used to call the SSL_CONF_cmd function in
      * OpenSSL.
+     * @param alpnProtocols The protocols the server accepts by ALPN, in the
+     * order of preference, e.g. {"h2", "http/1.1"}.
      * @note It's well known that TLS 1.0 and 1.1 are not considered secure in
      * 2020. And it's a good practice to only use TLS 1.2 and above.
      */
@@ -211,7 +225,8 @@ class TRANTOR_EXPORT TcpServer : NonCopyable
                    const std::string &keyPath,
                    bool useOldTLS = false,
                    const std::vector<std::pair<std::string, std::string>>
-                       &sslConfCmds = {});
+                       &sslConfCmds = {},
+                   const std::vector<std::string> &alpnProtocols = {});
 
   private:
     EventLoop *loop_;
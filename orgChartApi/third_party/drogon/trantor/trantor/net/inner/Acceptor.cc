@@ -55,6 +55,10 @@ void Acceptor::listen()
 {
     loop_->assertInLoopThread();
     sock_.listen();
+    if (steeringGroupSize_ > 0)
+    {
+        sock_.setReusePortCpuSteering(steeringGroupSize_);
+    }
     acceptChannel_.enableReading();
 }
 
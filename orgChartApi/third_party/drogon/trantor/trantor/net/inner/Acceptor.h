@@ -41,6 +41,12 @@ class Acceptor : NonCopyable
         newConnectionCallback_ = cb;
     };
     void listen();
+    // The program is attached when the socket has joined the group of
+    // SO_REUSEPORT sockets, i.e. after listening.
+    void setReusePortCpuSteering(size_t groupSize)
+    {
+        steeringGroupSize_ = groupSize;
+    }
 
   protected:
 #ifndef _WIN32
@@ -51,6 +57,7 @@ class Acceptor : NonCopyable
     EventLoop *loop_;
     NewConnectionCallback newConnectionCallback_;
     Channel acceptChannel_;
+    size_t steeringGroupSize_{0};
     void readCallback();
 };
 }  // namespace trantor
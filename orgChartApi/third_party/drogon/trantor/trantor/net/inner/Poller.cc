@@ -15,6 +15,9 @@
 #include "Poller.h"
 #ifdef __linux__
 #include "poller/EpollPoller.h"
+#include "poller/IoUringPoller.h"
+#include <trantor/utils/Logger.h>
+#include <atomic>
 #elif defined _WIN32
 #include "Wepoll.h"
 #include "poller/EpollPoller.h"
@@ -24,9 +27,21 @@
 #include "poller/PollPoller.h"
 #endif
 using namespace trantor;
+#ifdef __linux__
+static std::atomic<bool> useIoUring{false};
+#endif
 Poller *Poller::newPoller(EventLoop *loop)
 {
-#if defined __linux__ || defined _WIN32
+#if defined __linux__
+    if (useIoUring.load(std::memory_order_acquire))
+    {
+        auto poller = IoUringPoller::newPoller(loop);
+        if (poller)
+            return poller;
+        LOG_WARN << "io_uring is not available, use epoll instead";
+    }
+    return new EpollPoller(loop);
+#elif defined _WIN32
     return new EpollPoller(loop);
 #elif defined __FreeBSD__ || defined __OpenBSD__ || defined __APPLE__
     return new KQueue(loop);
@@ -34,3 +49,11 @@ Poller *Poller::newPoller(EventLoop *loop)
     return new PollPoller(loop);
 #endif
 }
+void Poller::enableIoUring(bool enable)
+{
+#ifdef __linux__
+    useIoUring.store(enable, std::memory_order_release);
+#else
+    (void)enable;
+#endif
+}
@@ -47,6 +47,7 @@ class Poller : NonCopyable
     {
     }
     static Poller *newPoller(EventLoop *loop);
+    static void enableIoUring(bool enable);
 
   private:
     EventLoop *ownerLoop_;
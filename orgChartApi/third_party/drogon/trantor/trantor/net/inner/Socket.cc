@@ -22,6 +22,9 @@
 #include <sys/socket.h>
 #include <netinet/tcp.h>
 #endif
+#ifdef __linux__
+#include <linux/filter.h>
+#endif
 
 using namespace trantor;
 
@@ -202,6 +205,32 @@ void Socket::setReusePort(bool on)
 #endif
 }
 
+void Socket::setReusePortCpuSteering(size_t groupSize)
+{
+#if defined(__linux__) && defined(SO_ATTACH_REUSEPORT_CBPF)
+    // A = cpu; A %= groupSize; return A
+    struct sock_filter code[] = {
+        {BPF_LD | BPF_W | BPF_ABS, 0, 0, uint32_t(SKF_AD_OFF + SKF_AD_CPU)},
+        {BPF_ALU | BPF_MOD | BPF_K, 0, 0, static_cast<uint32_t>(groupSize)},
+        {BPF_RET | BPF_A, 0, 0, 0}};
+    struct sock_fprog prog;
+    prog.len = sizeof(code) / sizeof(code[0]);
+    prog.filter = code;
+    if (groupSize == 0 ||
+        ::setsockopt(sockFd_,
+                     SOL_SOCKET,
+                     SO_ATTACH_REUSEPORT_CBPF,
+                     &prog,
+                     static_cast<socklen_t>(sizeof prog)) < 0)
+    {
+        LOG_SYSERR << "SO_ATTACH_REUSEPORT_CBPF failed.";
+    }
+#else
+    (void)groupSize;
+    LOG_ERROR << "SO_ATTACH_REUSEPORT_CBPF is not supported.";
+#endif
+}
+
 void Socket::setKeepAlive(bool on)
 {
 #ifdef _WIN32
@@ -115,6 +115,13 @@ class Socket : NonCopyable
     ///
     void setReusePort(bool on);
 
+    ///
+    /// Attach a classic BPF program to the SO_REUSEPORT group of the socket,
+    /// which selects the socket with the index of the CPU handling the
+    /// incoming packet modulo groupSize. Linux only.
+    ///
+    void setReusePortCpuSteering(size_t groupSize);
+
     ///
     /// Enable/disable SO_KEEPALIVE
     ///
@@ -22,7 +22,9 @@
 #include <sys/types.h>
 #ifndef _WIN32
 #include <unistd.h>
+#include <sys/uio.h>
 #else
+#include <WindowsSupport.h>
 #include <WinSock2.h>
 #include <Windows.h>
 #include <wincrypt.h>
@@ -176,6 +178,30 @@ inline bool verifyAltName(X509 *cert, const std::string &hostname)
 
 }  // namespace internal
 
+#if OPENSSL_VERSION_NUMBER >= 0x10002000L
+int selectAlpnProtocol(SSL *,
+                       const unsigned char **out,
+                       unsigned char *outlen,
+                       const unsigned char *in,
+                       unsigned int inlen,
+                       void *arg)
+{
+    // Select the first protocol of the server which the client supports.
+    auto protocols = static_cast<const std::string *>(arg);
+    if (SSL_select_next_proto(
+            const_cast<unsigned char **>(out),
+            outlen,
+            reinterpret_cast<const unsigned char *>(protocols->data()),
+            static_cast<unsigned int>(protocols->length()),
+            in,
+            inlen) != OPENSSL_NPN_NEGOTIATED)
+    {
+        return SSL_TLSEXT_ERR_NOACK;
+    }
+    return SSL_TLSEXT_ERR_OK;
+}
+#endif
+
 void initOpenSSL()
 {
 #if (OPENSSL_VERSION_NUMBER < 0x10100000L) || \
@@ -280,8 +306,29 @@ class SSLContext
         return ctxPtr_;
     }
 
+    void setAlpnProtocols(const std::vector<std::string> &protocols)
+    {
+#if OPENSSL_VERSION_NUMBER >= 0x10002000L
+        // The protocols are kept in the wire format, each one is prefixed
+        // with its length.
+        alpnProtocols_.clear();
+        for (auto &protocol : protocols)
+        {
+            alpnProtocols_.push_back(static_cast<char>(protocol.length()));
+            alpnProtocols_.append(protocol);
+        }
+        SSL_CTX_set_alpn_select_cb(ctxPtr_,
+                                   selectAlpnProtocol,
+                                   &alpnProtocols_);
+#else
+        (void)protocols;
+        LOG_WARN << "ALPN is not supported by this OpenSSL version";
+#endif
+    }
+
   private:
     SSL_CTX *ctxPtr_;
+    std::string alpnProtocols_;
 };
 class SSLConn
 {
@@ -318,7 +365,8 @@ std::shared_ptr<SSLContext> newSSLServerContext(
     const std::string &certPath,
     const std::string &keyPath,
     bool useOldTLS,
-    const std::vector<std::pair<std::string, std::string>> &sslConfCmds)
+    const std::vector<std::pair<std::string, std::string>> &sslConfCmds,
+    const std::vector<std::string> &alpnProtocols)
 {
     auto ctx = newSSLContext(useOldTLS, false, sslConfCmds);
     auto r = SSL_CTX_use_certificate_chain_file(ctx->get(), certPath.c_str());
@@ -345,6 +393,10 @@ std::shared_ptr<SSLContext> newSSLServerContext(
         LOG_FATAL << "Checking private key matches certificate: " << errbuf;
         abort();
     }
+    if (!alpnProtocols.empty())
+    {
+        ctx->setAlpnProtocols(alpnProtocols);
+    }
     return ctx;
 }
 std::shared_ptr<SSLContext> newSSLClientContext(
@@ -392,7 +444,8 @@ std::shared_ptr<SSLContext> newSSLServerContext(
     const std::string &,
     const std::string &,
     bool,
-    const std::vector<std::pair<std::string, std::string>> &)
+    const std::vector<std::pair<std::string, std::string>> &,
+    const std::vector<std::string> &)
 {
     LOG_FATAL << "OpenSSL is not found in your system!";
     abort();
@@ -468,6 +521,9 @@ void TcpConnectionImpl::startClientEncryptionInLoop(
     sslEncryptionPtr_->sendBufferPtr_ =
         std::make_unique<std::array<char, 8192>>();
     LOG_TRACE << "connectEstablished";
+    // Data must be read by OpenSSL from now on, note that data received by
+    // the poller before is still treated as plaintext.
+    ioChannelPtr_->setRecvBuffer(nullptr);
     ioChannelPtr_->enableWriting();
     SSL_set_connect_state(sslEncryptionPtr_->sslPtr_->get());
 }
@@ -499,6 +555,10 @@ void TcpConnectionImpl::startServerEncryptionInLoop(
     sslEncryptionPtr_->sendBufferPtr_ =
         std::make_unique<std::array<char, 8192>>();
     LOG_TRACE << "upgrade to ssl";
+    // Data must be read by OpenSSL from now on, note that data received by
+    // the poller before is still treated as plaintext.
+    ioChannelPtr_->setRecvBuffer(nullptr);
+    ioChannelPtr_->enableReading();
     SSL_set_accept_state(sslEncryptionPtr_->sslPtr_->get());
 }
 #endif
@@ -593,7 +653,11 @@ void TcpConnectionImpl::readCallback()
         loop_->assertInLoopThread();
         int ret = 0;
 
-        ssize_t n = readBuffer_.readFd(socketPtr_->fd(), &ret);
+        // The poller may have received data into the buffer already.
+        bool receivedByPoller = ioChannelPtr_->isReceivingByPoller();
+        ssize_t n = receivedByPoller
+                        ? ioChannelPtr_->takeReceivedBytes()
+                        : readBuffer_.readFd(socketPtr_->fd(), &ret);
         // LOG_TRACE<<"read "<<n<<" bytes from socket";
         if (n == 0)
         {
@@ -605,8 +669,13 @@ void TcpConnectionImpl::readCallback()
             if (errno == EPIPE || errno == ECONNRESET ||
                 errno == EAGAIN)  // TODO: any others?
             {
+                // The poller does not report errors of the socket in other
+                // ways.
+                bool closed = receivedByPoller && errno != EAGAIN;
                 LOG_DEBUG << "EPIPE or ECONNRESET, errno=" << errno
                           << " fd=" << socketPtr_->fd();
+                if (closed)
+                    handleClose();
                 return;
             }
 #ifdef _WIN32
@@ -636,6 +705,8 @@ void TcpConnectionImpl::readCallback()
     {
         LOG_TRACE << "read Callback";
         loop_->assertInLoopThread();
+        if (!fillSSLReadBio())
+            return;
         if (sslEncryptionPtr_->statusOfSSL_ == SSLStatus::Handshaking)
         {
             doHandshaking();
@@ -683,21 +754,45 @@ void TcpConnectionImpl::readCallback()
     }
 #endif
 }
+void TcpConnectionImpl::enableKickingOff(
+    size_t timeout,
+    const std::shared_ptr<TimingWheel> &timingWheel)
+{
+    assert(timingWheel);
+    assert(timingWheel->getLoop() == loop_);
+    assert(timeout > 0);
+    idleTimeout_ = timeout;
+    // The node is removed from the wheel before the connection is destroyed.
+    kickoffNode_.setCallback([this]() { forceClose(); });
+    loop_->runInLoop([thisPtr = shared_from_this(), timingWheel]() {
+        if (thisPtr->idleTimeout_ > 0)
+            timingWheel->insertNode(thisPtr->idleTimeout_,
+                                    &thisPtr->kickoffNode_);
+    });
+}
+void TcpConnectionImpl::keepAlive()
+{
+    idleTimeout_ = 0;
+    if (loop_->isInLoopThread())
+    {
+        kickoffNode_.unlink();
+    }
+    else
+    {
+        loop_->queueInLoop([thisPtr = shared_from_this()]() {
+            thisPtr->kickoffNode_.unlink();
+        });
+    }
+}
 void TcpConnectionImpl::extendLife()
 {
     if (idleTimeout_ > 0)
     {
-        auto now = Date::date();
-        if (now < lastTimingWheelUpdateTime_.after(1.0))
-            return;
-        lastTimingWheelUpdateTime_ = now;
-        auto entry = kickoffEntry_.lock();
-        if (entry)
-        {
-            auto timingWheelPtr = timingWheelWeakPtr_.lock();
-            if (timingWheelPtr)
-                timingWheelPtr->insertEntry(idleTimeout_, entry);
-        }
+        // Moving the node is cheap, and nothing is done if it stays in the
+        // same bucket.
+        auto timingWheel = kickoffNode_.wheel();
+        if (timingWheel)
+            timingWheel->insertNode(idleTimeout_, &kickoffNode_);
     }
 }
 void TcpConnectionImpl::writeCallback()
@@ -720,7 +815,7 @@ void TcpConnectionImpl::writeCallback()
         if (writeBuffer_->sendFp_ == nullptr)
 #endif
             {
-                if (writeBuffer_->msgBuffer_->readableBytes() <= 0)
+                if (writeBuffer_->buffer_.readableBytes() <= 0)
                 {
                     writeBufferList_.pop_front();
                     if (writeBufferList_.empty())
@@ -747,12 +842,10 @@ void TcpConnectionImpl::writeCallback()
                 }
                 else
                 {
-                    auto n =
-                        writeInLoop(writeBuffer_->msgBuffer_->peek(),
-                                    writeBuffer_->msgBuffer_->readableBytes());
+                    auto n = writeBufferInLoop(writeBuffer_->buffer_);
                     if (n >= 0)
                     {
-                        writeBuffer_->msgBuffer_->retrieve(n);
+                        writeBuffer_->buffer_.retrieve(n);
                     }
                     else
                     {
@@ -800,14 +893,11 @@ void TcpConnectionImpl::writeCallback()
 #endif
                         {
                             // There is data to be sent in the buffer.
-                            auto n = writeInLoop(
-                                writeBufferList_.front()->msgBuffer_->peek(),
-                                writeBufferList_.front()
-                                    ->msgBuffer_->readableBytes());
+                            auto n = writeBufferInLoop(
+                                writeBufferList_.front()->buffer_);
                             if (n >= 0)
                             {
-                                writeBufferList_.front()->msgBuffer_->retrieve(
-                                    n);
+                                writeBufferList_.front()->buffer_.retrieve(n);
                             }
                             else
                             {
@@ -874,6 +964,7 @@ void TcpConnectionImpl::connectEstablished()
             LOG_TRACE << "connectEstablished";
             assert(thisPtr->status_ == ConnStatus::Connecting);
             thisPtr->ioChannelPtr_->tie(thisPtr);
+            thisPtr->ioChannelPtr_->setRecvBuffer(&thisPtr->readBuffer_);
             thisPtr->ioChannelPtr_->enableReading();
             thisPtr->status_ = ConnStatus::Connected;
             if (thisPtr->connectionCallback_)
@@ -951,6 +1042,7 @@ void TcpConnectionImpl::connectDestroyed()
         connectionCallback_(shared_from_this());
     }
     ioChannelPtr_->remove();
+    kickoffNode_.unlink();
 }
 void TcpConnectionImpl::shutdown()
 {
@@ -1021,34 +1113,34 @@ void TcpConnectionImpl::sendInLoop(const char *buffer, size_t length)
     }
     if (remainLen > 0 && status_ == ConnStatus::Connected)
     {
-        if (writeBufferList_.empty())
-        {
-            BufferNodePtr node = std::make_shared<BufferNode>();
-            node->msgBuffer_ = std::make_shared<MsgBuffer>();
-            writeBufferList_.push_back(std::move(node));
-        }
+        appendToWriteBuffer(static_cast<const char *>(buffer) + sendLen,
+                            remainLen);
+    }
+}
+void TcpConnectionImpl::appendToWriteBuffer(const char *buffer, size_t length)
+{
+    if (writeBufferList_.empty())
+    {
+        BufferNodePtr node = std::make_shared<BufferNode>();
+        writeBufferList_.push_back(std::move(node));
+    }
 #ifndef _WIN32
-        else if (writeBufferList_.back()->sendFd_ >= 0)
+    else if (writeBufferList_.back()->sendFd_ >= 0)
 #else
-        else if (writeBufferList_.back()->sendFp_)
+    else if (writeBufferList_.back()->sendFp_)
 #endif
-        {
-            BufferNodePtr node = std::make_shared<BufferNode>();
-            node->msgBuffer_ = std::make_shared<MsgBuffer>();
-            writeBufferList_.push_back(std::move(node));
-        }
-        writeBufferList_.back()->msgBuffer_->append(
-            static_cast<const char *>(buffer) + sendLen, remainLen);
-        if (!ioChannelPtr_->isWriting())
-            ioChannelPtr_->enableWriting();
-        if (highWaterMarkCallback_ &&
-            writeBufferList_.back()->msgBuffer_->readableBytes() >
-                highWaterMarkLen_)
-        {
-            highWaterMarkCallback_(
-                shared_from_this(),
-                writeBufferList_.back()->msgBuffer_->readableBytes());
-        }
+    {
+        BufferNodePtr node = std::make_shared<BufferNode>();
+        writeBufferList_.push_back(std::move(node));
+    }
+    writeBufferList_.back()->buffer_.append(buffer, length);
+    if (!ioChannelPtr_->isWriting())
+        ioChannelPtr_->enableWriting();
+    if (highWaterMarkCallback_ &&
+        writeBufferList_.back()->buffer_.readableBytes() > highWaterMarkLen_)
+    {
+        highWaterMarkCallback_(shared_from_this(),
+                               writeBufferList_.back()->buffer_.readableBytes());
     }
 }
 // The order of data sending should be same as the order of calls of send()
@@ -1117,6 +1209,96 @@ void TcpConnectionImpl::send(const std::shared_ptr<MsgBuffer> &msgPtr)
         });
     }
 }
+void TcpConnectionImpl::sendInLoop(
+    const std::vector<std::pair<const char *, size_t>> &buffers)
+{
+    loop_->assertInLoopThread();
+    if (status_ != ConnStatus::Connected)
+    {
+        LOG_WARN << "Connection is not connected,give up sending";
+        return;
+    }
+#ifndef _WIN32
+    if (!isEncrypted_ && !ioChannelPtr_->isWriting() &&
+        writeBufferList_.empty())
+    {
+        extendLife();
+        // send directly, all the blocks in one system call
+        std::vector<struct iovec> vec(buffers.size());
+        for (size_t i = 0; i < buffers.size(); ++i)
+        {
+            vec[i].iov_base = const_cast<char *>(buffers[i].first);
+            vec[i].iov_len = buffers[i].second;
+        }
+        auto sendLen = ::writev(socketPtr_->fd(),
+                                vec.data(),
+                                static_cast<int>(vec.size()));
+        if (sendLen < 0)
+        {
+            // Nothing was written if the socket is full or the call was
+            // interrupted, all of it is buffered below.
+            if (errno != EWOULDBLOCK && errno != EAGAIN && errno != EINTR)
+            {
+                // The peer is gone, the read side reports the closing
+                if (errno == EPIPE || errno == ECONNRESET)
+                {
+                    LOG_DEBUG << "EPIPE or ECONNRESET, erron=" << errno;
+                    return;
+                }
+                LOG_SYSERR << "Unexpected error(" << errno << ")";
+                return;
+            }
+            sendLen = 0;
+        }
+        bytesSent_ += static_cast<size_t>(sendLen);
+        // The rest is appended to the sending buffer and written when the
+        // socket is writable again.
+        auto sent = static_cast<size_t>(sendLen);
+        for (auto const &buffer : buffers)
+        {
+            if (sent >= buffer.second)
+            {
+                sent -= buffer.second;
+                continue;
+            }
+            appendToWriteBuffer(buffer.first + sent, buffer.second - sent);
+            sent = 0;
+        }
+        return;
+    }
+#endif
+    for (auto const &buffer : buffers)
+    {
+        sendInLoop(buffer.first, buffer.second);
+    }
+}
+void TcpConnectionImpl::send(
+    const std::vector<std::pair<const char *, size_t>> &buffers)
+{
+    if (loop_->isInLoopThread())
+    {
+        std::lock_guard<std::mutex> guard(sendNumMutex_);
+        if (sendNum_ == 0)
+        {
+            sendInLoop(buffers);
+            return;
+        }
+    }
+    // The memory blocks are not owned by the connection, so copy them before
+    // deferring the sending to the loop thread.
+    auto buffer = std::make_shared<std::string>();
+    size_t length = 0;
+    for (auto const &block : buffers)
+    {
+        length += block.second;
+    }
+    buffer->reserve(length);
+    for (auto const &block : buffers)
+    {
+        buffer->append(block.first, block.second);
+    }
+    send(buffer);
+}
 void TcpConnectionImpl::send(const char *msg, size_t len)
 {
     if (loop_->isInLoopThread())
@@ -1658,6 +1840,36 @@ ssize_t TcpConnectionImpl::writeInLoop(const char *buffer, size_t length)
 #endif
 }
 
+ssize_t TcpConnectionImpl::writeBufferInLoop(const ChainedBuffer &buffer)
+{
+    // The slabs of the buffer are sent by one writev() call, without
+    // gathering them into one block first.
+    constexpr size_t kMaxBlocks{64};
+    struct iovec vec[kMaxBlocks];
+    auto count = buffer.peek(vec, kMaxBlocks);
+#ifndef _WIN32
+    if (!isEncrypted_)
+    {
+        auto n = ::writev(socketPtr_->fd(), vec, static_cast<int>(count));
+        if (n > 0)
+            bytesSent_ += static_cast<size_t>(n);
+        return n;
+    }
+#endif
+    ssize_t sendLen = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto len = static_cast<size_t>(vec[i].iov_len);
+        auto n = writeInLoop(static_cast<const char *>(vec[i].iov_base), len);
+        if (n < 0)
+            return sendLen > 0 ? sendLen : n;
+        sendLen += n;
+        if (static_cast<size_t>(n) < len)
+            break;
+    }
+    return sendLen;
+}
+
 #ifdef USE_OPENSSL
 
 TcpConnectionImpl::TcpConnectionImpl(EventLoop *loop,
@@ -1748,6 +1960,54 @@ bool TcpConnectionImpl::validatePeerCertificate()
     }
 }
 
+bool TcpConnectionImpl::fillSSLReadBio()
+{
+    // Data received by the poller after the upgrade belongs to OpenSSL and
+    // can't be put back into the socket, so OpenSSL reads from memory and the
+    // socket is read here from then on.
+    auto pending = ioChannelPtr_->pendingRecvBuffer();
+    auto ssl = sslEncryptionPtr_->sslPtr_->get();
+    if (!sslEncryptionPtr_->readBioBuffer_)
+    {
+        if (!pending)
+            return true;
+        auto memBio = BIO_new(BIO_s_mem());
+        BIO_set_mem_eof_return(memBio, -1);
+        SSL_set_bio(ssl,
+                    memBio,
+                    BIO_new_socket(socketPtr_->fd(), BIO_NOCLOSE));
+        sslEncryptionPtr_->readBioBuffer_ = std::make_unique<MsgBuffer>();
+    }
+    auto bio = SSL_get_rbio(ssl);
+    if (pending)
+    {
+        BIO_write(bio,
+                  pending->peek(),
+                  static_cast<int>(pending->readableBytes()));
+        pending->retrieveAll();
+    }
+    auto &buffer = *sslEncryptionPtr_->readBioBuffer_;
+    int err = 0;
+    ssize_t n = buffer.readFd(socketPtr_->fd(), &err);
+    if (n == 0)
+    {
+        handleClose();
+        return false;
+    }
+    if (n < 0)
+    {
+        if (err == EAGAIN || err == EWOULDBLOCK)
+            return true;
+        LOG_DEBUG << "read socket error, errno=" << err
+                  << " fd=" << socketPtr_->fd();
+        handleClose();
+        return false;
+    }
+    BIO_write(bio, buffer.peek(), static_cast<int>(buffer.readableBytes()));
+    buffer.retrieveAll();
+    return true;
+}
+
 void TcpConnectionImpl::doHandshaking()
 {
     assert(sslEncryptionPtr_->statusOfSSL_ == SSLStatus::Handshaking);
@@ -1814,3 +2074,23 @@ void TcpConnectionImpl::doHandshaking()
 }
 
 #endif
+
+std::string TcpConnectionImpl::applicationProtocol() const
+{
+#if defined(USE_OPENSSL) && OPENSSL_VERSION_NUMBER >= 0x10002000L
+    if (sslEncryptionPtr_ && sslEncryptionPtr_->sslPtr_)
+    {
+        const unsigned char *protocol{nullptr};
+        unsigned int length{0};
+        SSL_get0_alpn_selected(sslEncryptionPtr_->sslPtr_->get(),
+                               &protocol,
+                               &length);
+        if (protocol)
+        {
+            return std::string(reinterpret_cast<const char *>(protocol),
+                               length);
+        }
+    }
+#endif
+    return std::string();
+}
@@ -15,6 +15,7 @@
 #pragma once
 
 #include <trantor/net/TcpConnection.h>
+#include <trantor/utils/ChainedBuffer.h>
 #include <trantor/utils/TimingWheel.h>
 #include <list>
 #include <mutex>
@@ -46,7 +47,8 @@ std::shared_ptr<SSLContext> newSSLServerContext(
     const std::string &certPath,
     const std::string &keyPath,
     bool useOldTLS,
-    const std::vector<std::pair<std::string, std::string>> &sslConfCmds);
+    const std::vector<std::pair<std::string, std::string>> &sslConfCmds,
+    const std::vector<std::string> &alpnProtocols);
 std::shared_ptr<SSLContext> newSSLClientContext(
     bool useOldTLS,
     bool validateCert,
@@ -72,30 +74,6 @@ class TcpConnectionImpl : public TcpConnection,
                                           const TcpConnectionPtr &conn);
 
   public:
-    class KickoffEntry
-    {
-      public:
-        explicit KickoffEntry(const std::weak_ptr<TcpConnection> &conn)
-            : conn_(conn)
-        {
-        }
-        void reset()
-        {
-            conn_.reset();
-        }
-        ~KickoffEntry()
-        {
-            auto conn = conn_.lock();
-            if (conn)
-            {
-                conn->forceClose();
-            }
-        }
-
-      private:
-        std::weak_ptr<TcpConnection> conn_;
-    };
-
     TcpConnectionImpl(EventLoop *loop,
                       int socketfd,
                       const InetAddress &localAddr,
@@ -119,6 +97,8 @@ class TcpConnectionImpl : public TcpConnection,
     virtual void send(MsgBuffer &&buffer) override;
     virtual void send(const std::shared_ptr<std::string> &msgPtr) override;
     virtual void send(const std::shared_ptr<MsgBuffer> &msgPtr) override;
+    virtual void send(
+        const std::vector<std::pair<const char *, size_t>> &buffers) override;
     virtual void sendFile(const char *fileName,
                           size_t offset = 0,
                           size_t length = 0) override;
@@ -157,15 +137,7 @@ class TcpConnectionImpl : public TcpConnection,
         highWaterMarkLen_ = markLen;
     }
 
-    virtual void keepAlive() override
-    {
-        idleTimeout_ = 0;
-        auto entry = kickoffEntry_.lock();
-        if (entry)
-        {
-            entry->reset();
-        }
-    }
+    virtual void keepAlive() override;
     virtual bool isKeepAlive() override
     {
         return idleTimeout_ == 0;
@@ -199,27 +171,18 @@ class TcpConnectionImpl : public TcpConnection,
     {
         return isEncrypted_;
     }
+    virtual std::string applicationProtocol() const override;
 
   private:
     /// Internal use only.
 
-    std::weak_ptr<KickoffEntry> kickoffEntry_;
-    std::weak_ptr<TimingWheel> timingWheelWeakPtr_;
+    // The connection is closed when the node expires, it is refreshed when
+    // data is received.
+    TimingWheel::Node kickoffNode_;
     size_t idleTimeout_{0};
-    Date lastTimingWheelUpdateTime_;
 
     void enableKickingOff(size_t timeout,
-                          const std::shared_ptr<TimingWheel> &timingWheel)
-    {
-        assert(timingWheel);
-        assert(timingWheel->getLoop() == loop_);
-        assert(timeout > 0);
-        auto entry = std::make_shared<KickoffEntry>(shared_from_this());
-        kickoffEntry_ = entry;
-        timingWheelWeakPtr_ = timingWheel;
-        idleTimeout_ = timeout;
-        timingWheel->insertEntry(timeout, entry);
-    }
+                          const std::shared_ptr<TimingWheel> &timingWheel);
     void extendLife();
 #ifndef _WIN32
     void sendFile(int sfd, size_t offset = 0, size_t length = 0);
@@ -280,7 +243,7 @@ class TcpConnectionImpl : public TcpConnection,
         long long offset_;
 #endif
         ssize_t fileBytesToSend_;
-        std::shared_ptr<MsgBuffer> msgBuffer_;
+        ChainedBuffer buffer_;
         ~BufferNode()
         {
 #ifndef _WIN32
@@ -329,6 +292,11 @@ class TcpConnectionImpl : public TcpConnection,
     void sendInLoop(const char *buffer, size_t length);
     ssize_t writeInLoop(const char *buffer, size_t length);
 #endif
+    void sendInLoop(
+        const std::vector<std::pair<const char *, size_t>> &buffers);
+    // Queue data behind what is waiting to be written
+    void appendToWriteBuffer(const char *buffer, size_t length);
+    ssize_t writeBufferInLoop(const ChainedBuffer &buffer);
     size_t highWaterMarkLen_;
     std::string name_;
 
@@ -343,6 +311,7 @@ class TcpConnectionImpl : public TcpConnection,
 #ifdef USE_OPENSSL
   private:
     void doHandshaking();
+    bool fillSSLReadBio();
     bool validatePeerCertificate();
     struct SSLEncryption
     {
@@ -351,6 +320,8 @@ class TcpConnectionImpl : public TcpConnection,
         std::shared_ptr<SSLContext> sslCtxPtr_;
         std::unique_ptr<SSLConn> sslPtr_;
         std::unique_ptr<std::array<char, 8192>> sendBufferPtr_;
+        // Set when OpenSSL reads from memory instead of the socket.
+        std::unique_ptr<MsgBuffer> readBioBuffer_;
         bool isServer_{false};
         bool isUpgrade_{false};
         std::function<void()> upgradeCallback_;
@@ -19,26 +19,9 @@
 namespace trantor
 {
 std::atomic<TimerId> Timer::timersCreated_ = ATOMIC_VAR_INIT(InvalidTimerId);
-Timer::Timer(const TimerCallback &cb,
-             const TimePoint &when,
-             const TimeInterval &interval)
-    : callback_(cb),
-      when_(when),
-      interval_(interval),
-      repeat_(interval.count() > 0),
-      id_(++timersCreated_)
+TimerId Timer::newId()
 {
-}
-Timer::Timer(TimerCallback &&cb,
-             const TimePoint &when,
-             const TimeInterval &interval)
-    : callback_(std::move(cb)),
-      when_(when),
-      interval_(interval),
-      repeat_(interval.count() > 0),
-      id_(++timersCreated_)
-{
-    // LOG_TRACE<<"Timer move contrustor";
+    return ++timersCreated_;
 }
 void Timer::run() const
 {
@@ -46,7 +29,7 @@ void Timer::run() const
 }
 void Timer::restart(const TimePoint &now)
 {
-    if (repeat_)
+    if (isRepeat())
     {
         when_ = now + interval_;
     }
@@ -18,27 +18,24 @@
 #include <trantor/net/callbacks.h>
 #include <functional>
 #include <atomic>
-#include <iostream>
 #include <chrono>
+#include <stdint.h>
 
 namespace trantor
 {
 using TimerId = uint64_t;
 using TimePoint = std::chrono::steady_clock::time_point;
 using TimeInterval = std::chrono::microseconds;
+class TimerQueue;
+
+/**
+ * @brief A timer in the timing wheel of TimerQueue. Timers are pooled and
+ * reused by the queue, and linked into the slots of the wheel.
+ */
 class Timer : public NonCopyable
 {
   public:
-    Timer(const TimerCallback &cb,
-          const TimePoint &when,
-          const TimeInterval &interval);
-    Timer(TimerCallback &&cb,
-          const TimePoint &when,
-          const TimeInterval &interval);
-    ~Timer()
-    {
-        //   std::cout<<"Timer unconstract!"<<std::endl;
-    }
+    Timer() = default;
     void run() const;
     void restart(const TimePoint &now);
     bool operator<(const Timer &t) const;
@@ -47,21 +44,33 @@ class Timer : public NonCopyable
     {
         return when_;
     }
-    bool isRepeat()
+    bool isRepeat() const
     {
-        return repeat_;
+        return interval_.count() > 0;
     }
-    TimerId id()
+    TimerId id() const
     {
         return id_;
     }
 
+    /// Return a new ID, IDs are unique in the process.
+    static TimerId newId();
+
   private:
+    friend class TimerQueue;
     TimerCallback callback_;
     TimePoint when_;
-    const TimeInterval interval_;
-    const bool repeat_;
-    const TimerId id_;
+    TimeInterval interval_{0};
+    TimerId id_{0};
+    // The tick of the wheel at which the timer expires.
+    uint64_t tick_{0};
+    // Links of the slot list, or of the free list of the pool.
+    Timer *prev_{nullptr};
+    Timer *next_{nullptr};
+    uint8_t level_{0};
+    uint8_t index_{0};
+    bool linked_{false};
+    bool cancelled_{false};
     static std::atomic<TimerId> timersCreated_;
 };
 
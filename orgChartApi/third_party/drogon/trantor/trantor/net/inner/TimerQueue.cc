@@ -19,13 +19,36 @@
 #ifdef __linux__
 #include <sys/timerfd.h>
 #endif
+#include <algorithm>
 #include <string.h>
 #include <iostream>
 #ifndef _WIN32
 #include <unistd.h>
 #endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 using namespace trantor;
+
+constexpr size_t TimerQueue::kLevels;
+constexpr size_t TimerQueue::kSlotBits;
+constexpr size_t TimerQueue::kSlots;
+constexpr uint64_t TimerQueue::kSlotMask;
+constexpr size_t TimerQueue::kPoolChunkSize;
+constexpr uint64_t TimerQueue::kNoTick;
+
+static size_t lowestBit(uint64_t bits)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, bits);
+    return index;
+#else
+    return static_cast<size_t>(__builtin_ctzll(bits));
+#endif
+}
+
 #ifdef __linux__
 static int createTimerfd()
 {
@@ -81,22 +104,7 @@ void TimerQueue::handleRead()
     loop_->assertInLoopThread();
     const auto now = std::chrono::steady_clock::now();
     readTimerfd(timerfd_, now);
-
-    std::vector<TimerPtr> expired = getExpired(now);
-
-    callingExpiredTimers_ = true;
-    // cancelingTimers_.clear();
-    // safe to callback outside critical section
-    for (auto const &timerPtr : expired)
-    {
-        if (timerIdSet_.find(timerPtr->id()) != timerIdSet_.end())
-        {
-            timerPtr->run();
-        }
-    }
-    callingExpiredTimers_ = false;
-
-    reset(expired, now);
+    runExpired(now);
 }
 #else
 static int64_t howMuchTimeFromNow(const TimePoint &when)
@@ -113,23 +121,7 @@ static int64_t howMuchTimeFromNow(const TimePoint &when)
 void TimerQueue::processTimers()
 {
     loop_->assertInLoopThread();
-    const auto now = std::chrono::steady_clock::now();
-
-    std::vector<TimerPtr> expired = getExpired(now);
-
-    callingExpiredTimers_ = true;
-    // cancelingTimers_.clear();
-    // safe to callback outside critical section
-    for (auto const &timerPtr : expired)
-    {
-        if (timerIdSet_.find(timerPtr->id()) != timerIdSet_.end())
-        {
-            timerPtr->run();
-        }
-    }
-    callingExpiredTimers_ = false;
-
-    reset(expired, now);
+    runExpired(std::chrono::steady_clock::now());
 }
 #endif
 ///////////////////////////////////////
@@ -139,9 +131,11 @@ TimerQueue::TimerQueue(EventLoop *loop)
       timerfd_(createTimerfd()),
       timerfdChannelPtr_(new Channel(loop, timerfd_)),
 #endif
-      timers_(),
-      callingExpiredTimers_(false)
+      callingExpiredTimers_(false),
+      epoch_(std::chrono::steady_clock::now())
 {
+    memset(slots_, 0, sizeof(slots_));
+    memset(occupied_, 0, sizeof(occupied_));
 #ifdef __linux__
     timerfdChannelPtr_->setReadCallback(
         std::bind(&TimerQueue::handleRead, this));
@@ -162,11 +156,8 @@ void TimerQueue::reset()
             std::bind(&TimerQueue::handleRead, this));
         // we are always reading the timerfd, we disarm it with timerfd_settime.
         timerfdChannelPtr_->enableReading();
-        if (!timers_.empty())
-        {
-            const auto nextExpire = timers_.top()->when();
-            resetTimerfd(timerfd_, nextExpire);
-        }
+        scheduledTick_ = kNoTick;
+        updateTimeout();
     });
 }
 #endif
@@ -187,108 +178,341 @@ TimerId TimerQueue::addTimer(const TimerCallback &cb,
                              const TimePoint &when,
                              const TimeInterval &interval)
 {
-    std::shared_ptr<Timer> timerPtr =
-        std::make_shared<Timer>(cb, when, interval);
-
-    loop_->runInLoop([this, timerPtr]() { addTimerInLoop(timerPtr); });
-    return timerPtr->id();
+    auto id = Timer::newId();
+    if (loop_->isInLoopThread())
+    {
+        addTimerInLoop(TimerCallback(cb), when, interval, id);
+    }
+    else
+    {
+        loop_->queueInLoop([this, cb = cb, when, interval, id]() mutable {
+            addTimerInLoop(std::move(cb), when, interval, id);
+        });
+    }
+    return id;
 }
 TimerId TimerQueue::addTimer(TimerCallback &&cb,
                              const TimePoint &when,
                              const TimeInterval &interval)
 {
-    std::shared_ptr<Timer> timerPtr =
-        std::make_shared<Timer>(std::move(cb), when, interval);
-
-    loop_->runInLoop([this, timerPtr]() { addTimerInLoop(timerPtr); });
-    return timerPtr->id();
+    auto id = Timer::newId();
+    if (loop_->isInLoopThread())
+    {
+        addTimerInLoop(std::move(cb), when, interval, id);
+    }
+    else
+    {
+        loop_->queueInLoop(
+            [this, cb = std::move(cb), when, interval, id]() mutable {
+                addTimerInLoop(std::move(cb), when, interval, id);
+            });
+    }
+    return id;
 }
-void TimerQueue::addTimerInLoop(const TimerPtr &timer)
+void TimerQueue::addTimerInLoop(TimerCallback &&cb,
+                                const TimePoint &when,
+                                const TimeInterval &interval,
+                                TimerId id)
 {
     loop_->assertInLoopThread();
-    timerIdSet_.insert(timer->id());
-    if (insert(timer))
+    auto timer = allocTimer();
+    timer->callback_ = std::move(cb);
+    timer->when_ = when;
+    timer->interval_ = interval;
+    timer->id_ = id;
+    timer->cancelled_ = false;
+    timers_.emplace(id, timer);
+    auto tick = (std::max)(tickOf(when), currentTick_ + 1);
+    link(timer, tick);
+    if (tick < scheduledTick_)
     {
-// the earliest timer changed
+        // the earliest timer changed
+        scheduledTick_ = tick;
 #ifdef __linux__
-        resetTimerfd(timerfd_, timer->when());
+        resetTimerfd(timerfd_, timeOf(tick));
 #endif
     }
 }
 
 void TimerQueue::invalidateTimer(TimerId id)
 {
-    loop_->runInLoop([this, id]() { timerIdSet_.erase(id); });
+    loop_->runInLoop([this, id]() {
+        auto iter = timers_.find(id);
+        if (iter == timers_.end())
+            return;
+        auto timer = iter->second;
+        timers_.erase(iter);
+        if (timer->linked_)
+        {
+            unlink(timer);
+            freeTimer(timer);
+        }
+        else
+        {
+            // The timer is expiring, it is freed after the expired timers run.
+            timer->cancelled_ = true;
+        }
+    });
 }
 
-bool TimerQueue::insert(const TimerPtr &timerPtr)
+Timer *TimerQueue::allocTimer()
 {
-    loop_->assertInLoopThread();
-    bool earliestChanged = false;
-    if (timers_.size() == 0 || *timerPtr < *timers_.top())
+    if (!freeTimers_)
     {
-        earliestChanged = true;
+        pool_.emplace_back(new Timer[kPoolChunkSize]);
+        auto chunk = pool_.back().get();
+        for (size_t i = 0; i < kPoolChunkSize; ++i)
+        {
+            chunk[i].next_ = freeTimers_;
+            freeTimers_ = &chunk[i];
+        }
     }
-    timers_.push(timerPtr);
-    // std::cout<<"after push new
-    // timer:"<<timerPtr->when().microSecondsSinceEpoch()/1000000<<std::endl;
-    return earliestChanged;
+    auto timer = freeTimers_;
+    freeTimers_ = timer->next_;
+    return timer;
 }
-#ifndef __linux__
-int64_t TimerQueue::getTimeout() const
+
+void TimerQueue::freeTimer(Timer *timer)
 {
-    loop_->assertInLoopThread();
-    if (timers_.empty())
+    // Release the resources captured by the callback.
+    timer->callback_ = nullptr;
+    timer->next_ = freeTimers_;
+    freeTimers_ = timer;
+}
+
+uint64_t TimerQueue::tickOf(const TimePoint &when) const
+{
+    // Round up, so timers never expire early.
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(when -
+                                                                   epoch_)
+                  .count();
+    if (us <= 0)
+        return 0;
+    return (static_cast<uint64_t>(us) + 999) / 1000;
+}
+
+TimePoint TimerQueue::timeOf(uint64_t tick) const
+{
+    return epoch_ + std::chrono::milliseconds(tick);
+}
+
+Timer *&TimerQueue::listOf(const Timer *timer)
+{
+    if (timer->level_ == kLevels)
+        return overflow_;
+    return slots_[timer->level_][timer->index_];
+}
+
+void TimerQueue::link(Timer *timer, uint64_t tick)
+{
+    // The level is the lowest one on which the timer is in the same range as
+    // the current tick.
+    size_t level = 0;
+    while (level < kLevels &&
+           (tick >> (kSlotBits * (level + 1))) !=
+               (currentTick_ >> (kSlotBits * (level + 1))))
     {
-        return 10000;
+        ++level;
     }
+    timer->tick_ = tick;
+    timer->level_ = static_cast<uint8_t>(level);
+    if (level < kLevels)
+    {
+        auto index = (tick >> (kSlotBits * level)) & kSlotMask;
+        timer->index_ = static_cast<uint8_t>(index);
+        occupied_[level][index / 64] |= 1ULL << (index % 64);
+    }
+    auto &head = listOf(timer);
+    timer->prev_ = nullptr;
+    timer->next_ = head;
+    if (head)
+        head->prev_ = timer;
+    head = timer;
+    timer->linked_ = true;
+    ++timerCount_;
+}
+
+void TimerQueue::unlink(Timer *timer)
+{
+    auto &head = listOf(timer);
+    if (timer->prev_)
+        timer->prev_->next_ = timer->next_;
     else
+        head = timer->next_;
+    if (timer->next_)
+        timer->next_->prev_ = timer->prev_;
+    if (!head && timer->level_ < kLevels)
     {
-        return howMuchTimeFromNow(timers_.top()->when());
+        occupied_[timer->level_][timer->index_ / 64] &=
+            ~(1ULL << (timer->index_ % 64));
     }
+    timer->prev_ = nullptr;
+    timer->next_ = nullptr;
+    timer->linked_ = false;
+    --timerCount_;
 }
-#endif
 
-std::vector<TimerPtr> TimerQueue::getExpired(const TimePoint &now)
+size_t TimerQueue::findSlot(size_t level, size_t from) const
 {
-    std::vector<TimerPtr> expired;
-    while (!timers_.empty())
+    for (size_t word = from / 64; word < kSlots / 64; ++word)
     {
-        if (timers_.top()->when() < now)
+        auto bits = occupied_[level][word];
+        if (word == from / 64)
+            bits &= ~0ULL << (from % 64);
+        if (bits)
+            return word * 64 + lowestBit(bits);
+    }
+    return kSlots;
+}
+
+uint64_t TimerQueue::nextTick() const
+{
+    if (timerCount_ == 0)
+        return kNoTick;
+    // Slots of a level behind the current one have been emptied, so the
+    // first occupied slot after it is the next one to expire or cascade.
+    for (size_t level = 0; level < kLevels; ++level)
+    {
+        auto shift = kSlotBits * level;
+        auto index = findSlot(level, ((currentTick_ >> shift) & kSlotMask) + 1);
+        if (index < kSlots)
         {
-            expired.push_back(timers_.top());
-            timers_.pop();
+            return (((currentTick_ >> shift) & ~kSlotMask) | index) << shift;
         }
-        else
-            break;
     }
-    return expired;
+    auto shift = kSlotBits * kLevels;
+    return ((currentTick_ >> shift) + 1) << shift;
 }
-void TimerQueue::reset(const std::vector<TimerPtr> &expired,
-                       const TimePoint &now)
+
+void TimerQueue::cascade(size_t level, size_t index)
 {
-    loop_->assertInLoopThread();
-    for (auto const &timerPtr : expired)
+    auto timer = slots_[level][index];
+    slots_[level][index] = nullptr;
+    occupied_[level][index / 64] &= ~(1ULL << (index % 64));
+    while (timer)
     {
-        auto iter = timerIdSet_.find(timerPtr->id());
-        if (iter != timerIdSet_.end())
+        auto next = timer->next_;
+        --timerCount_;
+        link(timer, timer->tick_);
+        timer = next;
+    }
+}
+
+void TimerQueue::advance(uint64_t tick)
+{
+    while (currentTick_ < tick)
+    {
+        auto next = nextTick();
+        if (next > tick)
         {
-            if (timerPtr->isRepeat())
+            currentTick_ = tick;
+            return;
+        }
+        currentTick_ = next;
+        if ((next & ((1ULL << (kSlotBits * kLevels)) - 1)) == 0)
+        {
+            auto timer = overflow_;
+            overflow_ = nullptr;
+            while (timer)
             {
-                timerPtr->restart(now);
-                insert(timerPtr);
+                auto nextTimer = timer->next_;
+                --timerCount_;
+                link(timer, timer->tick_);
+                timer = nextTimer;
             }
-            else
+        }
+        for (size_t level = kLevels - 1; level > 0; --level)
+        {
+            auto shift = kSlotBits * level;
+            if ((next & ((1ULL << shift) - 1)) == 0)
+                cascade(level, (next >> shift) & kSlotMask);
+        }
+        auto index = next & kSlotMask;
+        while (auto timer = slots_[0][index])
+        {
+            unlink(timer);
+            expired_.push_back(timer);
+        }
+    }
+}
+
+void TimerQueue::runExpired(const TimePoint &now)
+{
+    // Timers expire in the ticks which have fully passed.
+    auto us =
+        std::chrono::duration_cast<std::chrono::microseconds>(now - epoch_)
+            .count();
+    advance(us > 0 ? static_cast<uint64_t>(us) / 1000 : 0);
+    // Timers in a slot are not ordered.
+    if (expired_.size() > 1)
+    {
+        std::sort(expired_.begin(),
+                  expired_.end(),
+                  [](const Timer *x, const Timer *y) {
+                      return *x < *y || (!(*y < *x) && x->id() < y->id());
+                  });
+    }
+
+    callingExpiredTimers_ = true;
+    for (auto timer : expired_)
+    {
+        if (!timer->cancelled_)
+        {
+            if (loop_->recordingStats_)
             {
-                timerIdSet_.erase(iter);
+                int64_t lateness =
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        now - timer->when())
+                        .count();
+                loop_->stats_->timerLateness.record(
+                    static_cast<uint64_t>(lateness > 0 ? lateness : 0));
             }
+            timer->run();
         }
     }
-#ifdef __linux__
-    if (!timers_.empty())
+    callingExpiredTimers_ = false;
+
+    for (auto timer : expired_)
     {
-        const auto nextExpire = timers_.top()->when();
-        resetTimerfd(timerfd_, nextExpire);
+        if (timer->cancelled_)
+        {
+            freeTimer(timer);
+        }
+        else if (timer->isRepeat())
+        {
+            timer->restart(now);
+            link(timer, (std::max)(tickOf(timer->when()), currentTick_ + 1));
+        }
+        else
+        {
+            timers_.erase(timer->id());
+            freeTimer(timer);
+        }
     }
+    expired_.clear();
+    updateTimeout();
+}
+
+void TimerQueue::updateTimeout()
+{
+    scheduledTick_ = nextTick();
+#ifdef __linux__
+    if (scheduledTick_ != kNoTick)
+        resetTimerfd(timerfd_, timeOf(scheduledTick_));
 #endif
 }
+
+#ifndef __linux__
+int64_t TimerQueue::getTimeout() const
+{
+    loop_->assertInLoopThread();
+    if (scheduledTick_ == kNoTick)
+    {
+        return 10000;
+    }
+    else
+    {
+        return howMuchTimeFromNow(timeOf(scheduledTick_));
+    }
+}
+#endif
@@ -17,24 +17,25 @@
 #include <trantor/utils/NonCopyable.h>
 #include <trantor/net/callbacks.h>
 #include "Timer.h"
-#include <queue>
 #include <memory>
 #include <atomic>
-#include <unordered_set>
+#include <unordered_map>
+#include <vector>
 namespace trantor
 {
 // class Timer;
 class EventLoop;
 class Channel;
-using TimerPtr = std::shared_ptr<Timer>;
-struct TimerPtrComparer
-{
-    bool operator()(const TimerPtr &x, const TimerPtr &y) const
-    {
-        return *x > *y;
-    }
-};
 
+/**
+ * @brief Timers of an event loop in a hierarchical timing wheel.
+ *
+ * The wheel has 4 levels of 256 slots, a slot of the lowest level is one
+ * millisecond, and timers beyond the range of the highest level (about 49
+ * days) wait in an overflow list. Timers are moved to lower levels when the
+ * time reaches their slots, so adding and cancelling a timer take constant
+ * time. Timers are allocated from a pool of the queue.
+ */
 class TimerQueue : NonCopyable
 {
   public:
@@ -46,7 +47,6 @@ class TimerQueue : NonCopyable
     TimerId addTimer(TimerCallback &&cb,
                      const TimePoint &when,
                      const TimeInterval &interval);
-    void addTimerInLoop(const TimerPtr &timer);
     void invalidateTimer(TimerId id);
 #ifdef __linux__
     void reset();
@@ -61,16 +61,46 @@ class TimerQueue : NonCopyable
     std::shared_ptr<Channel> timerfdChannelPtr_;
     void handleRead();
 #endif
-    std::priority_queue<TimerPtr, std::vector<TimerPtr>, TimerPtrComparer>
-        timers_;
-
     bool callingExpiredTimers_;
-    bool insert(const TimerPtr &timePtr);
-    std::vector<TimerPtr> getExpired();
-    void reset(const std::vector<TimerPtr> &expired, const TimePoint &now);
-    std::vector<TimerPtr> getExpired(const TimePoint &now);
+    void addTimerInLoop(TimerCallback &&cb,
+                        const TimePoint &when,
+                        const TimeInterval &interval,
+                        TimerId id);
+    void runExpired(const TimePoint &now);
 
   private:
-    std::unordered_set<uint64_t> timerIdSet_;
+    static constexpr size_t kLevels = 4;
+    static constexpr size_t kSlotBits = 8;
+    static constexpr size_t kSlots = 1 << kSlotBits;
+    static constexpr uint64_t kSlotMask = kSlots - 1;
+    static constexpr size_t kPoolChunkSize = 256;
+    static constexpr uint64_t kNoTick = UINT64_MAX;
+
+    Timer *allocTimer();
+    void freeTimer(Timer *timer);
+    uint64_t tickOf(const TimePoint &when) const;
+    TimePoint timeOf(uint64_t tick) const;
+    void link(Timer *timer, uint64_t tick);
+    void unlink(Timer *timer);
+    Timer *&listOf(const Timer *timer);
+    // Return the next tick at which timers expire or move to lower levels.
+    uint64_t nextTick() const;
+    size_t findSlot(size_t level, size_t from) const;
+    void advance(uint64_t tick);
+    void cascade(size_t level, size_t index);
+    void updateTimeout();
+
+    TimePoint epoch_;
+    uint64_t currentTick_{0};
+    Timer *slots_[kLevels][kSlots];
+    uint64_t occupied_[kLevels][kSlots / 64];
+    Timer *overflow_{nullptr};
+    size_t timerCount_{0};
+    // The tick of the next expiration scheduled for the poller.
+    uint64_t scheduledTick_{kNoTick};
+    std::unordered_map<TimerId, Timer *> timers_;
+    std::vector<Timer *> expired_;
+    std::vector<std::unique_ptr<Timer[]>> pool_;
+    Timer *freeTimers_{nullptr};
 };
 }  // namespace trantor
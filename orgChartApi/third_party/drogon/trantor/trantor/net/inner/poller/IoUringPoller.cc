@@ -0,0 +1,644 @@
+/**
+ *
+ *  IoUringPoller.cc
+ *  An Tao
+ *
+ *  Public header file in trantor lib.
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the License file.
+ *
+ *
+ */
+
+#include "IoUringPoller.h"
+#include "Channel.h"
+#ifdef USE_IO_URING
+#include <trantor/utils/Logger.h>
+#include <assert.h>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace trantor
+{
+#ifdef USE_IO_URING
+namespace
+{
+const unsigned kRingEntries = 1024;
+// The number of provided buffers must be a power of 2.
+const unsigned kBufferCount = 64;
+const unsigned kBufferSize = 16 * 1024;
+const uint16_t kBufferGroup = 0;
+// The user data of a request is (slot + 1) << 32 | kind | sequence, 0 is
+// used by the requests without interesting completions.
+const uint64_t kKindRecv = 0x80000000u;
+const uint32_t kSeqMask = 0x7fffffffu;
+
+inline uint64_t makeUserData(size_t slot, uint64_t kind, uint32_t seq)
+{
+    return (static_cast<uint64_t>(slot + 1) << 32) | kind | (seq & kSeqMask);
+}
+
+int ioUringSetup(unsigned entries, io_uring_params *params)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int ioUringEnter(int fd,
+                 unsigned toSubmit,
+                 unsigned minComplete,
+                 unsigned flags,
+                 const void *arg,
+                 size_t argSize)
+{
+    return static_cast<int>(::syscall(
+        __NR_io_uring_enter, fd, toSubmit, minComplete, flags, arg, argSize));
+}
+
+int ioUringRegister(int fd, unsigned opcode, const void *arg, unsigned nrArgs)
+{
+    return static_cast<int>(
+        ::syscall(__NR_io_uring_register, fd, opcode, arg, nrArgs));
+}
+}  // namespace
+
+IoUringPoller::IoUringPoller(EventLoop *loop) : Poller(loop)
+{
+}
+
+IoUringPoller *IoUringPoller::newPoller(EventLoop *loop)
+{
+    std::unique_ptr<IoUringPoller> poller(new IoUringPoller(loop));
+    if (!poller->init())
+        return nullptr;
+    return poller.release();
+}
+
+IoUringPoller::~IoUringPoller()
+{
+    if (ringFd_ >= 0)
+        close(ringFd_);
+    if (bufRing_)
+        munmap(bufRing_, kBufferCount * sizeof(io_uring_buf));
+    if (sqes_)
+        munmap(sqes_, sqesSize_);
+    if (cqRing_ && cqRing_ != sqRing_)
+        munmap(cqRing_, cqRingSize_);
+    if (sqRing_)
+        munmap(sqRing_, sqRingSize_);
+}
+
+bool IoUringPoller::init()
+{
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = kRingEntries * 4;
+    // Only the loop thread submits requests and reaps completions.
+#if defined(IORING_SETUP_SINGLE_ISSUER) && defined(IORING_SETUP_DEFER_TASKRUN)
+    params.flags |= IORING_SETUP_SUBMIT_ALL | IORING_SETUP_SINGLE_ISSUER |
+                    IORING_SETUP_DEFER_TASKRUN;
+#endif
+    ringFd_ = ioUringSetup(kRingEntries, &params);
+    if (ringFd_ < 0 && errno == EINVAL)
+    {
+        // Older kernels
+        memset(&params, 0, sizeof(params));
+        params.flags = IORING_SETUP_CQSIZE;
+        params.cq_entries = kRingEntries * 4;
+        ringFd_ = ioUringSetup(kRingEntries, &params);
+    }
+    if (ringFd_ < 0)
+    {
+        LOG_SYSERR << "io_uring_setup";
+        return false;
+    }
+    if (!(params.features & IORING_FEAT_EXT_ARG) ||
+        !(params.features & IORING_FEAT_NODROP))
+    {
+        LOG_WARN << "The kernel is too old for the io_uring poller";
+        return false;
+    }
+
+    sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqRingSize_ =
+        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMmap)
+    {
+        sqRingSize_ = cqRingSize_ = (std::max)(sqRingSize_, cqRingSize_);
+    }
+    auto ring = mmap(nullptr,
+                     sqRingSize_,
+                     PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE,
+                     ringFd_,
+                     IORING_OFF_SQ_RING);
+    if (ring == MAP_FAILED)
+    {
+        LOG_SYSERR << "mmap";
+        return false;
+    }
+    sqRing_ = ring;
+    if (singleMmap)
+    {
+        cqRing_ = sqRing_;
+    }
+    else
+    {
+        ring = mmap(nullptr,
+                    cqRingSize_,
+                    PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE,
+                    ringFd_,
+                    IORING_OFF_CQ_RING);
+        if (ring == MAP_FAILED)
+        {
+            LOG_SYSERR << "mmap";
+            return false;
+        }
+        cqRing_ = ring;
+    }
+    sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+    ring = mmap(nullptr,
+                sqesSize_,
+                PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_POPULATE,
+                ringFd_,
+                IORING_OFF_SQES);
+    if (ring == MAP_FAILED)
+    {
+        LOG_SYSERR << "mmap";
+        return false;
+    }
+    sqes_ = static_cast<io_uring_sqe *>(ring);
+
+    auto sq = static_cast<char *>(sqRing_);
+    sqHead_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+    sqTail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    sqMask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    sqEntries_ = params.sq_entries;
+    sqeTail_ = *sqTail_;
+    // Entries of the submission queue are used in order, so the indirection
+    // array maps every position to the entry with the same index.
+    auto array = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    for (unsigned i = 0; i < sqEntries_; ++i)
+        array[i] = i;
+    auto cq = static_cast<char *>(cqRing_);
+    cqHead_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    cqTail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    cqMask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+    initBufferRing();
+    return true;
+}
+
+void IoUringPoller::initBufferRing()
+{
+#ifdef IORING_RECV_MULTISHOT
+    size_t ringSize = kBufferCount * sizeof(io_uring_buf);
+    auto ring = mmap(nullptr,
+                     ringSize,
+                     PROT_READ | PROT_WRITE,
+                     MAP_ANONYMOUS | MAP_PRIVATE,
+                     -1,
+                     0);
+    if (ring == MAP_FAILED)
+        return;
+    io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = reinterpret_cast<uint64_t>(ring);
+    reg.ring_entries = kBufferCount;
+    reg.bgid = kBufferGroup;
+    if (ioUringRegister(ringFd_, IORING_REGISTER_PBUF_RING, &reg, 1) < 0)
+    {
+        // Provided buffer rings need Linux 5.19+, channels are read by their
+        // owners in this case.
+        LOG_DEBUG << "Provided buffer rings are not supported";
+        munmap(ring, ringSize);
+        return;
+    }
+    bufRing_ = static_cast<io_uring_buf *>(ring);
+    // The tail of the ring overlays the reserved field of the first buffer.
+    bufRingTail_ = reinterpret_cast<uint16_t *>(static_cast<char *>(ring) +
+                                                offsetof(io_uring_buf, resv));
+    buffers_.reset(new char[kBufferCount * kBufferSize]);
+    for (unsigned i = 0; i < kBufferCount; ++i)
+        recycleBuffer(static_cast<uint16_t>(i));
+    publishBuffers();
+    recvSupported_ = true;
+#endif
+}
+
+void IoUringPoller::recycleBuffer(uint16_t bid)
+{
+    // Do not assign the whole structure, which would overwrite the tail of
+    // the ring.
+    auto &buf = bufRing_[(bufTail_ + pendingBuffers_) & (kBufferCount - 1)];
+    buf.addr = reinterpret_cast<uint64_t>(buffers_.get() +
+                                          static_cast<size_t>(bid) *
+                                              kBufferSize);
+    buf.len = kBufferSize;
+    buf.bid = bid;
+    ++pendingBuffers_;
+}
+
+void IoUringPoller::publishBuffers()
+{
+    if (pendingBuffers_ == 0)
+        return;
+    bufTail_ += pendingBuffers_;
+    pendingBuffers_ = 0;
+    __atomic_store_n(bufRingTail_, bufTail_, __ATOMIC_RELEASE);
+}
+
+io_uring_sqe *IoUringPoller::getSqe()
+{
+    if (sqeTail_ - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) >= sqEntries_)
+    {
+        // The submission queue is full, submit it without waiting.
+        if (enter(0, 0, nullptr) < 0 && (errno == EBUSY || errno == EAGAIN))
+        {
+            reapCompletions();
+            enter(0, 0, nullptr);
+        }
+        if (sqeTail_ - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) >=
+            sqEntries_)
+        {
+            LOG_FATAL << "The io_uring submission queue is full";
+            abort();
+        }
+    }
+    auto sqe = &sqes_[sqeTail_ & sqMask_];
+    ++sqeTail_;
+    memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+int IoUringPoller::enter(unsigned minComplete, unsigned flags, const void *arg)
+{
+    __atomic_store_n(sqTail_, sqeTail_, __ATOMIC_RELEASE);
+    unsigned toSubmit = sqeTail_ - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+    if (toSubmit == 0 && minComplete == 0 && flags == 0)
+        return 0;
+    return ioUringEnter(ringFd_,
+                        toSubmit,
+                        minComplete,
+                        flags,
+                        arg,
+                        arg ? sizeof(io_uring_getevents_arg) : 0);
+}
+
+void IoUringPoller::poll(int timeoutMs, ChannelList *activeChannels)
+{
+    for (auto &cancel : pendingCancels_)
+    {
+        auto sqe = getSqe();
+        sqe->opcode = cancel.first;
+        sqe->fd = -1;
+        sqe->addr = cancel.second;
+    }
+    pendingCancels_.clear();
+    // Channels may become dirty while the queue is submitted when it is full.
+    for (size_t i = 0; i < dirtySlots_.size(); ++i)
+    {
+        auto slot = dirtySlots_[i];
+        auto &entry = entries_[slot];
+        if (!entry.dirty)
+            continue;
+        entry.dirty = false;
+        if (entry.channel)
+            syncChannel(slot, entry);
+    }
+    dirtySlots_.clear();
+
+    std::vector<std::pair<size_t, uint32_t>> redeliveries;
+    redeliveries.swap(redeliveries_);
+    __kernel_timespec ts;
+    io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof(arg));
+    if (timeoutMs >= 0)
+    {
+        ts.tv_sec = timeoutMs / 1000;
+        ts.tv_nsec = (timeoutMs % 1000) * 1000000;
+        arg.ts = reinterpret_cast<uint64_t>(&ts);
+    }
+    bool ready = !redeliveries.empty() || !activeSlots_.empty() ||
+                 __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE) != *cqHead_;
+    int ret = enter(ready ? 0 : 1,
+                    IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+                    &arg);
+    if (ret < 0 && errno != EINTR && errno != ETIME && errno != EBUSY &&
+        errno != EAGAIN)
+    {
+        LOG_SYSERR << "IoUringPoller::poll()";
+    }
+    reapCompletions();
+
+    for (auto &redelivery : redeliveries)
+    {
+        auto &entry = entries_[redelivery.first];
+        if (entry.channel && entry.generation == redelivery.second &&
+            entry.channel->isReading())
+        {
+            addActiveEvents(redelivery.first, entry, POLLIN);
+        }
+    }
+    for (auto slot : activeSlots_)
+    {
+        auto &entry = entries_[slot];
+        auto channel = entry.channel;
+        if (!channel)
+            continue;
+        channel->setRevents(entry.activeEvents);
+        activeChannels->push_back(channel);
+        entry.activeEvents = 0;
+        if (channel->receivedBytes_ > 0 &&
+            (channel->recvEof_ || channel->recvErrno_ != 0))
+        {
+            redeliveries_.emplace_back(slot, entry.generation);
+        }
+    }
+    activeSlots_.clear();
+}
+
+void IoUringPoller::reapCompletions()
+{
+    unsigned head = *cqHead_;
+    unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+    for (; head != tail; ++head)
+    {
+        auto &cqe = cqes_[head & cqMask_];
+        onCompletion(cqe.user_data, cqe.res, cqe.flags);
+    }
+    __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+    publishBuffers();
+}
+
+void IoUringPoller::onCompletion(uint64_t userData, int res, uint32_t flags)
+{
+    bool hasBuffer = recvSupported_ && (flags & IORING_CQE_F_BUFFER);
+    uint16_t bid = static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+    size_t slot = static_cast<size_t>(userData >> 32) - 1;
+    if (userData == 0 || slot >= entries_.size())
+    {
+        if (hasBuffer)
+            recycleBuffer(bid);
+        return;
+    }
+    auto &entry = entries_[slot];
+    auto seq = static_cast<uint32_t>(userData & kSeqMask);
+    if (!(userData & kKindRecv))
+    {
+        if (!entry.channel || !entry.pollArmed ||
+            seq != (entry.pollSeq & kSeqMask))
+            return;
+        // Poll requests are one-shot, re-arm it in the next round if the
+        // channel is still interested in the events.
+        entry.pollArmed = false;
+        markDirty(slot, entry);
+        if (res > 0)
+            addActiveEvents(slot, entry, res);
+        return;
+    }
+
+#ifdef IORING_RECV_MULTISHOT
+    if (!entry.channel || seq != (entry.generation & kSeqMask))
+    {
+        if (hasBuffer)
+            recycleBuffer(bid);
+        return;
+    }
+    auto channel = entry.channel;
+    if (res > 0)
+    {
+        recvVerified_ = true;
+        auto data = buffers_.get() + static_cast<size_t>(bid) * kBufferSize;
+        if (hasBuffer && channel->recvBuffer_)
+        {
+            channel->recvBuffer_->append(data, res);
+            channel->receivedBytes_ += res;
+            addActiveEvents(slot, entry, POLLIN);
+        }
+        else if (hasBuffer)
+        {
+            // The receive buffer is detached (e.g. the connection is upgraded
+            // to TLS) but the request is not cancelled yet. The data is kept
+            // for the channel, which is notified by the last completion.
+            if (!channel->pendingRecvBuffer_)
+                channel->pendingRecvBuffer_ =
+                    std::make_unique<MsgBuffer>(static_cast<size_t>(res));
+            channel->pendingRecvBuffer_->append(data, res);
+        }
+    }
+    else if (res == 0)
+    {
+        channel->recvEof_ = true;
+        entry.recvDone = true;
+        addActiveEvents(slot, entry, POLLIN);
+    }
+    else if (res == -ENOBUFS || res == -ECANCELED)
+    {
+        // Re-armed by the final completion.
+    }
+    else if ((res == -EINVAL || res == -EOPNOTSUPP) && !recvVerified_)
+    {
+        LOG_WARN << "Multishot receiving is not supported, use poll instead";
+        recvSupported_ = false;
+        channel->receivingByPoller_ = false;
+    }
+    else
+    {
+        channel->recvErrno_ = -res;
+        entry.recvDone = true;
+        addActiveEvents(slot, entry, POLLIN);
+    }
+    if (hasBuffer)
+        recycleBuffer(bid);
+    if (!(flags & IORING_CQE_F_MORE))
+    {
+        entry.recvArmed = false;
+        entry.recvCancelled = false;
+        markDirty(slot, entry);
+        if (channel->pendingRecvBuffer())
+            addActiveEvents(slot, entry, POLLIN);
+    }
+#else
+    (void)res;
+#endif
+}
+
+void IoUringPoller::syncChannel(size_t slot, Entry &entry)
+{
+    auto channel = entry.channel;
+    channel->receivingByPoller_ =
+        recvSupported_ && channel->recvBuffer_ != nullptr;
+    auto pollEvents = static_cast<uint32_t>(channel->events());
+    bool wantRecv = false;
+    if (channel->receivingByPoller_)
+    {
+        wantRecv = (pollEvents & Channel::kReadEvent) && !entry.recvDone;
+        pollEvents &= ~static_cast<uint32_t>(Channel::kReadEvent);
+    }
+    else if (entry.recvArmed)
+    {
+        // The socket must not be read before the receive request finishes,
+        // or the data would be out of order.
+        pollEvents &= ~static_cast<uint32_t>(Channel::kReadEvent);
+    }
+
+#ifdef IORING_RECV_MULTISHOT
+    if (wantRecv && !entry.recvArmed)
+    {
+        auto sqe = getSqe();
+        sqe->opcode = IORING_OP_RECV;
+        sqe->fd = channel->fd();
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = kBufferGroup;
+        sqe->user_data = makeUserData(slot, kKindRecv, entry.generation);
+        entry.recvArmed = true;
+    }
+    else if (!wantRecv && entry.recvArmed && !entry.recvCancelled)
+    {
+        auto sqe = getSqe();
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->fd = -1;
+        sqe->addr = makeUserData(slot, kKindRecv, entry.generation);
+        entry.recvCancelled = true;
+    }
+#else
+    (void)wantRecv;
+#endif
+
+    if (entry.pollArmed && entry.armedEvents != pollEvents)
+    {
+        auto sqe = getSqe();
+        sqe->opcode = IORING_OP_POLL_REMOVE;
+        sqe->fd = -1;
+        sqe->addr = makeUserData(slot, 0, entry.pollSeq);
+        entry.pollArmed = false;
+    }
+    if (pollEvents != 0 && !entry.pollArmed)
+    {
+        auto sqe = getSqe();
+        sqe->opcode = IORING_OP_POLL_ADD;
+        sqe->fd = channel->fd();
+        sqe->poll32_events = pollEvents;
+        sqe->user_data = makeUserData(slot, 0, ++entry.pollSeq);
+        entry.pollArmed = true;
+        entry.armedEvents = pollEvents;
+    }
+}
+
+void IoUringPoller::markDirty(size_t slot, Entry &entry)
+{
+    if (!entry.dirty)
+    {
+        entry.dirty = true;
+        dirtySlots_.push_back(slot);
+    }
+}
+
+void IoUringPoller::addActiveEvents(size_t slot, Entry &entry, int events)
+{
+    if (entry.activeEvents == 0)
+        activeSlots_.push_back(slot);
+    entry.activeEvents |= events;
+}
+
+void IoUringPoller::updateChannel(Channel *channel)
+{
+    assertInLoopThread();
+    int index = channel->index();
+    if (index < 0)
+    {
+        size_t slot;
+        if (!freeSlots_.empty())
+        {
+            slot = freeSlots_.back();
+            freeSlots_.pop_back();
+        }
+        else
+        {
+            slot = entries_.size();
+            entries_.emplace_back();
+        }
+        entries_[slot].channel = channel;
+        channel->setIndex(static_cast<int>(slot));
+        channel->receivedBytes_ = 0;
+        channel->recvEof_ = false;
+        channel->recvErrno_ = 0;
+        channel->pendingRecvBuffer_.reset();
+        index = static_cast<int>(slot);
+    }
+    auto slot = static_cast<size_t>(index);
+    assert(slot < entries_.size() && entries_[slot].channel == channel);
+    channel->receivingByPoller_ =
+        recvSupported_ && channel->recvBuffer_ != nullptr;
+    markDirty(slot, entries_[slot]);
+}
+
+void IoUringPoller::removeChannel(Channel *channel)
+{
+    assertInLoopThread();
+    int index = channel->index();
+    if (index < 0)
+        return;
+    auto slot = static_cast<size_t>(index);
+    assert(slot < entries_.size() && entries_[slot].channel == channel);
+    auto &entry = entries_[slot];
+    if (entry.pollArmed)
+    {
+        pendingCancels_.emplace_back(IORING_OP_POLL_REMOVE,
+                                     makeUserData(slot, 0, entry.pollSeq));
+    }
+    if (entry.recvArmed && !entry.recvCancelled)
+    {
+        pendingCancels_.emplace_back(IORING_OP_ASYNC_CANCEL,
+                                     makeUserData(slot,
+                                                  kKindRecv,
+                                                  entry.generation));
+    }
+    // Completions of the old requests are ignored by the new generation and
+    // sequence of the slot.
+    auto generation = entry.generation + 1;
+    auto pollSeq = entry.pollSeq;
+    entry = Entry();
+    entry.generation = generation;
+    entry.pollSeq = pollSeq;
+    freeSlots_.push_back(slot);
+    channel->setIndex(-1);
+    channel->receivingByPoller_ = false;
+}
+#else
+IoUringPoller::IoUringPoller(EventLoop *loop) : Poller(loop)
+{
+}
+IoUringPoller *IoUringPoller::newPoller(EventLoop *)
+{
+    return nullptr;
+}
+IoUringPoller::~IoUringPoller()
+{
+}
+void IoUringPoller::poll(int, ChannelList *)
+{
+}
+void IoUringPoller::updateChannel(Channel *)
+{
+}
+void IoUringPoller::removeChannel(Channel *)
+{
+}
+#endif
+}  // namespace trantor
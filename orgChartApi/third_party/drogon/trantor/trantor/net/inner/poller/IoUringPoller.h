@@ -0,0 +1,128 @@
+/**
+ *
+ *  IoUringPoller.h
+ *  An Tao
+ *
+ *  Public header file in trantor lib.
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the License file.
+ *
+ *
+ */
+
+#pragma once
+
+#include "../Poller.h"
+#include <trantor/utils/NonCopyable.h>
+#include <trantor/net/EventLoop.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#ifdef IORING_FEAT_EXT_ARG
+#define USE_IO_URING
+#endif
+#endif
+#endif
+
+#ifdef USE_IO_URING
+#include <memory>
+#include <vector>
+#endif
+
+namespace trantor
+{
+class Channel;
+
+/**
+ * @brief The poller based on io_uring (Linux 5.11+).
+ *
+ * Readiness of channels is watched by one-shot poll requests, which are
+ * re-armed after their events are handled, so the semantics are the same as
+ * the level-triggered epoll. The requests are submitted in a batch by the
+ * system call waiting for completions.
+ *
+ * Channels with a receive buffer (see Channel::setRecvBuffer()) are read by
+ * multishot receive requests into a ring of provided buffers (Linux 6.0+),
+ * so data arrives without any readiness event and read() call.
+ */
+class IoUringPoller : public Poller
+{
+  public:
+    /// Return nullptr if io_uring is not supported.
+    static IoUringPoller *newPoller(EventLoop *loop);
+    virtual ~IoUringPoller();
+    virtual void poll(int timeoutMs, ChannelList *activeChannels) override;
+    virtual void updateChannel(Channel *channel) override;
+    virtual void removeChannel(Channel *channel) override;
+
+  private:
+    explicit IoUringPoller(EventLoop *loop);
+#ifdef USE_IO_URING
+    struct Entry
+    {
+        Channel *channel{nullptr};
+        // Completions of receive requests are valid for the generation of the
+        // slot, and those of poll requests for the sequence of the request.
+        uint32_t generation{0};
+        uint32_t pollSeq{0};
+        uint32_t armedEvents{0};
+        int activeEvents{0};
+        bool pollArmed{false};
+        bool recvArmed{false};
+        bool recvCancelled{false};
+        bool recvDone{false};
+        bool dirty{false};
+    };
+
+    bool init();
+    void initBufferRing();
+    io_uring_sqe *getSqe();
+    int enter(unsigned minComplete, unsigned flags, const void *arg);
+    void syncChannel(size_t slot, Entry &entry);
+    void reapCompletions();
+    void onCompletion(uint64_t userData, int res, uint32_t flags);
+    void markDirty(size_t slot, Entry &entry);
+    void addActiveEvents(size_t slot, Entry &entry, int events);
+    void recycleBuffer(uint16_t bid);
+    void publishBuffers();
+
+    int ringFd_{-1};
+    void *sqRing_{nullptr};
+    void *cqRing_{nullptr};
+    size_t sqRingSize_{0};
+    size_t cqRingSize_{0};
+    io_uring_sqe *sqes_{nullptr};
+    size_t sqesSize_{0};
+    unsigned *sqHead_{nullptr};
+    unsigned *sqTail_{nullptr};
+    unsigned sqMask_{0};
+    unsigned sqEntries_{0};
+    unsigned sqeTail_{0};
+    unsigned *cqHead_{nullptr};
+    unsigned *cqTail_{nullptr};
+    unsigned cqMask_{0};
+    io_uring_cqe *cqes_{nullptr};
+
+    // The ring of provided buffers for receive requests.
+    io_uring_buf *bufRing_{nullptr};
+    uint16_t *bufRingTail_{nullptr};
+    uint16_t bufTail_{0};
+    uint16_t pendingBuffers_{0};
+    std::unique_ptr<char[]> buffers_;
+    bool recvSupported_{false};
+    bool recvVerified_{false};
+
+    std::vector<Entry> entries_;
+    std::vector<size_t> freeSlots_;
+    std::vector<size_t> dirtySlots_;
+    std::vector<size_t> activeSlots_;
+    // Channels with data and the end of the stream received at once, the
+    // end is delivered in the next round.
+    std::vector<std::pair<size_t, uint32_t>> redeliveries_;
+    std::vector<std::pair<uint8_t, uint64_t>> pendingCancels_;
+#endif
+};
+}  // namespace trantor
@@ -0,0 +1,93 @@
+// Benchmark of the latency of log calls, text logs vs. binary logs.
+// Usage: binary_logger_test [lines]
+// Both write to an AsyncFileLogger. It prints the average time of a log call
+// and the number of bytes written per line. The cost of binary logs without
+// the file logger is measured with an output function discarding records.
+#include <trantor/utils/AsyncFileLogger.h>
+#include <trantor/utils/BinaryLogger.h>
+#include <trantor/utils/Logger.h>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <stdio.h>
+using namespace trantor;
+
+static void run(size_t lineNum, bool binary)
+{
+    std::chrono::steady_clock::time_point start, end;
+    uint64_t bytes = 0;
+    {
+        AsyncFileLogger logger;
+        logger.setFileName(binary ? "binary_logger_test"
+                                  : "text_logger_test");
+        logger.setFileSizeLimit(1024ULL * 1024 * 1024 * 1024);
+        if (binary)
+            logger.setFileHeader(BinaryLogger::fileHeader);
+        logger.startLogging();
+        auto output = [&logger, &bytes](const char *msg, const uint64_t len) {
+            bytes += len;
+            logger.output(msg, len);
+        };
+        auto flush = [&logger]() { logger.flush(); };
+        if (binary)
+            BinaryLogger::setOutputFunction(output, flush);
+        else
+            Logger::setOutputFunction(output, flush);
+        std::string name = "PersonsController";
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < lineNum; ++i)
+        {
+            if (binary)
+                BLOG_INFO("getOne personId: {} by {}", i, name);
+            else
+                LOG_INFO << "getOne personId: " << i << " by " << name;
+        }
+        end = std::chrono::steady_clock::now();
+        BinaryLogger::setOutputFunction(nullptr, nullptr);
+        Logger::setOutputFunction(
+            [](const char *msg, const uint64_t len) {
+                fwrite(msg, 1, static_cast<size_t>(len), stdout);
+            },
+            []() { fflush(stdout); });
+    }
+    std::cout << (binary ? "binary: " : "text:   ")
+              << std::chrono::duration<double, std::nano>(end - start)
+                         .count() /
+                     lineNum
+              << " ns/call, " << static_cast<double>(bytes) / lineNum
+              << " bytes/line" << std::endl;
+}
+
+static void runWithoutFile(size_t lineNum)
+{
+    uint64_t bytes = 0;
+    BinaryLogger::setOutputFunction(
+        [&bytes](const char *, const uint64_t len) { bytes += len; },
+        nullptr);
+    std::string name = "PersonsController";
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < lineNum; ++i)
+    {
+        BLOG_INFO("getOne personId: {} by {}", i, name);
+    }
+    auto end = std::chrono::steady_clock::now();
+    BinaryLogger::setOutputFunction(nullptr, nullptr);
+    std::cout << "binary without file: "
+              << std::chrono::duration<double, std::nano>(end - start)
+                         .count() /
+                     lineNum
+              << " ns/call" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t lineNum = 1000000;
+    if (argc > 1)
+        lineNum = std::stoul(argv[1]);
+    for (int round = 0; round < 2; ++round)
+    {
+        run(lineNum, false);
+        run(lineNum, true);
+        runWithoutFile(lineNum);
+    }
+}
@@ -0,0 +1,218 @@
+// Benchmark of MsgBuffer vs. ChainedBuffer on a socket pair.
+// Usage: chained_buffer_test [rounds]
+// upload: a 1MB request body is read and kept until it is complete.
+// pipelined: 160 batches of 64 small requests are sent and every request is
+// parsed as soon as its header is complete.
+// backpressure: 1MB is queued in 1KB pieces while the peer is not reading,
+// like the sending buffer of a TcpConnection, and then written.
+#include <trantor/utils/ChainedBuffer.h>
+#include <trantor/utils/MsgBuffer.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <sys/socket.h>
+#include <unistd.h>
+using namespace trantor;
+
+static constexpr size_t kUploadSize{1024 * 1024};
+static const std::string request =
+    "GET /persons/42 HTTP/1.1\r\nHost: 127.0.0.1\r\n"
+    "Authorization: Bearer 0123456789abcdef\r\n\r\n";
+static constexpr char kHeaderEnd[]{"\r\n\r\n"};
+
+struct Result
+{
+    double ms{0};
+    size_t calls{0};
+};
+
+static void report(const char *name, const char *buffer, const Result &result)
+{
+    std::cout << name << " " << buffer << ": " << result.ms << " ms, "
+              << result.calls << " syscalls" << std::endl;
+}
+
+static void writeAll(int fd, const std::string &data)
+{
+    size_t sent = 0;
+    while (sent < data.length())
+    {
+        auto n = ::write(fd, data.data() + sent, data.length() - sent);
+        if (n <= 0)
+            return;
+        sent += static_cast<size_t>(n);
+    }
+}
+
+static void readAll(int fd, size_t len)
+{
+    char buf[65536];
+    while (len > 0)
+    {
+        auto n = ::read(fd, buf, (std::min)(len, sizeof(buf)));
+        if (n <= 0)
+            return;
+        len -= static_cast<size_t>(n);
+    }
+}
+
+static double since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+template <typename Buffer>
+static Result upload(int fds[2])
+{
+    std::string body(kUploadSize, 'x');
+    Result result;
+    Buffer buffer;
+    std::thread sender([&]() { writeAll(fds[0], body); });
+    auto start = std::chrono::steady_clock::now();
+    int err = 0;
+    while (buffer.readableBytes() < kUploadSize)
+    {
+        if (buffer.readFd(fds[1], &err) <= 0)
+            break;
+        ++result.calls;
+    }
+    buffer.retrieveAll();
+    result.ms = since(start);
+    sender.join();
+    return result;
+}
+
+static bool parseOne(MsgBuffer &buffer)
+{
+    auto end = buffer.peek() + buffer.readableBytes();
+    auto pos = std::search(buffer.peek(), end, kHeaderEnd, kHeaderEnd + 4);
+    if (pos == end)
+        return false;
+    buffer.retrieve(pos + 4 - buffer.peek());
+    return true;
+}
+
+static bool parseOne(ChainedBuffer &buffer)
+{
+    // The header is parsed in one block, the data is only copied when the
+    // header crosses two slabs.
+    auto len = (std::min)(buffer.readableBytes(), size_t{4096});
+    auto begin = buffer.contiguous(len);
+    auto pos = std::search(begin, begin + len, kHeaderEnd, kHeaderEnd + 4);
+    if (pos == begin + len)
+        return false;
+    buffer.retrieve(pos + 4 - begin);
+    return true;
+}
+
+template <typename Buffer>
+static Result pipelined(int fds[2])
+{
+    constexpr size_t kBatches{160};
+    constexpr size_t kBatch{64};
+    std::string batch;
+    for (size_t i = 0; i < kBatch; ++i)
+        batch += request;
+    Result result;
+    Buffer buffer;
+    std::thread sender([&]() {
+        for (size_t i = 0; i < kBatches; ++i)
+            writeAll(fds[0], batch);
+    });
+    auto start = std::chrono::steady_clock::now();
+    int err = 0;
+    size_t parsed = 0;
+    while (parsed < kBatches * kBatch)
+    {
+        if (buffer.readFd(fds[1], &err) <= 0)
+            break;
+        ++result.calls;
+        while (parseOne(buffer))
+            ++parsed;
+    }
+    result.ms = since(start);
+    sender.join();
+    return result;
+}
+
+static ssize_t writeFd(MsgBuffer &buffer, int fd)
+{
+    auto n = ::write(fd, buffer.peek(), buffer.readableBytes());
+    if (n > 0)
+        buffer.retrieve(static_cast<size_t>(n));
+    return n;
+}
+
+static ssize_t writeFd(ChainedBuffer &buffer, int fd)
+{
+    int err = 0;
+    return buffer.writeFd(fd, &err);
+}
+
+template <typename Buffer>
+static Result backpressure(int fds[2])
+{
+    std::string piece(1024, 'x');
+    Result result;
+    Buffer buffer;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < kUploadSize / piece.length(); ++i)
+        buffer.append(piece);
+    std::thread receiver([&]() { readAll(fds[1], kUploadSize); });
+    while (buffer.readableBytes() > 0)
+    {
+        if (writeFd(buffer, fds[0]) <= 0)
+            break;
+        ++result.calls;
+    }
+    result.ms = since(start);
+    receiver.join();
+    return result;
+}
+
+template <typename Buffer>
+static void runAll(const char *name, size_t rounds)
+{
+    int fds[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+        return;
+    Result up, pipe, back;
+    for (size_t i = 0; i < rounds; ++i)
+    {
+        auto r = upload<Buffer>(fds);
+        up.ms += r.ms;
+        up.calls += r.calls;
+        r = pipelined<Buffer>(fds);
+        pipe.ms += r.ms;
+        pipe.calls += r.calls;
+        r = backpressure<Buffer>(fds);
+        back.ms += r.ms;
+        back.calls += r.calls;
+    }
+    for (auto result : {&up, &pipe, &back})
+    {
+        result->ms /= rounds;
+        result->calls /= rounds;
+    }
+    report("upload", name, up);
+    report("pipelined", name, pipe);
+    report("backpressure", name, back);
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t rounds = 20;
+    if (argc > 1)
+        rounds = std::stoul(argv[1]);
+    for (int round = 0; round < 2; ++round)
+    {
+        runAll<MsgBuffer>("MsgBuffer", rounds);
+        runAll<ChainedBuffer>("ChainedBuffer", rounds);
+    }
+}
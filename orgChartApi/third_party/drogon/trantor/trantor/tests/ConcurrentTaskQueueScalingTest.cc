@@ -0,0 +1,165 @@
+// Benchmark of the scaling of ConcurrentTaskQueue with the number of threads,
+// compared with a queue of tasks shared by all threads and guarded by one
+// mutex (the former implementation of ConcurrentTaskQueue).
+// Usage: concurrent_task_queue_scaling_test [max threads] [tasks]
+// tiny: tasks doing nothing. medium: tasks computing for about 10us.
+// external: all tasks are queued by the main thread. fan-out: 64 tasks each
+// queue a part of the tasks from the threads of the queue.
+#include <trantor/utils/ConcurrentTaskQueue.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace trantor;
+
+class MutexTaskQueue
+{
+  public:
+    explicit MutexTaskQueue(size_t threadNum)
+    {
+        for (size_t i = 0; i < threadNum; ++i)
+            threads_.emplace_back([this]() { queueFunc(); });
+    }
+    ~MutexTaskQueue()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cond_.notify_all();
+        for (auto &t : threads_)
+            t.join();
+    }
+    void runTaskInQueue(std::function<void()> &&task)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push(std::move(task));
+        cond_.notify_one();
+    }
+
+  private:
+    void queueFunc()
+    {
+        while (true)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                while (!stop_ && tasks_.empty())
+                    cond_.wait(lock);
+                if (stop_)
+                    return;
+                task = std::move(tasks_.front());
+                tasks_.pop();
+            }
+            task();
+        }
+    }
+    std::queue<std::function<void()>> tasks_;
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    bool stop_{false};
+};
+
+static std::atomic<uint64_t> sink{0};
+
+static void medium()
+{
+    uint64_t x = 88172645463325252ULL;
+    for (int i = 0; i < 4000; ++i)
+    {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+    }
+    sink += x;
+}
+
+template <typename Queue>
+static double run(size_t threads, size_t tasks, bool tiny, bool fanOut)
+{
+    Queue queue(threads);
+    std::atomic<size_t> done{0};
+    std::mutex mutex;
+    std::condition_variable cond;
+    auto task = [&]() {
+        if (!tiny)
+            medium();
+        if (++done == tasks)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            cond.notify_one();
+        }
+    };
+    auto start = std::chrono::steady_clock::now();
+    if (fanOut)
+    {
+        constexpr size_t kParents{64};
+        for (size_t i = 0; i < kParents; ++i)
+        {
+            auto count = tasks / kParents + (i < tasks % kParents ? 1 : 0);
+            queue.runTaskInQueue([&queue, &task, count]() {
+                for (size_t j = 0; j < count; ++j)
+                    queue.runTaskInQueue(task);
+            });
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < tasks; ++i)
+            queue.runTaskInQueue(task);
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cond.wait(lock, [&]() { return done == tasks; });
+    }
+    auto end = std::chrono::steady_clock::now();
+    return tasks / std::chrono::duration<double>(end - start).count();
+}
+
+struct StealingTaskQueue : public ConcurrentTaskQueue
+{
+    explicit StealingTaskQueue(size_t threadNum)
+        : ConcurrentTaskQueue(threadNum, "scaling")
+    {
+    }
+    using ConcurrentTaskQueue::runTaskInQueue;
+};
+
+int main(int argc, char *argv[])
+{
+    size_t maxThreads = 64;
+    size_t tasks = 200000;
+    if (argc > 1)
+        maxThreads = std::stoul(argv[1]);
+    if (argc > 2)
+        tasks = std::stoul(argv[2]);
+    std::cout << "hardware threads: " << std::thread::hardware_concurrency()
+              << std::endl;
+    for (auto tiny : {true, false})
+    {
+        for (auto fanOut : {false, true})
+        {
+            auto count = tiny ? tasks : tasks / 20;
+            std::cout << (tiny ? "tiny" : "medium")
+                      << (fanOut ? " fan-out" : " external") << ", " << count
+                      << " tasks, tasks/s mutex vs. stealing:" << std::endl;
+            for (size_t threads = 1; threads <= maxThreads; threads *= 2)
+            {
+                auto mutexRate =
+                    run<MutexTaskQueue>(threads, count, tiny, fanOut);
+                auto stealingRate =
+                    run<StealingTaskQueue>(threads, count, tiny, fanOut);
+                std::cout << "  " << threads << " threads: " << mutexRate
+                          << " vs. " << stealingRate << std::endl;
+            }
+        }
+    }
+}
@@ -0,0 +1,66 @@
+// Benchmark of formatting dates and log lines.
+// Usage: date_format_test [calls]
+// The dates advance by 1 microsecond per call, like the dates of logs and
+// requests of a busy server. The log lines are discarded by the output
+// function.
+#include <trantor/utils/Date.h>
+#include <trantor/utils/Logger.h>
+#include <chrono>
+#include <iostream>
+#include <string>
+using namespace trantor;
+
+template <typename Func>
+static void run(const char *name, size_t calls, Func &&func)
+{
+    auto base = Date::now().microSecondsSinceEpoch();
+    size_t length = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < calls; ++i)
+    {
+        length += func(Date(base + static_cast<int64_t>(i)));
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::cout << name << ": "
+              << std::chrono::duration<double, std::nano>(end - start)
+                         .count() /
+                     calls
+              << " ns/call (" << length / calls << " bytes)" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t calls = 2000000;
+    if (argc > 1)
+        calls = std::stoul(argv[1]);
+    size_t lineLength = 0;
+    Logger::setOutputFunction(
+        [&lineLength](const char *, const uint64_t len) {
+            lineLength = static_cast<size_t>(len);
+        },
+        []() {});
+    Logger::setLogLevel(Logger::kInfo);
+    const std::string format = "%Y-%m-%d %H:%M:%S";
+    for (int round = 0; round < 2; ++round)
+    {
+        run("toFormattedString", calls, [](const Date &date) {
+            return date.toFormattedString(true).length();
+        });
+        run("toFormattedStringLocal", calls, [](const Date &date) {
+            return date.toFormattedStringLocal(true).length();
+        });
+        run("toCustomedFormattedString", calls, [&format](const Date &date) {
+            return date.toCustomedFormattedString(format, true).length();
+        });
+        run("toCustomedFormattedStringLocal",
+            calls,
+            [&format](const Date &date) {
+                return date.toCustomedFormattedStringLocal(format, true)
+                    .length();
+            });
+        run("LOG_INFO", calls, [&lineLength](const Date &) {
+            LOG_INFO << "getOne personId: " << 42;
+            return lineLength;
+        });
+    }
+}
@@ -0,0 +1,64 @@
+// Benchmark of the overhead of the statistics of event loops.
+// Usage: event_loop_stats_test [round trips]
+// Two loops pass a function back and forth with queueInLoop(), so every round
+// trip runs two iterations of each loop, with a poll, a wakeup callback and a
+// queued function, which is the worst case of the overhead.
+#include <trantor/net/EventLoopThread.h>
+#include <trantor/utils/Logger.h>
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <string>
+using namespace trantor;
+
+static double run(EventLoop *ping, EventLoop *pong, size_t roundTrips)
+{
+    std::promise<void> done;
+    size_t count = 0;
+    std::function<void()> pingFunc;
+    std::function<void()> pongFunc = [&]() { ping->queueInLoop(pingFunc); };
+    pingFunc = [&]() {
+        if (++count == roundTrips)
+        {
+            done.set_value();
+            return;
+        }
+        pong->queueInLoop(pongFunc);
+    };
+    auto start = std::chrono::steady_clock::now();
+    ping->queueInLoop(pingFunc);
+    done.get_future().wait();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() /
+           roundTrips;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t roundTrips = 200000;
+    if (argc > 1)
+        roundTrips = std::stoul(argv[1]);
+    EventLoopThread pingThread("ping");
+    EventLoopThread pongThread("pong");
+    pingThread.run();
+    pongThread.run();
+    auto ping = pingThread.getLoop();
+    auto pong = pongThread.getLoop();
+    for (int round = 0; round < 3; ++round)
+    {
+        EventLoop::enableStats(false);
+        auto disabled = run(ping, pong, roundTrips);
+        EventLoop::enableStats(true);
+        auto enabled = run(ping, pong, roundTrips);
+        std::cout << "round trip: disabled " << disabled << " ns, enabled "
+                  << enabled << " ns (" << (enabled / disabled - 1) * 100
+                  << "%)" << std::endl;
+    }
+    auto &stats = ping->stats();
+    std::cout << "ping loop: " << stats.busyTime.count()
+              << " iterations, busy p50 " << stats.busyTime.percentile(50)
+              << " ns, poll p50 " << stats.pollTime.percentile(50)
+              << " ns, queue lag p99 " << stats.queueLag.percentile(99)
+              << " ns, max callback " << stats.callbackTime.max() << " ns"
+              << std::endl;
+}
@@ -0,0 +1,166 @@
+// Benchmark of the io_uring poller with request/response round trips on
+// persistent connections. Usage: io_uring_test [io_uring(0/1)] [connections]
+// [requests per connection]
+// It prints the number of requests per second and the number of read and
+// write system calls of the IO loop thread per request.
+#include <trantor/net/TcpServer.h>
+#include <trantor/net/EventLoopThread.h>
+#include <trantor/utils/Logger.h>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+using namespace trantor;
+
+#ifdef __linux__
+static const std::string request =
+    "GET /ping HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n";
+static const std::string response =
+    "HTTP/1.1 200 OK\r\nContent-Length: 4\r\n\r\npong";
+
+// Return the numbers of read and write system calls of the thread.
+static std::pair<size_t, size_t> syscallCounts(pid_t tid)
+{
+    std::ifstream file("/proc/self/task/" + std::to_string(tid) + "/io");
+    std::string key;
+    size_t value;
+    std::pair<size_t, size_t> counts{0, 0};
+    while (file >> key >> value)
+    {
+        if (key == "syscr:")
+            counts.first = value;
+        else if (key == "syscw:")
+            counts.second = value;
+    }
+    return counts;
+}
+#endif
+
+int main(int argc, char *argv[])
+{
+#ifdef __linux__
+    Logger::setLogLevel(Logger::kWarn);
+    bool ioUring = true;
+    size_t connNum = 16;
+    size_t requestNum = 20000;
+    if (argc > 1)
+        ioUring = std::stoi(argv[1]) != 0;
+    if (argc > 2)
+        connNum = std::stoul(argv[2]);
+    if (argc > 3)
+        requestNum = std::stoul(argv[3]);
+    EventLoop::enableIoUring(ioUring);
+
+    EventLoopThread loopThread("IoLoop");
+    loopThread.run();
+    auto loop = loopThread.getLoop();
+    std::promise<pid_t> tidPromise;
+    loop->runInLoop([&tidPromise]() {
+        tidPromise.set_value(static_cast<pid_t>(::syscall(SYS_gettid)));
+    });
+    auto tid = tidPromise.get_future().get();
+
+    TcpServer server(loop, InetAddress(8889), "test");
+    server.setRecvMessageCallback(
+        [](const TcpConnectionPtr &connPtr, MsgBuffer *buffer) {
+            while (buffer->readableBytes() >= request.length())
+            {
+                buffer->retrieve(request.length());
+                connPtr->send(response);
+            }
+        });
+    std::promise<void> started;
+    loop->runInLoop([&server, &started]() {
+        server.start();
+        started.set_value();
+    });
+    started.get_future().get();
+
+    std::atomic<size_t> failures{0};
+    auto before = syscallCounts(tid);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> clients;
+    for (size_t c = 0; c < connNum; ++c)
+    {
+        clients.emplace_back([requestNum, &failures]() {
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons(8889);
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+            int on = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+            if (::connect(fd,
+                          reinterpret_cast<sockaddr *>(&addr),
+                          sizeof(addr)) < 0)
+            {
+                LOG_SYSERR << "connect";
+                ++failures;
+                ::close(fd);
+                return;
+            }
+            char buf[256];
+            for (size_t n = 0; n < requestNum; ++n)
+            {
+                if (::write(fd, request.data(), request.length()) !=
+                    static_cast<ssize_t>(request.length()))
+                {
+                    ++failures;
+                    break;
+                }
+                size_t received = 0;
+                while (received < response.length())
+                {
+                    auto r = ::read(fd, buf, sizeof(buf));
+                    if (r <= 0)
+                        break;
+                    received += static_cast<size_t>(r);
+                }
+                if (received != response.length())
+                {
+                    ++failures;
+                    break;
+                }
+            }
+            ::close(fd);
+        });
+    }
+    for (auto &client : clients)
+        client.join();
+    auto seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+    auto after = syscallCounts(tid);
+    double total = static_cast<double>(connNum * requestNum);
+    std::cout << (ioUring ? "io_uring" : "epoll") << ": " << total
+              << " requests in " << seconds << "s, "
+              << static_cast<size_t>(total / seconds) << " requests/sec, "
+              << (after.first - before.first) / total << " reads and "
+              << (after.second - before.second) / total
+              << " writes per request, " << failures << " failures"
+              << std::endl;
+    std::promise<void> stopped;
+    loop->runInLoop([&server, &stopped]() {
+        server.stop();
+        stopped.set_value();
+    });
+    stopped.get_future().get();
+    loop->quit();
+#else
+    (void)argc;
+    (void)argv;
+    std::cout << "io_uring is only supported on Linux" << std::endl;
+#endif
+}
@@ -0,0 +1,77 @@
+// Benchmark of the cost of a LOG_DEBUG statement in a hot path, like the
+// "getOne personId" log of the orgChartApi controllers, with every way of
+// enabling or disabling it.
+// Usage: log_level_test [calls]
+// The enabled logs are formatted and discarded by the output function.
+#include <trantor/utils/Logger.h>
+#include <chrono>
+#include <iostream>
+#include <string>
+using namespace trantor;
+
+#if defined(__GNUC__)
+#define NOINLINE __attribute__((noinline))
+#else
+#define NOINLINE
+#endif
+
+static volatile int sink;
+
+static NOINLINE void getOneWithoutLog(int personId)
+{
+    sink = personId;
+}
+
+static NOINLINE void getOne(int personId)
+{
+    LOG_DEBUG << "getOne personId: " << personId;
+    sink = personId;
+}
+
+// The macros expand TRANTOR_MIN_LOG_LEVEL where they are used, this is the
+// same as building with -DTRANTOR_MIN_LOG_LEVEL=INFO.
+#undef TRANTOR_MIN_LOG_LEVEL
+#define TRANTOR_MIN_LOG_LEVEL 2
+static NOINLINE void getOneMinLevelInfo(int personId)
+{
+    LOG_DEBUG << "getOne personId: " << personId;
+    sink = personId;
+}
+
+static void run(const char *name, size_t calls, void (*handler)(int))
+{
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < calls; ++i)
+    {
+        handler(static_cast<int>(i));
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::cout << name << ": "
+              << std::chrono::duration<double, std::nano>(end - start)
+                         .count() /
+                     calls
+              << " ns/call" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t calls = 10000000;
+    if (argc > 1)
+        calls = std::stoul(argv[1]);
+    Logger::setOutputFunction([](const char *, const uint64_t) {}, []() {});
+    for (int round = 0; round < 2; ++round)
+    {
+        Logger::setLogLevel(Logger::kInfo);
+        run("no log statement", calls, getOneWithoutLog);
+        run("removed at compile time", calls, getOneMinLevelInfo);
+        run("disabled by the global level", calls, getOne);
+        Logger::setModuleLogLevel("PersonsController", Logger::kDebug);
+        run("disabled, DEBUG for another module", calls, getOne);
+        Logger::setModuleLogLevel("LogLevelTest", Logger::kDebug);
+        run("enabled for this module", calls / 10, getOne);
+        Logger::removeModuleLogLevel("LogLevelTest");
+        Logger::removeModuleLogLevel("PersonsController");
+        Logger::setLogLevel(Logger::kDebug);
+        run("enabled by the global level", calls / 10, getOne);
+    }
+}
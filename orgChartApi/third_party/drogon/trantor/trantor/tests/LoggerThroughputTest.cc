@@ -0,0 +1,75 @@
+// Benchmark of writing logs to files by AsyncFileLogger from many threads.
+// Usage: logger_throughput_test [lines] [max threads]
+// For 1, 2, 4, ... threads, it writes the lines (in total) with LOG_INFO and
+// with AsyncFileLogger::output() directly, and prints the number of lines per
+// second, including the time of writing all of them to the file.
+#include <trantor/utils/AsyncFileLogger.h>
+#include <trantor/utils/Logger.h>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+using namespace trantor;
+
+static size_t run(size_t threadNum, size_t lineNum, bool direct)
+{
+    auto start = std::chrono::steady_clock::now();
+    {
+        AsyncFileLogger logger;
+        logger.setFileName("logger_throughput_test");
+        logger.setFileSizeLimit(1024 * 1024 * 1024);
+        logger.startLogging();
+        Logger::setOutputFunction(
+            [&logger](const char *msg, const uint64_t len) {
+                logger.output(msg, len);
+            },
+            [&logger]() { logger.flush(); });
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < threadNum; ++t)
+        {
+            threads.emplace_back([&logger, lineNum, threadNum, direct]() {
+                const std::string line =
+                    "20221010 08:00:00.000000 UTC 12345 INFO getOne "
+                    "personId: 1234 - PersonsController.cc:42\n";
+                for (size_t i = 0; i < lineNum / threadNum; ++i)
+                {
+                    if (direct)
+                        logger.output(line.data(), line.length());
+                    else
+                        LOG_INFO << "getOne personId: " << i;
+                }
+            });
+        }
+        for (auto &thread : threads)
+            thread.join();
+        Logger::setOutputFunction(
+            [](const char *msg, const uint64_t len) {
+                fwrite(msg, 1, static_cast<size_t>(len), stdout);
+            },
+            []() { fflush(stdout); });
+    }
+    auto seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+    return static_cast<size_t>(lineNum / seconds);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t lineNum = 4000000;
+    size_t maxThreads = 32;
+    if (argc > 1)
+        lineNum = std::stoul(argv[1]);
+    if (argc > 2)
+        maxThreads = std::stoul(argv[2]);
+    for (size_t threadNum = 1; threadNum <= maxThreads; threadNum *= 2)
+    {
+        auto logLines = run(threadNum, lineNum, false);
+        auto outputLines = run(threadNum, lineNum, true);
+        std::cout << threadNum << " threads: LOG_INFO " << logLines
+                  << " lines/sec, output() " << outputLines << " lines/sec"
+                  << std::endl;
+    }
+}
@@ -0,0 +1,131 @@
+// Benchmark of accepting connections by one SO_REUSEPORT socket per event
+// loop. Usage: reuse_port_test [loops] [connections] [steering(0/1)]
+// It prints the number of connections per second and the number of
+// connections accepted by every loop.
+#include <trantor/net/TcpServer.h>
+#include <trantor/net/EventLoopThread.h>
+#include <trantor/utils/Logger.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+using namespace trantor;
+
+int main(int argc, char *argv[])
+{
+#ifdef __linux__
+    Logger::setLogLevel(Logger::kWarn);
+    size_t loopNum = std::thread::hardware_concurrency();
+    size_t connNum = 100000;
+    bool steering = true;
+    if (argc > 1)
+        loopNum = std::stoul(argv[1]);
+    if (argc > 2)
+        connNum = std::stoul(argv[2]);
+    if (argc > 3)
+        steering = std::stoi(argv[3]) != 0;
+
+    std::vector<std::unique_ptr<EventLoopThread>> loopThreads;
+    std::vector<std::unique_ptr<TcpServer>> servers;
+    std::unique_ptr<std::atomic<size_t>[]> counts(
+        new std::atomic<size_t>[loopNum]);
+    std::atomic<size_t> total{0};
+    std::promise<void> allAccepted;
+    InetAddress addr(8888);
+    for (size_t i = 0; i < loopNum; ++i)
+    {
+        counts[i] = 0;
+        loopThreads.emplace_back(new EventLoopThread("AcceptLoop"));
+        loopThreads.back()->setCpuAffinity(i);
+        servers.emplace_back(
+            new TcpServer(loopThreads.back()->getLoop(), addr, "test"));
+        if (steering)
+            servers.back()->setReusePortCpuSteering(loopNum);
+        servers.back()->setConnectionCallback(
+            [&counts, &total, &allAccepted, connNum, i](
+                const TcpConnectionPtr &connPtr) {
+                if (connPtr->connected())
+                {
+                    ++counts[i];
+                    if (++total == connNum)
+                        allAccepted.set_value();
+                    connPtr->forceClose();
+                }
+            });
+        servers.back()->start();
+    }
+    // Start listening in order, so the i-th socket of the reuseport group
+    // belongs to the i-th loop.
+    for (auto &loopThread : loopThreads)
+    {
+        loopThread->run();
+        std::promise<void> listened;
+        loopThread->getLoop()->queueInLoop(
+            [&listened]() { listened.set_value(); });
+        listened.get_future().get();
+    }
+
+    size_t clientNum = (std::max)(loopNum, static_cast<size_t>(4));
+    std::vector<std::thread> clients;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t c = 0; c < clientNum; ++c)
+    {
+        clients.emplace_back([c, clientNum, connNum]() {
+            sockaddr_in server{};
+            server.sin_family = AF_INET;
+            server.sin_port = htons(8888);
+            server.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            for (size_t n = c; n < connNum; n += clientNum)
+            {
+                int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+                if (::connect(fd,
+                              reinterpret_cast<sockaddr *>(&server),
+                              sizeof(server)) < 0)
+                {
+                    LOG_SYSERR << "connect";
+                }
+                ::close(fd);
+            }
+        });
+    }
+    for (auto &client : clients)
+        client.join();
+    allAccepted.get_future().get();
+    auto seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+    std::cout << connNum << " connections in " << seconds << "s, "
+              << static_cast<size_t>(connNum / seconds)
+              << " connections/sec, steering " << (steering ? "on" : "off")
+              << std::endl;
+    for (size_t i = 0; i < loopNum; ++i)
+    {
+        std::cout << "loop " << i << ": " << counts[i] << std::endl;
+    }
+    for (size_t i = 0; i < loopNum; ++i)
+    {
+        std::promise<void> destroyed;
+        loopThreads[i]->getLoop()->runInLoop([&servers, &destroyed, i]() {
+            servers[i].reset();
+            destroyed.set_value();
+        });
+        destroyed.get_future().get();
+        loopThreads[i]->getLoop()->quit();
+    }
+#else
+    (void)argc;
+    (void)argv;
+    std::cout << "SO_REUSEPORT steering is only supported on Linux"
+              << std::endl;
+#endif
+}
@@ -0,0 +1,81 @@
+// Benchmark of timers. Usage: timer_queue_test [timers]
+// It adds and cancels timers with delays up to an hour, like idle timeouts
+// of connections, then runs timers with delays up to a second. It prints the
+// cost of every operation and the maximum lateness of the timers.
+// Timers of the second phase start to expire after all of them are added.
+#include <trantor/net/EventLoop.h>
+#include <trantor/utils/Logger.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+using namespace trantor;
+
+static double nsPerOp(std::chrono::steady_clock::time_point start,
+                      size_t count)
+{
+    return std::chrono::duration<double, std::nano>(
+               std::chrono::steady_clock::now() - start)
+               .count() /
+           count;
+}
+
+int main(int argc, char *argv[])
+{
+    Logger::setLogLevel(Logger::kWarn);
+    size_t timerNum = 1000000;
+    if (argc > 1)
+        timerNum = std::stoul(argv[1]);
+    EventLoop loop;
+    std::mt19937 rng(42);
+    std::vector<TimerId> ids;
+    ids.reserve(timerNum);
+    size_t fired = 0;
+    double maxLateness = 0;
+    std::chrono::steady_clock::time_point start;
+    loop.queueInLoop([&]() {
+        std::uniform_real_distribution<double> longDelay(1.0, 3600.0);
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < timerNum; ++i)
+        {
+            ids.push_back(loop.runAfter(longDelay(rng), []() {}));
+        }
+        std::cout << "add: " << nsPerOp(start, timerNum) << " ns/timer"
+                  << std::endl;
+        start = std::chrono::steady_clock::now();
+        for (auto id : ids)
+        {
+            loop.invalidateTimer(id);
+        }
+        std::cout << "cancel: " << nsPerOp(start, timerNum) << " ns/timer"
+                  << std::endl;
+
+        std::uniform_real_distribution<double> shortDelay(2.0, 3.0);
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < timerNum; ++i)
+        {
+            auto delay = shortDelay(rng);
+            auto when = std::chrono::steady_clock::now() +
+                        std::chrono::duration_cast<
+                            std::chrono::steady_clock::duration>(
+                            std::chrono::duration<double>(delay));
+            loop.runAfter(delay, [&, when]() {
+                auto lateness = std::chrono::duration<double, std::milli>(
+                                    std::chrono::steady_clock::now() - when)
+                                    .count();
+                maxLateness = (std::max)(maxLateness, lateness);
+                if (++fired == timerNum)
+                {
+                    std::cout << "run: " << timerNum << " timers in "
+                              << nsPerOp(start, 1) / 1e9
+                              << "s including the delays, max lateness "
+                              << maxLateness << " ms" << std::endl;
+                    loop.quit();
+                }
+            });
+        }
+    });
+    loop.loop();
+}
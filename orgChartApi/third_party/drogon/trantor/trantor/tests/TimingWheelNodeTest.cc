@@ -0,0 +1,99 @@
+// Benchmark of refreshing idle timeouts of keep-alive connections in a
+// timing wheel. Usage: timing_wheel_node_test [connections] [rounds]
+// Every round refreshes all connections in random order, one refresh per
+// request, and the wheel ticks between rounds. It prints the cost of a
+// refresh with nodes embedded in connections and with shared entries.
+#include <trantor/utils/TimingWheel.h>
+#include <trantor/net/EventLoop.h>
+#include <trantor/utils/Logger.h>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+using namespace trantor;
+
+struct Connection
+{
+    TimingWheel::Node node;
+    std::shared_ptr<TimingWheel::CallbackEntry> entry;
+};
+
+int main(int argc, char *argv[])
+{
+    Logger::setLogLevel(Logger::kWarn);
+    size_t connNum = 200000;
+    size_t rounds = 10;
+    if (argc > 1)
+        connNum = std::stoul(argv[1]);
+    if (argc > 2)
+        rounds = std::stoul(argv[2]);
+    const double tick = 0.02;
+    const size_t idleTimeout = 60;
+    EventLoop loop;
+    TimingWheel wheel(&loop, idleTimeout, static_cast<float>(tick));
+    std::vector<Connection> connections(connNum);
+    size_t kicked = 0;
+    for (auto &conn : connections)
+    {
+        conn.node.setCallback([&kicked]() { ++kicked; });
+        conn.entry = std::make_shared<TimingWheel::CallbackEntry>(
+            [&kicked]() { ++kicked; });
+    }
+    std::vector<size_t> order(connNum);
+    std::iota(order.begin(), order.end(), 0);
+    std::mt19937 rng(42);
+
+    double nodeTime = 0;
+    double entryTime = 0;
+    size_t round = 0;
+    std::function<void()> runRound = [&]() {
+        std::shuffle(order.begin(), order.end(), rng);
+        auto start = std::chrono::steady_clock::now();
+        for (auto i : order)
+        {
+            wheel.insertNode(idleTimeout, &connections[i].node);
+        }
+        auto middle = std::chrono::steady_clock::now();
+        for (auto i : order)
+        {
+            wheel.insertEntry(idleTimeout, connections[i].entry);
+        }
+        auto end = std::chrono::steady_clock::now();
+        nodeTime += std::chrono::duration<double>(middle - start).count();
+        entryTime += std::chrono::duration<double>(end - middle).count();
+        if (++round < rounds)
+        {
+            loop.runAfter(tick * 1.5, runRound);
+            return;
+        }
+        double refreshes = static_cast<double>(connNum * rounds);
+        std::cout << connNum << " connections, " << rounds << " rounds"
+                  << std::endl;
+        std::cout << "embedded nodes: " << nodeTime * 1e9 / refreshes
+                  << " ns/refresh" << std::endl;
+        std::cout << "shared entries: " << entryTime * 1e9 / refreshes
+                  << " ns/refresh" << std::endl;
+        for (auto &conn : connections)
+        {
+            conn.node.unlink();
+        }
+        loop.quit();
+    };
+    loop.queueInLoop(runRound);
+    loop.loop();
+    // The shared entries are released with the wheel.
+    for (auto &conn : connections)
+    {
+        conn.entry.reset();
+    }
+    if (kicked != 0)
+    {
+        LOG_ERROR << kicked << " connections are kicked off before timeout";
+        return 1;
+    }
+}
@@ -0,0 +1,69 @@
+/**
+ *
+ *  LogDecode.cc
+ *  An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the License file.
+ *
+ *
+ */
+
+// trantor_logdecode [--json] file...
+// Decode binary log files written by trantor::BinaryLogger to the standard
+// output, as text lines in the format of trantor::Logger or as JSON lines.
+#include <trantor/utils/BinaryLogger.h>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <string.h>
+
+int main(int argc, char *argv[])
+{
+    auto format = trantor::BinaryLogDecoder::kText;
+    int fileNum = 0;
+    int ret = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--json") == 0)
+        {
+            format = trantor::BinaryLogDecoder::kJson;
+            continue;
+        }
+        if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0)
+        {
+            fileNum = 0;
+            break;
+        }
+        ++fileNum;
+    }
+    if (fileNum == 0)
+    {
+        std::cerr << "usage: " << argv[0] << " [--json] file..." << std::endl;
+        return 1;
+    }
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--json") == 0)
+            continue;
+        std::ifstream in(argv[i], std::ios::binary);
+        if (!in)
+        {
+            std::cerr << argv[i] << ": cannot open the file" << std::endl;
+            ret = 1;
+            continue;
+        }
+        std::string data((std::istreambuf_iterator<char>(in)),
+                         std::istreambuf_iterator<char>());
+        trantor::BinaryLogDecoder decoder(format);
+        if (!decoder.decode(data.data(), data.length(), std::cout))
+        {
+            std::cerr << argv[i] << ": not a binary log or corrupted"
+                      << std::endl;
+            ret = 1;
+        }
+    }
+    return ret;
+}
@@ -0,0 +1,128 @@
+#include <trantor/utils/AsyncFileLogger.h>
+#include <gtest/gtest.h>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#ifndef _WIN32
+#include <dirent.h>
+#include <stdlib.h>
+#include <unistd.h>
+using namespace trantor;
+
+namespace
+{
+struct LogDir
+{
+    LogDir()
+    {
+        char tmpl[] = "/tmp/trantor_logger_XXXXXX";
+        path = mkdtemp(tmpl);
+        path += "/";
+    }
+    ~LogDir()
+    {
+        for (auto &file : files())
+            unlink(file.c_str());
+        rmdir(path.c_str());
+    }
+    std::vector<std::string> files() const
+    {
+        std::vector<std::string> result;
+        auto dir = opendir(path.c_str());
+        while (auto entry = readdir(dir))
+        {
+            std::string name = entry->d_name;
+            if (name != "." && name != "..")
+                result.push_back(path + name);
+        }
+        closedir(dir);
+        return result;
+    }
+    std::vector<std::string> lines() const
+    {
+        std::vector<std::string> result;
+        for (auto &file : files())
+        {
+            std::ifstream in(file);
+            std::string line;
+            while (std::getline(in, line))
+                result.push_back(line);
+        }
+        return result;
+    }
+    std::string path;
+};
+}  // namespace
+
+TEST(AsyncFileLoggerTest, ThreadsKeepOrder)
+{
+    LogDir dir;
+    constexpr int kThreads = 8;
+    constexpr int kLines = 20000;
+    {
+        AsyncFileLogger logger;
+        logger.setFileName("order", ".log", dir.path);
+        logger.setFileSizeLimit(1024 * 1024 * 1024);
+        logger.startLogging();
+        std::vector<std::thread> threads;
+        for (int t = 0; t < kThreads; ++t)
+        {
+            threads.emplace_back([&logger, t]() {
+                for (int i = 0; i < kLines; ++i)
+                {
+                    auto line = std::to_string(t) + " " + std::to_string(i) +
+                                " " + std::string(i % 50, 'x') + "\n";
+                    logger.output(line.data(), line.length());
+                    if (i % 5000 == 0)
+                        logger.flush();
+                }
+            });
+        }
+        for (auto &thread : threads)
+            thread.join();
+        // Lines written after the threads exited come from a new buffer.
+        std::string last = "main\n";
+        logger.output(last.data(), last.length());
+    }
+    auto lines = dir.lines();
+    ASSERT_EQ(lines.size(), static_cast<size_t>(kThreads * kLines + 1));
+    std::vector<int> next(kThreads, 0);
+    for (auto &line : lines)
+    {
+        if (line == "main")
+            continue;
+        auto space = line.find(' ');
+        auto t = std::stoi(line.substr(0, space));
+        auto i = std::stoi(line.substr(space + 1));
+        ASSERT_EQ(i, next[t]);
+        ++next[t];
+    }
+}
+
+TEST(AsyncFileLoggerTest, Rotation)
+{
+    LogDir dir;
+    constexpr int kLines = 100000;
+    {
+        AsyncFileLogger logger;
+        logger.setFileName("rotation", ".log", dir.path);
+        logger.setFileSizeLimit(512 * 1024);
+        logger.setSyncPolicy(AsyncFileLogger::kSyncOnRotation);
+        logger.startLogging();
+        for (int i = 0; i < kLines; ++i)
+        {
+            auto line = std::to_string(i) + " rotation test\n";
+            logger.output(line.data(), line.length());
+        }
+    }
+    EXPECT_GT(dir.files().size(), 2u);
+    EXPECT_EQ(dir.lines().size(), static_cast<size_t>(kLines));
+}
+#endif
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,128 @@
+#include <trantor/utils/BinaryLogger.h>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+using namespace trantor;
+
+namespace
+{
+std::string output;
+enum class Color
+{
+    kRed = 1,
+    kGreen
+};
+
+std::string decode(const std::string &data,
+                   BinaryLogDecoder::Format format = BinaryLogDecoder::kText,
+                   bool *ok = nullptr)
+{
+    BinaryLogDecoder decoder(format);
+    std::ostringstream os;
+    auto result = decoder.decode(data.data(), data.length(), os);
+    if (ok)
+        *ok = result;
+    return os.str();
+}
+
+void logAll()
+{
+    BLOG_INFO("getOne personId: {}", 42);
+    BLOG_WARN("name {} age {} score {} ok {} grade {}",
+              std::string("bob"),
+              -7,
+              2.5,
+              true,
+              'A');
+    const char *title = "quote\" and\nnewline";
+    BLOG_ERROR("title {} color {} extra",
+               title,
+               Color::kGreen,
+               18446744073709551615ULL);
+    BLOG_DEBUG("no arguments");
+}
+}  // namespace
+
+class BinaryLoggerTest : public testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        output.clear();
+        BinaryLogger::setOutputFunction(
+            [](const char *msg, const uint64_t len) {
+                output.append(msg, static_cast<size_t>(len));
+            },
+            []() {});
+    }
+};
+
+TEST_F(BinaryLoggerTest, Text)
+{
+    logAll();
+    auto text = decode(BinaryLogger::fileHeader() + output);
+    EXPECT_NE(text.find(" INFO  getOne personId: 42 - "
+                        "BinaryLoggerUnittest.cc:"),
+              std::string::npos);
+    EXPECT_NE(text.find(" WARN  name bob age -7 score 2.5 ok 1 grade A"),
+              std::string::npos);
+    EXPECT_NE(text.find(" ERROR title quote\" and\nnewline color 2 extra "
+                        "18446744073709551615 - "),
+              std::string::npos);
+    EXPECT_NE(text.find(" DEBUG no arguments - "), std::string::npos);
+    // The time is decoded from the calibration records.
+    auto today = Date::now().toFormattedString(false).substr(0, 8);
+    EXPECT_EQ(text.substr(0, 8), today);
+}
+
+TEST_F(BinaryLoggerTest, Json)
+{
+    logAll();
+    auto json = decode(BinaryLogger::fileHeader() + output,
+                       BinaryLogDecoder::kJson);
+    EXPECT_NE(json.find("\"level\":\"WARN\",\"file\":"
+                        "\"BinaryLoggerUnittest.cc\""),
+              std::string::npos);
+    EXPECT_NE(json.find("\"args\":[\"bob\",-7,2.5,true,\"A\"]"),
+              std::string::npos);
+    EXPECT_NE(json.find("\"message\":\"title quote\\\" and\\nnewline color 2 "
+                        "extra 18446744073709551615\""),
+              std::string::npos);
+}
+
+TEST_F(BinaryLoggerTest, Segments)
+{
+    // Sites registered before the header are only in the header.
+    logAll();
+    auto data = BinaryLogger::fileHeader();
+    output.clear();
+    logAll();
+    data += output + "3 log information is lost\n";
+    data += BinaryLogger::fileHeader();
+    output.clear();
+    BLOG_INFO("second process {}", 1);
+    data += output;
+    bool ok;
+    auto text = decode(data, BinaryLogDecoder::kText, &ok);
+    EXPECT_TRUE(ok);
+    EXPECT_NE(text.find("3 log information is lost\n"), std::string::npos);
+    EXPECT_NE(text.find("second process 1"), std::string::npos);
+    EXPECT_NE(text.find("getOne personId: 42"), std::string::npos);
+}
+
+TEST_F(BinaryLoggerTest, Corrupted)
+{
+    logAll();
+    auto data = BinaryLogger::fileHeader() + output;
+    bool ok;
+    decode(data.substr(0, data.length() - 3), BinaryLogDecoder::kText, &ok);
+    EXPECT_FALSE(ok);
+    decode("plain text\n", BinaryLogDecoder::kText, &ok);
+    EXPECT_FALSE(ok);
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,143 @@
+#include <trantor/utils/ChainedBuffer.h>
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+using namespace trantor;
+
+namespace
+{
+std::string pattern(size_t len)
+{
+    std::string data(len, '\0');
+    for (size_t i = 0; i < len; ++i)
+        data[i] = static_cast<char>('a' + i % 26);
+    return data;
+}
+
+std::string content(const ChainedBuffer &buffer)
+{
+    struct iovec vec[64];
+    auto count = buffer.peek(vec, 64);
+    std::string data;
+    for (size_t i = 0; i < count; ++i)
+        data.append(static_cast<const char *>(vec[i].iov_base),
+                    vec[i].iov_len);
+    return data;
+}
+}  // namespace
+
+TEST(ChainedBufferTest, AppendAndRetrieve)
+{
+    ChainedBuffer buffer;
+    EXPECT_EQ(buffer.readableBytes(), 0);
+    struct iovec vec[4];
+    EXPECT_EQ(buffer.peek(vec, 4), 0);
+
+    auto data = pattern(ChainedBuffer::kSlabSize * 2 + 100);
+    buffer.append(data.data(), 100);
+    buffer.append(data.data() + 100, data.length() - 100);
+    EXPECT_EQ(buffer.readableBytes(), data.length());
+    EXPECT_EQ(buffer.slabCount(), 3);
+    EXPECT_EQ(buffer.peek(vec, 4), 3);
+    EXPECT_EQ(vec[0].iov_len, ChainedBuffer::kSlabSize);
+    EXPECT_EQ(vec[2].iov_len, 100);
+    EXPECT_EQ(content(buffer), data);
+
+    buffer.retrieve(10);
+    EXPECT_EQ(content(buffer), data.substr(10));
+    buffer.retrieve(ChainedBuffer::kSlabSize);
+    EXPECT_EQ(buffer.slabCount(), 2);
+    EXPECT_EQ(content(buffer), data.substr(ChainedBuffer::kSlabSize + 10));
+    // Only the first blocks are returned when the array is small.
+    EXPECT_EQ(buffer.peek(vec, 1), 1);
+    EXPECT_EQ(vec[0].iov_len, ChainedBuffer::kSlabSize - 10);
+
+    buffer.retrieve(buffer.readableBytes());
+    EXPECT_EQ(buffer.readableBytes(), 0);
+    EXPECT_EQ(buffer.slabCount(), 0);
+    buffer.append("hello");
+    EXPECT_EQ(content(buffer), "hello");
+    buffer.retrieve(2);
+    EXPECT_EQ(content(buffer), "llo");
+    buffer.retrieveAll();
+    EXPECT_EQ(buffer.readableBytes(), 0);
+    EXPECT_EQ(buffer.slabCount(), 0);
+}
+
+TEST(ChainedBufferTest, Contiguous)
+{
+    ChainedBuffer buffer;
+    auto data = pattern(ChainedBuffer::kSlabSize + 1000);
+    buffer.append(data);
+    // Data in the first slab is not copied.
+    auto first = buffer.contiguous(100);
+    struct iovec vec[2];
+    buffer.peek(vec, 2);
+    EXPECT_EQ(first, vec[0].iov_base);
+    EXPECT_EQ(std::string(first, 100), data.substr(0, 100));
+
+    buffer.retrieve(ChainedBuffer::kSlabSize - 50);
+    auto block = buffer.contiguous(500);
+    EXPECT_EQ(std::string(block, 500),
+              data.substr(ChainedBuffer::kSlabSize - 50, 500));
+    EXPECT_EQ(content(buffer), data.substr(ChainedBuffer::kSlabSize - 50));
+}
+
+TEST(ChainedBufferTest, Move)
+{
+    ChainedBuffer buffer;
+    buffer.append("hello world");
+    ChainedBuffer other(std::move(buffer));
+    EXPECT_EQ(buffer.readableBytes(), 0);
+    EXPECT_EQ(content(other), "hello world");
+    buffer = std::move(other);
+    EXPECT_EQ(content(buffer), "hello world");
+}
+
+TEST(ChainedBufferTest, ReadAndWriteFd)
+{
+    int fds[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    auto data = pattern(50000);
+    ChainedBuffer out;
+    out.append(data);
+    ChainedBuffer in;
+    in.append("x");
+    int err = 0;
+    size_t received = 0;
+    while (out.readableBytes() > 0 || received < data.length())
+    {
+        if (out.readableBytes() > 0)
+        {
+            ASSERT_GT(out.writeFd(fds[0], &err), 0);
+        }
+        auto n = in.readFd(fds[1], &err);
+        ASSERT_GT(n, 0);
+        received += static_cast<size_t>(n);
+    }
+    EXPECT_EQ(content(in), "x" + data);
+    EXPECT_EQ(in.readableBytes(), data.length() + 1);
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+TEST(ChainedBufferTest, ThreadExit)
+{
+    std::thread([]() {
+        // Constructed before the slab pool of the thread, so it is destroyed
+        // after the pool.
+        static thread_local ChainedBuffer buffer;
+        buffer.append(pattern(ChainedBuffer::kSlabSize * 2));
+        buffer.retrieve(ChainedBuffer::kSlabSize);
+        EXPECT_EQ(buffer.slabCount(), 1);
+    }).join();
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
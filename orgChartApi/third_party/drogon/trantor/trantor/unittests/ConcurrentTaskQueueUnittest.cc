@@ -0,0 +1,100 @@
+#include <trantor/utils/ConcurrentTaskQueue.h>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <vector>
+using namespace trantor;
+
+TEST(ConcurrentTaskQueueTest, RunAllTasks)
+{
+    ConcurrentTaskQueue queue(4, "unittest");
+    std::atomic<int> sum{0};
+    for (int i = 0; i < 10000; ++i)
+    {
+        queue.runTaskInQueue([&sum]() { ++sum; });
+    }
+    queue.syncTaskInQueue([]() {});
+    while (queue.getTaskCount() > 0 || sum < 10000)
+        std::this_thread::yield();
+    EXPECT_EQ(sum, 10000);
+}
+
+TEST(ConcurrentTaskQueueTest, NestedTasks)
+{
+    ConcurrentTaskQueue queue(4, "unittest");
+    std::atomic<int> sum{0};
+    std::promise<void> done;
+    // Every task queues two tasks, the tasks of the last level count.
+    std::function<void(int)> fork = [&](int level) {
+        if (level == 0)
+        {
+            if (++sum == 1024)
+                done.set_value();
+            return;
+        }
+        queue.runTaskInQueue([&fork, level]() { fork(level - 1); });
+        queue.runTaskInQueue([&fork, level]() { fork(level - 1); });
+    };
+    queue.runTaskInQueue([&fork]() { fork(10); });
+    done.get_future().wait();
+    EXPECT_EQ(sum, 1024);
+}
+
+TEST(ConcurrentTaskQueueTest, Submit)
+{
+    ConcurrentTaskQueue queue(2, "unittest");
+    auto length = queue.submit([]() { return std::string("hello").length(); });
+    EXPECT_EQ(length.get(), 5);
+    auto error = queue.submit([]() -> int { throw std::runtime_error("x"); });
+    EXPECT_THROW(error.get(), std::runtime_error);
+    auto nested = queue.submit([&queue]() {
+        return queue.submit([]() { return 42; });
+    });
+    EXPECT_EQ(nested.get().get(), 42);
+}
+
+TEST(ConcurrentTaskQueueTest, Priority)
+{
+    ConcurrentTaskQueue queue(1, "unittest");
+    std::promise<void> blocked;
+    auto unblock = blocked.get_future().share();
+    std::promise<void> started;
+    queue.runTaskInQueue([unblock, &started]() {
+        started.set_value();
+        unblock.wait();
+    });
+    started.get_future().wait();
+
+    std::vector<int> order;
+    queue.runTaskInQueue([&order]() { order.push_back(3); },
+                         ConcurrentTaskQueue::Priority::kLow);
+    queue.runTaskInQueue([&order]() { order.push_back(2); });
+    queue.runTaskInQueue([&order]() { order.push_back(1); },
+                         ConcurrentTaskQueue::Priority::kHigh);
+    EXPECT_EQ(queue.getTaskCount(), 3);
+    blocked.set_value();
+    auto last = queue.submit([]() {}, ConcurrentTaskQueue::Priority::kLow);
+    last.wait();
+    EXPECT_EQ(order, (std::vector<int>{1, 2, 3}));
+    EXPECT_EQ(queue.getTaskCount(), 0);
+}
+
+TEST(ConcurrentTaskQueueTest, Stop)
+{
+    ConcurrentTaskQueue queue(3, "unittest");
+    auto future = queue.submit([]() { return 1; });
+    EXPECT_EQ(future.get(), 1);
+    queue.stop();
+    // Tasks queued after stopping are released with the queue.
+    auto counter = std::make_shared<int>(0);
+    queue.runTaskInQueue([counter]() { ++*counter; });
+    EXPECT_EQ(counter.use_count(), 2);
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -36,6 +36,28 @@ TEST(Date, DatabaseStringTest)
     ms = (dbDate.microSecondsSinceEpoch() % 1000000) / 1000;
     EXPECT_EQ(ms, 0);
 }
+TEST(Date, CachedFormatTest)
+{
+    // 2018-01-01 12:12:12 UTC
+    const int64_t second = 1514808732LL * 1000000;
+    EXPECT_EQ("20180101 12:12:12.000001",
+              trantor::Date(second + 1).toFormattedString(true));
+    EXPECT_EQ("20180101 12:12:12.123456",
+              trantor::Date(second + 123456).toFormattedString(true));
+    EXPECT_EQ("20180101 12:12:12",
+              trantor::Date(second + 999999).toFormattedString(false));
+    EXPECT_EQ("20180101 12:12:13.000000",
+              trantor::Date(second + 1000000).toFormattedString(true));
+    EXPECT_EQ("2018-01-01 12:12:12.000010",
+              trantor::Date(second + 10).toCustomedFormattedString(
+                  "%Y-%m-%d %H:%M:%S", true));
+    EXPECT_EQ("12:12:12.000010",
+              trantor::Date(second + 10).toCustomedFormattedString("%H:%M:%S",
+                                                                   true));
+    EXPECT_EQ(trantor::Date(second).toCustomedFormattedStringLocal(
+                  "%Y%m%d %H:%M:%S", true),
+              trantor::Date(second).toFormattedStringLocal(true));
+}
 int main(int argc, char **argv)
 {
     testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,125 @@
+#include <trantor/net/EventLoopThread.h>
+#include <trantor/utils/LatencyHistogram.h>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <future>
+#include <thread>
+using namespace trantor;
+
+TEST(LatencyHistogramTest, Buckets)
+{
+    for (uint64_t value = 0; value < 8; ++value)
+    {
+        EXPECT_EQ(LatencyHistogram::bucketIndex(value), value);
+        EXPECT_EQ(LatencyHistogram::bucketUpperBound(value), value);
+    }
+    EXPECT_EQ(LatencyHistogram::bucketIndex(8), 8);
+    EXPECT_EQ(LatencyHistogram::bucketIndex(16), 16);
+    EXPECT_EQ(LatencyHistogram::bucketIndex(17), 16);
+    EXPECT_EQ(LatencyHistogram::bucketUpperBound(16), 17);
+    // Every value is in a bucket with a width of at most 1/8 of the value.
+    for (uint64_t value = 1; value < (uint64_t{1} << 39); value = value * 3 + 1)
+    {
+        auto index = LatencyHistogram::bucketIndex(value);
+        auto upperBound = LatencyHistogram::bucketUpperBound(index);
+        EXPECT_GE(upperBound, value);
+        EXPECT_LE(upperBound - value, value / 8);
+        if (index > 0)
+        {
+            EXPECT_LT(LatencyHistogram::bucketUpperBound(index - 1), value);
+        }
+    }
+    EXPECT_EQ(LatencyHistogram::bucketIndex(UINT64_MAX),
+              LatencyHistogram::kBucketCount - 1);
+}
+
+TEST(LatencyHistogramTest, Percentiles)
+{
+    LatencyHistogram histogram;
+    EXPECT_EQ(histogram.percentile(50), 0);
+    for (uint64_t value = 1; value <= 1000; ++value)
+        histogram.record(value * 1000);
+    EXPECT_EQ(histogram.count(), 1000);
+    EXPECT_EQ(histogram.sum(), 500500000);
+    EXPECT_EQ(histogram.max(), 1000000);
+    auto median = histogram.percentile(50);
+    EXPECT_GE(median, 500000);
+    EXPECT_LE(median, 500000 * 9 / 8);
+    EXPECT_EQ(histogram.percentile(100), 1000000);
+    histogram.reset();
+    EXPECT_EQ(histogram.count(), 0);
+    EXPECT_EQ(histogram.max(), 0);
+    EXPECT_EQ(histogram.percentile(99), 0);
+}
+
+TEST(EventLoopStatsTest, Record)
+{
+    EventLoopThread loopThread;
+    loopThread.run();
+    auto loop = loopThread.getLoop();
+    auto &stats = loop->stats();
+
+    // Nothing is recorded by default.
+    loop->runInLoop([]() {});
+    std::promise<void> done;
+    loop->runAfter(0.01, [&done]() { done.set_value(); });
+    done.get_future().wait();
+    EXPECT_EQ(stats.busyTime.count(), 0);
+    EXPECT_EQ(stats.callbackTime.count(), 0);
+
+    EventLoop::enableStats();
+    // Wake the loop up so that it records from the next iteration.
+    std::promise<void> enabled;
+    loop->queueInLoop([&enabled]() { enabled.set_value(); });
+    enabled.get_future().wait();
+    std::promise<void> timer;
+    loop->runAfter(0.01, [&timer]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        timer.set_value();
+    });
+    timer.get_future().wait();
+    for (int i = 0; i < 10; ++i)
+    {
+        // Let the loop wait in the poller before queueing the next function.
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        std::promise<void> queued;
+        loop->queueInLoop([&queued]() { queued.set_value(); });
+        queued.get_future().wait();
+    }
+    EventLoop::enableStats(false);
+    std::promise<void> disabled;
+    loop->queueInLoop([&disabled]() { disabled.set_value(); });
+    disabled.get_future().wait();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    EXPECT_GE(stats.pollTime.count(), 10);
+    EXPECT_GE(stats.pollTime.sum(), 5000000);
+    EXPECT_GE(stats.busyTime.count(), 10);
+    EXPECT_GE(stats.activeChannels.count(), 10);
+    EXPECT_GE(stats.callbackTime.count(), 11);
+    // The timer callback slept for 2ms.
+    EXPECT_GE(stats.callbackTime.max(), 2000000);
+    EXPECT_GE(stats.busyTime.max(), 2000000);
+    EXPECT_GE(stats.queueLength.count(), 10);
+    EXPECT_GE(stats.queueLag.count(), 10);
+    EXPECT_EQ(stats.timerLateness.count(), 1);
+
+    auto count = stats.busyTime.count();
+    std::promise<void> idle;
+    loop->queueInLoop([&idle]() { idle.set_value(); });
+    idle.get_future().wait();
+    EXPECT_EQ(stats.busyTime.count(), count);
+
+    loop->resetStats();
+    std::promise<void> reset;
+    loop->queueInLoop([&reset]() { reset.set_value(); });
+    reset.get_future().wait();
+    EXPECT_EQ(stats.busyTime.count(), 0);
+    EXPECT_EQ(stats.timerLateness.count(), 0);
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
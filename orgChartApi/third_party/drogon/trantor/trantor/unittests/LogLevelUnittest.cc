@@ -0,0 +1,160 @@
+#include <trantor/utils/Logger.h>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+using namespace trantor;
+
+namespace
+{
+std::string output;
+int evaluated = 0;
+// The level set by the TRANTOR_MIN_LOG_LEVEL CMake option.
+const int buildMinLogLevel = TRANTOR_MIN_LOG_LEVEL;
+
+int evaluate()
+{
+    return ++evaluated;
+}
+
+void logAll()
+{
+    LOG_DEBUG << "debug " << evaluate();
+    LOG_INFO << "info " << evaluate();
+    LOG_WARN << "warn " << evaluate();
+}
+
+// The macros expand TRANTOR_MIN_LOG_LEVEL where they are used.
+#undef TRANTOR_MIN_LOG_LEVEL
+#define TRANTOR_MIN_LOG_LEVEL 2
+void logAllAboveDebug()
+{
+    LOG_TRACE << "trace " << evaluate();
+    LOG_DEBUG << "debug " << evaluate();
+    LOG_DEBUG_IF(true) << "debug if " << evaluate();
+    LOG_INFO << "info " << evaluate();
+}
+
+#undef TRANTOR_MIN_LOG_LEVEL
+#define TRANTOR_MIN_LOG_LEVEL 6
+void logAllFatal()
+{
+    LOG_ERROR << "error";
+    LOG_FATAL << "fatal";
+    LOG_SYSERR << "syserr";
+}
+}  // namespace
+
+class LogLevelTest : public testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        output.clear();
+        evaluated = 0;
+        Logger::setOutputFunction(
+            [](const char *msg, const uint64_t len) {
+                output.append(msg, static_cast<size_t>(len));
+            },
+            []() {});
+        Logger::setLogLevel(Logger::kInfo);
+    }
+    void TearDown() override
+    {
+        Logger::removeModuleLogLevel("LogLevelUnittest");
+        Logger::removeModuleLogLevel("PersonsController");
+        Logger::setLogLevel(Logger::kDebug);
+    }
+};
+
+TEST_F(LogLevelTest, Global)
+{
+    logAll();
+    EXPECT_EQ(output.find("debug"), std::string::npos);
+    EXPECT_NE(output.find("info 1"), std::string::npos);
+    EXPECT_NE(output.find("warn 2"), std::string::npos);
+    // The arguments of disabled logs are not evaluated.
+    EXPECT_EQ(evaluated, 2);
+    EXPECT_EQ(Logger::logLevel(__FILE__), Logger::kInfo);
+}
+
+TEST_F(LogLevelTest, Module)
+{
+    if (buildMinLogLevel > Logger::kDebug)
+        return;
+    Logger::setModuleLogLevel("PersonsController", Logger::kDebug);
+    logAll();
+    EXPECT_EQ(output.find("debug"), std::string::npos);
+    EXPECT_EQ(Logger::logLevel("src/controllers/PersonsController.cc"),
+              Logger::kDebug);
+    EXPECT_EQ(Logger::logLevel("PersonsController.h"), Logger::kDebug);
+    EXPECT_EQ(Logger::logLevel("src/PersonsControllerBase.cc"),
+              Logger::kInfo);
+
+    Logger::setModuleLogLevel("LogLevelUnittest", Logger::kDebug);
+    output.clear();
+    logAll();
+    EXPECT_NE(output.find("debug"), std::string::npos);
+    EXPECT_NE(output.find("info"), std::string::npos);
+
+    // Module levels also silence logs enabled by the global level, but not
+    // warnings.
+    Logger::setModuleLogLevel("LogLevelUnittest", Logger::kWarn);
+    output.clear();
+    logAll();
+    EXPECT_EQ(output.find("debug"), std::string::npos);
+    EXPECT_EQ(output.find("info"), std::string::npos);
+    EXPECT_NE(output.find("warn"), std::string::npos);
+
+    Logger::removeModuleLogLevel("LogLevelUnittest");
+    output.clear();
+    logAll();
+    EXPECT_EQ(output.find("debug"), std::string::npos);
+    EXPECT_NE(output.find("info"), std::string::npos);
+
+    // The global level still applies to files without a module level.
+    Logger::setLogLevel(Logger::kDebug);
+    EXPECT_EQ(Logger::logLevel(__FILE__), Logger::kDebug);
+    output.clear();
+    logAll();
+    EXPECT_NE(output.find("debug"), std::string::npos);
+}
+
+TEST_F(LogLevelTest, CompileTime)
+{
+    Logger::setLogLevel(Logger::kTrace);
+    Logger::setModuleLogLevel("LogLevelUnittest", Logger::kTrace);
+    logAllAboveDebug();
+    EXPECT_EQ(output.find("trace"), std::string::npos);
+    EXPECT_EQ(output.find("debug"), std::string::npos);
+    EXPECT_NE(output.find("info 1"), std::string::npos);
+    EXPECT_EQ(evaluated, 1);
+}
+
+TEST_F(LogLevelTest, CompileTimeFatal)
+{
+    logAllFatal();
+    EXPECT_EQ(output.find("error"), std::string::npos);
+    EXPECT_NE(output.find("fatal"), std::string::npos);
+    EXPECT_NE(output.find("syserr"), std::string::npos);
+}
+
+TEST_F(LogLevelTest, ManyFiles)
+{
+    // More files than the cache holds, the levels are looked up by the
+    // address of the file name so it must outlive the cache.
+    static std::vector<std::string> files;
+    for (int i = 0; i < 4096; ++i)
+        files.push_back("src/File" + std::to_string(i) + ".cc");
+    for (auto &file : files)
+        EXPECT_EQ(Logger::logLevel(file.c_str()), Logger::kInfo);
+    Logger::setLogLevel(Logger::kWarn);
+    for (auto &file : files)
+        EXPECT_EQ(Logger::logLevel(file.c_str()), Logger::kWarn);
+    EXPECT_EQ(Logger::logLevel(__FILE__), Logger::kWarn);
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
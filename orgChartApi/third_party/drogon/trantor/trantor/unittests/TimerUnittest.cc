@@ -0,0 +1,138 @@
+#include <trantor/net/EventLoop.h>
+#include <trantor/utils/TimingWheel.h>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace trantor;
+using namespace std::literals;
+
+TEST(Timer, OrderTest)
+{
+    EventLoop loop;
+    std::string order;
+    // 300ms is on the second level of the wheel.
+    loop.runAfter(0.3, [&]() {
+        order += "d";
+        loop.quit();
+    });
+    loop.runAfter(0.02, [&]() { order += "b"; });
+    loop.runAfter(0.001, [&]() { order += "a"; });
+    loop.runAfter(0.02, [&]() { order += "c"; });
+    auto start = std::chrono::steady_clock::now();
+    loop.loop();
+    EXPECT_EQ(order, "abcd");
+    EXPECT_GE(std::chrono::steady_clock::now() - start, 300ms);
+}
+
+TEST(Timer, InvalidateTest)
+{
+    EventLoop loop;
+    std::vector<TimerId> ids;
+    int count = 0;
+    loop.queueInLoop([&]() {
+        for (int i = 0; i < 1000; ++i)
+        {
+            ids.push_back(
+                loop.runAfter(0.001 * (i % 50), [&count]() { ++count; }));
+        }
+        for (size_t i = 0; i < ids.size(); i += 2)
+        {
+            loop.invalidateTimer(ids[i]);
+        }
+    });
+    loop.runAfter(0.1, [&]() { loop.quit(); });
+    loop.loop();
+    EXPECT_EQ(count, 500);
+}
+
+TEST(Timer, InvalidateExpiringTest)
+{
+    EventLoop loop;
+    TimerId second{InvalidTimerId};
+    bool secondRun = false;
+    // Both timers expire in the first round, the first one cancels the
+    // second one.
+    loop.runAfter(0.01, [&]() { loop.invalidateTimer(second); });
+    second = loop.runAfter(0.0101, [&]() { secondRun = true; });
+    loop.runAfter(0.05, [&]() { loop.quit(); });
+    std::this_thread::sleep_for(20ms);
+    loop.loop();
+    EXPECT_FALSE(secondRun);
+}
+
+TEST(Timer, RepeatTest)
+{
+    EventLoop loop;
+    int count = 0;
+    TimerId id{InvalidTimerId};
+    id = loop.runEvery(0.01, [&]() {
+        if (++count == 5)
+            loop.invalidateTimer(id);
+    });
+    loop.runAfter(0.2, [&]() { loop.quit(); });
+    loop.loop();
+    EXPECT_EQ(count, 5);
+}
+
+TEST(Timer, CrossThreadTest)
+{
+    EventLoop loop;
+    int count = 0;
+    std::thread thread([&]() {
+        std::this_thread::sleep_for(10ms);
+        for (int i = 0; i < 100; ++i)
+        {
+            loop.runAfter(0.001 * i, [&count]() { ++count; });
+        }
+        loop.runAfter(0.2, [&]() { loop.quit(); });
+    });
+    loop.loop();
+    thread.join();
+    EXPECT_EQ(count, 100);
+}
+
+TEST(TimingWheel, EntryHeldOnce)
+{
+    EventLoop loop;
+    std::weak_ptr<void> weakA, weakB;
+    bool aliveAt1500 = false;
+    bool releasedAt1500 = false;
+    {
+        TimingWheel wheel(&loop, 10, 0.01f);
+        {
+            auto a = std::make_shared<int>(1);
+            auto b = std::make_shared<int>(2);
+            weakA = a;
+            weakB = b;
+            // Alternating refreshes keep one node per entry.
+            for (int i = 0; i < 1000; ++i)
+            {
+                wheel.insertEntryInloop(2, a);
+                wheel.insertEntryInloop(1, b);
+            }
+            EXPECT_EQ(a.use_count(), 2);
+            EXPECT_EQ(b.use_count(), 2);
+            // A shorter delay does not cut the lifetime short.
+            wheel.insertEntryInloop(1, a);
+            EXPECT_EQ(a.use_count(), 2);
+        }
+        loop.runAfter(1.5, [&]() {
+            aliveAt1500 = !weakA.expired();
+            releasedAt1500 = weakB.expired();
+        });
+        loop.runAfter(2.5, [&]() { loop.quit(); });
+        loop.loop();
+    }
+    EXPECT_TRUE(aliveAt1500);
+    EXPECT_TRUE(releasedAt1500);
+    EXPECT_TRUE(weakA.expired());
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -15,14 +15,19 @@
 #include <trantor/utils/AsyncFileLogger.h>
 #include <trantor/utils/Utilities.h>
 #ifndef _WIN32
+#include <sys/uio.h>
 #include <unistd.h>
+#include <limits.h>
 #ifdef __linux__
 #include <sys/prctl.h>
 #endif
 #else
 #include <Windows.h>
+#include <io.h>
 #endif
 #include <string.h>
+#include <errno.h>
+#include <algorithm>
 #include <iostream>
 #include <functional>
 #include <chrono>
@@ -31,141 +36,400 @@ namespace trantor
 {
 static constexpr std::chrono::seconds kLogFlushTimeout{1};
 static constexpr size_t kMemBufferSize{4 * 1024 * 1024};
+static constexpr size_t kChunkSize{256 * 1024};
+// At most 100M bytes logs in buffers.
+static constexpr size_t kMaxChunks{400};
 extern const char *strerror_tl(int savedErrno);
+
+struct AsyncFileLogger::Chunk
+{
+    explicit Chunk(size_t cap) : data(new char[cap]), capacity(cap)
+    {
+    }
+    std::unique_ptr<char[]> data;
+    const size_t capacity;
+    // Appended by the owner thread, the bytes before it are complete.
+    std::atomic<size_t> committed{0};
+    // The bytes before it have been written by the logging thread.
+    size_t written{0};
+    uint64_t seq{0};
+    ThreadBuffer *owner{nullptr};
+    Chunk *next{nullptr};
+};
+
+struct AsyncFileLogger::ThreadBuffer
+{
+    // Both chunks are replaced only by the owner thread, the spare one is
+    // refilled by the logging thread.
+    std::atomic<Chunk *> current{nullptr};
+    std::atomic<Chunk *> spare{nullptr};
+    std::atomic<uint64_t> lostCounter{0};
+    std::atomic<bool> exited{false};
+    std::atomic<bool> closed{false};
+    // The sequence of the last chunk taken by the owner thread.
+    uint64_t seq{0};
+    // Only used in the logging thread. The sequence of the next chunk to be
+    // finished, the current chunk is written before it is full only if it is
+    // that one.
+    uint64_t nextSeq{1};
+    bool exiting{false};
+};
+
+struct AsyncFileLogger::LocalBuffers
+{
+    ~LocalBuffers();
+    std::vector<std::pair<uint64_t, std::shared_ptr<ThreadBuffer>>> buffers;
+};
+
+// Trivially destructible, so they are still valid in the destructors of
+// objects with static storage duration, and need no initialization check.
+static thread_local bool t_localBuffersDestroyed{false};
+// The buffer of the logger used last in this thread.
+static thread_local uint64_t t_lastLoggerId{0};
+static thread_local void *t_lastBuffer{nullptr};
+static std::atomic<uint64_t> s_loggerId{0};
 }  // namespace trantor
 
 using namespace trantor;
 
+AsyncFileLogger::LocalBuffers::~LocalBuffers()
+{
+    t_localBuffersDestroyed = true;
+    t_lastLoggerId = 0;
+    for (auto &buffer : buffers)
+        buffer.second->exited.store(true, std::memory_order_release);
+}
+
+AsyncFileLogger::LocalBuffers &AsyncFileLogger::localBuffers()
+{
+    static thread_local LocalBuffers buffers;
+    return buffers;
+}
+
 AsyncFileLogger::AsyncFileLogger()
-    : logBufferPtr_(new std::string), nextBufferPtr_(new std::string)
+    : id_(++s_loggerId), sharedBuffer_(std::make_shared<ThreadBuffer>())
 {
-    logBufferPtr_->reserve(kMemBufferSize);
-    nextBufferPtr_->reserve(kMemBufferSize);
+    threadBuffers_.push_back(sharedBuffer_);
 }
 
 AsyncFileLogger::~AsyncFileLogger()
 {
-    // std::cout << "~AsyncFileLogger" << std::endl;
-    stopFlag_ = true;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopFlag_ = true;
+    }
+    cond_.notify_all();
     if (threadPtr_)
     {
-        cond_.notify_all();
         threadPtr_->join();
     }
-    // std::cout << "thread exit" << std::endl;
+    writeChunks();
+    if (loggerFilePtr_ && syncPolicy_ != kNoSync)
+        loggerFilePtr_->sync();
+    std::lock_guard<std::mutex> lock(registryMutex_);
+    for (auto &buffer : threadBuffers_)
     {
-        std::lock_guard<std::mutex> guard_(mutex_);
-        if (logBufferPtr_->length() > 0)
-        {
-            writeBuffers_.push(logBufferPtr_);
-        }
-        while (!writeBuffers_.empty())
+        buffer->closed.store(true, std::memory_order_release);
+        freeChunk(buffer->current.exchange(nullptr));
+        freeChunk(buffer->spare.exchange(nullptr));
+    }
+}
+
+AsyncFileLogger::ThreadBuffer *AsyncFileLogger::threadBuffer()
+{
+    if (t_lastLoggerId == id_)
+        return static_cast<ThreadBuffer *>(t_lastBuffer);
+    ThreadBuffer *result = nullptr;
+    for (auto &buffer : localBuffers().buffers)
+    {
+        if (buffer.first == id_)
         {
-            StringPtr tmpPtr = (StringPtr &&) writeBuffers_.front();
-            writeBuffers_.pop();
-            writeLogToFile(tmpPtr);
+            result = buffer.second.get();
+            break;
         }
     }
+    if (!result)
+        result = registerThread();
+    t_lastLoggerId = id_;
+    t_lastBuffer = result;
+    return result;
+}
+
+AsyncFileLogger::ThreadBuffer *AsyncFileLogger::registerThread()
+{
+    auto &buffers = localBuffers().buffers;
+    buffers.erase(
+        std::remove_if(
+            buffers.begin(),
+            buffers.end(),
+            [](const std::pair<uint64_t, std::shared_ptr<ThreadBuffer>> &b) {
+                return b.second->closed.load(std::memory_order_acquire);
+            }),
+        buffers.end());
+    auto buffer = std::make_shared<ThreadBuffer>();
+    buffers.emplace_back(id_, buffer);
+    std::lock_guard<std::mutex> lock(registryMutex_);
+    threadBuffers_.push_back(buffer);
+    return buffer.get();
 }
 
 void AsyncFileLogger::output(const char *msg, const uint64_t len)
 {
-    std::lock_guard<std::mutex> guard_(mutex_);
     if (len > kMemBufferSize)
         return;
-    if (!logBufferPtr_)
+    std::unique_lock<std::mutex> lock;
+    ThreadBuffer *buffer;
+    if (!t_localBuffersDestroyed)
+    {
+        buffer = threadBuffer();
+    }
+    else
+    {
+        lock = std::unique_lock<std::mutex>(sharedMutex_);
+        buffer = sharedBuffer_.get();
+    }
+    auto chunk = buffer->current.load(std::memory_order_relaxed);
+    size_t pos = chunk ? chunk->committed.load(std::memory_order_relaxed) : 0;
+    if (!chunk || chunk->capacity - pos < len)
+    {
+        chunk = switchChunk(buffer, static_cast<size_t>(len));
+        if (!chunk)
+        {
+            buffer->lostCounter.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        pos = 0;
+    }
+    memcpy(chunk->data.get() + pos, msg, static_cast<size_t>(len));
+    chunk->committed.store(pos + static_cast<size_t>(len),
+                           std::memory_order_release);
+}
+
+AsyncFileLogger::Chunk *AsyncFileLogger::switchChunk(ThreadBuffer *buffer,
+                                                     size_t len)
+{
+    Chunk *chunk = nullptr;
+    if (len <= kChunkSize)
+    {
+        chunk = buffer->spare.exchange(nullptr, std::memory_order_acquire);
+    }
+    if (!chunk)
     {
-        logBufferPtr_ = std::make_shared<std::string>();
-        logBufferPtr_->reserve(kMemBufferSize);
+        chunk = allocChunk((std::max)(len, kChunkSize));
+        if (!chunk)
+            return nullptr;
     }
-    if (logBufferPtr_->capacity() - logBufferPtr_->length() < len)
+    chunk->owner = buffer;
+    chunk->seq = ++buffer->seq;
+    auto full = buffer->current.exchange(chunk, std::memory_order_acq_rel);
+    if (full)
     {
-        swapBuffer();
+        auto head = fullChunks_.load(std::memory_order_relaxed);
+        do
+        {
+            full->next = head;
+        } while (!fullChunks_.compare_exchange_weak(head,
+                                                    full,
+                                                    std::memory_order_release,
+                                                    std::memory_order_relaxed));
+        // A chunk is filled only once per kChunkSize bytes, so the lock is
+        // rarely taken.
+        std::lock_guard<std::mutex> lock(mutex_);
         cond_.notify_one();
     }
-    if (writeBuffers_.size() > 25)  // 100M bytes logs in buffer
+    return chunk;
+}
+
+AsyncFileLogger::Chunk *AsyncFileLogger::allocChunk(size_t capacity)
+{
+    if (chunkCount_.fetch_add(1, std::memory_order_relaxed) >= kMaxChunks)
     {
-        ++lostCounter_;
-        return;
+        chunkCount_.fetch_sub(1, std::memory_order_relaxed);
+        return nullptr;
     }
+    return new Chunk(capacity);
+}
 
-    if (lostCounter_ > 0)
+void AsyncFileLogger::freeChunk(Chunk *chunk)
+{
+    if (chunk)
     {
-        char logErr[128];
-        auto strlen =
-            snprintf(logErr,
-                     sizeof(logErr),
-                     "%llu log information is lost\n",
-                     static_cast<long long unsigned int>(lostCounter_));
-        lostCounter_ = 0;
-        logBufferPtr_->append(logErr, strlen);
+        delete chunk;
+        chunkCount_.fetch_sub(1, std::memory_order_relaxed);
     }
-    logBufferPtr_->append(msg, len);
+}
+
+void AsyncFileLogger::recycleChunk(Chunk *chunk)
+{
+    auto owner = chunk->owner;
+    if (chunk->capacity != kChunkSize || owner->exiting)
+    {
+        freeChunk(chunk);
+        return;
+    }
+    chunk->committed.store(0, std::memory_order_relaxed);
+    chunk->written = 0;
+    freeChunk(owner->spare.exchange(chunk, std::memory_order_release));
 }
 
 void AsyncFileLogger::flush()
 {
-    std::lock_guard<std::mutex> guard_(mutex_);
-    if (logBufferPtr_->length() > 0)
     {
-        // std::cout<<"flush log buffer
-        // len:"<<logBufferPtr_->length()<<std::endl;
-        swapBuffer();
-        cond_.notify_one();
+        std::lock_guard<std::mutex> lock(mutex_);
+        flushRequested_ = true;
     }
+    cond_.notify_one();
 }
 
-void AsyncFileLogger::writeLogToFile(const StringPtr buf)
+void AsyncFileLogger::writeChunks()
 {
-    if (!loggerFilePtr_)
     {
-        loggerFilePtr_ = std::unique_ptr<LoggerFile>(
-            new LoggerFile(filePath_, fileBaseName_, fileExtName_));
+        std::lock_guard<std::mutex> lock(registryMutex_);
+        bufferSnapshot_ = threadBuffers_;
+    }
+    // Chunks pushed by a thread before it exits are seen in the queue, so they
+    // are all written before its buffer is removed.
+    for (auto &buffer : bufferSnapshot_)
+        buffer->exiting = buffer->exited.load(std::memory_order_acquire);
+
+    Chunk *reversed = fullChunks_.exchange(nullptr, std::memory_order_acquire);
+    Chunk *chunks = nullptr;
+    while (reversed)
+    {
+        auto next = reversed->next;
+        reversed->next = chunks;
+        chunks = reversed;
+        reversed = next;
     }
-    loggerFilePtr_->writeLog(buf);
-    if (loggerFilePtr_->getLength() > sizeLimit_)
+
+    lostMessages_.clear();
+    for (auto &buffer : bufferSnapshot_)
+    {
+        auto lost = buffer->lostCounter.exchange(0, std::memory_order_relaxed);
+        if (lost > 0)
+        {
+            lostMessages_.emplace_back(std::to_string(lost) +
+                                       " log information is lost\n");
+        }
+    }
+    for (auto &msg : lostMessages_)
+        slices_.push_back({msg.data(), msg.length()});
+
+    for (auto chunk = chunks; chunk; chunk = chunk->next)
     {
-        loggerFilePtr_.reset();
+        auto committed = chunk->committed.load(std::memory_order_acquire);
+        if (committed > chunk->written)
+        {
+            slices_.push_back({chunk->data.get() + chunk->written,
+                               committed - chunk->written});
+        }
+        chunk->owner->nextSeq = chunk->seq + 1;
+        writtenChunks_.push_back(chunk);
     }
+    for (auto &buffer : bufferSnapshot_)
+    {
+        auto chunk = buffer->current.load(std::memory_order_acquire);
+        if (!chunk || chunk->seq != buffer->nextSeq)
+            continue;
+        auto committed = chunk->committed.load(std::memory_order_acquire);
+        if (committed > chunk->written)
+        {
+            slices_.push_back({chunk->data.get() + chunk->written,
+                               committed - chunk->written});
+            chunk->written = committed;
+        }
+    }
+
+    if (!slices_.empty())
+    {
+        writeLogToFile(slices_.data(), slices_.size());
+        slices_.clear();
+        if (loggerFilePtr_)
+        {
+            loggerFilePtr_->flush();
+            if (syncPolicy_ == kSyncOnFlush)
+                loggerFilePtr_->sync();
+        }
+    }
+    for (auto chunk : writtenChunks_)
+        recycleChunk(chunk);
+    writtenChunks_.clear();
+
+    bool removing = false;
+    for (auto &buffer : bufferSnapshot_)
+    {
+        if (buffer->exiting)
+        {
+            freeChunk(buffer->current.exchange(nullptr));
+            freeChunk(buffer->spare.exchange(nullptr));
+            removing = true;
+        }
+    }
+    if (removing)
+    {
+        std::lock_guard<std::mutex> lock(registryMutex_);
+        threadBuffers_.erase(
+            std::remove_if(threadBuffers_.begin(),
+                           threadBuffers_.end(),
+                           [](const std::shared_ptr<ThreadBuffer> &buffer) {
+                               return buffer->exiting;
+                           }),
+            threadBuffers_.end());
+    }
+    bufferSnapshot_.clear();
 }
 
-void AsyncFileLogger::logThreadFunc()
+void AsyncFileLogger::writeLogToFile(const LogSlice *slices, size_t count)
 {
-#ifdef __linux__
-    prctl(PR_SET_NAME, "AsyncFileLogger");
-#endif
-    while (!stopFlag_)
+    size_t begin = 0;
+    uint64_t pending = 0;
+    for (size_t i = 0; i < count; ++i)
     {
+        if (!loggerFilePtr_)
         {
-            std::unique_lock<std::mutex> lock(mutex_);
-            while (writeBuffers_.size() == 0 && !stopFlag_)
+            loggerFilePtr_ = std::unique_ptr<LoggerFile>(
+                new LoggerFile(filePath_, fileBaseName_, fileExtName_));
+            if (headerFunc_)
             {
-                if (cond_.wait_for(lock, kLogFlushTimeout) ==
-                    std::cv_status::timeout)
-                {
-                    if (logBufferPtr_->length() > 0)
-                    {
-                        swapBuffer();
-                    }
-                    break;
-                }
+                auto header = headerFunc_();
+                LogSlice slice{header.data(), header.length()};
+                loggerFilePtr_->writeLog(&slice, 1);
             }
-            tmpBuffers_.swap(writeBuffers_);
         }
+        pending += slices[i].len;
+        if (loggerFilePtr_->getLength() + pending > sizeLimit_)
+        {
+            loggerFilePtr_->writeLog(slices + begin, i + 1 - begin);
+            if (syncPolicy_ != kNoSync)
+                loggerFilePtr_->sync();
+            loggerFilePtr_.reset();
+            begin = i + 1;
+            pending = 0;
+        }
+    }
+    if (begin < count)
+        loggerFilePtr_->writeLog(slices + begin, count - begin);
+}
 
-        while (!tmpBuffers_.empty())
+void AsyncFileLogger::logThreadFunc()
+{
+#ifdef __linux__
+    prctl(PR_SET_NAME, "AsyncFileLogger");
+#endif
+    while (true)
+    {
         {
-            StringPtr tmpPtr = (StringPtr &&) tmpBuffers_.front();
-            tmpBuffers_.pop();
-            writeLogToFile(tmpPtr);
-            tmpPtr->clear();
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (stopFlag_)
+                break;
+            if (!flushRequested_ &&
+                !fullChunks_.load(std::memory_order_acquire))
             {
-                std::unique_lock<std::mutex> lock(mutex_);
-                nextBufferPtr_ = tmpPtr;
+                cond_.wait_for(lock, kLogFlushTimeout);
             }
+            flushRequested_ = false;
         }
-        if (loggerFilePtr_)
-            loggerFilePtr_->flush();
+        writeChunks();
     }
 }
 
@@ -194,17 +458,62 @@ AsyncFileLogger::LoggerFile::LoggerFile(const std::string &filePath,
     if (fp_ == nullptr)
     {
         std::cout << strerror_tl(errno) << std::endl;
+        return;
     }
+    fseek(fp_, 0, SEEK_END);
+    auto length = ftell(fp_);
+    if (length > 0)
+        length_ = static_cast<uint64_t>(length);
 }
 
 uint64_t AsyncFileLogger::LoggerFile::fileSeq_{0};
-void AsyncFileLogger::LoggerFile::writeLog(const StringPtr buf)
+void AsyncFileLogger::LoggerFile::writeLog(const LogSlice *slices,
+                                           size_t count)
 {
-    if (fp_)
+    if (!fp_)
+        return;
+#ifndef _WIN32
+    // The stream is only used to open and close the file, the data is written
+    // directly to its descriptor.
+    auto fd = fileno(fp_);
+    constexpr size_t kMaxIovecs = IOV_MAX < 1024 ? IOV_MAX : 1024;
+    struct iovec vecs[kMaxIovecs];
+    size_t index = 0;
+    size_t offset = 0;
+    while (index < count)
+    {
+        int vecNum = 0;
+        for (size_t i = index; i < count && vecNum < (int)kMaxIovecs; ++i)
+        {
+            auto skip = i == index ? offset : 0;
+            vecs[vecNum].iov_base = const_cast<char *>(slices[i].data) + skip;
+            vecs[vecNum].iov_len = slices[i].len - skip;
+            ++vecNum;
+        }
+        auto n = ::writev(fd, vecs, vecNum);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            std::cout << strerror_tl(errno) << std::endl;
+            return;
+        }
+        length_ += n;
+        auto left = static_cast<size_t>(n);
+        while (index < count && left >= slices[index].len - offset)
+        {
+            left -= slices[index].len - offset;
+            ++index;
+            offset = 0;
+        }
+        offset += left;
+    }
+#else
+    for (size_t i = 0; i < count; ++i)
     {
-        // std::cout<<"write "<<buf->length()<<" bytes to file"<<std::endl;
-        fwrite(buf->c_str(), 1, buf->length(), fp_);
+        length_ += fwrite(slices[i].data, 1, slices[i].len, fp_);
     }
+#endif
 }
 
 void AsyncFileLogger::LoggerFile::flush()
@@ -215,11 +524,23 @@ void AsyncFileLogger::LoggerFile::flush()
     }
 }
 
+void AsyncFileLogger::LoggerFile::sync()
+{
+    if (!fp_)
+        return;
+#ifdef _WIN32
+    fflush(fp_);
+    _commit(_fileno(fp_));
+#elif defined(__linux__)
+    fdatasync(fileno(fp_));
+#else
+    fsync(fileno(fp_));
+#endif
+}
+
 uint64_t AsyncFileLogger::LoggerFile::getLength()
 {
-    if (fp_)
-        return ftell(fp_);
-    return 0;
+    return length_;
 }
 
 AsyncFileLogger::LoggerFile::~LoggerFile()
@@ -247,19 +568,3 @@ AsyncFileLogger::LoggerFile::~LoggerFile()
 #endif
     }
 }
-
-void AsyncFileLogger::swapBuffer()
-{
-    writeBuffers_.push(logBufferPtr_);
-    if (nextBufferPtr_)
-    {
-        logBufferPtr_ = nextBufferPtr_;
-        nextBufferPtr_.reset();
-        logBufferPtr_->clear();
-    }
-    else
-    {
-        logBufferPtr_ = std::make_shared<std::string>();
-        logBufferPtr_->reserve(kMemBufferSize);
-    }
-}
@@ -17,13 +17,16 @@
 #include <trantor/utils/NonCopyable.h>
 #include <trantor/utils/Date.h>
 #include <trantor/exports.h>
+#include <atomic>
 #include <thread>
 #include <mutex>
 #include <string>
 #include <condition_variable>
+#include <functional>
 #include <sstream>
 #include <memory>
 #include <queue>
+#include <vector>
 
 namespace trantor
 {
@@ -34,10 +37,29 @@ using StringPtrQueue = std::queue<StringPtr>;
  * @brief This class implements utility functions for writing logs to files
  * asynchronously.
  *
+ * Every thread appends its messages to its own buffer without any lock. Full
+ * buffers are handed to the logging thread through a lock-free queue, and the
+ * logging thread writes all pending buffers with batched writev() calls.
+ * Messages of one thread keep their order in the file, messages of different
+ * threads are interleaved buffer by buffer.
  */
 class TRANTOR_EXPORT AsyncFileLogger : NonCopyable
 {
   public:
+    /**
+     * @brief When the data written to log files is synchronized to the disk.
+     */
+    enum SyncPolicy
+    {
+        /// Leave it to the operating system.
+        kNoSync = 0,
+        /// Synchronize a log file before it is switched.
+        kSyncOnRotation,
+        /// Synchronize after every round of writing, i.e. at least once per
+        /// second while logging.
+        kSyncOnFlush
+    };
+
     /**
      * @brief Write the message to the log file.
      *
@@ -69,6 +91,25 @@ class TRANTOR_EXPORT AsyncFileLogger : NonCopyable
         sizeLimit_ = limit;
     }
 
+    /**
+     * @brief Set when the log files are synchronized to the disk, see
+     * SyncPolicy. The default is kNoSync.
+     */
+    void setSyncPolicy(SyncPolicy policy)
+    {
+        syncPolicy_ = policy;
+    }
+
+    /**
+     * @brief Set the function whose result is written at the beginning of
+     * every log file, e.g. BinaryLogger::fileHeader. It is called in the
+     * logging thread.
+     */
+    void setFileHeader(std::function<std::string()> headerFunc)
+    {
+        headerFunc_ = std::move(headerFunc);
+    }
+
     /**
      * @brief Set the log file name.
      *
@@ -93,20 +134,54 @@ class TRANTOR_EXPORT AsyncFileLogger : NonCopyable
     AsyncFileLogger();
 
   protected:
+    struct Chunk;
+    struct ThreadBuffer;
+    struct LocalBuffers;
+    static LocalBuffers &localBuffers();
+    struct LogSlice
+    {
+        const char *data;
+        size_t len;
+    };
+    ThreadBuffer *threadBuffer();
+    ThreadBuffer *registerThread();
+    Chunk *switchChunk(ThreadBuffer *buffer, size_t len);
+    Chunk *allocChunk(size_t capacity);
+    void freeChunk(Chunk *chunk);
+    void recycleChunk(Chunk *chunk);
+    void writeChunks();
+    void writeLogToFile(const LogSlice *slices, size_t count);
+    void logThreadFunc();
+
+    // The id distinguishes loggers in the thread local lists of buffers even
+    // if a logger is created at the address of a destroyed one.
+    const uint64_t id_;
     std::mutex mutex_;
     std::condition_variable cond_;
-    StringPtr logBufferPtr_;
-    StringPtr nextBufferPtr_;
-    StringPtrQueue writeBuffers_;
-    StringPtrQueue tmpBuffers_;
-    void writeLogToFile(const StringPtr buf);
-    std::unique_ptr<std::thread> threadPtr_;
     bool stopFlag_{false};
-    void logThreadFunc();
+    bool flushRequested_{false};
+    std::unique_ptr<std::thread> threadPtr_;
+    // Full chunks of all threads, in the reverse order of pushing.
+    std::atomic<Chunk *> fullChunks_{nullptr};
+    std::atomic<size_t> chunkCount_{0};
+    std::mutex registryMutex_;
+    std::vector<std::shared_ptr<ThreadBuffer>> threadBuffers_;
+    // Used under sharedMutex_ by threads whose thread local storage has been
+    // destroyed.
+    std::shared_ptr<ThreadBuffer> sharedBuffer_;
+    std::mutex sharedMutex_;
+    // Only used in the logging thread.
+    std::vector<std::shared_ptr<ThreadBuffer>> bufferSnapshot_;
+    std::vector<Chunk *> writtenChunks_;
+    std::vector<LogSlice> slices_;
+    std::vector<std::string> lostMessages_;
+
     std::string filePath_{"./"};
     std::string fileBaseName_{"trantor"};
     std::string fileExtName_{".log"};
     uint64_t sizeLimit_{20 * 1024 * 1024};
+    SyncPolicy syncPolicy_{kNoSync};
+    std::function<std::string()> headerFunc_;
     class LoggerFile : NonCopyable
     {
       public:
@@ -114,16 +189,18 @@ class TRANTOR_EXPORT AsyncFileLogger : NonCopyable
                    const std::string &fileBaseName,
                    const std::string &fileExtName);
         ~LoggerFile();
-        void writeLog(const StringPtr buf);
+        void writeLog(const LogSlice *slices, size_t count);
         uint64_t getLength();
         explicit operator bool() const
         {
             return fp_ != nullptr;
         }
         void flush();
+        void sync();
 
       protected:
         FILE *fp_{nullptr};
+        uint64_t length_{0};
         Date creationDate_;
         std::string fileFullName_;
         std::string filePath_;
@@ -132,9 +209,6 @@ class TRANTOR_EXPORT AsyncFileLogger : NonCopyable
         static uint64_t fileSeq_;
     };
     std::unique_ptr<LoggerFile> loggerFilePtr_;
-
-    uint64_t lostCounter_{0};
-    void swapBuffer();
 };
 
 }  // namespace trantor
@@ -0,0 +1,646 @@
+/**
+ *
+ *  BinaryLogger.cc
+ *  An Tao
+ *
+ *  Public header file in trantor lib.
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the License file.
+ *
+ *
+ */
+
+#include <trantor/utils/BinaryLogger.h>
+#include <trantor/utils/Date.h>
+#include <trantor/utils/LogStream.h>
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+#include <x86intrin.h>
+#define TRANTOR_HAS_RDTSC
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define TRANTOR_HAS_RDTSC
+#endif
+
+namespace trantor
+{
+extern uint64_t currentThreadId();
+
+namespace
+{
+// Every file starts with the magic, the records of a file may be preceded by
+// another magic if logs of another process are appended to it.
+constexpr char kMagic[] = "TRBLOG1\n";
+constexpr size_t kMagicLen = sizeof(kMagic) - 1;
+// Records are a tag, the varint length of the payload and the payload.
+enum RecordTag : char
+{
+    kLogRecord = 1,
+    kSiteRecord = 2,
+    kClockRecord = 3
+};
+
+const char *const kLevelStrings[Logger::kNumberOfLogLevels] = {
+    " TRACE ",
+    " DEBUG ",
+    " INFO  ",
+    " WARN  ",
+    " ERROR ",
+    " FATAL ",
+};
+const char *const kLevelNames[Logger::kNumberOfLogLevels] =
+    {"TRACE", "DEBUG", "INFO", "WARN", "ERROR", "FATAL"};
+
+inline uint64_t ticks()
+{
+#ifdef TRANTOR_HAS_RDTSC
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+#endif
+}
+
+uint64_t wallMicroSeconds()
+{
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch())
+            .count());
+}
+
+// Times in records are ticks since the base, calibration records map ticks to
+// the wall clock. It is initialized by setOutputFunction(), before any record
+// is written.
+struct Clock
+{
+    uint64_t baseTicks;
+    double ticksPerSecond;
+    uint64_t calibrationInterval;
+};
+Clock s_clock;
+std::once_flag s_clockOnce;
+
+void initClock()
+{
+    s_clock.baseTicks = ticks();
+#ifdef TRANTOR_HAS_RDTSC
+    // Estimate the frequency, the decoder refines it by later calibration
+    // records.
+    auto start = std::chrono::steady_clock::now();
+    auto end = start;
+    while (end - start < std::chrono::milliseconds(5))
+        end = std::chrono::steady_clock::now();
+    auto ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+            .count();
+    s_clock.ticksPerSecond = static_cast<double>(ticks() - s_clock.baseTicks) *
+                             1e9 / static_cast<double>(ns);
+#else
+    s_clock.ticksPerSecond = 1e9;
+#endif
+    s_clock.calibrationInterval =
+        static_cast<uint64_t>(s_clock.ticksPerSecond);
+}
+
+std::function<void(const char *msg, const uint64_t len)> &outputFunc()
+{
+    static std::function<void(const char *msg, const uint64_t len)> func;
+    return func;
+}
+
+std::function<void()> &flushFunc()
+{
+    static std::function<void()> func;
+    return func;
+}
+
+struct SiteRegistry
+{
+    std::mutex mutex;
+    // Encoded site records, the id of a site is its index plus 1.
+    std::vector<std::string> records;
+};
+
+SiteRegistry &siteRegistry()
+{
+    static SiteRegistry registry;
+    return registry;
+}
+
+// Trivially constructible, so accessing it needs no initialization check.
+struct ThreadState
+{
+    uint64_t threadId;
+    uint64_t lastCalibration;
+};
+thread_local ThreadState t_state{0, 0};
+
+void appendVarint(std::string &str, uint64_t v)
+{
+    char buf[10];
+    str.append(buf, binlog::putVarint(buf, v) - buf);
+}
+
+void appendString(std::string &str, const char *s, size_t len)
+{
+    appendVarint(str, len);
+    str.append(s, len);
+}
+
+void appendRecord(std::string &str, RecordTag tag, const std::string &payload)
+{
+    str.push_back(tag);
+    appendVarint(str, payload.length());
+    str.append(payload);
+}
+
+std::string clockRecord(uint64_t now)
+{
+    auto &clk = s_clock;
+    std::string payload;
+    appendVarint(payload, now > clk.baseTicks ? now - clk.baseTicks : 0);
+    appendVarint(payload, wallMicroSeconds());
+    char buf[sizeof(double)];
+    memcpy(buf, &clk.ticksPerSecond, sizeof(buf));
+    payload.append(buf, sizeof(buf));
+    std::string record;
+    appendRecord(record, kClockRecord, payload);
+    return record;
+}
+
+bool getVarint(const char *&p, const char *end, uint64_t &v)
+{
+    v = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7)
+    {
+        auto byte = static_cast<unsigned char>(*p++);
+        v |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+bool getString(const char *&p, const char *end, std::string &str)
+{
+    uint64_t len;
+    if (!getVarint(p, end, len) || len > static_cast<uint64_t>(end - p))
+        return false;
+    str.assign(p, static_cast<size_t>(len));
+    p += len;
+    return true;
+}
+
+void appendJsonString(std::string &out, const char *s, size_t len)
+{
+    out.push_back('"');
+    for (size_t i = 0; i < len; ++i)
+    {
+        auto c = static_cast<unsigned char>(s[i]);
+        switch (c)
+        {
+            case '"':
+                out.append("\\\"");
+                break;
+            case '\\':
+                out.append("\\\\");
+                break;
+            case '\n':
+                out.append("\\n");
+                break;
+            case '\r':
+                out.append("\\r");
+                break;
+            case '\t':
+                out.append("\\t");
+                break;
+            default:
+                if (c < 0x20)
+                {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out.append(buf);
+                }
+                else
+                {
+                    out.push_back(static_cast<char>(c));
+                }
+        }
+    }
+    out.push_back('"');
+}
+}  // namespace
+}  // namespace trantor
+
+using namespace trantor;
+
+void BinaryLogger::setOutputFunction(
+    std::function<void(const char *msg, const uint64_t len)> outputFunc,
+    std::function<void()> flushFunc)
+{
+    std::call_once(s_clockOnce, initClock);
+    trantor::outputFunc() = outputFunc;
+    trantor::flushFunc() = flushFunc;
+}
+
+std::string BinaryLogger::fileHeader()
+{
+    std::call_once(s_clockOnce, initClock);
+    std::string header(kMagic, kMagicLen);
+    header.append(clockRecord(ticks()));
+    auto &registry = siteRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (auto &record : registry.records)
+        header.append(record);
+    return header;
+}
+
+uint32_t BinaryLogger::registerSite(Site &site,
+                                    const char *format,
+                                    const char *signature)
+{
+    auto &registry = siteRegistry();
+    std::string record;
+    uint32_t id;
+    {
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        id = site.id_.load(std::memory_order_relaxed);
+        if (id != 0)
+            return id;
+        id = static_cast<uint32_t>(registry.records.size() + 1);
+        Logger::SourceFile file(site.file_);
+        std::string payload;
+        appendVarint(payload, id);
+        payload.push_back(static_cast<char>(site.level_));
+        appendVarint(payload, static_cast<uint64_t>(site.line_));
+        appendString(payload, file.data_, static_cast<size_t>(file.size_));
+        appendString(payload, format, strlen(format));
+        appendString(payload, signature, strlen(signature));
+        appendRecord(record, kSiteRecord, payload);
+        registry.records.push_back(record);
+        site.id_.store(id, std::memory_order_release);
+    }
+    // Files created from now on have the site in their headers, the current
+    // one gets it here.
+    auto &func = trantor::outputFunc();
+    if (func)
+        func(record.data(), record.length());
+    return id;
+}
+
+char *BinaryLogger::beginRecord(char *buf, uint32_t id)
+{
+    auto &func = trantor::outputFunc();
+    if (!func)
+        return nullptr;
+    auto now = ticks();
+    auto &state = t_state;
+    if (now - state.lastCalibration > s_clock.calibrationInterval)
+    {
+        state.lastCalibration = now;
+        if (state.threadId == 0)
+            state.threadId = currentThreadId();
+        auto record = clockRecord(now);
+        func(record.data(), record.length());
+    }
+    // Leave room for the tag and the length.
+    auto p = buf + 6;
+    p = binlog::putVarint(p, id);
+    p = binlog::putVarint(
+        p, now > s_clock.baseTicks ? now - s_clock.baseTicks : 0);
+    return binlog::putVarint(p, state.threadId);
+}
+
+void BinaryLogger::endRecord(char *buf, char *end, Logger::LogLevel level)
+{
+    auto payload = buf + 6;
+    char lenBuf[5];
+    auto lenSize = binlog::putVarint(lenBuf, end - payload) - lenBuf;
+    auto start = payload - lenSize - 1;
+    start[0] = kLogRecord;
+    memcpy(start + 1, lenBuf, lenSize);
+    trantor::outputFunc()(start, end - start);
+    if (level >= Logger::kError)
+    {
+        auto &flush = trantor::flushFunc();
+        if (flush)
+            flush();
+    }
+}
+
+bool BinaryLogDecoder::decode(const char *data, size_t len, std::ostream &os)
+{
+    sites_.clear();
+    clocks_.clear();
+    records_.clear();
+    const char *p = data;
+    const char *end = data + len;
+    bool started = false;
+    uint64_t lastTicks = 0;
+    while (p < end)
+    {
+        if (static_cast<size_t>(end - p) >= kMagicLen &&
+            memcmp(p, kMagic, kMagicLen) == 0)
+        {
+            flushSegment(os);
+            sites_.clear();
+            clocks_.clear();
+            p += kMagicLen;
+            started = true;
+            continue;
+        }
+        if (!started)
+            break;
+        if (*p >= '0' && *p <= '9')
+        {
+            // A notice of lost logs written by AsyncFileLogger.
+            auto eol = static_cast<const char *>(memchr(p, '\n', end - p));
+            if (!eol)
+                break;
+            records_.push_back(
+                {lastTicks, nullptr, 0, strtoull(p, nullptr, 10)});
+            p = eol + 1;
+            continue;
+        }
+        auto tag = *p++;
+        uint64_t payloadLen;
+        if (!getVarint(p, end, payloadLen) ||
+            payloadLen > static_cast<uint64_t>(end - p))
+        {
+            break;
+        }
+        const char *payload = p;
+        const char *payloadEnd = p + payloadLen;
+        p = payloadEnd;
+        uint64_t id;
+        if (tag == kLogRecord)
+        {
+            uint64_t recordTicks;
+            if (!getVarint(payload, payloadEnd, id) ||
+                !getVarint(payload, payloadEnd, recordTicks))
+            {
+                break;
+            }
+            lastTicks = recordTicks;
+            records_.push_back({recordTicks,
+                                payloadEnd - payloadLen,
+                                static_cast<size_t>(payloadLen),
+                                0});
+        }
+        else if (tag == kSiteRecord)
+        {
+            SiteInfo site;
+            uint64_t line;
+            if (!getVarint(payload, payloadEnd, id) || payload >= payloadEnd)
+                break;
+            auto level = static_cast<unsigned char>(*payload++);
+            if (level >= Logger::kNumberOfLogLevels ||
+                !getVarint(payload, payloadEnd, line) ||
+                !getString(payload, payloadEnd, site.file) ||
+                !getString(payload, payloadEnd, site.format) ||
+                !getString(payload, payloadEnd, site.signature))
+            {
+                break;
+            }
+            site.level = static_cast<Logger::LogLevel>(level);
+            site.line = static_cast<int>(line);
+            sites_[static_cast<uint32_t>(id)] = std::move(site);
+        }
+        else if (tag == kClockRecord)
+        {
+            uint64_t clockTicks, us;
+            double ticksPerSecond;
+            if (!getVarint(payload, payloadEnd, clockTicks) ||
+                !getVarint(payload, payloadEnd, us) ||
+                payloadEnd - payload < static_cast<long>(sizeof(double)))
+            {
+                break;
+            }
+            memcpy(&ticksPerSecond, payload, sizeof(double));
+            clocks_.emplace_back(clockTicks, us);
+            if (ticksPerSecond > 0)
+                ticksPerMicroSecond_ = ticksPerSecond / 1e6;
+        }
+        else
+        {
+            break;
+        }
+    }
+    bool ok = p == end && started;
+    if (!flushSegment(os))
+        ok = false;
+    return ok;
+}
+
+bool BinaryLogDecoder::flushSegment(std::ostream &os)
+{
+    std::sort(clocks_.begin(), clocks_.end());
+    std::stable_sort(records_.begin(),
+                     records_.end(),
+                     [](const Record &a, const Record &b) {
+                         return a.ticks < b.ticks;
+                     });
+    bool ok = true;
+    for (auto &record : records_)
+    {
+        if (!writeRecord(record, os))
+            ok = false;
+    }
+    records_.clear();
+    return ok;
+}
+
+uint64_t BinaryLogDecoder::toMicroSeconds(uint64_t ticks) const
+{
+    if (clocks_.empty())
+        return 0;
+    auto it = std::upper_bound(clocks_.begin(),
+                               clocks_.end(),
+                               std::make_pair(ticks, UINT64_MAX));
+    // Interpolate between the calibration records around the time, or
+    // extrapolate from the nearest two.
+    size_t i = it == clocks_.begin() ? 0 : (it - clocks_.begin()) - 1;
+    if (i + 1 == clocks_.size() && i > 0)
+        --i;
+    auto &a = clocks_[i];
+    double usPerTick = 1.0 / ticksPerMicroSecond_;
+    if (i + 1 < clocks_.size() && clocks_[i + 1].first > a.first &&
+        clocks_[i + 1].second > a.second)
+    {
+        auto &b = clocks_[i + 1];
+        usPerTick = static_cast<double>(b.second - a.second) /
+                    static_cast<double>(b.first - a.first);
+    }
+    auto offset = (static_cast<double>(ticks) - static_cast<double>(a.first)) *
+                  usPerTick;
+    return static_cast<uint64_t>(static_cast<double>(a.second) + offset);
+}
+
+bool BinaryLogDecoder::writeRecord(const Record &record, std::ostream &os)
+{
+    auto us = toMicroSeconds(record.ticks);
+    auto time = Date(static_cast<int64_t>(us)).toFormattedString(true);
+    std::string line;
+    if (record.lost > 0)
+    {
+        if (format_ == kJson)
+        {
+            line = "{\"time\":\"" + time + "\",\"lost\":" +
+                   std::to_string(record.lost) + "}\n";
+        }
+        else
+        {
+            line = std::to_string(record.lost) + " log information is lost\n";
+        }
+        os << line;
+        return true;
+    }
+    const char *p = record.data;
+    const char *end = record.data + record.len;
+    uint64_t id, recordTicks, tid;
+    getVarint(p, end, id);
+    getVarint(p, end, recordTicks);
+    auto it = sites_.find(static_cast<uint32_t>(id));
+    if (!getVarint(p, end, tid) || it == sites_.end())
+    {
+        os << time << " UTC unknown log site " << id << "\n";
+        return false;
+    }
+    auto &site = it->second;
+
+    // Format every argument by LogStream, as the text logger does.
+    std::vector<std::string> args;
+    std::vector<bool> quoted;
+    bool ok = true;
+    for (auto type : site.signature)
+    {
+        LogStream stream;
+        uint64_t v = 0;
+        bool isString = false;
+        switch (type)
+        {
+            case 'b':
+            case 'c':
+                if (p >= end)
+                {
+                    ok = false;
+                    break;
+                }
+                if (type == 'b')
+                    stream << (*p != 0);
+                else
+                    stream << *p;
+                ++p;
+                break;
+            case 'i':
+                ok = getVarint(p, end, v);
+                stream << static_cast<long long>((v >> 1) ^ (~(v & 1) + 1));
+                break;
+            case 'u':
+                ok = getVarint(p, end, v);
+                stream << static_cast<unsigned long long>(v);
+                break;
+            case 'p':
+                ok = getVarint(p, end, v);
+                stream << reinterpret_cast<const void *>(
+                    static_cast<uintptr_t>(v));
+                isString = true;
+                break;
+            case 'd':
+            {
+                double d;
+                if (end - p < static_cast<long>(sizeof(d)))
+                {
+                    ok = false;
+                    break;
+                }
+                memcpy(&d, p, sizeof(d));
+                p += sizeof(d);
+                stream << d;
+                break;
+            }
+            case 's':
+            {
+                std::string str;
+                ok = getString(p, end, str);
+                stream << str;
+                isString = true;
+                break;
+            }
+            default:
+                ok = false;
+        }
+        if (!ok)
+            break;
+        args.emplace_back(stream.bufferData(), stream.bufferLength());
+        quoted.push_back(isString || type == 'c');
+    }
+    if (!ok)
+    {
+        os << time << " UTC corrupted record of " << site.file << ':'
+           << site.line << "\n";
+        return false;
+    }
+
+    std::string message;
+    size_t argIndex = 0;
+    auto &format = site.format;
+    for (size_t i = 0; i < format.length(); ++i)
+    {
+        if (format[i] == '{' && i + 1 < format.length() &&
+            format[i + 1] == '}' && argIndex < args.size())
+        {
+            message.append(args[argIndex++]);
+            ++i;
+        }
+        else
+        {
+            message.push_back(format[i]);
+        }
+    }
+    for (; argIndex < args.size(); ++argIndex)
+    {
+        message.push_back(' ');
+        message.append(args[argIndex]);
+    }
+
+    if (format_ == kJson)
+    {
+        line = "{\"time\":\"" + time + "\",\"timestamp\":" +
+               std::to_string(us) + ",\"thread\":" + std::to_string(tid) +
+               ",\"level\":\"" + kLevelNames[site.level] + "\",\"file\":";
+        appendJsonString(line, site.file.data(), site.file.length());
+        line += ",\"line\":" + std::to_string(site.line) + ",\"message\":";
+        appendJsonString(line, message.data(), message.length());
+        line += ",\"args\":[";
+        for (size_t i = 0; i < args.size(); ++i)
+        {
+            if (i > 0)
+                line.push_back(',');
+            if (quoted[i])
+                appendJsonString(line, args[i].data(), args[i].length());
+            else if (site.signature[i] == 'b')
+                line += args[i] == "1" ? "true" : "false";
+            else
+                line += args[i];
+        }
+        line += "]}\n";
+    }
+    else
+    {
+        line = time + " UTC " + std::to_string(tid) +
+               kLevelStrings[site.level] + message + " - " + site.file + ':' +
+               std::to_string(site.line) + '\n';
+    }
+    os << line;
+    return true;
+}
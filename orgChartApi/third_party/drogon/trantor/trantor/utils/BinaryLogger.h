@@ -0,0 +1,407 @@
+/**
+ *
+ *  @file BinaryLogger.h
+ *  @author An Tao
+ *
+ *  Public header file in trantor lib.
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the License file.
+ *
+ *
+ */
+
+#pragma once
+
+#include <trantor/utils/Logger.h>
+#include <trantor/utils/NonCopyable.h>
+#include <trantor/exports.h>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace trantor
+{
+namespace binlog
+{
+/**
+ * @brief Encoding of an argument type in binary logs. The type code is
+ * stored in the signature of a log site, the value is stored in records.
+ */
+template <typename T, typename Enable = void>
+struct ArgTraits;
+
+inline char *putVarint(char *p, uint64_t v)
+{
+    while (v >= 0x80)
+    {
+        *p++ = static_cast<char>(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = static_cast<char>(v);
+    return p;
+}
+
+template <>
+struct ArgTraits<bool>
+{
+    static constexpr char kType = 'b';
+    static size_t size(bool)
+    {
+        return 1;
+    }
+    static char *encode(char *p, bool v)
+    {
+        *p++ = v ? 1 : 0;
+        return p;
+    }
+};
+
+template <>
+struct ArgTraits<char>
+{
+    static constexpr char kType = 'c';
+    static size_t size(char)
+    {
+        return 1;
+    }
+    static char *encode(char *p, char v)
+    {
+        *p++ = v;
+        return p;
+    }
+};
+
+template <typename T>
+struct ArgTraits<T,
+                 typename std::enable_if<std::is_integral<T>::value &&
+                                         std::is_signed<T>::value &&
+                                         !std::is_same<T, char>::value>::type>
+{
+    static constexpr char kType = 'i';
+    static size_t size(T)
+    {
+        return 10;
+    }
+    static char *encode(char *p, T v)
+    {
+        auto n = static_cast<int64_t>(v);
+        // Zigzag encoding keeps small negative numbers short.
+        return putVarint(p,
+                         (static_cast<uint64_t>(n) << 1) ^
+                             static_cast<uint64_t>(n >> 63));
+    }
+};
+
+template <typename T>
+struct ArgTraits<T,
+                 typename std::enable_if<std::is_integral<T>::value &&
+                                         std::is_unsigned<T>::value &&
+                                         !std::is_same<T, bool>::value &&
+                                         !std::is_same<T, char>::value>::type>
+{
+    static constexpr char kType = 'u';
+    static size_t size(T)
+    {
+        return 10;
+    }
+    static char *encode(char *p, T v)
+    {
+        return putVarint(p, static_cast<uint64_t>(v));
+    }
+};
+
+template <typename T>
+struct ArgTraits<
+    T,
+    typename std::enable_if<std::is_floating_point<T>::value>::type>
+{
+    static constexpr char kType = 'd';
+    static size_t size(T)
+    {
+        return sizeof(double);
+    }
+    static char *encode(char *p, T v)
+    {
+        auto d = static_cast<double>(v);
+        memcpy(p, &d, sizeof(d));
+        return p + sizeof(d);
+    }
+};
+
+template <typename T>
+struct ArgTraits<T, typename std::enable_if<std::is_enum<T>::value>::type>
+{
+    using Underlying = typename std::underlying_type<T>::type;
+    static constexpr char kType = ArgTraits<Underlying>::kType;
+    static size_t size(T)
+    {
+        return 10;
+    }
+    static char *encode(char *p, T v)
+    {
+        return ArgTraits<Underlying>::encode(p, static_cast<Underlying>(v));
+    }
+};
+
+template <>
+struct ArgTraits<const char *>
+{
+    static constexpr char kType = 's';
+    static size_t size(const char *v)
+    {
+        return v ? 5 + strlen(v) : 5;
+    }
+    static char *encode(char *p, const char *v)
+    {
+        auto len = v ? strlen(v) : 0;
+        p = putVarint(p, len);
+        memcpy(p, v, len);
+        return p + len;
+    }
+};
+
+template <>
+struct ArgTraits<char *> : ArgTraits<const char *>
+{
+};
+
+template <>
+struct ArgTraits<std::string>
+{
+    static constexpr char kType = 's';
+    static size_t size(const std::string &v)
+    {
+        return 5 + v.length();
+    }
+    static char *encode(char *p, const std::string &v)
+    {
+        p = putVarint(p, v.length());
+        memcpy(p, v.data(), v.length());
+        return p + v.length();
+    }
+};
+
+template <typename T>
+struct ArgTraits<T *,
+                 typename std::enable_if<
+                     !std::is_same<typename std::remove_cv<T>::type,
+                                   char>::value>::type>
+{
+    static constexpr char kType = 'p';
+    static size_t size(const T *)
+    {
+        return 10;
+    }
+    static char *encode(char *p, const T *v)
+    {
+        return putVarint(p, reinterpret_cast<uintptr_t>(v));
+    }
+};
+
+template <typename... Args>
+struct Signature
+{
+    static constexpr char value[] = {
+        ArgTraits<typename std::decay<Args>::type>::kType..., '\0'};
+};
+template <typename... Args>
+constexpr char Signature<Args...>::value[];
+
+}  // namespace binlog
+
+/**
+ * @brief This class implements structured binary logs.
+ *
+ * A binary log record only contains the id of its log site, a timestamp, the
+ * thread id and the raw arguments. The level, the source location and the
+ * format string of a site are written once per log file, and the records are
+ * formatted offline by BinaryLogDecoder (see the trantor_logdecode tool).
+ *
+ * The output usually goes to an AsyncFileLogger which is not used for text
+ * logs:
+ * @code
+   trantor::AsyncFileLogger fileLogger;
+   fileLogger.setFileName("app", ".blog");
+   fileLogger.setFileHeader(trantor::BinaryLogger::fileHeader);
+   fileLogger.startLogging();
+   trantor::BinaryLogger::setOutputFunction(
+       [&](const char *msg, const uint64_t len) {
+           fileLogger.output(msg, len);
+       },
+       [&]() { fileLogger.flush(); });
+   BLOG_INFO("getOne personId: {}", personId);
+   @endcode
+ */
+class TRANTOR_EXPORT BinaryLogger : public NonCopyable
+{
+  public:
+    /**
+     * @brief A log site, which is a static object of every BLOG_* statement.
+     */
+    class Site
+    {
+      public:
+        constexpr Site(Logger::LogLevel level, const char *file, int line)
+            : level_(level), file_(file), line_(line)
+        {
+        }
+
+      private:
+        friend class BinaryLogger;
+        const Logger::LogLevel level_;
+        const char *const file_;
+        const int line_;
+        std::atomic<uint32_t> id_{0};
+    };
+
+    /**
+     * @brief Set the output function of binary logs. Binary logs are
+     * discarded until it is set.
+     */
+    static void setOutputFunction(
+        std::function<void(const char *msg, const uint64_t len)> outputFunc,
+        std::function<void()> flushFunc);
+
+    /**
+     * @brief Return the data which must be at the beginning of every binary
+     * log file, see AsyncFileLogger::setFileHeader().
+     */
+    static std::string fileHeader();
+
+    /**
+     * @brief Write a record, use the BLOG_* macros instead.
+     *
+     * @param format The format string, every "{}" is replaced by the next
+     * argument.
+     */
+    template <typename... Args>
+    static void log(Site &site, const char *format, const Args &...args)
+    {
+        auto id = site.id_.load(std::memory_order_acquire);
+        if (id == 0)
+            id = registerSite(site, format, binlog::Signature<Args...>::value);
+        size_t size = kMaxHeaderSize;
+        using Expander = int[];
+        (void)Expander{0,
+                       (size += binlog::ArgTraits<
+                            typename std::decay<Args>::type>::size(args),
+                        0)...};
+        char stackBuf[256];
+        std::unique_ptr<char[]> heapBuf;
+        char *buf = stackBuf;
+        if (size > sizeof(stackBuf))
+        {
+            heapBuf.reset(new char[size]);
+            buf = heapBuf.get();
+        }
+        auto p = beginRecord(buf, id);
+        if (!p)
+            return;
+        (void)Expander{
+            0,
+            (p = binlog::ArgTraits<typename std::decay<Args>::type>::encode(
+                 p, args),
+             0)...};
+        endRecord(buf, p, site.level_);
+    }
+
+  private:
+    // The tag, the length, the site id, the time and the thread id.
+    static constexpr size_t kMaxHeaderSize = 1 + 5 + 5 + 10 + 10;
+    static uint32_t registerSite(Site &site,
+                                 const char *format,
+                                 const char *signature);
+    static char *beginRecord(char *buf, uint32_t id);
+    static void endRecord(char *buf, char *end, Logger::LogLevel level);
+};
+
+/**
+ * @brief This class decodes binary log files into text or JSON lines.
+ *
+ * Records of different threads are sorted by their timestamps.
+ */
+class TRANTOR_EXPORT BinaryLogDecoder : public NonCopyable
+{
+  public:
+    enum Format
+    {
+        kText = 0,
+        kJson
+    };
+    explicit BinaryLogDecoder(Format format = kText) : format_(format)
+    {
+    }
+
+    /**
+     * @brief Decode the content of a binary log file.
+     *
+     * @return false if the data is not a binary log or is corrupted, the
+     * records before the error are still decoded.
+     */
+    bool decode(const char *data, size_t len, std::ostream &os);
+
+  private:
+    struct SiteInfo
+    {
+        Logger::LogLevel level;
+        int line;
+        std::string file;
+        std::string format;
+        std::string signature;
+    };
+    struct Record
+    {
+        uint64_t ticks;
+        const char *data;
+        size_t len;
+        // The record is a notice of lost logs if lost > 0.
+        uint64_t lost;
+    };
+    bool flushSegment(std::ostream &os);
+    bool writeRecord(const Record &record, std::ostream &os);
+    uint64_t toMicroSeconds(uint64_t ticks) const;
+
+    Format format_;
+    std::map<uint32_t, SiteInfo> sites_;
+    // Pairs of the time in ticks and microseconds since the epoch.
+    std::vector<std::pair<uint64_t, uint64_t>> clocks_;
+    double ticksPerMicroSecond_{1.0};
+    std::vector<Record> records_;
+};
+
+}  // namespace trantor
+
+#define TRANTOR_BLOG_(level, ...)                                     \
+    do                                                                \
+    {                                                                 \
+        if ((TRANTOR_MIN_LOG_LEVEL <= (level) ||                      \
+             (level) == trantor::Logger::kFatal) &&                   \
+            trantor::Logger::shouldLog((level), __FILE__))            \
+        {                                                             \
+            static trantor::BinaryLogger::Site trantorLogSite_(       \
+                (level), __FILE__, __LINE__);                         \
+            trantor::BinaryLogger::log(trantorLogSite_, __VA_ARGS__); \
+        }                                                             \
+    } while (0)
+
+#ifdef NDEBUG
+#define BLOG_TRACE(...) \
+    do                  \
+    {                   \
+    } while (0)
+#else
+#define BLOG_TRACE(...) TRANTOR_BLOG_(trantor::Logger::kTrace, __VA_ARGS__)
+#endif
+#define BLOG_DEBUG(...) TRANTOR_BLOG_(trantor::Logger::kDebug, __VA_ARGS__)
+#define BLOG_INFO(...) TRANTOR_BLOG_(trantor::Logger::kInfo, __VA_ARGS__)
+#define BLOG_WARN(...) TRANTOR_BLOG_(trantor::Logger::kWarn, __VA_ARGS__)
+#define BLOG_ERROR(...) TRANTOR_BLOG_(trantor::Logger::kError, __VA_ARGS__)
+#define BLOG_FATAL(...) TRANTOR_BLOG_(trantor::Logger::kFatal, __VA_ARGS__)
@@ -0,0 +1,279 @@
+/**
+ *
+ *  ChainedBuffer.cc
+ *  An Tao
+ *
+ *  Public header file in trantor lib.
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the License file.
+ *
+ *
+ */
+
+#include <trantor/utils/ChainedBuffer.h>
+#include <algorithm>
+#include <atomic>
+#include <string.h>
+#ifndef _WIN32
+#include <sys/uio.h>
+#else
+#include <WindowsSupport.h>
+#include <winsock2.h>
+#endif
+#include <errno.h>
+#include <assert.h>
+
+using namespace trantor;
+
+constexpr size_t ChainedBuffer::kSlabSize;
+
+namespace
+{
+// The number of new slabs offered to readv() by readFd().
+constexpr size_t kReadSlabs{4};
+// The maximum number of blocks given to writev() by writeFd().
+constexpr size_t kWriteBlocks{64};
+
+std::atomic<size_t> &maxFreeSlabs()
+{
+    static std::atomic<size_t> maxFreeSlabs{64};
+    return maxFreeSlabs;
+}
+
+// Trivially destructible, so it is still valid when buffers are destroyed
+// after the pool of the thread, e.g. in destructors of thread_local objects.
+thread_local bool t_slabPoolDestroyed{false};
+
+/**
+ * The free slabs of a thread. Every event loop runs in its own thread, so
+ * this is the free list of the loop, and it is used without locks. Slabs
+ * released by another thread go to the free list of that thread.
+ */
+class SlabPool
+{
+  public:
+    ~SlabPool()
+    {
+        t_slabPoolDestroyed = true;
+        for (auto slab : freeSlabs_)
+            delete[] slab;
+    }
+    char *get()
+    {
+        if (freeSlabs_.empty())
+            return new char[ChainedBuffer::kSlabSize];
+        auto slab = freeSlabs_.back();
+        freeSlabs_.pop_back();
+        return slab;
+    }
+    void put(char *slab)
+    {
+        if (freeSlabs_.size() < maxFreeSlabs().load(std::memory_order_relaxed))
+            freeSlabs_.push_back(slab);
+        else
+            delete[] slab;
+    }
+    static SlabPool &instance()
+    {
+        static thread_local SlabPool pool;
+        return pool;
+    }
+
+  private:
+    std::vector<char *> freeSlabs_;
+};
+
+char *getSlab()
+{
+    if (t_slabPoolDestroyed)
+        return new char[ChainedBuffer::kSlabSize];
+    return SlabPool::instance().get();
+}
+
+void putSlab(char *slab)
+{
+    if (t_slabPoolDestroyed)
+        delete[] slab;
+    else
+        SlabPool::instance().put(slab);
+}
+
+void setBlock(struct iovec &vec, const char *data, size_t len)
+{
+    vec.iov_base = const_cast<char *>(data);
+    vec.iov_len = static_cast<decltype(vec.iov_len)>(len);
+}
+}  // namespace
+
+ChainedBuffer::~ChainedBuffer()
+{
+    retrieveAll();
+}
+
+ChainedBuffer::ChainedBuffer(ChainedBuffer &&other) noexcept
+{
+    *this = std::move(other);
+}
+
+ChainedBuffer &ChainedBuffer::operator=(ChainedBuffer &&other) noexcept
+{
+    slabs_.swap(other.slabs_);
+    std::swap(head_, other.head_);
+    std::swap(tail_, other.tail_);
+    std::swap(readableBytes_, other.readableBytes_);
+    contiguousBuffer_.swap(other.contiguousBuffer_);
+    return *this;
+}
+
+void ChainedBuffer::setMaxFreeSlabs(size_t count)
+{
+    maxFreeSlabs().store(count, std::memory_order_relaxed);
+}
+
+void ChainedBuffer::append(const char *buf, size_t len)
+{
+    while (len > 0)
+    {
+        if (slabs_.empty() || tail_ == kSlabSize)
+        {
+            slabs_.push_back(getSlab());
+            tail_ = 0;
+        }
+        auto n = (std::min)(len, kSlabSize - tail_);
+        memcpy(slabs_.back() + tail_, buf, n);
+        tail_ += n;
+        readableBytes_ += n;
+        buf += n;
+        len -= n;
+    }
+}
+
+size_t ChainedBuffer::peek(struct iovec *vec, size_t count) const
+{
+    if (readableBytes_ == 0)
+        return 0;
+    count = (std::min)(count, slabs_.size());
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto begin = i == 0 ? head_ : 0;
+        auto end = i + 1 == slabs_.size() ? tail_ : kSlabSize;
+        setBlock(vec[i], slabs_[i] + begin, end - begin);
+    }
+    return count;
+}
+
+const char *ChainedBuffer::contiguous(size_t len)
+{
+    assert(len <= readableBytes_);
+    if (len <= firstBlockBytes())
+        return slabs_.front() + head_;
+    contiguousBuffer_.resize(len);
+    size_t copied = 0;
+    for (size_t i = 0; copied < len; ++i)
+    {
+        auto begin = i == 0 ? head_ : 0;
+        auto n = (std::min)(len - copied, kSlabSize - begin);
+        memcpy(contiguousBuffer_.data() + copied, slabs_[i] + begin, n);
+        copied += n;
+    }
+    return contiguousBuffer_.data();
+}
+
+void ChainedBuffer::releaseFront()
+{
+    putSlab(slabs_.front());
+    slabs_.pop_front();
+    head_ = 0;
+}
+
+void ChainedBuffer::retrieve(size_t len)
+{
+    assert(len <= readableBytes_);
+    while (len > 0)
+    {
+        auto first = firstBlockBytes();
+        if (len < first)
+        {
+            head_ += len;
+            readableBytes_ -= len;
+            return;
+        }
+        len -= first;
+        readableBytes_ -= first;
+        // A drained buffer holds no slab, the last one goes back to the pool
+        // of the thread for the next data.
+        releaseFront();
+        if (slabs_.empty())
+            tail_ = 0;
+    }
+}
+
+void ChainedBuffer::retrieveAll()
+{
+    while (!slabs_.empty())
+        releaseFront();
+    tail_ = 0;
+    readableBytes_ = 0;
+}
+
+ssize_t ChainedBuffer::readFd(int fd, int *retErrno)
+{
+    struct iovec vec[kReadSlabs + 1];
+    char *newSlabs[kReadSlabs];
+    size_t count = 0;
+    size_t writable = slabs_.empty() ? 0 : kSlabSize - tail_;
+    if (writable > 0)
+        setBlock(vec[count++], slabs_.back() + tail_, writable);
+    for (size_t i = 0; i < kReadSlabs; ++i)
+    {
+        newSlabs[i] = getSlab();
+        setBlock(vec[count++], newSlabs[i], kSlabSize);
+    }
+    ssize_t n = ::readv(fd, vec, static_cast<int>(count));
+    if (n < 0)
+    {
+        *retErrno = errno;
+    }
+    size_t left = n > 0 ? static_cast<size_t>(n) : 0;
+    auto taken = (std::min)(left, writable);
+    tail_ += taken;
+    readableBytes_ += taken;
+    left -= taken;
+    for (size_t i = 0; i < kReadSlabs; ++i)
+    {
+        if (left == 0)
+        {
+            putSlab(newSlabs[i]);
+            continue;
+        }
+        taken = (std::min)(left, kSlabSize);
+        slabs_.push_back(newSlabs[i]);
+        tail_ = taken;
+        readableBytes_ += taken;
+        left -= taken;
+    }
+    return n;
+}
+
+ssize_t ChainedBuffer::writeFd(int fd, int *retErrno)
+{
+    struct iovec vec[kWriteBlocks];
+    auto count = peek(vec, kWriteBlocks);
+    if (count == 0)
+        return 0;
+#ifndef _WIN32
+    ssize_t n = ::writev(fd, vec, static_cast<int>(count));
+#else
+    ssize_t n = ::send(fd,
+                       static_cast<const char *>(vec[0].iov_base),
+                       vec[0].iov_len,
+                       0);
+#endif
+    if (n < 0)
+        *retErrno = errno;
+    else
+        retrieve(static_cast<size_t>(n));
+    return n;
+}
@@ -0,0 +1,166 @@
+/**
+ *
+ *  @file ChainedBuffer.h
+ *  @author An Tao
+ *
+ *  Public header file in trantor lib.
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the License file.
+ *
+ *
+ */
+
+#pragma once
+#include <trantor/utils/NonCopyable.h>
+#include <trantor/exports.h>
+#include <deque>
+#include <string>
+#include <vector>
+#include <stddef.h>
+#ifdef _WIN32
+using ssize_t = long long;
+#endif
+
+struct iovec;
+
+namespace trantor
+{
+/**
+ * @brief This class represents a memory buffer made of a chain of fixed-size
+ * slabs.
+ *
+ * Unlike MsgBuffer, the buffer never moves the data it holds: appending data
+ * fills the last slab and then links new ones, and retrieving data releases
+ * the slabs at the front, so an empty buffer holds no memory. The slabs are taken from and returned to a free
+ * list of the current thread, so a busy event loop reuses the same few slabs
+ * instead of allocating memory.
+ *
+ * The data is read through a list of memory blocks (see peek()) which can be
+ * given to writev() directly. Parsers needing the data in one block can get
+ * a contiguous copy of it on demand (see contiguous()).
+ */
+class TRANTOR_EXPORT ChainedBuffer : public NonCopyable
+{
+  public:
+    static constexpr size_t kSlabSize{16 * 1024};
+
+    ChainedBuffer() = default;
+    ~ChainedBuffer();
+    ChainedBuffer(ChainedBuffer &&other) noexcept;
+    ChainedBuffer &operator=(ChainedBuffer &&other) noexcept;
+
+    /**
+     * @brief Return the size of the data in the buffer.
+     *
+     * @return size_t
+     */
+    size_t readableBytes() const
+    {
+        return readableBytes_;
+    }
+
+    /**
+     * @brief Return the number of slabs held by the buffer.
+     *
+     * @return size_t
+     */
+    size_t slabCount() const
+    {
+        return slabs_.size();
+    }
+
+    /**
+     * @brief Append new data to the buffer.
+     *
+     * @param buf
+     * @param len
+     */
+    void append(const char *buf, size_t len);
+    void append(const std::string &buf)
+    {
+        append(buf.data(), buf.length());
+    }
+
+    /**
+     * @brief Get the memory blocks of the data in the buffer, in order.
+     *
+     * @param vec The array to fill.
+     * @param count The size of the array.
+     * @return size_t The number of blocks filled, 0 if the buffer is empty.
+     * @note The blocks are valid until the buffer is modified.
+     */
+    size_t peek(struct iovec *vec, size_t count) const;
+
+    /**
+     * @brief Get the first len bytes of the data in one memory block.
+     *
+     * @param len The length of the block, it must not be greater than the
+     * size of the data.
+     * @return const char* The data itself when it is in one slab, a copy of
+     * it otherwise.
+     * @note The block is valid until the buffer is modified.
+     */
+    const char *contiguous(size_t len);
+
+    /**
+     * @brief Remove some bytes from the beginning of the buffer.
+     *
+     * @param len
+     */
+    void retrieve(size_t len);
+
+    /**
+     * @brief Remove all data in the buffer.
+     *
+     */
+    void retrieveAll();
+
+    /**
+     * @brief Read data from a file descriptor and put it into the buffer.
+     *
+     * @param fd The file descriptor. It is usually a socket.
+     * @param retErrno The error code when reading.
+     * @return ssize_t The number of bytes read from the file descriptor. -1 is
+     * returned when an error occurs.
+     * @note The data is read into the free space of the last slab and a few
+     * new slabs by one readv() call.
+     */
+    ssize_t readFd(int fd, int *retErrno);
+
+    /**
+     * @brief Write the data of the buffer to a file descriptor and remove the
+     * bytes written from the buffer.
+     *
+     * @param fd The file descriptor. It is usually a socket.
+     * @param retErrno The error code when writing.
+     * @return ssize_t The number of bytes written. -1 is returned when an
+     * error occurs.
+     */
+    ssize_t writeFd(int fd, int *retErrno);
+
+    /**
+     * @brief Set the maximum number of free slabs kept by each thread.
+     *
+     * @param count The default value is 64, i.e. 1MB per thread.
+     */
+    static void setMaxFreeSlabs(size_t count);
+
+  private:
+    size_t firstBlockBytes() const
+    {
+        return slabs_.size() == 1 ? tail_ - head_ : kSlabSize - head_;
+    }
+    void releaseFront();
+
+    std::deque<char *> slabs_;
+    // The offset of the data in the first slab.
+    size_t head_{0};
+    // The end of the data in the last slab.
+    size_t tail_{0};
+    size_t readableBytes_{0};
+    std::vector<char> contiguousBuffer_;
+};
+
+}  // namespace trantor
@@ -14,17 +14,224 @@
 
 #include <trantor/utils/ConcurrentTaskQueue.h>
 #include <trantor/utils/Logger.h>
+#include <deque>
 #include <assert.h>
 #ifdef __linux__
 #include <sys/prctl.h>
 #endif
 using namespace trantor;
+
+namespace
+{
+constexpr size_t kPriorityCount{3};
+
+/**
+ * A Chase-Lev work-stealing deque ("Correct and Efficient Work-Stealing for
+ * Weak Memory Models", Lê et al., 2013). Only the owner thread pushes and
+ * pops at the bottom, other threads steal from the top without locks.
+ */
+template <typename T>
+class StealingDeque
+{
+  public:
+    StealingDeque() : array_(new Array(256))
+    {
+    }
+    ~StealingDeque()
+    {
+        delete array_.load(std::memory_order_relaxed);
+    }
+    void push(T *item)
+    {
+        auto bottom = bottom_.load(std::memory_order_relaxed);
+        auto top = top_.load(std::memory_order_acquire);
+        auto array = array_.load(std::memory_order_relaxed);
+        if (bottom - top > array->capacity() - 1)
+        {
+            // Thieves may still read the old array, it is freed with the
+            // deque.
+            retired_.emplace_back(array);
+            array = array->grow(bottom, top);
+            array_.store(array, std::memory_order_release);
+        }
+        array->put(bottom, item);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+    }
+    bool empty() const
+    {
+        return bottom_.load(std::memory_order_relaxed) <=
+               top_.load(std::memory_order_relaxed);
+    }
+    T *pop()
+    {
+        // Only the owner pushes, so the deque stays empty if it is empty now.
+        if (empty())
+            return nullptr;
+        auto bottom = bottom_.load(std::memory_order_relaxed) - 1;
+        auto array = array_.load(std::memory_order_relaxed);
+        bottom_.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto top = top_.load(std::memory_order_relaxed);
+        if (top > bottom)
+        {
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        auto item = array->get(bottom);
+        if (top == bottom)
+        {
+            // The last item, race against thieves.
+            if (!top_.compare_exchange_strong(top,
+                                              top + 1,
+                                              std::memory_order_seq_cst,
+                                              std::memory_order_relaxed))
+                item = nullptr;
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+    T *steal()
+    {
+        auto top = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto bottom = bottom_.load(std::memory_order_acquire);
+        if (top >= bottom)
+            return nullptr;
+        auto item = array_.load(std::memory_order_acquire)->get(top);
+        if (!top_.compare_exchange_strong(top,
+                                          top + 1,
+                                          std::memory_order_seq_cst,
+                                          std::memory_order_relaxed))
+            return nullptr;
+        return item;
+    }
+
+  private:
+    class Array
+    {
+      public:
+        explicit Array(int64_t capacity)
+            : capacity_(capacity), items_(new std::atomic<T *>[capacity])
+        {
+        }
+        int64_t capacity() const
+        {
+            return capacity_;
+        }
+        T *get(int64_t index) const
+        {
+            return items_[index & (capacity_ - 1)].load(
+                std::memory_order_relaxed);
+        }
+        void put(int64_t index, T *item)
+        {
+            items_[index & (capacity_ - 1)].store(item,
+                                                  std::memory_order_relaxed);
+        }
+        Array *grow(int64_t bottom, int64_t top) const
+        {
+            auto array = new Array(capacity_ * 2);
+            for (auto i = top; i < bottom; ++i)
+                array->put(i, get(i));
+            return array;
+        }
+
+      private:
+        int64_t capacity_;
+        std::unique_ptr<std::atomic<T *>[]> items_;
+    };
+
+    std::atomic<int64_t> top_{0};
+    std::atomic<int64_t> bottom_{0};
+    std::atomic<Array *> array_;
+    std::vector<std::unique_ptr<Array>> retired_;
+};
+}  // namespace
+
+struct ConcurrentTaskQueue::Worker
+{
+    ~Worker()
+    {
+        for (auto &deque : deques_)
+        {
+            while (auto task = deque.pop())
+                delete task;
+        }
+    }
+    void push(Task &&task, size_t priority)
+    {
+        std::lock_guard<std::mutex> lock(inboxMutex_);
+        inboxes_[priority].push_back(std::move(task));
+        inboxCount_.fetch_add(1, std::memory_order_relaxed);
+    }
+    bool pop(size_t priority, Task &task)
+    {
+        if (auto taskPtr = deques_[priority].pop())
+        {
+            task = std::move(*taskPtr);
+            delete taskPtr;
+            return true;
+        }
+        if (inboxCount_.load(std::memory_order_relaxed) == 0)
+            return false;
+        std::lock_guard<std::mutex> lock(inboxMutex_);
+        return popInbox(priority, task);
+    }
+    bool steal(size_t priority, Task &task)
+    {
+        if (!deques_[priority].empty())
+        {
+            if (auto taskPtr = deques_[priority].steal())
+            {
+                task = std::move(*taskPtr);
+                delete taskPtr;
+                return true;
+            }
+        }
+        if (inboxCount_.load(std::memory_order_relaxed) == 0)
+            return false;
+        std::unique_lock<std::mutex> lock(inboxMutex_, std::try_to_lock);
+        if (!lock.owns_lock())
+            return false;
+        return popInbox(priority, task);
+    }
+    bool popInbox(size_t priority, Task &task)
+    {
+        auto &inbox = inboxes_[priority];
+        if (inbox.empty())
+            return false;
+        task = std::move(inbox.front());
+        inbox.pop_front();
+        inboxCount_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // The tasks queued by the tasks running in this thread.
+    StealingDeque<Task> deques_[kPriorityCount];
+    // The tasks queued by other threads.
+    std::mutex inboxMutex_;
+    std::deque<Task> inboxes_[kPriorityCount];
+    std::atomic<size_t> inboxCount_{0};
+};
+
+namespace
+{
+// The queue and the index of the current thread if it is a thread of a queue.
+thread_local ConcurrentTaskQueue *currentQueue{nullptr};
+thread_local size_t currentQueueNum{0};
+}  // namespace
+
 ConcurrentTaskQueue::ConcurrentTaskQueue(size_t threadNum,
                                          const std::string &name)
     : queueCount_(threadNum), queueName_(name), stop_(false)
 {
     assert(threadNum > 0);
     for (unsigned int i = 0; i < queueCount_; ++i)
+    {
+        workers_.emplace_back(new Worker);
+    }
+    for (unsigned int i = 0; i < queueCount_; ++i)
     {
         threads_.push_back(
             std::thread(std::bind(&ConcurrentTaskQueue::queueFunc, this, i)));
@@ -33,16 +240,61 @@ ConcurrentTaskQueue::ConcurrentTaskQueue(size_t threadNum,
 void ConcurrentTaskQueue::runTaskInQueue(const std::function<void()> &task)
 {
     LOG_TRACE << "copy task into queue";
-    std::lock_guard<std::mutex> lock(taskMutex_);
-    taskQueue_.push(task);
-    taskCond_.notify_one();
+    runTaskInQueue(std::function<void()>(task), Priority::kNormal);
 }
 void ConcurrentTaskQueue::runTaskInQueue(std::function<void()> &&task)
 {
     LOG_TRACE << "move task into queue";
-    std::lock_guard<std::mutex> lock(taskMutex_);
-    taskQueue_.push(std::move(task));
-    taskCond_.notify_one();
+    runTaskInQueue(std::move(task), Priority::kNormal);
+}
+void ConcurrentTaskQueue::runTaskInQueue(std::function<void()> &&task,
+                                         Priority priority)
+{
+    auto index = static_cast<size_t>(priority);
+    if (currentQueue == this)
+    {
+        workers_[currentQueueNum]->deques_[index].push(
+            new Task(std::move(task)));
+    }
+    else
+    {
+        auto next = nextWorker_.fetch_add(1, std::memory_order_relaxed);
+        workers_[next % queueCount_]->push(std::move(task), index);
+    }
+    taskCounts_[index].fetch_add(1);
+    if (idleCount_.load() > 0)
+    {
+        std::lock_guard<std::mutex> lock(taskMutex_);
+        taskCond_.notify_one();
+    }
+}
+bool ConcurrentTaskQueue::takeTask(size_t queueNum, Task &task)
+{
+    for (size_t priority = 0; priority < kPriorityCount; ++priority)
+    {
+        if (taskCounts_[priority].load(std::memory_order_relaxed) <= 0)
+            continue;
+        bool found = workers_[queueNum]->pop(priority, task);
+        for (size_t i = 1; !found && i < queueCount_; ++i)
+        {
+            found = workers_[(queueNum + i) % queueCount_]->steal(priority,
+                                                                  task);
+        }
+        if (found)
+        {
+            taskCounts_[priority].fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+int64_t ConcurrentTaskQueue::taskCount() const
+{
+    int64_t count = 0;
+    for (auto &taskCount : taskCounts_)
+        count += taskCount.load();
+    return count;
 }
 void ConcurrentTaskQueue::queueFunc(int queueNum)
 {
@@ -51,39 +303,49 @@ void ConcurrentTaskQueue::queueFunc(int queueNum)
 #ifdef __linux__
     ::prctl(PR_SET_NAME, tmpName);
 #endif
+    currentQueue = this;
+    currentQueueNum = static_cast<size_t>(queueNum);
     while (!stop_)
     {
-        std::function<void()> r;
+        Task task;
+        if (takeTask(queueNum, task))
         {
-            std::unique_lock<std::mutex> lock(taskMutex_);
-            while (!stop_ && taskQueue_.size() == 0)
-            {
-                taskCond_.wait(lock);
-            }
-            if (taskQueue_.size() > 0)
-            {
-                LOG_TRACE << "got a new task!";
-                r = std::move(taskQueue_.front());
-                taskQueue_.pop();
-            }
-            else
-                continue;
+            LOG_TRACE << "got a new task!";
+            task();
+            continue;
         }
-        r();
+        std::unique_lock<std::mutex> lock(taskMutex_);
+        if (taskCount() > 0)
+        {
+            // A task is being queued or was missed by a failed steal.
+            lock.unlock();
+            std::this_thread::yield();
+            continue;
+        }
+        idleCount_.fetch_add(1);
+        while (!stop_ && taskCount() <= 0)
+        {
+            taskCond_.wait(lock);
+        }
+        idleCount_.fetch_sub(1);
     }
+    currentQueue = nullptr;
 }
 
 size_t ConcurrentTaskQueue::getTaskCount()
 {
-    std::lock_guard<std::mutex> guard(taskMutex_);
-    return taskQueue_.size();
+    auto count = taskCount();
+    return count > 0 ? static_cast<size_t>(count) : 0;
 }
 
 void ConcurrentTaskQueue::stop()
 {
     if (!stop_)
     {
-        stop_ = true;
+        {
+            std::lock_guard<std::mutex> lock(taskMutex_);
+            stop_ = true;
+        }
         taskCond_.notify_all();
         for (auto &t : threads_)
             t.join();
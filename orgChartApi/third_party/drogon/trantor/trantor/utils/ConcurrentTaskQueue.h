@@ -16,11 +16,14 @@
 
 #include <trantor/utils/TaskQueue.h>
 #include <trantor/exports.h>
-#include <list>
+#include <atomic>
+#include <condition_variable>
+#include <future>
 #include <memory>
-#include <vector>
-#include <queue>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace trantor
 {
@@ -28,10 +31,25 @@ namespace trantor
  * @brief This class implements a task queue running in parallel. Basically this
  * can be called a threads pool.
  *
+ * Every thread of the queue has its own deques of tasks. Tasks queued by a
+ * task running in the queue go to the deque of its thread, tasks queued by
+ * other threads are spread over the threads of the queue, and an idle thread
+ * steals tasks from the others. So the threads don't contend on one lock.
  */
 class TRANTOR_EXPORT ConcurrentTaskQueue : public TaskQueue
 {
   public:
+    /**
+     * @brief The priorities of tasks. The tasks with a higher priority are
+     * run first, tasks with the same priority are not ordered.
+     */
+    enum class Priority
+    {
+        kHigh = 0,
+        kNormal,
+        kLow
+    };
+
     /**
      * @brief Construct a new concurrent task queue instance.
      *
@@ -48,6 +66,39 @@ class TRANTOR_EXPORT ConcurrentTaskQueue : public TaskQueue
     virtual void runTaskInQueue(const std::function<void()> &task);
     virtual void runTaskInQueue(std::function<void()> &&task);
 
+    /**
+     * @brief Run a task in the queue with the given priority.
+     *
+     * @param task
+     * @param priority
+     */
+    void runTaskInQueue(std::function<void()> &&task, Priority priority);
+
+    /**
+     * @brief Run a function in the queue and get its result.
+     *
+     * @param func The function to run, it takes no argument.
+     * @param priority
+     * @return std::future The future of the return value of the function, it
+     * also gets the exception thrown by the function.
+     * @code
+       auto future = queue.submit([password]() { return hash(password); });
+       ...
+       auto hashed = future.get();
+       @endcode
+     */
+    template <typename Func>
+    auto submit(Func &&func, Priority priority = Priority::kNormal)
+        -> std::future<decltype(func())>
+    {
+        using Result = decltype(func());
+        auto task = std::make_shared<std::packaged_task<Result()>>(
+            std::forward<Func>(func));
+        auto future = task->get_future();
+        runTaskInQueue([task]() { (*task)(); }, priority);
+        return future;
+    }
+
     /**
      * @brief Get the name of the queue.
      *
@@ -74,16 +125,27 @@ class TRANTOR_EXPORT ConcurrentTaskQueue : public TaskQueue
     ~ConcurrentTaskQueue();
 
   private:
+    struct Worker;
+    using Task = std::function<void()>;
+
     size_t queueCount_;
     std::string queueName_;
 
-    std::queue<std::function<void()>> taskQueue_;
+    std::vector<std::unique_ptr<Worker>> workers_;
     std::vector<std::thread> threads_;
+    // The numbers of tasks queued and not taken by a thread yet, for each
+    // priority.
+    std::atomic<int64_t> taskCounts_[3]{};
+    std::atomic<size_t> nextWorker_{0};
 
+    // Idle threads wait on the condition.
     std::mutex taskMutex_;
     std::condition_variable taskCond_;
+    std::atomic<size_t> idleCount_{0};
     std::atomic_bool stop_;
     void queueFunc(int queueNum);
+    bool takeTask(size_t queueNum, Task &task);
+    int64_t taskCount() const;
 };
 
 }  // namespace trantor
@@ -19,6 +19,7 @@
 #endif
 #include <cstdlib>
 #include <iostream>
+#include <limits>
 #include <string.h>
 #ifdef _WIN32
 #include <WinSock2.h>
@@ -49,6 +50,129 @@ int gettimeofday(timeval *tp, void *tzp)
     return (0);
 }
 #endif
+namespace
+{
+// The seconds part of the last date formatted by the current thread for
+// each kind of format, so formatting dates of the same second only appends
+// the microseconds.
+enum FormatKind
+{
+    kUtc = 0,
+    kLocal,
+    kCustomUtc,
+    kCustomLocal,
+    kNumberOfFormatKinds
+};
+struct FormatCache
+{
+    int64_t second{std::numeric_limits<int64_t>::min()};
+    std::string format;
+    size_t length{0};
+    char buf[256];
+};
+
+const FormatCache &formatSeconds(FormatKind kind,
+                                 int64_t microSecondsSinceEpoch,
+                                 const std::string *fmtStr = nullptr)
+{
+    static thread_local FormatCache caches[kNumberOfFormatKinds];
+    auto &cache = caches[kind];
+    auto second = microSecondsSinceEpoch / MICRO_SECONDS_PRE_SEC;
+    if (second == cache.second && (!fmtStr || *fmtStr == cache.format))
+        return cache;
+    time_t seconds = static_cast<time_t>(second);
+    struct tm tm_time;
+    if (kind == kLocal || kind == kCustomLocal)
+    {
+#ifndef _WIN32
+        localtime_r(&seconds, &tm_time);
+#else
+        localtime_s(&tm_time, &seconds);
+#endif
+    }
+    else
+    {
+#ifndef _WIN32
+        gmtime_r(&seconds, &tm_time);
+#else
+        gmtime_s(&tm_time, &seconds);
+#endif
+    }
+    if (fmtStr)
+    {
+        cache.format = *fmtStr;
+        cache.length =
+            strftime(cache.buf, sizeof(cache.buf), fmtStr->c_str(), &tm_time);
+    }
+    else
+    {
+        auto len = snprintf(cache.buf,
+                            sizeof(cache.buf),
+                            "%4d%02d%02d %02d:%02d:%02d",
+                            tm_time.tm_year + 1900,
+                            tm_time.tm_mon + 1,
+                            tm_time.tm_mday,
+                            tm_time.tm_hour,
+                            tm_time.tm_min,
+                            tm_time.tm_sec);
+        cache.length = len > 0 ? static_cast<size_t>(len) : 0;
+    }
+    cache.second = second;
+    return cache;
+}
+
+// Formats the date of the cache and the microseconds into buf, which has at
+// least 12 more bytes than the cache.
+size_t appendMicroseconds(const FormatCache &cache,
+                          int64_t microSecondsSinceEpoch,
+                          bool showMicroseconds,
+                          char *buf)
+{
+    memcpy(buf, cache.buf, cache.length);
+    auto p = buf + cache.length;
+    if (!showMicroseconds)
+        return cache.length;
+    int microseconds =
+        static_cast<int>(microSecondsSinceEpoch % MICRO_SECONDS_PRE_SEC);
+    if (microseconds < 0)
+    {
+        return cache.length +
+               static_cast<size_t>(snprintf(p, 12, ".%06d", microseconds));
+    }
+    *p = '.';
+    for (int i = 6; i > 0; --i)
+    {
+        p[i] = static_cast<char>('0' + microseconds % 10);
+        microseconds /= 10;
+    }
+    return cache.length + 7;
+}
+
+std::string formatDate(FormatKind kind,
+                       int64_t microSecondsSinceEpoch,
+                       bool showMicroseconds,
+                       const std::string *fmtStr = nullptr)
+{
+    const auto &cache = formatSeconds(kind, microSecondsSinceEpoch, fmtStr);
+    char buf[sizeof(cache.buf) + 12];
+    return std::string(buf,
+                       appendMicroseconds(cache,
+                                          microSecondsSinceEpoch,
+                                          showMicroseconds,
+                                          buf));
+}
+}  // namespace
+
+// Used by Logger, formats the UTC date like toFormattedString(true) into buf
+// which has at least 32 bytes.
+size_t formatUtcDate(int64_t microSecondsSinceEpoch, char *buf)
+{
+    return appendMicroseconds(formatSeconds(kUtc, microSecondsSinceEpoch),
+                              microSecondsSinceEpoch,
+                              true,
+                              buf);
+}
+
 const Date Date::date()
 {
 #ifndef _WIN32
@@ -102,66 +226,15 @@ struct tm Date::tmStruct() const
 }
 std::string Date::toFormattedString(bool showMicroseconds) const
 {
-    //  std::cout<<"toFormattedString"<<std::endl;
-    char buf[128] = {0};
-    time_t seconds =
-        static_cast<time_t>(microSecondsSinceEpoch_ / MICRO_SECONDS_PRE_SEC);
-    struct tm tm_time;
-#ifndef _WIN32
-    gmtime_r(&seconds, &tm_time);
-#else
-    gmtime_s(&tm_time, &seconds);
-#endif
-
-    if (showMicroseconds)
-    {
-        int microseconds =
-            static_cast<int>(microSecondsSinceEpoch_ % MICRO_SECONDS_PRE_SEC);
-        snprintf(buf,
-                 sizeof(buf),
-                 "%4d%02d%02d %02d:%02d:%02d.%06d",
-                 tm_time.tm_year + 1900,
-                 tm_time.tm_mon + 1,
-                 tm_time.tm_mday,
-                 tm_time.tm_hour,
-                 tm_time.tm_min,
-                 tm_time.tm_sec,
-                 microseconds);
-    }
-    else
-    {
-        snprintf(buf,
-                 sizeof(buf),
-                 "%4d%02d%02d %02d:%02d:%02d",
-                 tm_time.tm_year + 1900,
-                 tm_time.tm_mon + 1,
-                 tm_time.tm_mday,
-                 tm_time.tm_hour,
-                 tm_time.tm_min,
-                 tm_time.tm_sec);
-    }
-    return buf;
+    return formatDate(kUtc, microSecondsSinceEpoch_, showMicroseconds);
 }
 std::string Date::toCustomedFormattedString(const std::string &fmtStr,
                                             bool showMicroseconds) const
 {
-    char buf[256] = {0};
-    time_t seconds =
-        static_cast<time_t>(microSecondsSinceEpoch_ / MICRO_SECONDS_PRE_SEC);
-    struct tm tm_time;
-#ifndef _WIN32
-    gmtime_r(&seconds, &tm_time);
-#else
-    gmtime_s(&tm_time, &seconds);
-#endif
-    strftime(buf, sizeof(buf), fmtStr.c_str(), &tm_time);
-    if (!showMicroseconds)
-        return std::string(buf);
-    char decimals[12] = {0};
-    int microseconds =
-        static_cast<int>(microSecondsSinceEpoch_ % MICRO_SECONDS_PRE_SEC);
-    snprintf(decimals, sizeof(decimals), ".%06d", microseconds);
-    return std::string(buf) + decimals;
+    return formatDate(kCustomUtc,
+                      microSecondsSinceEpoch_,
+                      showMicroseconds,
+                      &fmtStr);
 }
 void Date::toCustomedFormattedString(const std::string &fmtStr,
                                      char *str,
@@ -180,45 +253,7 @@ void Date::toCustomedFormattedString(const std::string &fmtStr,
 }
 std::string Date::toFormattedStringLocal(bool showMicroseconds) const
 {
-    //  std::cout<<"toFormattedString"<<std::endl;
-    char buf[128] = {0};
-    time_t seconds =
-        static_cast<time_t>(microSecondsSinceEpoch_ / MICRO_SECONDS_PRE_SEC);
-    struct tm tm_time;
-#ifndef _WIN32
-    localtime_r(&seconds, &tm_time);
-#else
-    localtime_s(&tm_time, &seconds);
-#endif
-
-    if (showMicroseconds)
-    {
-        int microseconds =
-            static_cast<int>(microSecondsSinceEpoch_ % MICRO_SECONDS_PRE_SEC);
-        snprintf(buf,
-                 sizeof(buf),
-                 "%4d%02d%02d %02d:%02d:%02d.%06d",
-                 tm_time.tm_year + 1900,
-                 tm_time.tm_mon + 1,
-                 tm_time.tm_mday,
-                 tm_time.tm_hour,
-                 tm_time.tm_min,
-                 tm_time.tm_sec,
-                 microseconds);
-    }
-    else
-    {
-        snprintf(buf,
-                 sizeof(buf),
-                 "%4d%02d%02d %02d:%02d:%02d",
-                 tm_time.tm_year + 1900,
-                 tm_time.tm_mon + 1,
-                 tm_time.tm_mday,
-                 tm_time.tm_hour,
-                 tm_time.tm_min,
-                 tm_time.tm_sec);
-    }
-    return buf;
+    return formatDate(kLocal, microSecondsSinceEpoch_, showMicroseconds);
 }
 std::string Date::toDbStringLocal() const
 {
@@ -315,23 +350,10 @@ Date Date::fromDbStringLocal(const std::string &datetime)
 std::string Date::toCustomedFormattedStringLocal(const std::string &fmtStr,
                                                  bool showMicroseconds) const
 {
-    char buf[256] = {0};
-    time_t seconds =
-        static_cast<time_t>(microSecondsSinceEpoch_ / MICRO_SECONDS_PRE_SEC);
-    struct tm tm_time;
-#ifndef _WIN32
-    localtime_r(&seconds, &tm_time);
-#else
-    localtime_s(&tm_time, &seconds);
-#endif
-    strftime(buf, sizeof(buf), fmtStr.c_str(), &tm_time);
-    if (!showMicroseconds)
-        return std::string(buf);
-    char decimals[12] = {0};
-    int microseconds =
-        static_cast<int>(microSecondsSinceEpoch_ % MICRO_SECONDS_PRE_SEC);
-    snprintf(decimals, sizeof(decimals), ".%06d", microseconds);
-    return std::string(buf) + decimals;
+    return formatDate(kCustomLocal,
+                      microSecondsSinceEpoch_,
+                      showMicroseconds,
+                      &fmtStr);
 }
 Date::Date(unsigned int year,
            unsigned int month,
@@ -0,0 +1,100 @@
+/**
+ *
+ *  LatencyHistogram.cc
+ *  An Tao
+ *
+ *  Public header file in trantor lib.
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the License file.
+ *
+ *
+ */
+
+#include <trantor/utils/LatencyHistogram.h>
+#include <algorithm>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+using namespace trantor;
+
+constexpr size_t LatencyHistogram::kSubBucketBits;
+constexpr size_t LatencyHistogram::kSubBuckets;
+constexpr size_t LatencyHistogram::kMaxExponent;
+constexpr size_t LatencyHistogram::kBucketCount;
+
+namespace
+{
+// The index of the highest bit set, the value must not be 0.
+inline size_t highestBit(uint64_t value)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return static_cast<size_t>(index);
+#else
+    return static_cast<size_t>(63 - __builtin_clzll(value));
+#endif
+}
+}  // namespace
+
+LatencyHistogram::LatencyHistogram()
+{
+    for (auto &bucket : buckets_)
+        bucket.store(0, std::memory_order_relaxed);
+}
+
+size_t LatencyHistogram::bucketIndex(uint64_t value)
+{
+    if (value < kSubBuckets)
+        return static_cast<size_t>(value);
+    auto exponent = highestBit(value);
+    if (exponent >= kMaxExponent)
+        return kBucketCount - 1;
+    auto subBucket = (value >> (exponent - kSubBucketBits)) & (kSubBuckets - 1);
+    return (exponent - kSubBucketBits + 1) * kSubBuckets +
+           static_cast<size_t>(subBucket);
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t index)
+{
+    if (index < kSubBuckets)
+        return index;
+    if (index >= kBucketCount - 1)
+        return UINT64_MAX;
+    auto exponent = index / kSubBuckets + kSubBucketBits - 1;
+    auto subBucket = index % kSubBuckets;
+    auto width = uint64_t{1} << (exponent - kSubBucketBits);
+    return ((kSubBuckets + subBucket) << (exponent - kSubBucketBits)) + width -
+           1;
+}
+
+uint64_t LatencyHistogram::percentile(double percentile) const
+{
+    uint64_t total = 0;
+    for (auto &bucket : buckets_)
+        total += bucket.load(std::memory_order_relaxed);
+    if (total == 0)
+        return 0;
+    auto rank = static_cast<uint64_t>(percentile / 100 * total + 0.5);
+    rank = (std::max)(rank, uint64_t{1});
+    uint64_t counted = 0;
+    for (size_t i = 0; i < kBucketCount; ++i)
+    {
+        counted += buckets_[i].load(std::memory_order_relaxed);
+        if (counted >= rank)
+            return (std::min)(bucketUpperBound(i), max());
+    }
+    return max();
+}
+
+void LatencyHistogram::reset()
+{
+    for (auto &bucket : buckets_)
+        bucket.store(0, std::memory_order_relaxed);
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
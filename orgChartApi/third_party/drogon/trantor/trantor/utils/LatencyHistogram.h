@@ -0,0 +1,122 @@
+/**
+ *
+ *  @file LatencyHistogram.h
+ *  @author An Tao
+ *
+ *  Public header file in trantor lib.
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the License file.
+ *
+ *
+ */
+
+#pragma once
+#include <trantor/utils/NonCopyable.h>
+#include <trantor/exports.h>
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace trantor
+{
+/**
+ * @brief This class represents a histogram of values, usually durations in
+ * nanoseconds, with buckets growing exponentially like HDR histograms.
+ *
+ * Values under 8 are counted exactly, bigger values are counted in 8 buckets
+ * per power of two, so a percentile is within 12.5% of the real value.
+ *
+ * Only one thread may record values, usually the thread of an event loop.
+ * Other threads can read the histogram at any time, the counters are read
+ * one by one, so the result is not an exact snapshot.
+ */
+class TRANTOR_EXPORT LatencyHistogram : public NonCopyable
+{
+  public:
+    static constexpr size_t kSubBucketBits{3};
+    static constexpr size_t kSubBuckets{1 << kSubBucketBits};
+    // Values from 2^kMaxExponent (about 18 minutes in nanoseconds) are
+    // counted in the last bucket.
+    static constexpr size_t kMaxExponent{40};
+    static constexpr size_t kBucketCount{(kMaxExponent - kSubBucketBits + 1) *
+                                         kSubBuckets};
+
+    LatencyHistogram();
+
+    /**
+     * @brief Record a value.
+     *
+     * @param value
+     */
+    void record(uint64_t value)
+    {
+        auto &bucket = buckets_[bucketIndex(value)];
+        bucket.store(bucket.load(std::memory_order_relaxed) + 1,
+                     std::memory_order_relaxed);
+        count_.store(count_.load(std::memory_order_relaxed) + 1,
+                     std::memory_order_relaxed);
+        sum_.store(sum_.load(std::memory_order_relaxed) + value,
+                   std::memory_order_relaxed);
+        if (value > max_.load(std::memory_order_relaxed))
+            max_.store(value, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Return the number of values recorded.
+     */
+    uint64_t count() const
+    {
+        return count_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Return the sum of the values recorded.
+     */
+    uint64_t sum() const
+    {
+        return sum_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Return the maximum value recorded.
+     */
+    uint64_t max() const
+    {
+        return max_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Return the value at a percentile.
+     *
+     * @param percentile between 0 and 100.
+     * @return uint64_t The upper bound of the bucket of the value, 0 if no
+     * value is recorded.
+     */
+    uint64_t percentile(double percentile) const;
+
+    /**
+     * @brief Set all counters to 0. It must be called in the thread recording
+     * values.
+     */
+    void reset();
+
+    /**
+     * @brief Return the index of the bucket counting a value.
+     */
+    static size_t bucketIndex(uint64_t value);
+
+    /**
+     * @brief Return the largest value counted by a bucket.
+     */
+    static uint64_t bucketUpperBound(size_t index);
+
+  private:
+    std::atomic<uint64_t> buckets_[kBucketCount];
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+}  // namespace trantor
@@ -13,8 +13,10 @@
  */
 
 #include <trantor/utils/Logger.h>
+#include <mutex>
 #include <stdio.h>
 #include <thread>
+#include <unordered_map>
 #ifdef __unix__
 #include <unistd.h>
 #include <sys/syscall.h>
@@ -54,6 +56,151 @@ const char *strerror_tl(int savedErrno)
 #endif
 }
 
+namespace
+{
+// The log levels of modules. The levels of source files are cached in an
+// open addressing table keyed by the address of __FILE__, which is written
+// with the mutex held and read without locking. A file is only cached within
+// kMaxProbes slots of its hash, files which don't fit (which is unlikely
+// unless the table is nearly full) use the global level.
+struct ModuleLogLevels
+{
+    static constexpr size_t kSlotNum = 1024;
+    static constexpr size_t kMaxProbes = 16;
+    // The cached level of source files without a module level.
+    static constexpr int kGlobalLevel = -1;
+    struct Slot
+    {
+        std::atomic<const char *> file{nullptr};
+        std::atomic<int> level{kGlobalLevel};
+    };
+
+    static size_t hash(const char *file)
+    {
+        auto h = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(file));
+        return static_cast<size_t>((h * 0x9E3779B97F4A7C15ULL) >> 54);
+    }
+    int levelOf(const char *file) const
+    {
+        const char *name = file;
+        for (auto p = file; *p; ++p)
+        {
+            if (*p == '/' || *p == '\\')
+                name = p + 1;
+        }
+        auto iter = levels.find(std::string(name, strcspn(name, ".")));
+        if (iter == levels.end())
+            return kGlobalLevel;
+        return iter->second;
+    }
+    void refresh()
+    {
+        for (auto &slot : slots)
+        {
+            auto file = slot.file.load(std::memory_order_relaxed);
+            if (file)
+                slot.level.store(levelOf(file), std::memory_order_relaxed);
+        }
+    }
+
+    std::mutex mutex;
+    std::unordered_map<std::string, Logger::LogLevel> levels;
+    Slot slots[kSlotNum];
+};
+
+ModuleLogLevels &moduleLogLevels()
+{
+    static ModuleLogLevels modules;
+    return modules;
+}
+}  // namespace
+
+void Logger::setModuleLogLevel(const std::string &module, LogLevel level)
+{
+    {
+        auto &modules = moduleLogLevels();
+        std::lock_guard<std::mutex> lock(modules.mutex);
+        modules.levels[module] = level;
+        modules.refresh();
+    }
+    updateLowestLogLevel();
+}
+
+void Logger::removeModuleLogLevel(const std::string &module)
+{
+    {
+        auto &modules = moduleLogLevels();
+        std::lock_guard<std::mutex> lock(modules.mutex);
+        modules.levels.erase(module);
+        modules.refresh();
+    }
+    updateLowestLogLevel();
+}
+
+void Logger::updateLowestLogLevel()
+{
+    auto &modules = moduleLogLevels();
+    std::lock_guard<std::mutex> lock(modules.mutex);
+    auto lowest = logLevel_();
+    for (auto &module : modules.levels)
+    {
+        if (module.second < lowest)
+            lowest = module.second;
+    }
+    if (modules.levels.empty())
+    {
+        lowestLogLevel_().store(lowest);
+        hasModuleLogLevels_().store(false);
+    }
+    else
+    {
+        hasModuleLogLevels_().store(true);
+        lowestLogLevel_().store(lowest);
+    }
+}
+
+Logger::LogLevel Logger::logLevel(const char *file)
+{
+    auto &modules = moduleLogLevels();
+    auto index = ModuleLogLevels::hash(file);
+    size_t i = 0;
+    for (; i < ModuleLogLevels::kMaxProbes; ++i)
+    {
+        auto &slot = modules.slots[(index + i) % ModuleLogLevels::kSlotNum];
+        auto cached = slot.file.load(std::memory_order_acquire);
+        if (cached == file)
+        {
+            auto level = slot.level.load(std::memory_order_relaxed);
+            return level == ModuleLogLevels::kGlobalLevel
+                       ? logLevel_()
+                       : static_cast<LogLevel>(level);
+        }
+        if (!cached)
+            break;
+    }
+    // Not cached and there is no room for the file, slots are never freed.
+    if (i == ModuleLogLevels::kMaxProbes)
+        return logLevel_();
+    std::lock_guard<std::mutex> lock(modules.mutex);
+    auto level = modules.levelOf(file);
+    for (i = 0; i < ModuleLogLevels::kMaxProbes; ++i)
+    {
+        auto &slot = modules.slots[(index + i) % ModuleLogLevels::kSlotNum];
+        auto cached = slot.file.load(std::memory_order_relaxed);
+        if (cached == file)
+            break;
+        if (!cached)
+        {
+            slot.level.store(level, std::memory_order_relaxed);
+            slot.file.store(file, std::memory_order_release);
+            break;
+        }
+    }
+    return level == ModuleLogLevels::kGlobalLevel
+               ? logLevel_()
+               : static_cast<LogLevel>(level);
+}
+
 inline LogStream &operator<<(LogStream &s, T v)
 {
     s.append(v.str_, v.len_);
@@ -68,8 +215,6 @@ inline LogStream &operator<<(LogStream &s, const Logger::SourceFile &v)
 }  // namespace trantor
 using namespace trantor;
 
-static thread_local uint64_t lastSecond_{0};
-static thread_local char lastTimeString_[32] = {0};
 #ifdef __linux__
 static thread_local pid_t threadId_{0};
 #else
@@ -77,33 +222,12 @@ static thread_local uint64_t threadId_{0};
 #endif
 //   static thread_local LogStream logStream_;
 
-void Logger::formatTime()
+namespace trantor
+{
+extern size_t formatUtcDate(int64_t microSecondsSinceEpoch, char *buf);
+
+uint64_t currentThreadId()
 {
-    uint64_t now = static_cast<uint64_t>(date_.secondsSinceEpoch());
-    uint64_t microSec =
-        static_cast<uint64_t>(date_.microSecondsSinceEpoch() -
-                              date_.roundSecond().microSecondsSinceEpoch());
-    if (now != lastSecond_)
-    {
-        lastSecond_ = now;
-#ifndef _MSC_VER
-        strncpy(lastTimeString_,
-                date_.toFormattedString(false).c_str(),
-                sizeof(lastTimeString_) - 1);
-#else
-        strncpy_s<sizeof lastTimeString_>(
-            lastTimeString_,
-            date_.toFormattedString(false).c_str(),
-            sizeof(lastTimeString_) - 1);
-#endif
-    }
-    logStream_ << T(lastTimeString_, 17);
-    char tmp[32];
-    snprintf(tmp,
-             sizeof(tmp),
-             ".%06llu UTC ",
-             static_cast<long long unsigned int>(microSec));
-    logStream_ << T(tmp, 12);
 #ifdef __linux__
     if (threadId_ == 0)
         threadId_ = static_cast<pid_t>(::syscall(SYS_gettid));
@@ -130,7 +254,17 @@ void Logger::formatTime()
         pthread_threadid_np(NULL, &threadId_);
     }
 #endif
-    logStream_ << threadId_;
+    return static_cast<uint64_t>(threadId_);
+}
+}  // namespace trantor
+
+void Logger::formatTime()
+{
+    char buf[32];
+    logStream_.append(buf,
+                      formatUtcDate(date_.microSecondsSinceEpoch(), buf));
+    logStream_ << T(" UTC ", 5);
+    logStream_ << currentThreadId();
 }
 static const char *logLevelStr[Logger::LogLevel::kNumberOfLogLevels] = {
     " TRACE ",
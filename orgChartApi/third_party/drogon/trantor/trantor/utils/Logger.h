@@ -18,9 +18,11 @@
 #include <trantor/utils/Date.h>
 #include <trantor/utils/LogStream.h>
 #include <trantor/exports.h>
+#include <atomic>
 #include <cstring>
 #include <functional>
 #include <iostream>
+#include <string>
 #include <vector>
 
 #define TRANTOR_IF_(cond) for (int _r = 0; _r == 0 && (cond); _r = 1)
@@ -121,6 +123,7 @@ class TRANTOR_EXPORT Logger : public NonCopyable
     static void setLogLevel(LogLevel level)
     {
         logLevel_() = level;
+        updateLowestLogLevel();
     }
 
     /**
@@ -133,6 +136,48 @@ class TRANTOR_EXPORT Logger : public NonCopyable
         return logLevel_();
     }
 
+    /**
+     * @brief Set the log level of a module, which overrides the global log
+     * level for the TRACE, DEBUG and INFO logs of the module. A module is the
+     * base name of source files without the extension, e.g.
+     * "PersonsController" for PersonsController.cc and PersonsController.h.
+     *
+     * @note Module levels can be changed at any time, but every TRACE, DEBUG
+     * or INFO log at or above the lowest level in use costs a lookup of the
+     * level of its source file. The levels of about a thousand source files
+     * are cached, files beyond that use the global level.
+     */
+    static void setModuleLogLevel(const std::string &module, LogLevel level);
+
+    /**
+     * @brief Remove the log level of a module, the logs of the module follow
+     * the global log level again.
+     */
+    static void removeModuleLogLevel(const std::string &module);
+
+    /**
+     * @brief Get the log level of a source file, which is the level of its
+     * module if set, otherwise the global log level.
+     *
+     * @param file The path of the source file, usually __FILE__.
+     */
+    static LogLevel logLevel(const char *file);
+
+    /**
+     * @brief Check if the logs of the level in the source file are printed.
+     * It is used by the LOG_* macros.
+     */
+    static bool shouldLog(LogLevel level, const char *file)
+    {
+        // Logs below the global level and all module levels are filtered
+        // without looking up the module.
+        if (level < lowestLogLevel_().load(std::memory_order_relaxed))
+            return false;
+        if (!hasModuleLogLevels_().load(std::memory_order_relaxed))
+            return true;
+        return logLevel(file) <= level;
+    }
+
   protected:
     static void defaultOutputFunction(const char *msg, const uint64_t len)
     {
@@ -143,15 +188,27 @@ class TRANTOR_EXPORT Logger : public NonCopyable
         fflush(stdout);
     }
     void formatTime();
-    static LogLevel &logLevel_()
-    {
 #ifdef RELEASE
-        static LogLevel logLevel = LogLevel::kInfo;
+    static constexpr LogLevel kDefaultLogLevel = LogLevel::kInfo;
 #else
-        static LogLevel logLevel = LogLevel::kDebug;
+    static constexpr LogLevel kDefaultLogLevel = LogLevel::kDebug;
 #endif
+    static LogLevel &logLevel_()
+    {
+        static LogLevel logLevel = kDefaultLogLevel;
         return logLevel;
     }
+    static std::atomic<LogLevel> &lowestLogLevel_()
+    {
+        static std::atomic<LogLevel> lowestLogLevel{kDefaultLogLevel};
+        return lowestLogLevel;
+    }
+    static std::atomic<bool> &hasModuleLogLevels_()
+    {
+        static std::atomic<bool> hasModuleLogLevels{false};
+        return hasModuleLogLevels;
+    }
+    static void updateLowestLogLevel();
     static std::function<void(const char *msg, const uint64_t len)>
         &outputFunc_()
     {
@@ -219,6 +276,18 @@ class TRANTOR_EXPORT RawLogger : public NonCopyable
     LogStream logStream_;
     int index_{-1};
 };
+#ifndef TRANTOR_MIN_LOG_LEVEL
+// Logs below this level (0 for TRACE, ..., 5 for FATAL) are removed at
+// compile time, see the TRANTOR_MIN_LOG_LEVEL CMake option. LOG_FATAL and
+// LOG_SYSERR are never removed.
+#define TRANTOR_MIN_LOG_LEVEL 0
+#endif
+#define TRANTOR_LOG_COMPILED_(level) \
+    (TRANTOR_MIN_LOG_LEVEL <= trantor::Logger::level)
+#define TRANTOR_LOG_ON_(level)       \
+    (TRANTOR_LOG_COMPILED_(level) && \
+     trantor::Logger::shouldLog(trantor::Logger::level, __FILE__))
+
 #ifdef NDEBUG
 #define LOG_TRACE                                                          \
     TRANTOR_IF_(0)                                                         \
@@ -226,11 +295,11 @@ class TRANTOR_EXPORT RawLogger : public NonCopyable
         .stream()
 #else
 #define LOG_TRACE                                                          \
-    TRANTOR_IF_(trantor::Logger::logLevel() <= trantor::Logger::kTrace)    \
+    TRANTOR_IF_(TRANTOR_LOG_ON_(kTrace))                                   \
     trantor::Logger(__FILE__, __LINE__, trantor::Logger::kTrace, __func__) \
         .stream()
 #define LOG_TRACE_TO(index)                                                \
-    TRANTOR_IF_(trantor::Logger::logLevel() <= trantor::Logger::kTrace)    \
+    TRANTOR_IF_(TRANTOR_LOG_ON_(kTrace))                                   \
     trantor::Logger(__FILE__, __LINE__, trantor::Logger::kTrace, __func__) \
         .setIndex(index)                                                   \
         .stream()
@@ -238,29 +307,33 @@ class TRANTOR_EXPORT RawLogger : public NonCopyable
 #endif
 
 #define LOG_DEBUG                                                          \
-    TRANTOR_IF_(trantor::Logger::logLevel() <= trantor::Logger::kDebug)    \
+    TRANTOR_IF_(TRANTOR_LOG_ON_(kDebug))                                   \
     trantor::Logger(__FILE__, __LINE__, trantor::Logger::kDebug, __func__) \
         .stream()
 #define LOG_DEBUG_TO(index)                                                \
-    TRANTOR_IF_(trantor::Logger::logLevel() <= trantor::Logger::kDebug)    \
+    TRANTOR_IF_(TRANTOR_LOG_ON_(kDebug))                                   \
     trantor::Logger(__FILE__, __LINE__, trantor::Logger::kDebug, __func__) \
         .setIndex(index)                                                   \
         .stream()
-#define LOG_INFO                                                       \
-    TRANTOR_IF_(trantor::Logger::logLevel() <= trantor::Logger::kInfo) \
+#define LOG_INFO                        \
+    TRANTOR_IF_(TRANTOR_LOG_ON_(kInfo)) \
     trantor::Logger(__FILE__, __LINE__).stream()
-#define LOG_INFO_TO(index)                                             \
-    TRANTOR_IF_(trantor::Logger::logLevel() <= trantor::Logger::kInfo) \
+#define LOG_INFO_TO(index)              \
+    TRANTOR_IF_(TRANTOR_LOG_ON_(kInfo)) \
     trantor::Logger(__FILE__, __LINE__).setIndex(index).stream()
-#define LOG_WARN \
+#define LOG_WARN                              \
+    TRANTOR_IF_(TRANTOR_LOG_COMPILED_(kWarn)) \
     trantor::Logger(__FILE__, __LINE__, trantor::Logger::kWarn).stream()
 #define LOG_WARN_TO(index)                                      \
+    TRANTOR_IF_(TRANTOR_LOG_COMPILED_(kWarn))                   \
     trantor::Logger(__FILE__, __LINE__, trantor::Logger::kWarn) \
         .setIndex(index)                                        \
         .stream()
-#define LOG_ERROR \
+#define LOG_ERROR                              \
+    TRANTOR_IF_(TRANTOR_LOG_COMPILED_(kError)) \
     trantor::Logger(__FILE__, __LINE__, trantor::Logger::kError).stream()
 #define LOG_ERROR_TO(index)                                      \
+    TRANTOR_IF_(TRANTOR_LOG_COMPILED_(kError))                   \
     trantor::Logger(__FILE__, __LINE__, trantor::Logger::kError) \
         .setIndex(index)                                         \
         .stream()
@@ -277,25 +350,22 @@ class TRANTOR_EXPORT RawLogger : public NonCopyable
 #define LOG_RAW trantor::RawLogger().stream()
 #define LOG_RAW_TO(index) trantor::RawLogger().setIndex(index).stream()
 
-#define LOG_TRACE_IF(cond)                                                  \
-    TRANTOR_IF_((trantor::Logger::logLevel() <= trantor::Logger::kTrace) && \
-                (cond))                                                     \
-    trantor::Logger(__FILE__, __LINE__, trantor::Logger::kTrace, __func__)  \
+#define LOG_TRACE_IF(cond)                                                 \
+    TRANTOR_IF_(TRANTOR_LOG_ON_(kTrace) && (cond))                         \
+    trantor::Logger(__FILE__, __LINE__, trantor::Logger::kTrace, __func__) \
         .stream()
-#define LOG_DEBUG_IF(cond)                                                  \
-    TRANTOR_IF_((trantor::Logger::logLevel() <= trantor::Logger::kDebug) && \
-                (cond))                                                     \
-    trantor::Logger(__FILE__, __LINE__, trantor::Logger::kDebug, __func__)  \
+#define LOG_DEBUG_IF(cond)                                                 \
+    TRANTOR_IF_(TRANTOR_LOG_ON_(kDebug) && (cond))                         \
+    trantor::Logger(__FILE__, __LINE__, trantor::Logger::kDebug, __func__) \
         .stream()
-#define LOG_INFO_IF(cond)                                                  \
-    TRANTOR_IF_((trantor::Logger::logLevel() <= trantor::Logger::kInfo) && \
-                (cond))                                                    \
+#define LOG_INFO_IF(cond)                         \
+    TRANTOR_IF_(TRANTOR_LOG_ON_(kInfo) && (cond)) \
     trantor::Logger(__FILE__, __LINE__).stream()
-#define LOG_WARN_IF(cond) \
-    TRANTOR_IF_(cond)     \
+#define LOG_WARN_IF(cond)                               \
+    TRANTOR_IF_(TRANTOR_LOG_COMPILED_(kWarn) && (cond)) \
     trantor::Logger(__FILE__, __LINE__, trantor::Logger::kWarn).stream()
-#define LOG_ERROR_IF(cond) \
-    TRANTOR_IF_(cond)      \
+#define LOG_ERROR_IF(cond)                               \
+    TRANTOR_IF_(TRANTOR_LOG_COMPILED_(kError) && (cond)) \
     trantor::Logger(__FILE__, __LINE__, trantor::Logger::kError).stream()
 #define LOG_FATAL_IF(cond) \
     TRANTOR_IF_(cond)      \
@@ -345,42 +415,41 @@ class TRANTOR_EXPORT RawLogger : public NonCopyable
     trantor::Logger(__FILE__, __LINE__, trantor::Logger::kFatal).stream()
 #else
 #define DLOG_TRACE                                                         \
-    TRANTOR_IF_(trantor::Logger::logLevel() <= trantor::Logger::kTrace)    \
+    TRANTOR_IF_(TRANTOR_LOG_ON_(kTrace))                                   \
     trantor::Logger(__FILE__, __LINE__, trantor::Logger::kTrace, __func__) \
         .stream()
 #define DLOG_DEBUG                                                         \
-    TRANTOR_IF_(trantor::Logger::logLevel() <= trantor::Logger::kDebug)    \
+    TRANTOR_IF_(TRANTOR_LOG_ON_(kDebug))                                   \
     trantor::Logger(__FILE__, __LINE__, trantor::Logger::kDebug, __func__) \
         .stream()
-#define DLOG_INFO                                                      \
-    TRANTOR_IF_(trantor::Logger::logLevel() <= trantor::Logger::kInfo) \
+#define DLOG_INFO                       \
+    TRANTOR_IF_(TRANTOR_LOG_ON_(kInfo)) \
     trantor::Logger(__FILE__, __LINE__).stream()
-#define DLOG_WARN \
+#define DLOG_WARN                             \
+    TRANTOR_IF_(TRANTOR_LOG_COMPILED_(kWarn)) \
     trantor::Logger(__FILE__, __LINE__, trantor::Logger::kWarn).stream()
-#define DLOG_ERROR \
+#define DLOG_ERROR                             \
+    TRANTOR_IF_(TRANTOR_LOG_COMPILED_(kError)) \
     trantor::Logger(__FILE__, __LINE__, trantor::Logger::kError).stream()
 #define DLOG_FATAL \
     trantor::Logger(__FILE__, __LINE__, trantor::Logger::kFatal).stream()
 
-#define DLOG_TRACE_IF(cond)                                                 \
-    TRANTOR_IF_((trantor::Logger::logLevel() <= trantor::Logger::kTrace) && \
-                (cond))                                                     \
-    trantor::Logger(__FILE__, __LINE__, trantor::Logger::kTrace, __func__)  \
+#define DLOG_TRACE_IF(cond)                                                \
+    TRANTOR_IF_(TRANTOR_LOG_ON_(kTrace) && (cond))                         \
+    trantor::Logger(__FILE__, __LINE__, trantor::Logger::kTrace, __func__) \
         .stream()
-#define DLOG_DEBUG_IF(cond)                                                 \
-    TRANTOR_IF_((trantor::Logger::logLevel() <= trantor::Logger::kDebug) && \
-                (cond))                                                     \
-    trantor::Logger(__FILE__, __LINE__, trantor::Logger::kDebug, __func__)  \
+#define DLOG_DEBUG_IF(cond)                                                \
+    TRANTOR_IF_(TRANTOR_LOG_ON_(kDebug) && (cond))                         \
+    trantor::Logger(__FILE__, __LINE__, trantor::Logger::kDebug, __func__) \
         .stream()
-#define DLOG_INFO_IF(cond)                                                 \
-    TRANTOR_IF_((trantor::Logger::logLevel() <= trantor::Logger::kInfo) && \
-                (cond))                                                    \
+#define DLOG_INFO_IF(cond)                        \
+    TRANTOR_IF_(TRANTOR_LOG_ON_(kInfo) && (cond)) \
     trantor::Logger(__FILE__, __LINE__).stream()
-#define DLOG_WARN_IF(cond) \
-    TRANTOR_IF_(cond)      \
+#define DLOG_WARN_IF(cond)                              \
+    TRANTOR_IF_(TRANTOR_LOG_COMPILED_(kWarn) && (cond)) \
     trantor::Logger(__FILE__, __LINE__, trantor::Logger::kWarn).stream()
-#define DLOG_ERROR_IF(cond) \
-    TRANTOR_IF_(cond)       \
+#define DLOG_ERROR_IF(cond)                              \
+    TRANTOR_IF_(TRANTOR_LOG_COMPILED_(kError) && (cond)) \
     trantor::Logger(__FILE__, __LINE__, trantor::Logger::kError).stream()
 #define DLOG_FATAL_IF(cond) \
     TRANTOR_IF_(cond)       \
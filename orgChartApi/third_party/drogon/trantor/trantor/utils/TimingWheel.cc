@@ -13,64 +13,135 @@
  */
 
 #include <trantor/utils/TimingWheel.h>
+#include <algorithm>
 
 using namespace trantor;
 
+constexpr size_t TimingWheel::kMaxBucketsNum;
+constexpr size_t TimingWheel::kPoolChunkSize;
+
+void TimingWheel::Node::unlink()
+{
+    if (!wheel_)
+        return;
+    prev_->next_ = next_;
+    next_->prev_ = prev_;
+    prev_ = nullptr;
+    next_ = nullptr;
+    wheel_ = nullptr;
+}
+
 TimingWheel::TimingWheel(trantor::EventLoop *loop,
                          size_t maxTimeout,
                          float ticksInterval,
                          size_t bucketsNumPerWheel)
-    : loop_(loop),
-      ticksInterval_(ticksInterval),
-      bucketsNumPerWheel_(bucketsNumPerWheel)
+    : loop_(loop), ticksInterval_(ticksInterval)
 {
     assert(maxTimeout > 1);
     assert(ticksInterval > 0);
-    assert(bucketsNumPerWheel_ > 1);
+    assert(bucketsNumPerWheel > 1);
+    (void)bucketsNumPerWheel;
     size_t maxTickNum = static_cast<size_t>(maxTimeout / ticksInterval);
-    auto ticksNum = bucketsNumPerWheel;
-    wheelsNum_ = 1;
-    while (maxTickNum > ticksNum)
+    // One more bucket than the longest delay, so a node is never inserted
+    // into the bucket being expired.
+    buckets_.resize((std::min)(maxTickNum + 2, kMaxBucketsNum));
+    for (auto &bucket : buckets_)
     {
-        ++wheelsNum_;
-        ticksNum *= bucketsNumPerWheel_;
+        bucket.prev_ = &bucket;
+        bucket.next_ = &bucket;
     }
-    wheels_.resize(wheelsNum_);
-    for (size_t i = 0; i < wheelsNum_; ++i)
+    timerId_ = loop_->runEvery(ticksInterval_, [this]() { onTick(); });
+}
+
+TimingWheel::~TimingWheel()
+{
+    loop_->assertInLoopThread();
+    loop_->invalidateTimer(timerId_);
+    // Release the entries, embedded nodes are just removed.
+    for (auto &bucket : buckets_)
     {
-        wheels_[i].resize(bucketsNumPerWheel_);
-    }
-    timerId_ = loop_->runEvery(ticksInterval_, [this]() {
-        ++ticksCounter_;
-        size_t t = ticksCounter_;
-        size_t pow = 1;
-        for (size_t i = 0; i < wheelsNum_; ++i)
+        while (bucket.next_ != &bucket)
         {
-            if ((t % pow) == 0)
+            auto node = static_cast<Node *>(bucket.next_);
+            node->unlink();
+            if (node->entry_)
             {
-                EntryBucket tmp;
-                {
-                    // use tmp val to make this critical area as short as
-                    // possible.
-                    wheels_[i].front().swap(tmp);
-                    wheels_[i].pop_front();
-                    wheels_[i].push_back(EntryBucket());
-                }
+                auto entry = std::move(node->entry_);
+                entryNodes_.erase(entry.get());
+                freeNode(node);
             }
-            pow = pow * bucketsNumPerWheel_;
         }
-    });
+    }
+    LOG_TRACE << "TimingWheel destruct!";
 }
 
-TimingWheel::~TimingWheel()
+void TimingWheel::onTick()
 {
-    loop_->assertInLoopThread();
-    loop_->invalidateTimer(timerId_);
-    for (auto iter = wheels_.rbegin(); iter != wheels_.rend(); ++iter)
+    size_t tick = ++ticksCounter_;
+    auto &bucket = buckets_[tick % buckets_.size()];
+    while (bucket.next_ != &bucket)
     {
-        iter->clear();
+        auto node = static_cast<Node *>(bucket.next_);
+        node->unlink();
+        if (node->expiredTick_ > tick)
+        {
+            // The delay is longer than the wheel, go around again.
+            link(node);
+        }
+        else if (node->entry_)
+        {
+            // The entry may be inserted again by its destructor.
+            auto entry = std::move(node->entry_);
+            entryNodes_.erase(entry.get());
+            freeNode(node);
+        }
+        else if (node->callback_)
+        {
+            // The node may be destroyed by the callback.
+            node->callback_();
+        }
     }
-    LOG_TRACE << "TimingWheel destruct!";
+}
+
+TimingWheel::Link &TimingWheel::bucketOf(size_t expiredTick)
+{
+    size_t tick = ticksCounter_;
+    size_t ticks = (std::min)(expiredTick - tick, buckets_.size() - 1);
+    return buckets_[(tick + ticks) % buckets_.size()];
+}
+
+void TimingWheel::link(Node *node)
+{
+    auto &bucket = bucketOf(node->expiredTick_);
+    node->prev_ = bucket.prev_;
+    node->next_ = &bucket;
+    bucket.prev_->next_ = node;
+    bucket.prev_ = node;
+    node->wheel_ = this;
+}
+
+TimingWheel::Node *TimingWheel::allocNode()
+{
+    if (!freeNodes_)
+    {
+        pool_.emplace_back(new Node[kPoolChunkSize]);
+        auto chunk = pool_.back().get();
+        for (size_t i = 0; i < kPoolChunkSize; ++i)
+        {
+            chunk[i].next_ = freeNodes_;
+            freeNodes_ = &chunk[i];
+        }
+    }
+    auto node = freeNodes_;
+    freeNodes_ = static_cast<Node *>(node->next_);
+    node->next_ = nullptr;
+    return node;
+}
+
+void TimingWheel::freeNode(Node *node)
+{
+    node->next_ = freeNodes_;
+    freeNodes_ = node;
 }
 
 void TimingWheel::insertEntry(size_t delay, EntryPtr entryPtr)
@@ -81,46 +152,49 @@ void TimingWheel::insertEntry(size_t delay, EntryPtr entryPtr)
         return;
     if (loop_->isInLoopThread())
     {
-        insertEntryInloop(delay, entryPtr);
+        insertEntryInloop(delay, std::move(entryPtr));
     }
     else
     {
-        loop_->runInLoop(
-            [this, delay, entryPtr]() { insertEntryInloop(delay, entryPtr); });
+        loop_->runInLoop([this, delay, entryPtr]() {
+            insertEntryInloop(delay, entryPtr);
+        });
     }
 }
 
 void TimingWheel::insertEntryInloop(size_t delay, EntryPtr entryPtr)
 {
     loop_->assertInLoopThread();
-
-    delay = static_cast<size_t>(delay / ticksInterval_ + 1);
-    size_t t = ticksCounter_;
-    for (size_t i = 0; i < wheelsNum_; ++i)
+    size_t expiredTick = ticksCounter_ + delayTicks(delay);
+    // The entry is held until its latest expiry, so its node is moved later
+    // and kept where it is otherwise.
+    auto iter = entryNodes_.find(entryPtr.get());
+    if (iter != entryNodes_.end())
     {
-        if (delay <= bucketsNumPerWheel_)
-        {
-            wheels_[i][delay - 1].insert(entryPtr);
-            break;
-        }
-        if (i < (wheelsNum_ - 1))
+        auto node = iter->second;
+        if (node->expiredTick_ < expiredTick)
         {
-            entryPtr = std::make_shared<CallbackEntry>(
-                [this, delay, i, t, entryPtr]() {
-                    if (delay > 0)
-                    {
-                        wheels_[i][(delay + (t % bucketsNumPerWheel_) - 1) %
-                                   bucketsNumPerWheel_]
-                            .insert(entryPtr);
-                    }
-                });
+            node->unlink();
+            node->expiredTick_ = expiredTick;
+            link(node);
         }
-        else
-        {
-            // delay is too long to put entry at valid position in wheels;
-            wheels_[i][bucketsNumPerWheel_ - 1].insert(entryPtr);
-        }
-        delay = (delay + (t % bucketsNumPerWheel_) - 1) / bucketsNumPerWheel_;
-        t = t / bucketsNumPerWheel_;
+        return;
     }
-}
\ No newline at end of file
+    auto node = allocNode();
+    entryNodes_.emplace(entryPtr.get(), node);
+    node->entry_ = std::move(entryPtr);
+    node->expiredTick_ = expiredTick;
+    link(node);
+}
+
+void TimingWheel::insertNode(size_t delay, Node *node)
+{
+    loop_->assertInLoopThread();
+    assert(node);
+    size_t expiredTick = ticksCounter_ + delayTicks(delay);
+    if (node->wheel_ == this && node->expiredTick_ == expiredTick)
+        return;
+    node->unlink();
+    node->expiredTick_ = expiredTick;
+    link(node);
+}
@@ -16,8 +16,11 @@
 
 #include <trantor/net/EventLoop.h>
 #include <trantor/utils/Logger.h>
+#include <trantor/utils/NonCopyable.h>
 #include <trantor/exports.h>
+#include <functional>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <deque>
 #include <vector>
@@ -34,13 +37,16 @@ namespace trantor
 {
 using EntryPtr = std::shared_ptr<void>;
 
-using EntryBucket = std::unordered_set<EntryPtr>;
-using BucketQueue = std::deque<EntryBucket>;
-
 /**
  * @brief This class implements a timer strategy with high performance and low
  * accuracy. This is usually used internally.
  *
+ * The wheel is a ring of buckets, one per tick, and every bucket is an
+ * intrusive list of nodes. An object whose lifetime is tracked can embed a
+ * Node, which moves between buckets without any allocation when the object is
+ * refreshed. An entry inserted by insertEntry() is held by one node allocated
+ * from a pool of the wheel, inserting it again moves that node, so the wheel
+ * holds at most one node per entry.
  */
 class TRANTOR_EXPORT TimingWheel
 {
@@ -60,6 +66,51 @@ class TRANTOR_EXPORT TimingWheel
         std::function<void()> cb_;
     };
 
+    struct Link
+    {
+        Link *prev_{nullptr};
+        Link *next_{nullptr};
+    };
+
+    /**
+     * @brief A node which can be embedded in an object tracked by the wheel.
+     * The callback is called in the loop thread when the node expires. Nodes
+     * must be inserted and removed in the loop thread of the wheel.
+     */
+    class TRANTOR_EXPORT Node : public Link, public NonCopyable
+    {
+      public:
+        Node() = default;
+        explicit Node(std::function<void()> cb) : callback_(std::move(cb))
+        {
+        }
+        ~Node()
+        {
+            unlink();
+        }
+        void setCallback(std::function<void()> cb)
+        {
+            callback_ = std::move(cb);
+        }
+
+        /// Return the wheel if the node is in a wheel, otherwise nullptr.
+        TimingWheel *wheel() const
+        {
+            return wheel_;
+        }
+
+        /// Remove the node from the wheel without calling the callback.
+        void unlink();
+
+      private:
+        friend class TimingWheel;
+        TimingWheel *wheel_{nullptr};
+        size_t expiredTick_{0};
+        std::function<void()> callback_;
+        // The entry held by a node of the pool.
+        EntryPtr entry_;
+    };
+
     /**
      * @brief Construct a new timing wheel instance.
      *
@@ -67,21 +118,30 @@ class TRANTOR_EXPORT TimingWheel
      * @param maxTimeout The maximum timeout of the timing wheel.
      * @param ticksInterval The internal timer tick interval.  It affects the
      * accuracy of the timing wheel.
-     * @param bucketsNumPerWheel The number of buckets per wheel.
-     * @note The max delay of the timing wheel is about
-     * ticksInterval*(bucketsNumPerWheel^wheelsNum) seconds.
-     * @example Four wheels with 200 buckets per wheel means the timing wheel
-     * can work with a timeout up to 200^4 seconds, about 50 years;
+     * @param bucketsNumPerWheel Not used any more, the wheel has one bucket
+     * per tick of the maximum timeout (up to 65536 buckets, nodes with longer
+     * timeouts go around the wheel).
      */
     TimingWheel(trantor::EventLoop *loop,
                 size_t maxTimeout,
                 float ticksInterval = TIMING_TICK_INTERVAL,
                 size_t bucketsNumPerWheel = TIMING_BUCKET_NUM_PER_WHEEL);
 
+    /**
+     * @brief Hold the entry for the delay (in seconds), the entry is
+     * released when it expires. Inserting an entry again extends its
+     * lifetime.
+     */
     void insertEntry(size_t delay, EntryPtr entryPtr);
 
     void insertEntryInloop(size_t delay, EntryPtr entryPtr);
 
+    /**
+     * @brief Insert the node or move it to expire after the delay (in
+     * seconds), in the loop thread.
+     */
+    void insertNode(size_t delay, Node *node);
+
     EventLoop *getLoop()
     {
         return loop_;
@@ -90,7 +150,24 @@ class TRANTOR_EXPORT TimingWheel
     ~TimingWheel();
 
   private:
-    std::vector<BucketQueue> wheels_;
+    static constexpr size_t kMaxBucketsNum = 65536;
+    static constexpr size_t kPoolChunkSize = 256;
+
+    Link &bucketOf(size_t expiredTick);
+    void link(Node *node);
+    void onTick();
+    Node *allocNode();
+    void freeNode(Node *node);
+    size_t delayTicks(size_t delay) const
+    {
+        return static_cast<size_t>(delay / ticksInterval_ + 1);
+    }
+
+    std::vector<Link> buckets_;
+    std::vector<std::unique_ptr<Node[]>> pool_;
+    Node *freeNodes_{nullptr};
+    // The node holding each entry in the wheel.
+    std::unordered_map<void *, Node *> entryNodes_;
 
     std::atomic<size_t> ticksCounter_{0};
 
@@ -98,7 +175,5 @@ class TRANTOR_EXPORT TimingWheel
     trantor::EventLoop *loop_;
 
     float ticksInterval_;
-    size_t wheelsNum_;
-    size_t bucketsNumPerWheel_;
 };
 }  // namespace trantor
@@ -0,0 +1,232 @@
+#include "json/json.h"
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+/** \brief Measure the cost of building, reading and writing typical API
+ * objects, a list of people as returned by a REST endpoint.
+ * Example Usage:
+ * $g++ benchmark.cpp -O2 -ljsoncpp -std=c++11 -o benchmark
+ * $./benchmark 20000 ../../test/data/[a-z]*.json
+ * build:   5097.28 ns/object
+ * lookup:  979.293 ns/object
+ * write:   3693.48 ns/object
+ * write (stream):   5162.52 ns/object
+ * write (shortest): 2620.23 ns/object
+ * copy:    3329.82 ns/object
+ * destroy: 1087.86 ns/object
+ * (4828512 bytes, checksum 380828890)
+ * request (heap):     234281 ns
+ * request (document): 183835 ns
+ * corpus (59 files, 24179 bytes)
+ * write:            46.8929 MB/s
+ * write (shortest): 48.0484 MB/s
+ *
+ * A request parses a page of 20 people and writes it back, like the list
+ * endpoints of a REST server, with its values either in the heap or in a
+ * Json::Document. The files given after the count are written in a loop.
+ *
+ * Build jsoncpp with JSONCPP_WITH_FLAT_OBJECTS to compare the two object
+ * storages.
+ */
+namespace {
+using Clock = std::chrono::steady_clock;
+
+Json::Value makePerson(int id) {
+  Json::Value person;
+  person["id"] = id;
+  person["first_name"] = "Firstname" + std::to_string(id);
+  person["last_name"] = "Lastname" + std::to_string(id);
+  person["hire_date"] = "2021-04-01";
+  person["score"] = (id % 1000) / 10.0;
+  Json::Value department;
+  department["id"] = id % 20;
+  department["name"] = "Department";
+  person["department"] = std::move(department);
+  Json::Value job;
+  job["id"] = id % 50;
+  job["title"] = "Engineer";
+  person["job"] = std::move(job);
+  if (id % 10) {
+    Json::Value manager;
+    manager["id"] = id - id % 10;
+    manager["full_name"] = "Manager Name";
+    person["manager"] = std::move(manager);
+  } else {
+    person["manager"] = Json::Value();
+  }
+  return person;
+}
+
+double nsPerObject(Clock::time_point start, int count) {
+  return std::chrono::duration<double, std::nano>(Clock::now() - start)
+             .count() /
+         count;
+}
+
+std::string handleRequest(Json::CharReader& reader,
+                          Json::StreamWriter& writer, Json::Value& request,
+                          std::string const& body) {
+  if (!reader.parse(body.data(), body.data() + body.size(), &request,
+                    nullptr))
+    return std::string();
+  Json::Value response(Json::arrayValue);
+  for (auto const& person : request)
+    response.append(makePerson(person["id"].asInt()));
+  std::ostringstream stream;
+  writer.write(response, &stream);
+  return stream.str();
+}
+
+double nsPerWrite(Json::StreamWriter& writer, Json::Value const& root,
+                  bool useStream, int count) {
+  size_t size = 0;
+  auto start = Clock::now();
+  if (useStream) {
+    std::ostringstream stream;
+    writer.write(root, &stream);
+    size = stream.str().size();
+  } else {
+    std::string document;
+    writer.append(root, &document);
+    size = document.size();
+  }
+  return size ? nsPerObject(start, count) : 0;
+}
+
+double megabytesPerSecond(Json::StreamWriterBuilder const& builder,
+                          std::vector<Json::Value> const& corpus,
+                          size_t bytes, int rounds) {
+  std::unique_ptr<Json::StreamWriter> writer(builder.newStreamWriter());
+  std::string document;
+  auto start = Clock::now();
+  for (int i = 0; i < rounds; ++i) {
+    for (auto const& root : corpus) {
+      document.clear();
+      writer->append(root, &document);
+    }
+  }
+  std::chrono::duration<double> elapsed = Clock::now() - start;
+  return static_cast<double>(bytes) * rounds / elapsed.count() / 1e6;
+}
+
+double nsPerRequest(bool useDocument, int count, std::string const& body) {
+  Json::CharReaderBuilder readerBuilder;
+  std::unique_ptr<Json::CharReader> reader(readerBuilder.newCharReader());
+  Json::StreamWriterBuilder writerBuilder;
+  writerBuilder["indentation"] = "";
+  std::unique_ptr<Json::StreamWriter> writer(writerBuilder.newStreamWriter());
+  size_t size = 0;
+  auto start = Clock::now();
+  for (int i = 0; i < count; ++i) {
+    if (useDocument) {
+      Json::Document document;
+      Json::Document::Scope scope(document);
+      size += handleRequest(*reader, *writer, document.root(), body).size();
+    } else {
+      Json::Value request;
+      size += handleRequest(*reader, *writer, request, body).size();
+    }
+  }
+  return size ? nsPerObject(start, count) : 0;
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+  int count = argc > 1 ? std::atoi(argv[1]) : 10000;
+  if (count <= 0)
+    return EXIT_FAILURE;
+
+  auto start = Clock::now();
+  Json::Value people(Json::arrayValue);
+  for (int i = 0; i < count; ++i)
+    people.append(makePerson(i));
+  double build = nsPerObject(start, count);
+
+  start = Clock::now();
+  Json::Int64 sum = 0;
+  for (auto const& person : people) {
+    sum += person["id"].asInt();
+    sum += person["department"]["id"].asInt();
+    sum += person["job"]["id"].asInt();
+    sum += static_cast<Json::Int64>(person["last_name"].asString().size());
+    if (person.isMember("manager") && !person["manager"].isNull())
+      sum += person["manager"]["id"].asInt();
+  }
+  double lookup = nsPerObject(start, count);
+
+  start = Clock::now();
+  Json::StreamWriterBuilder builder;
+  builder["indentation"] = "";
+  std::string document = Json::writeString(builder, people);
+  double write = nsPerObject(start, count);
+
+  std::unique_ptr<Json::StreamWriter> writer(builder.newStreamWriter());
+  double writeStream = nsPerWrite(*writer, people, true, count);
+  Json::StreamWriterBuilder shortestBuilder = builder;
+  shortestBuilder["precisionType"] = "shortest";
+  writer.reset(shortestBuilder.newStreamWriter());
+  double writeShortest = nsPerWrite(*writer, people, false, count);
+
+  start = Clock::now();
+  Json::Value copy(people);
+  double copyTime = nsPerObject(start, count);
+
+  start = Clock::now();
+  copy = Json::Value();
+  double destroy = nsPerObject(start, count);
+
+  std::cout << "build:   " << build << " ns/object\n"
+            << "lookup:  " << lookup << " ns/object\n"
+            << "write:   " << write << " ns/object\n"
+            << "write (stream):   " << writeStream << " ns/object\n"
+            << "write (shortest): " << writeShortest << " ns/object\n"
+            << "copy:    " << copyTime << " ns/object\n"
+            << "destroy: " << destroy << " ns/object\n"
+            << "(" << document.size() << " bytes, checksum " << sum << ")"
+            << std::endl;
+
+  Json::Value page(Json::arrayValue);
+  for (Json::ArrayIndex i = 0; i < 20 && i < people.size(); ++i)
+    page.append(people[i]);
+  std::string body = Json::writeString(builder, page);
+  int requests = count / 10 + 1;
+  std::cout << "request (heap):     " << nsPerRequest(false, requests, body)
+            << " ns\n"
+            << "request (document): " << nsPerRequest(true, requests, body)
+            << " ns" << std::endl;
+
+  // The other arguments are JSON files, written as they are parsed.
+  std::vector<Json::Value> corpus;
+  size_t bytes = 0;
+  Json::CharReaderBuilder readerBuilder;
+  for (int i = 2; i < argc; ++i) {
+    std::ifstream file(argv[i], std::ios::binary);
+    Json::Value root;
+    try {
+      if (!Json::parseFromStream(readerBuilder, file, &root, nullptr))
+        continue;
+    } catch (std::exception const&) {
+      continue;
+    }
+    bytes += Json::writeString(builder, root).size();
+    corpus.push_back(std::move(root));
+  }
+  if (!corpus.empty()) {
+    int rounds = count / 100 + 1;
+    std::cout << "corpus (" << corpus.size() << " files, " << bytes
+              << " bytes)\n"
+              << "write:            "
+              << megabytesPerSecond(builder, corpus, bytes, rounds)
+              << " MB/s\n"
+              << "write (shortest): "
+              << megabytesPerSecond(shortestBuilder, corpus, bytes, rounds)
+              << " MB/s" << std::endl;
+  }
+  return EXIT_SUCCESS;
+}
@@ -6,6 +6,7 @@
 #ifndef JSON_ALLOCATOR_H_INCLUDED
 #define JSON_ALLOCATOR_H_INCLUDED
 
+#include <cstddef>
 #include <cstring>
 #include <memory>
 
@@ -82,6 +83,94 @@ bool operator!=(const SecureAllocator<T>&, const SecureAllocator<U>&) {
   return false;
 }
 
+/** \brief Memory that is only released all at once.
+ *
+ * The allocations are taken from chunks of growing sizes and deallocating
+ * does nothing. It is the memory of the values of a Json::Document.
+ * It is not thread-safe.
+ */
+class JSON_API MonotonicBuffer {
+public:
+  /// \param chunkSize Size of the first chunk, the next ones are bigger.
+  explicit MonotonicBuffer(size_t chunkSize = 4096);
+  MonotonicBuffer(MonotonicBuffer const&) = delete;
+  MonotonicBuffer& operator=(MonotonicBuffer const&) = delete;
+  ~MonotonicBuffer();
+
+  void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+  /// Release all the allocations.
+  void release();
+
+  /// Number of allocations since the last release.
+  size_t allocations() const { return allocations_; }
+  /// Number of bytes in the chunks.
+  size_t capacity() const { return capacity_; }
+
+  /** \brief Buffer of the values constructed by this thread.
+   *
+   * Null by default, see Document::Scope.
+   */
+  static MonotonicBuffer* current();
+  static void setCurrent(MonotonicBuffer* buffer);
+
+private:
+  struct Chunk {
+    Chunk* next;
+    size_t size;
+  };
+
+  Chunk* chunks_{nullptr};
+  char* cursor_{nullptr};
+  char* end_{nullptr};
+  size_t chunkSize_;
+  size_t allocations_{0};
+  size_t capacity_{0};
+};
+
+/** \brief Allocator taking memory from a MonotonicBuffer, or from the heap
+ * when it has no buffer.
+ *
+ * Copies of containers are allocated from the heap.
+ */
+template <typename T> class BufferAllocator {
+public:
+  using value_type = T;
+
+  BufferAllocator() = default;
+  explicit BufferAllocator(MonotonicBuffer* buffer) : buffer_(buffer) {}
+  template <typename U>
+  BufferAllocator(const BufferAllocator<U>& other) : buffer_(other.buffer()) {}
+
+  T* allocate(size_t n) {
+    if (buffer_)
+      return static_cast<T*>(buffer_->allocate(n * sizeof(T), alignof(T)));
+    return std::allocator<T>().allocate(n);
+  }
+  void deallocate(T* p, size_t n) {
+    if (!buffer_)
+      std::allocator<T>().deallocate(p, n);
+  }
+
+  BufferAllocator select_on_container_copy_construction() const {
+    return BufferAllocator();
+  }
+
+  MonotonicBuffer* buffer() const { return buffer_; }
+
+private:
+  MonotonicBuffer* buffer_{nullptr};
+};
+
+template <typename T, typename U>
+bool operator==(const BufferAllocator<T>& a, const BufferAllocator<U>& b) {
+  return a.buffer() == b.buffer();
+}
+
+template <typename T, typename U>
+bool operator!=(const BufferAllocator<T>& a, const BufferAllocator<U>& b) {
+  return a.buffer() != b.buffer();
+}
+
 } // namespace Json
 
 #pragma pack(pop)
@@ -25,6 +25,14 @@
 #define JSON_USE_NULLREF 1
 #endif
 
+// If non-zero, the members of objects and the elements of arrays are stored
+// in a Json::FlatMap, slabs with an index sorted by key, instead of a std::map.
+// It must be the same for the library and its users. The default is to use
+// std::map.
+#ifndef JSONCPP_USING_FLAT_OBJECTS
+#define JSONCPP_USING_FLAT_OBJECTS 0
+#endif
+
 /// If defined, indicates that the source file is amalgamated
 /// to prevent private header inclusion.
 /// Remarks: it is automatically defined in the generated amalgamated header.
@@ -13,8 +13,10 @@
 #include <deque>
 #include <iosfwd>
 #include <istream>
+#include <memory>
 #include <stack>
 #include <string>
+#include <vector>
 
 // Disable warning C4251: <data member>: <type> needs to have dll-interface to
 // be used by...
@@ -327,6 +329,12 @@ public:
    * - `"skipBom": false or true`
    *   - If true, if the input starts with the Unicode byte order mark (BOM),
    *     it is skipped.
+   * - `"fastParse": false or true`
+   *   - If true, documents made of plain JSON are parsed with a structural
+   *     index built with SIMD instructions, which is several times faster.
+   *     The other documents (comments, trailing commas, errors...) are
+   *     parsed by the regular reader, so the results are the same either
+   *     way.
    *
    * You can examine 'settings_` yourself to see the defaults. You can also
    * write and read them just like any JSON Value.
@@ -362,6 +370,131 @@ public:
   static void strictMode(Json::Value* settings);
 };
 
+class LazyDocument;
+
+/** \brief A value of a LazyDocument.
+ *
+ * It is a cheap handle on a value of the document, which is only decoded when
+ * value() or one of the as*() methods is called. Missing members and elements
+ * are null, like with the const accessors of Value.
+ *
+ * A LazyValue must not be used after the document is destroyed or parses
+ * another text.
+ */
+class JSON_API LazyValue {
+public:
+  LazyValue() = default;
+
+  ValueType type() const;
+  bool isNull() const;
+  bool isBool() const;
+  bool isNumeric() const;
+  bool isString() const;
+  bool isArray() const;
+  bool isObject() const;
+
+  /// Number of values in array or object
+  ArrayIndex size() const;
+
+  /// Return true if the object has a member named key.
+  bool isMember(const char* key) const;
+  /// Same as isMember(char const*)
+  bool isMember(const String& key) const;
+
+  /// Access an object value by name, returns null if there is no member with
+  /// that name.
+  LazyValue operator[](const char* key) const;
+  /// Access an object value by name, returns null if there is no member with
+  /// that name.
+  LazyValue operator[](const String& key) const;
+
+  /// Access an array element (zero based index), returns null if index is
+  /// out of range.
+  LazyValue operator[](ArrayIndex index) const;
+  /// Access an array element (zero based index), returns null if index is
+  /// out of range.
+  LazyValue operator[](int index) const;
+
+  /** \brief Decodes the value and its children.
+   * \throw RuntimeError if the value is not valid JSON.
+   */
+  Value value() const;
+
+  String asString() const;
+  Int asInt() const;
+  UInt asUInt() const;
+#if defined(JSON_HAS_INT64)
+  Int64 asInt64() const;
+  UInt64 asUInt64() const;
+#endif // if defined(JSON_HAS_INT64)
+  double asDouble() const;
+  bool asBool() const;
+
+private:
+  friend class LazyDocument;
+  class Document;
+
+  LazyValue(Document* document, ArrayIndex position, Value const* value);
+  LazyValue find(const char* begin, const char* end) const;
+
+  Document* document_ = nullptr;
+  ArrayIndex position_ = 0;
+  Value const* value_ = nullptr;
+};
+
+/** \brief A JSON document parsed on demand.
+ *
+ * parse() only builds the structural index of the document (see the
+ * `"fastParse"` setting of CharReaderBuilder) and checks its grammar. The
+ * members and elements are then found by walking the index, skipping the
+ * nested containers in constant time, and only the values which are accessed
+ * are decoded. This is much faster than building a Value of the whole
+ * document when only a few fields are read.
+ *
+ * The documents which are not plain JSON (comments, trailing commas...) are
+ * parsed completely with the settings of the builder, comments are never
+ * collected.
+ *
+ * The text given to parse() must outlive the document. A LazyDocument is not
+ * thread-safe, even for reading.
+ *
+ * Usage:
+ *   \code
+ *   Json::LazyDocument document;
+ *   Json::String errs;
+ *   if (document.parse(text.data(), text.data() + text.size(), &errs)) {
+ *     auto name = document.root()["employee"]["name"].asString();
+ *   }
+ *   \endcode
+ */
+class JSON_API LazyDocument {
+public:
+  LazyDocument();
+  explicit LazyDocument(CharReaderBuilder const& builder);
+  ~LazyDocument();
+  LazyDocument(LazyDocument const&) = delete;
+  LazyDocument& operator=(LazyDocument const&) = delete;
+
+  /** \brief Read a <a HREF="http://www.json.org">JSON</a> document.
+   *
+   * \param      beginDoc Pointer on the beginning of the UTF-8 encoded string
+   *                      of the document to read.
+   * \param      endDoc   Pointer on the end of the UTF-8 encoded string of the
+   *                      document to read. Must be >= beginDoc.
+   * \param[out] errs     Formatted error messages (if not NULL).
+   * \return \c true if the document was successfully parsed, \c false if an
+   * error occurred. The tokens other than containers and strings are only
+   * checked when they are decoded.
+   */
+  bool parse(char const* beginDoc, char const* endDoc, String* errs);
+
+  /// The root value of the parsed document.
+  LazyValue root() const;
+
+private:
+  std::unique_ptr<LazyValue::Document> document_;
+};
+
 /** Consume entire stream and use its begin/end.
  * Someday we might have a real StreamReader, but for now this
  * is convenient.
@@ -39,11 +39,16 @@
 #endif
 #endif
 
+#include <algorithm>
 #include <array>
+#include <cstddef>
+#include <cstring>
 #include <exception>
+#include <iterator>
 #include <map>
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 // Disable warning C4251: <data member>: <type> needs to have dll-interface to
@@ -128,7 +133,8 @@ enum CommentPlacement {
  */
 enum PrecisionType {
   significantDigits = 0, ///< we set max number of significant digits in string
-  decimalPlaces          ///< we set max number of digits after "." in string
+  decimalPlaces,         ///< we set max number of digits after "." in string
+  shortestRoundTrip      ///< shortest string parsed back as the same value
 };
 
 /** \brief Lightweight wrapper to tag static string.
@@ -157,6 +163,290 @@ private:
   const char* c_str_;
 };
 
+#if JSONCPP_USING_FLAT_OBJECTS
+/** \brief Associative container keeping a vector of pointers to its elements
+ * sorted by key.
+ *
+ * It is used instead of std::map for the members of objects and the elements
+ * of arrays when JSONCPP_USING_FLAT_OBJECTS is non-zero. The elements are
+ * stored in slabs which hold several of them, so a container costs a few
+ * allocations instead of one per element, and lookups are binary searches in
+ * contiguous memory. Iteration is in key order like std::map. Pointers and
+ * references to an element stay valid until it is erased, but inserting or
+ * removing an element invalidates the iterators, like std::vector.
+ */
+template <typename Key, typename T,
+          typename Allocator = std::allocator<std::pair<Key, T>>>
+class FlatMap {
+  using Traits = std::allocator_traits<Allocator>;
+
+public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<Key, T>;
+  using allocator_type = Allocator;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+
+  template <typename V> class Iterator {
+  public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = typename std::remove_const<V>::type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = V*;
+    using reference = V&;
+
+    Iterator() = default;
+    template <typename U, typename = typename std::enable_if<
+                              std::is_convertible<U*, V*>::value>::type>
+    Iterator(Iterator<U> const& other) : current_(other.current_) {}
+
+    reference operator*() const { return **current_; }
+    pointer operator->() const { return *current_; }
+    Iterator& operator++() {
+      ++current_;
+      return *this;
+    }
+    Iterator operator++(int) { return Iterator(current_++); }
+    Iterator& operator--() {
+      --current_;
+      return *this;
+    }
+    Iterator operator--(int) { return Iterator(current_--); }
+    Iterator operator+(difference_type n) const {
+      return Iterator(current_ + n);
+    }
+    Iterator operator-(difference_type n) const {
+      return Iterator(current_ - n);
+    }
+    difference_type operator-(Iterator const& other) const {
+      return current_ - other.current_;
+    }
+    bool operator==(Iterator const& other) const {
+      return current_ == other.current_;
+    }
+    bool operator!=(Iterator const& other) const {
+      return current_ != other.current_;
+    }
+
+  private:
+    friend class FlatMap;
+    template <typename U> friend class Iterator;
+    explicit Iterator(value_type* const* current) : current_(current) {}
+
+    value_type* const* current_{nullptr};
+  };
+  using iterator = Iterator<value_type>;
+  using const_iterator = Iterator<const value_type>;
+
+  explicit FlatMap(Allocator const& allocator = Allocator())
+      : allocator_(allocator), index_(IndexAllocator(allocator)) {}
+  FlatMap(FlatMap const& other)
+      : FlatMap(other, Traits::select_on_container_copy_construction(
+                           other.allocator_)) {}
+  FlatMap(FlatMap const& other, Allocator const& allocator)
+      : FlatMap(allocator) {
+    // The destructor releases a partial copy, since the delegated
+    // constructor has finished.
+    reserve(other.size());
+    for (value_type const* value : other.index_)
+      index_.push_back(construct(*value));
+  }
+  FlatMap& operator=(FlatMap const& other) {
+    if (this != &other) {
+      FlatMap copy(other, allocator_);
+      swap(copy);
+    }
+    return *this;
+  }
+  ~FlatMap() { release(); }
+
+  void swap(FlatMap& other) {
+    using std::swap;
+    swap(allocator_, other.allocator_);
+    index_.swap(other.index_);
+    swap(slabs_, other.slabs_);
+    swap(next_, other.next_);
+    swap(end_, other.end_);
+    swap(free_, other.free_);
+  }
+
+  allocator_type get_allocator() const { return allocator_; }
+
+  iterator begin() { return iterator(index_.data()); }
+  const_iterator begin() const { return const_iterator(index_.data()); }
+  iterator end() { return iterator(index_.data() + index_.size()); }
+  const_iterator end() const {
+    return const_iterator(index_.data() + index_.size());
+  }
+
+  bool empty() const { return index_.empty(); }
+  size_type size() const { return index_.size(); }
+  void clear() { release(); }
+  void reserve(size_type size) {
+    index_.reserve(size);
+    if (size > index_.size() &&
+        size - index_.size() > static_cast<size_type>(end_ - next_))
+      addSlab(size - index_.size());
+  }
+
+  iterator lower_bound(Key const& key) {
+    return begin() + lowerBound(key);
+  }
+  const_iterator lower_bound(Key const& key) const {
+    return begin() + lowerBound(key);
+  }
+  iterator find(Key const& key) {
+    iterator it = lower_bound(key);
+    return it != end() && it->first == key ? it : end();
+  }
+  const_iterator find(Key const& key) const {
+    const_iterator it = lower_bound(key);
+    return it != end() && it->first == key ? it : end();
+  }
+
+  /// Insert \c value before \c hint if it is the right position, like
+  /// std::map::insert(). The elements are usually appended.
+  iterator insert(const_iterator hint, value_type&& value) {
+    if ((hint == end() || value.first < hint->first) &&
+        (hint == begin() || (hint - 1)->first < value.first))
+      return insertAt(hint - begin(), std::move(value));
+    return emplace(std::move(value.first), std::move(value.second)).first;
+  }
+  std::pair<iterator, bool> emplace(Key&& key, T&& value) {
+    difference_type position = index_.size();
+    if (!empty() && !(index_.back()->first < key)) {
+      position = lowerBound(key);
+      if (index_[position]->first == key)
+        return std::make_pair(begin() + position, false);
+    }
+    return std::make_pair(
+        insertAt(position, value_type(std::move(key), std::move(value))),
+        true);
+  }
+  T& operator[](Key const& key) {
+    difference_type position = lowerBound(key);
+    if (position == static_cast<difference_type>(index_.size()) ||
+        !(index_[position]->first == key))
+      return insertAt(position, value_type(key, T()))->second;
+    return index_[position]->second;
+  }
+
+  iterator erase(const_iterator position) {
+    difference_type offset = position - begin();
+    value_type* value = index_[offset];
+    index_.erase(index_.begin() + offset);
+    destroy(value);
+    return begin() + offset;
+  }
+  size_type erase(Key const& key) {
+    const_iterator it = find(key);
+    if (it == end())
+      return 0;
+    erase(it);
+    return 1;
+  }
+
+  bool operator<(FlatMap const& other) const {
+    return std::lexicographical_compare(begin(), end(), other.begin(),
+                                        other.end());
+  }
+  bool operator==(FlatMap const& other) const {
+    return size() == other.size() && std::equal(begin(), end(), other.begin());
+  }
+
+private:
+  using IndexAllocator =
+      typename Traits::template rebind_alloc<value_type*>;
+  // Header of a slab, stored in the place of its first slots.
+  struct Slab {
+    Slab* next;
+    size_type capacity;
+  };
+  static constexpr size_type kHeaderSlots =
+      (sizeof(Slab) + sizeof(value_type) - 1) / sizeof(value_type);
+  static constexpr size_type kMinSlabCapacity = 4;
+  static_assert(alignof(Slab) <= alignof(value_type),
+                "the slab header must fit the alignment of the elements");
+  static_assert(sizeof(value_type*) <= sizeof(value_type),
+                "a free slot must hold the link to the next one");
+
+  difference_type lowerBound(Key const& key) const {
+    auto it = std::lower_bound(
+        index_.begin(), index_.end(), key,
+        [](value_type const* value, Key const& k) { return value->first < k; });
+    return it - index_.begin();
+  }
+
+  iterator insertAt(difference_type position, value_type&& value) {
+    value_type* slot = construct(std::move(value));
+    try {
+      index_.insert(index_.begin() + position, slot);
+    } catch (...) {
+      destroy(slot);
+      throw;
+    }
+    return begin() + position;
+  }
+
+  // Take a slot, from the erased ones first, and construct the value in it.
+  template <typename V> value_type* construct(V&& value) {
+    value_type* slot = free_;
+    if (slot) {
+      std::memcpy(&free_, static_cast<void*>(slot), sizeof(free_));
+    } else {
+      if (next_ == end_)
+        addSlab((std::max)(size_type(kMinSlabCapacity), index_.size()));
+      slot = next_++;
+    }
+    try {
+      Traits::construct(allocator_, slot, std::forward<V>(value));
+    } catch (...) {
+      freeSlot(slot);
+      throw;
+    }
+    return slot;
+  }
+  void destroy(value_type* value) {
+    Traits::destroy(allocator_, value);
+    freeSlot(value);
+  }
+  void freeSlot(value_type* slot) {
+    std::memcpy(static_cast<void*>(slot), &free_, sizeof(free_));
+    free_ = slot;
+  }
+
+  void addSlab(size_type capacity) {
+    value_type* storage = Traits::allocate(allocator_, kHeaderSlots + capacity);
+    slabs_ = ::new (static_cast<void*>(storage)) Slab{slabs_, capacity};
+    next_ = storage + kHeaderSlots;
+    end_ = next_ + capacity;
+  }
+  // Destroy the elements and give the slabs back.
+  void release() {
+    for (value_type* value : index_)
+      Traits::destroy(allocator_, value);
+    index_.clear();
+    while (slabs_) {
+      Slab* slab = slabs_;
+      slabs_ = slab->next;
+      Traits::deallocate(allocator_, reinterpret_cast<value_type*>(slab),
+                         kHeaderSlots + slab->capacity);
+    }
+    next_ = end_ = free_ = nullptr;
+  }
+
+  Allocator allocator_;
+  std::vector<value_type*, IndexAllocator> index_;
+  Slab* slabs_{nullptr};
+  // The slots of the last slab which were never used.
+  value_type* next_{nullptr};
+  value_type* end_{nullptr};
+  // The erased slots, each one holds the next one.
+  value_type* free_{nullptr};
+};
+#endif // if JSONCPP_USING_FLAT_OBJECTS
+
 /** \brief Represents a <a HREF="http://www.json.org">JSON</a> value.
  *
  * This class is a discriminated union wrapper that can represents a:
@@ -260,7 +550,13 @@ private:
 #ifndef JSONCPP_DOC_EXCLUDE_IMPLEMENTATION
   class CZString {
   public:
-    enum DuplicationPolicy { noDuplication = 0, duplicate, duplicateOnCopy };
+    enum DuplicationPolicy {
+      noDuplication = 0,
+      duplicate,
+      duplicateOnCopy,
+      // Like duplicate, but in a MonotonicBuffer, so it is never released.
+      duplicateInBuffer
+    };
     CZString(ArrayIndex index);
     CZString(char const* str, unsigned length, DuplicationPolicy allocate);
     CZString(CZString const& other);
@@ -293,7 +589,15 @@ private:
   };
 
 public:
-  typedef std::map<CZString, Value> ObjectValues;
+#if JSONCPP_USING_FLAT_OBJECTS
+  typedef FlatMap<CZString, Value,
+                  BufferAllocator<std::pair<CZString, Value>>>
+      ObjectValues;
+#else
+  typedef std::map<CZString, Value, std::less<CZString>,
+                   BufferAllocator<std::pair<const CZString, Value>>>
+      ObjectValues;
+#endif
 #endif // ifndef JSONCPP_DOC_EXCLUDE_IMPLEMENTATION
 
 public:
@@ -598,6 +902,11 @@ private:
   }
   bool isAllocated() const { return bits_.allocated_; }
   void setIsAllocated(bool v) { bits_.allocated_ = v; }
+  bool isBuffered() const { return bits_.buffered_; }
+  void setIsBuffered(bool v) { bits_.buffered_ = v; }
+
+  void allocateString(char const* value, unsigned length);
+  void allocateMap(ObjectValues const* other);
 
   void initBasic(ValueType type, bool allocated = false);
   void dupPayload(const Value& other);
@@ -630,6 +939,8 @@ private:
     unsigned int value_type_ : 8;
     // Unless allocated_, string_ must be null-terminated.
     unsigned int allocated_ : 1;
+    // The string_ or map_ is in a MonotonicBuffer, so it is not released.
+    unsigned int buffered_ : 1;
   } bits_;
 
   class Comments {
@@ -925,6 +1236,59 @@ public:
 
 inline void swap(Value& a, Value& b) { a.swap(b); }
 
+#define JSON_HAS_DOCUMENT 1
+
+/** \brief A root Value whose tree is allocated from a MonotonicBuffer.
+ *
+ * The strings, objects and arrays constructed by a thread while a Scope is
+ * alive are allocated from the buffer of the document, as well as the members
+ * and elements added to them later. They are released all at once with the
+ * document, which avoids most of the cost of allocating and freeing trees,
+ * like the ones parsed for each request of a server.
+ *
+ * Copies of these values are allocated from the heap, but the values moved or
+ * swapped out of the tree must not outlive the document.
+ *
+ * Example:
+ * \code
+ * Json::Document document;
+ * {
+ *   Json::Document::Scope scope(document);
+ *   ok = reader->parse(begin, end, &document.root(), &errs);
+ * }
+ * std::cout << document.root()["name"].asString();
+ * \endcode
+ */
+class JSON_API Document {
+public:
+  /** \brief Allocate the values constructed by this thread from the buffer
+   * of a document while it is alive.
+   */
+  class JSON_API Scope {
+  public:
+    explicit Scope(Document& document);
+    Scope(Scope const&) = delete;
+    Scope& operator=(Scope const&) = delete;
+    ~Scope();
+
+  private:
+    MonotonicBuffer* previous_;
+  };
+
+  /// \param chunkSize Size of the first chunk of the buffer.
+  explicit Document(size_t chunkSize = 4096);
+
+  Value& root() { return root_; }
+  const Value& root() const { return root_; }
+  MonotonicBuffer& buffer() { return buffer_; }
+  const MonotonicBuffer& buffer() const { return buffer_; }
+
+private:
+  // Declared first to be destroyed last.
+  MonotonicBuffer buffer_;
+  Value root_;
+};
+
 } // namespace Json
 
 #pragma pack(pop)
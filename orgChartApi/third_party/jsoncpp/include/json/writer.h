@@ -23,6 +23,8 @@
 #pragma pack(push)
 #pragma pack()
 
+#define JSON_HAS_STREAM_WRITER_APPEND 1
+
 namespace Json {
 
 class Value;
@@ -54,6 +56,15 @@ public:
    */
   virtual int write(Value const& root, OStream* sout) = 0;
 
+  /** Append the document of a Value to a string, as configured in sub-class.
+   *   The writers of StreamWriterBuilder write straight into the string,
+   *   the default implementation goes through a stream.
+   *   \pre document != NULL
+   *   \return zero on success
+   *   \throw std::exception possibly, depending on configuration
+   */
+  virtual int append(Value const& root, String* document);
+
   /** \brief A simple abstract factory.
    */
   class JSON_API Factory {
@@ -66,7 +77,7 @@ public:
   }; // Factory
 };   // StreamWriter
 
-/** \brief Write into stringstream, then return string, for convenience.
+/** \brief Write into a string and return it, for convenience.
  * A StreamWriter will be created from the factory, used, and then deleted.
  */
 String JSON_API writeString(StreamWriter::Factory const& factory,
@@ -109,8 +120,10 @@ public:
    *  infinity as "-Infinity".
    *  - "precision": int
    *  - Number of precision digits for formatting of real values.
-   *  - "precisionType": "significant"(default) or "decimal"
-   *  - Type of precision for formatting of real values.
+   *  - "precisionType": "significant"(default), "decimal" or "shortest"
+   *  - Type of precision for formatting of real values. "shortest" writes
+   *    the fewest digits that read back as the same value, and ignores
+   *    "precision".
    *  - "emitUTF8": false or true
    *  - If true, outputs raw UTF8 strings instead of escaping them.
 
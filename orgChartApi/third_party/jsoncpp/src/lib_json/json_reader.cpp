@@ -12,6 +12,7 @@
 #endif // if !defined(JSON_IS_AMALGAMATION)
 #include <algorithm>
 #include <cassert>
+#include <cfloat>
 #include <cmath>
 #include <cstring>
 #include <iostream>
@@ -21,6 +22,18 @@
 #include <set>
 #include <sstream>
 #include <utility>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                    \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#endif
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
 
 #include <cstdio>
 #if __cplusplus >= 201103L
@@ -1889,26 +1902,727 @@ public:
   }
 };
 
-CharReaderBuilder::CharReaderBuilder() { setDefaults(&settings_); }
-CharReaderBuilder::~CharReaderBuilder() = default;
-CharReader* CharReaderBuilder::newCharReader() const {
-  bool collectComments = settings_["collectComments"].asBool();
+
+// Implementation of the structural index parser
+// ////////////////////////////////
+//
+// The document is parsed in two stages, like simdjson does. The first stage
+// classifies the characters 64 at a time with SIMD instructions and records
+// in an index the positions of the structural characters ({}[]:,), of the
+// quotes around strings and of the first character of the other tokens. The
+// second stage walks the index to build the Values without any tokenizer:
+// containers are delimited by the index and the strings without escape
+// sequences are copied in one go.
+//
+// Only the standard JSON grammar is handled by the second stage. Anything
+// else (comments, trailing commas, special floats, errors, ...) is handed
+// over to OurReader, so the results are always the same as OurReader's.
+
+namespace {
+
+struct BlockMasks {
+  uint64_t quote;
+  uint64_t backslash;
+  uint64_t whitespace;
+  uint64_t op;
+};
+
+using BlockClassifier = void (*)(const char* block, BlockMasks& masks);
+
+enum CharClass : unsigned char {
+  quoteClass = 1,
+  backslashClass = 2,
+  whitespaceClass = 4,
+  opClass = 8
+};
+
+struct CharClassTable {
+  unsigned char classes[256];
+  CharClassTable() : classes() {
+    classes[static_cast<unsigned char>('"')] = quoteClass;
+    classes[static_cast<unsigned char>('\\')] = backslashClass;
+    for (char c : {' ', '\t', '\n', '\r'})
+      classes[static_cast<unsigned char>(c)] = whitespaceClass;
+    for (char c : {'{', '}', '[', ']', ':', ','})
+      classes[static_cast<unsigned char>(c)] = opClass;
+  }
+};
+
+const unsigned char* charClasses() {
+  static const CharClassTable table;
+  return table.classes;
+}
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                    \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define JSONCPP_HAS_SSE2 1
+
+uint64_t movemask128(__m128i bytes) {
+  return static_cast<uint32_t>(_mm_movemask_epi8(bytes));
+}
+
+void classifyBlockSse2(const char* block, BlockMasks& masks) {
+  masks = BlockMasks();
+  for (unsigned i = 0; i < 4; ++i) {
+    const __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * i));
+    // '[' and ']' only differ from '{' and '}' by the 0x20 bit.
+    const __m128i lower = _mm_or_si128(chunk, _mm_set1_epi8(0x20));
+    const __m128i whitespace =
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')),
+                                  _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t'))),
+                     _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n')),
+                                  _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r'))));
+    const __m128i op =
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(lower, _mm_set1_epi8('{')),
+                                  _mm_cmpeq_epi8(lower, _mm_set1_epi8('}'))),
+                     _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(',')),
+                                  _mm_cmpeq_epi8(chunk, _mm_set1_epi8(':'))));
+    const unsigned shift = 16 * i;
+    masks.quote |= movemask128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('"')))
+                   << shift;
+    masks.backslash |= movemask128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\\')))
+                       << shift;
+    masks.whitespace |= movemask128(whitespace) << shift;
+    masks.op |= movemask128(op) << shift;
+  }
+}
+#endif
+
+#if !defined(JSONCPP_HAS_SSE2)
+void classifyBlockScalar(const char* block, BlockMasks& masks) {
+  const unsigned char* classes = charClasses();
+  masks = BlockMasks();
+  for (unsigned i = 0; i < 64; ++i) {
+    const unsigned c = classes[static_cast<unsigned char>(block[i])];
+    masks.quote |= uint64_t(c & quoteClass) << i;
+    masks.backslash |= uint64_t((c & backslashClass) >> 1) << i;
+    masks.whitespace |= uint64_t((c & whitespaceClass) >> 2) << i;
+    masks.op |= uint64_t((c & opClass) >> 3) << i;
+  }
+}
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define JSONCPP_HAS_AVX2_DISPATCH 1
+
+__attribute__((target("avx2"))) uint64_t movemask256(__m256i bytes) {
+  return static_cast<uint32_t>(_mm256_movemask_epi8(bytes));
+}
+
+__attribute__((target("avx2"))) void classifyBlockAvx2(const char* block,
+                                                         BlockMasks& masks) {
+  masks = BlockMasks();
+  for (unsigned i = 0; i < 2; ++i) {
+    const __m256i chunk =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32 * i));
+    const __m256i lower = _mm256_or_si256(chunk, _mm256_set1_epi8(0x20));
+    const __m256i whitespace = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' ')),
+                        _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\t'))),
+        _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\n')),
+                        _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\r'))));
+    const __m256i op = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(lower, _mm256_set1_epi8('{')),
+                        _mm256_cmpeq_epi8(lower, _mm256_set1_epi8('}'))),
+        _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(',')),
+                        _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(':'))));
+    const unsigned shift = 32 * i;
+    masks.quote |= movemask256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('"')))
+                   << shift;
+    masks.backslash |=
+        movemask256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\\'))) << shift;
+    masks.whitespace |= movemask256(whitespace) << shift;
+    masks.op |= movemask256(op) << shift;
+  }
+}
+#endif
+
+BlockClassifier selectBlockClassifier() {
+#if defined(JSONCPP_HAS_AVX2_DISPATCH)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return &classifyBlockAvx2;
+#endif
+#if defined(JSONCPP_HAS_SSE2)
+  return &classifyBlockSse2;
+#else
+  return &classifyBlockScalar;
+#endif
+}
+
+BlockClassifier blockClassifier() {
+  static const BlockClassifier classifier = selectBlockClassifier();
+  return classifier;
+}
+
+unsigned trailingZeroes(uint64_t bits) {
+#if defined(_MSC_VER) && defined(_M_X64)
+  unsigned long index;
+  _BitScanForward64(&index, bits);
+  return static_cast<unsigned>(index);
+#elif defined(__GNUC__)
+  return static_cast<unsigned>(__builtin_ctzll(bits));
+#else
+  unsigned count = 0;
+  for (; !(bits & 1); bits >>= 1)
+    ++count;
+  return count;
+#endif
+}
+
+// Returns the mask of the characters escaped by a backslash. escapedCarry is
+// 1 when the first character of the block is escaped by the previous block.
+uint64_t escapedChars(uint64_t backslash, uint64_t& escapedCarry) {
+  const uint64_t evenBits = 0x5555555555555555ULL;
+  backslash &= ~escapedCarry;
+  const uint64_t followsEscape = backslash << 1 | escapedCarry;
+  // The sequences of backslashes starting on odd bits are cleared by the
+  // addition, the carries land on the character following them.
+  const uint64_t oddSequenceStarts = backslash & ~evenBits & ~followsEscape;
+  const uint64_t sequencesStartingOnEvenBits = oddSequenceStarts + backslash;
+  escapedCarry = sequencesStartingOnEvenBits < backslash ? 1 : 0;
+  const uint64_t invertMask = sequencesStartingOnEvenBits << 1;
+  return (evenBits ^ invertMask) & followsEscape;
+}
+
+// Bit i of the result is the parity of the bits 0 to i of bits.
+uint64_t prefixXor(uint64_t bits) {
+  bits ^= bits << 1;
+  bits ^= bits << 2;
+  bits ^= bits << 4;
+  bits ^= bits << 8;
+  bits ^= bits << 16;
+  bits ^= bits << 32;
+  return bits;
+}
+
+const double exactPowersOfTen[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                   1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                   1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                                   1e18, 1e19, 1e20, 1e21, 1e22};
+
+bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+bool decodeHexQuad(const char* current, unsigned int& value) {
+  value = 0;
+  for (int index = 0; index < 4; ++index) {
+    const char c = current[index];
+    value *= 16;
+    if (c >= '0' && c <= '9')
+      value += static_cast<unsigned int>(c - '0');
+    else if (c >= 'a' && c <= 'f')
+      value += static_cast<unsigned int>(c - 'a' + 10);
+    else if (c >= 'A' && c <= 'F')
+      value += static_cast<unsigned int>(c - 'A' + 10);
+    else
+      return false;
+  }
+  return true;
+}
+
+} // namespace
+
+class StructuralParser {
+public:
+  explicit StructuralParser(OurFeatures const& features);
+
+  // Builds the index of the document, returns false if a string is not
+  // terminated.
+  bool index(const char* beginDoc, const char* endDoc);
+  // Parses the indexed document, returns false if it is not plain JSON.
+  bool parse(Value& root);
+  // Parses the value at the given position of the index. Errors are thrown
+  // as RuntimeError.
+  Value parseAt(size_t position);
+
+  bool decodeString(const char* begin, const char* end, String& decoded);
+
+  const char* begin_ = nullptr;
+  const char* end_ = nullptr;
+  std::vector<uint32_t> positions_;
+  size_t size_ = 0;
+  OurFeatures const features_;
+
+private:
+  bool readValue(Value& value, size_t depth);
+  bool readObject(Value& value, uint32_t start, size_t depth);
+  bool readArray(Value& value, uint32_t start, size_t depth);
+  bool readString(Value& value, uint32_t start);
+  bool readScalar(Value& value, uint32_t start);
+  bool readToken(Value& value, uint32_t start, const char* end);
+  bool decodeNumber(const char* current, const char* end, Value& decoded);
+  bool decodeDouble(const char* begin, const char* end, Value& decoded);
+
+  const uint32_t* current_ = nullptr;
+  const uint32_t* last_ = nullptr;
+  bool throwErrors_ = false;
+  String string_;
+  std::unique_ptr<OurReader> tokenReader_;
+  std::unique_ptr<IStringStream> doubleStream_;
+};
+
+StructuralParser::StructuralParser(OurFeatures const& features)
+    : features_(features) {}
+
+bool StructuralParser::index(const char* beginDoc, const char* endDoc) {
+  begin_ = beginDoc;
+  end_ = endDoc;
+  if (features_.skipBom_ && end_ - begin_ >= 3 &&
+      strncmp(begin_, "\xEF\xBB\xBF", 3) == 0)
+    begin_ += 3;
+  const auto length = static_cast<size_t>(end_ - begin_);
+  if (length >= std::numeric_limits<uint32_t>::max())
+    return false;
+  // The structural characters are usually a small part of the document, so
+  // the index starts from an estimate and grows when a block may not fit. A
+  // large index left by a previous document is released.
+  static constexpr size_t keptPositions = 64 * 1024;
+  const size_t expected = length / 8 + 65;
+  if (positions_.size() > keptPositions && positions_.size() > 4 * expected)
+    std::vector<uint32_t>().swap(positions_);
+  if (positions_.size() < expected)
+    positions_.resize(expected);
+  uint32_t* out = positions_.data();
+  const BlockClassifier classify = blockClassifier();
+  uint64_t escapedCarry = 0;
+  uint64_t inStringCarry = 0;
+  uint64_t scalarCarry = 0;
+  char padded[64];
+  for (size_t offset = 0; offset < length; offset += 64) {
+    const char* block = begin_ + offset;
+    if (length - offset < 64) {
+      memset(padded, ' ', sizeof(padded));
+      memcpy(padded, block, length - offset);
+      block = padded;
+    }
+    // Up to 64 positions of the block, plus the sentinel.
+    const auto used = static_cast<size_t>(out - positions_.data());
+    if (positions_.size() - used < 65) {
+      positions_.resize(positions_.size() * 2);
+      out = positions_.data() + used;
+    }
+    BlockMasks masks;
+    classify(block, masks);
+    const uint64_t quote =
+        masks.quote & ~escapedChars(masks.backslash, escapedCarry);
+    // The opening quotes and the characters of the strings are in strings,
+    // not the closing quotes.
+    const uint64_t inString = prefixXor(quote) ^ inStringCarry;
+    inStringCarry = 0 - (inString >> 63);
+    const uint64_t scalar = ~(masks.op | masks.whitespace | quote | inString);
+    const uint64_t scalarStarts = scalar & ~(scalar << 1 | scalarCarry);
+    scalarCarry = scalar >> 63;
+    uint64_t structurals = (masks.op & ~inString) | quote | scalarStarts;
+    const auto base = static_cast<uint32_t>(offset);
+    while (structurals) {
+      *out++ = base + trailingZeroes(structurals);
+      structurals &= structurals - 1;
+    }
+  }
+  size_ = static_cast<size_t>(out - positions_.data());
+  positions_[size_] = static_cast<uint32_t>(length);
+  return inStringCarry == 0;
+}
+
+bool StructuralParser::parse(Value& root) {
+  current_ = positions_.data();
+  last_ = current_ + size_;
+  throwErrors_ = false;
+  if (current_ == last_)
+    return false;
+  const char first = begin_[*current_];
+  if (features_.strictRoot_ && first != '{' && first != '[')
+    return false;
+  return readValue(root, 1) && current_ == last_;
+}
+
+Value StructuralParser::parseAt(size_t position) {
+  current_ = positions_.data() + position;
+  last_ = positions_.data() + size_;
+  throwErrors_ = true;
+  Value value;
+  if (!readValue(value, 1))
+    throwRuntimeError("Invalid JSON document");
+  return value;
+}
+
+bool StructuralParser::readValue(Value& value, size_t depth) {
+  if (depth > features_.stackLimit_ || current_ == last_)
+    return false;
+  const uint32_t start = *current_++;
+  switch (begin_[start]) {
+  case '{':
+    return readObject(value, start, depth);
+  case '[':
+    return readArray(value, start, depth);
+  case '"':
+    return readString(value, start);
+  case '}':
+  case ']':
+  case ':':
+  case ',':
+    return false;
+  default:
+    return readScalar(value, start);
+  }
+}
+
+bool StructuralParser::readObject(Value& value, uint32_t start, size_t depth) {
+  Value init(objectValue);
+  value.swapPayload(init);
+  value.setOffsetStart(start);
+  if (current_ == last_)
+    return false;
+  if (begin_[*current_] == '}') {
+    value.setOffsetLimit(*current_++ + 1);
+    return true;
+  }
+  for (;;) {
+    // The opening and closing quotes of the name and the colon.
+    if (last_ - current_ < 3 || begin_[current_[0]] != '"' ||
+        begin_[current_[2]] != ':')
+      return false;
+    const char* name = begin_ + current_[0] + 1;
+    const char* nameEnd = begin_ + current_[1];
+    current_ += 3;
+    if (memchr(name, '\\', static_cast<size_t>(nameEnd - name))) {
+      if (!decodeString(name, nameEnd, string_))
+        return false;
+      name = string_.data();
+      nameEnd = name + string_.size();
+    }
+    if (nameEnd - name >= (1 << 30))
+      return false;
+    if (features_.rejectDupKeys_ && value.find(name, nameEnd))
+      return false;
+    if (!readValue(*value.demand(name, nameEnd), depth + 1) ||
+        current_ == last_)
+      return false;
+    const uint32_t position = *current_++;
+    if (begin_[position] == '}') {
+      value.setOffsetLimit(position + 1);
+      return true;
+    }
+    if (begin_[position] != ',')
+      return false;
+  }
+}
+
+bool StructuralParser::readArray(Value& value, uint32_t start, size_t depth) {
+  Value init(arrayValue);
+  value.swapPayload(init);
+  value.setOffsetStart(start);
+  if (current_ == last_)
+    return false;
+  if (begin_[*current_] == ']') {
+    value.setOffsetLimit(*current_++ + 1);
+    return true;
+  }
+  for (ArrayIndex index = 0;; ++index) {
+    if (!readValue(value[index], depth + 1) || current_ == last_)
+      return false;
+    const uint32_t position = *current_++;
+    if (begin_[position] == ']') {
+      value.setOffsetLimit(position + 1);
+      return true;
+    }
+    if (begin_[position] != ',')
+      return false;
+  }
+}
+
+bool StructuralParser::readString(Value& value, uint32_t start) {
+  // The closing quote always follows the opening one in the index.
+  const uint32_t limit = *current_++ + 1;
+  const char* begin = begin_ + start + 1;
+  const char* end = begin_ + limit - 1;
+  if (memchr(begin, '\\', static_cast<size_t>(end - begin))) {
+    if (!decodeString(begin, end, string_))
+      return readToken(value, start, begin_ + limit);
+    begin = string_.data();
+    end = begin + string_.size();
+  }
+  Value decoded(begin, end);
+  value.swapPayload(decoded);
+  value.setOffsetStart(start);
+  value.setOffsetLimit(limit);
+  return true;
+}
+
+bool StructuralParser::readScalar(Value& value, uint32_t start) {
+  const unsigned char* classes = charClasses();
+  const char* current = begin_ + start;
+  const char* end = current + 1;
+  // The token ends where the structural index starts the next one.
+  while (end != end_ && (classes[static_cast<unsigned char>(*end)] &
+                         (quoteClass | whitespaceClass | opClass)) == 0)
+    ++end;
+  const auto length = end - current;
+  Value decoded;
+  bool ok;
+  switch (*current) {
+  case 't':
+    ok = length == 4 && memcmp(current, "true", 4) == 0;
+    decoded = true;
+    break;
+  case 'f':
+    ok = length == 5 && memcmp(current, "false", 5) == 0;
+    decoded = false;
+    break;
+  case 'n':
+    ok = length == 4 && memcmp(current, "null", 4) == 0;
+    break;
+  default:
+    ok = decodeNumber(current, end, decoded);
+    break;
+  }
+  if (!ok)
+    return readToken(value, start, end);
+  value.swapPayload(decoded);
+  value.setOffsetStart(start);
+  value.setOffsetLimit(end - begin_);
+  return true;
+}
+
+// Reads a token which is not plain JSON, or is invalid, with OurReader.
+bool StructuralParser::readToken(Value& value, uint32_t start,
+                                 const char* end) {
+  if (!tokenReader_) {
+    OurFeatures features = features_;
+    features.strictRoot_ = false;
+    features.failIfExtra_ = true;
+    features.skipBom_ = false;
+    tokenReader_.reset(new OurReader(features));
+  }
+  Value decoded;
+  if (!tokenReader_->parse(begin_ + start, end, decoded, false)) {
+    if (throwErrors_)
+      throwRuntimeError(tokenReader_->getFormattedErrorMessages());
+    return false;
+  }
+  // The token may be preceded or followed by comments, which must be
+  // collected by OurReader.
+  if (!throwErrors_ && (decoded.getOffsetStart() != 0 ||
+                        decoded.getOffsetLimit() != end - begin_ - start))
+    return false;
+  value.swapPayload(decoded);
+  value.setOffsetStart(start + decoded.getOffsetStart());
+  value.setOffsetLimit(start + decoded.getOffsetLimit());
+  return true;
+}
+
+// Decodes the numbers of the JSON grammar like OurReader::decodeNumber()
+// does. The other numbers are left to OurReader.
+bool StructuralParser::decodeNumber(const char* current, const char* end,
+                                    Value& decoded) {
+  const char* const begin = current;
+  const bool isNegative = *current == '-';
+  if (isNegative)
+    ++current;
+  // At most 19 digits are accumulated, so that the mantissa cannot overflow.
+  uint64_t mantissa = 0;
+  int digits = 0;
+  const char* integral = current;
+  for (; current != end && isDigit(*current); ++current, ++digits)
+    mantissa = mantissa * 10 + static_cast<unsigned>(*current - '0');
+  if (current == integral || (*integral == '0' && current - integral > 1))
+    return false;
+  if (current == end) {
+    if (digits > 18)
+      return false;
+    if (isNegative) {
+      if (mantissa > Value::LargestUInt(Value::maxLargestInt))
+        return false;
+      decoded = -Value::LargestInt(mantissa);
+    } else if (mantissa <= Value::LargestUInt(Value::maxLargestInt)) {
+      decoded = Value::LargestInt(mantissa);
+    } else if (mantissa <= Value::maxLargestUInt) {
+      decoded = Value::LargestUInt(mantissa);
+    } else {
+      return false;
+    }
+    return true;
+  }
+  int exponent = 0;
+  if (*current == '.') {
+    const char* fraction = ++current;
+    for (; current != end && isDigit(*current); ++current, ++digits)
+      mantissa = mantissa * 10 + static_cast<unsigned>(*current - '0');
+    if (current == fraction)
+      return false;
+    exponent = -static_cast<int>(current - fraction);
+  }
+  if (current != end && (*current == 'e' || *current == 'E')) {
+    ++current;
+    const bool isNegativeExponent = current != end && *current == '-';
+    if (current != end && (*current == '-' || *current == '+'))
+      ++current;
+    const char* exponentDigits = current;
+    int value = 0;
+    for (; current != end && isDigit(*current) && value < 10000; ++current)
+      value = value * 10 + (*current - '0');
+    if (current == exponentDigits)
+      return false;
+    exponent += isNegativeExponent ? -value : value;
+  }
+  if (current != end)
+    return false;
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+  // Both the mantissa and the power of ten are exact doubles, so the result
+  // is correctly rounded, like the one of the standard library.
+  if (digits <= 19 && mantissa <= (uint64_t(1) << 53) && exponent >= -22 &&
+      exponent <= 22) {
+    auto value = static_cast<double>(mantissa);
+    if (exponent < 0)
+      value /= exactPowersOfTen[-exponent];
+    else
+      value *= exactPowersOfTen[exponent];
+    decoded = isNegative ? -value : value;
+    return true;
+  }
+#endif
+  return decodeDouble(begin, end, decoded);
+}
+
+bool StructuralParser::decodeDouble(const char* begin, const char* end,
+                                    Value& decoded) {
+  if (!doubleStream_)
+    doubleStream_.reset(new IStringStream);
+  doubleStream_->clear();
+  doubleStream_->str(String(begin, end));
+  double value = 0;
+  if (!(*doubleStream_ >> value)) {
+    if (value == std::numeric_limits<double>::max())
+      value = std::numeric_limits<double>::infinity();
+    else if (value == std::numeric_limits<double>::lowest())
+      value = -std::numeric_limits<double>::infinity();
+    else if (!std::isinf(value))
+      return false;
+  }
+  decoded = value;
+  return true;
+}
+
+// Decodes the escape sequences like OurReader::decodeString() does.
+bool StructuralParser::decodeString(const char* current, const char* end,
+                                    String& decoded) {
+  decoded.clear();
+  for (;;) {
+    const char* escape = static_cast<const char*>(
+        memchr(current, '\\', static_cast<size_t>(end - current)));
+    if (!escape) {
+      decoded.append(current, end);
+      return true;
+    }
+    decoded.append(current, escape);
+    current = escape + 1;
+    if (current == end)
+      return false;
+    switch (*current++) {
+    case '"':
+      decoded += '"';
+      break;
+    case '/':
+      decoded += '/';
+      break;
+    case '\\':
+      decoded += '\\';
+      break;
+    case 'b':
+      decoded += '\b';
+      break;
+    case 'f':
+      decoded += '\f';
+      break;
+    case 'n':
+      decoded += '\n';
+      break;
+    case 'r':
+      decoded += '\r';
+      break;
+    case 't':
+      decoded += '\t';
+      break;
+    case 'u': {
+      unsigned int unicode = 0;
+      if (end - current < 4 || !decodeHexQuad(current, unicode))
+        return false;
+      current += 4;
+      if (unicode >= 0xD800 && unicode <= 0xDBFF) {
+        unsigned int surrogatePair = 0;
+        if (end - current < 6 || current[0] != '\\' || current[1] != 'u' ||
+            !decodeHexQuad(current + 2, surrogatePair))
+          return false;
+        current += 6;
+        unicode = 0x10000 + ((unicode & 0x3FF) << 10) + (surrogatePair & 0x3FF);
+      }
+      decoded += codePointToUTF8(unicode);
+    } break;
+    default:
+      return false;
+    }
+  }
+}
+
+class FastCharReader : public CharReader {
+  bool const collectComments_;
+  OurFeatures const features_;
+  StructuralParser parser_;
+  std::unique_ptr<OurReader> reader_;
+
+public:
+  FastCharReader(bool collectComments, OurFeatures const& features)
+      : collectComments_(collectComments), features_(features),
+        parser_(features) {}
+  bool parse(char const* beginDoc, char const* endDoc, Value* root,
+             String* errs) override {
+    Value parsed;
+    if (parser_.index(beginDoc, endDoc) && parser_.parse(parsed)) {
+      root->swapPayload(parsed);
+      root->setOffsetStart(parsed.getOffsetStart());
+      root->setOffsetLimit(parsed.getOffsetLimit());
+      if (errs)
+        errs->clear();
+      return true;
+    }
+    if (!reader_)
+      reader_.reset(new OurReader(features_));
+    bool ok = reader_->parse(beginDoc, endDoc, *root, collectComments_);
+    if (errs) {
+      *errs = reader_->getFormattedErrorMessages();
+    }
+    return ok;
+  }
+};
+
+static OurFeatures ourFeatures(Json::Value const& settings) {
   OurFeatures features = OurFeatures::all();
-  features.allowComments_ = settings_["allowComments"].asBool();
-  features.allowTrailingCommas_ = settings_["allowTrailingCommas"].asBool();
-  features.strictRoot_ = settings_["strictRoot"].asBool();
+  features.allowComments_ = settings["allowComments"].asBool();
+  features.allowTrailingCommas_ = settings["allowTrailingCommas"].asBool();
+  features.strictRoot_ = settings["strictRoot"].asBool();
   features.allowDroppedNullPlaceholders_ =
-      settings_["allowDroppedNullPlaceholders"].asBool();
-  features.allowNumericKeys_ = settings_["allowNumericKeys"].asBool();
-  features.allowSingleQuotes_ = settings_["allowSingleQuotes"].asBool();
+      settings["allowDroppedNullPlaceholders"].asBool();
+  features.allowNumericKeys_ = settings["allowNumericKeys"].asBool();
+  features.allowSingleQuotes_ = settings["allowSingleQuotes"].asBool();
 
   // Stack limit is always a size_t, so we get this as an unsigned int
   // regardless of it we have 64-bit integer support enabled.
-  features.stackLimit_ = static_cast<size_t>(settings_["stackLimit"].asUInt());
-  features.failIfExtra_ = settings_["failIfExtra"].asBool();
-  features.rejectDupKeys_ = settings_["rejectDupKeys"].asBool();
-  features.allowSpecialFloats_ = settings_["allowSpecialFloats"].asBool();
-  features.skipBom_ = settings_["skipBom"].asBool();
+  features.stackLimit_ = static_cast<size_t>(settings["stackLimit"].asUInt());
+  features.failIfExtra_ = settings["failIfExtra"].asBool();
+  features.rejectDupKeys_ = settings["rejectDupKeys"].asBool();
+  features.allowSpecialFloats_ = settings["allowSpecialFloats"].asBool();
+  features.skipBom_ = settings["skipBom"].asBool();
+  return features;
+}
+
+CharReaderBuilder::CharReaderBuilder() { setDefaults(&settings_); }
+CharReaderBuilder::~CharReaderBuilder() = default;
+CharReader* CharReaderBuilder::newCharReader() const {
+  bool collectComments = settings_["collectComments"].asBool();
+  OurFeatures features = ourFeatures(settings_);
+  if (settings_["fastParse"].asBool())
+    return new FastCharReader(collectComments, features);
   return new OurCharReader(collectComments, features);
 }
 
@@ -1926,6 +2640,7 @@ bool CharReaderBuilder::validate(Json::Value* invalid) const {
       "rejectDupKeys",
       "allowSpecialFloats",
       "skipBom",
+      "fastParse",
   };
   for (auto si = settings_.begin(); si != settings_.end(); ++si) {
     auto key = si.name();
@@ -1956,6 +2671,7 @@ void CharReaderBuilder::strictMode(Json::Value* settings) {
   (*settings)["rejectDupKeys"] = true;
   (*settings)["allowSpecialFloats"] = false;
   (*settings)["skipBom"] = true;
+  (*settings)["fastParse"] = true;
   //! [CharReaderBuilderStrictMode]
 }
 // static
@@ -1973,9 +2689,369 @@ void CharReaderBuilder::setDefaults(Json::Value* settings) {
   (*settings)["rejectDupKeys"] = false;
   (*settings)["allowSpecialFloats"] = false;
   (*settings)["skipBom"] = true;
+  (*settings)["fastParse"] = true;
   //! [CharReaderBuilderDefaults]
 }
 
+// Implementation of class LazyDocument
+// ////////////////////////////////
+
+class LazyValue::Document {
+public:
+  explicit Document(OurFeatures const& features) : parser_(features) {}
+
+  bool validate();
+  // Returns the position in the index following the value at position.
+  size_t skip(size_t position) const;
+  char at(size_t position) const {
+    return parser_.begin_[parser_.positions_[position]];
+  }
+  // Returns the string at position, decoded if needed.
+  void name(size_t position, const char*& begin, const char*& end);
+
+  mutable StructuralParser parser_;
+  // The position of the matching closing bracket of each opening one.
+  std::vector<uint32_t> closings_;
+  bool lazy_ = false;
+  // The document, when it is not parsed lazily.
+  Value value_;
+  String name_;
+};
+
+// Checks the grammar of the indexed document and matches the brackets. The
+// tokens which are not strings are only decoded when they are accessed.
+bool LazyValue::Document::validate() {
+  const size_t size = parser_.size_;
+  const OurFeatures& features = parser_.features_;
+  // A scalar root may be followed by anything when failIfExtra is false, such
+  // documents are better parsed completely.
+  if (size == 0 || features.rejectDupKeys_ || (at(0) != '{' && at(0) != '['))
+    return false;
+  if (closings_.size() < size)
+    closings_.resize(size);
+  std::vector<uint32_t> openings;
+  size_t position = 0;
+  for (;;) {
+    // A value is expected at position.
+    if (position == size || openings.size() + 1 > features.stackLimit_)
+      return false;
+    const char c = at(position);
+    if (c == '{' || c == '[') {
+      const char closing = c == '{' ? '}' : ']';
+      openings.push_back(static_cast<uint32_t>(position++));
+      if (position != size && at(position) == closing) {
+        closings_[openings.back()] = static_cast<uint32_t>(position++);
+        openings.pop_back();
+      } else if (c == '{') {
+        if (size - position < 3 || at(position) != '"' ||
+            at(position + 2) != ':')
+          return false;
+        position += 3;
+        continue;
+      } else {
+        continue;
+      }
+    } else if (c == '"') {
+      position += 2;
+    } else if (c == '}' || c == ']' || c == ':' || c == ',') {
+      return false;
+    } else {
+      // Comments may hide separators, like in "[1//,\n2]".
+      const uint32_t* positions = parser_.positions_.data();
+      if (memchr(parser_.begin_ + positions[position], '/',
+                 positions[position + 1] - positions[position]))
+        return false;
+      ++position;
+    }
+    // A value has been skipped, a separator or a closing bracket follows.
+    for (;;) {
+      if (openings.empty())
+        return position == size;
+      if (position == size)
+        return false;
+      const bool inObject = at(openings.back()) == '{';
+      const char separator = at(position);
+      if (separator == (inObject ? '}' : ']')) {
+        closings_[openings.back()] = static_cast<uint32_t>(position++);
+        openings.pop_back();
+        continue;
+      }
+      if (separator != ',')
+        return false;
+      ++position;
+      if (inObject) {
+        if (size - position < 3 || at(position) != '"' ||
+            at(position + 2) != ':')
+          return false;
+        position += 3;
+      }
+      break;
+    }
+  }
+}
+
+size_t LazyValue::Document::skip(size_t position) const {
+  switch (at(position)) {
+  case '{':
+  case '[':
+    return closings_[position] + 1;
+  case '"':
+    return position + 2;
+  default:
+    return position + 1;
+  }
+}
+
+void LazyValue::Document::name(size_t position, const char*& begin,
+                              const char*& end) {
+  begin = parser_.begin_ + parser_.positions_[position] + 1;
+  end = parser_.begin_ + parser_.positions_[position + 1];
+  if (!memchr(begin, '\\', static_cast<size_t>(end - begin)))
+    return;
+  String& decoded = name_;
+  if (!parser_.decodeString(begin, end, decoded)) {
+    // Throws the error of OurReader.
+    parser_.parseAt(position);
+  }
+  begin = decoded.data();
+  end = begin + decoded.size();
+}
+
+LazyDocument::LazyDocument() : LazyDocument(CharReaderBuilder()) {}
+
+LazyDocument::LazyDocument(CharReaderBuilder const& builder)
+    : document_(new LazyValue::Document(ourFeatures(builder.settings_))) {}
+
+LazyDocument::~LazyDocument() = default;
+
+bool LazyDocument::parse(char const* beginDoc, char const* endDoc,
+                         String* errs) {
+  document_->lazy_ =
+      document_->parser_.index(beginDoc, endDoc) && document_->validate();
+  if (document_->lazy_) {
+    if (errs)
+      errs->clear();
+    return true;
+  }
+  // Not plain JSON, parse it completely.
+  document_->value_ = Value();
+  OurReader reader(document_->parser_.features_);
+  bool ok = reader.parse(beginDoc, endDoc, document_->value_, false);
+  if (errs)
+    *errs = reader.getFormattedErrorMessages();
+  return ok;
+}
+
+LazyValue LazyDocument::root() const {
+  if (document_->lazy_)
+    return LazyValue(document_.get(), 0, nullptr);
+  return LazyValue(document_.get(), 0, &document_->value_);
+}
+
+// Implementation of class LazyValue
+// ////////////////////////////////
+
+LazyValue::LazyValue(LazyValue::Document* document, ArrayIndex position,
+                     Value const* value)
+    : document_(document), position_(position), value_(value) {}
+
+ValueType LazyValue::type() const {
+  if (!document_)
+    return nullValue;
+  if (value_)
+    return value_->type();
+  switch (document_->at(position_)) {
+  case '{':
+    return objectValue;
+  case '[':
+    return arrayValue;
+  case '"':
+    return stringValue;
+  default:
+    return value().type();
+  }
+}
+
+bool LazyValue::isNull() const { return type() == nullValue; }
+
+bool LazyValue::isBool() const { return type() == booleanValue; }
+
+bool LazyValue::isNumeric() const {
+  const ValueType valueType = type();
+  return valueType == intValue || valueType == uintValue ||
+         valueType == realValue;
+}
+
+bool LazyValue::isString() const { return type() == stringValue; }
+
+bool LazyValue::isArray() const { return type() == arrayValue; }
+
+bool LazyValue::isObject() const { return type() == objectValue; }
+
+ArrayIndex LazyValue::size() const {
+  if (!document_)
+    return 0;
+  if (value_)
+    return value_->size();
+  const char opening = document_->at(position_);
+  if (opening != '{' && opening != '[')
+    return 0;
+  const size_t closing = document_->closings_[position_];
+  size_t position = position_ + 1;
+  if (opening == '[') {
+    ArrayIndex count = 0;
+    for (; position != closing; ++count) {
+      position = document_->skip(position);
+      if (position != closing)
+        ++position;
+    }
+    return count;
+  }
+  // Duplicated names are only counted once, like in a Value.
+  std::vector<std::pair<const char*, size_t>> names;
+  while (position != closing) {
+    const char* name = document_->parser_.begin_ +
+                       document_->parser_.positions_[position] + 1;
+    const auto length = static_cast<size_t>(
+        document_->parser_.begin_ +
+        document_->parser_.positions_[position + 1] - name);
+    if (memchr(name, '\\', length))
+      return value().size();
+    names.emplace_back(name, length);
+    position = document_->skip(position + 3);
+    if (position != closing)
+      ++position;
+  }
+  std::sort(names.begin(), names.end(),
+            [](const std::pair<const char*, size_t>& a,
+               const std::pair<const char*, size_t>& b) {
+              const int order = memcmp(a.first, b.first,
+                                       std::min(a.second, b.second));
+              return order < 0 || (order == 0 && a.second < b.second);
+            });
+  auto count = static_cast<ArrayIndex>(names.size());
+  for (size_t index = 1; index < names.size(); ++index) {
+    if (names[index].second == names[index - 1].second &&
+        memcmp(names[index].first, names[index - 1].first,
+               names[index].second) == 0)
+      --count;
+  }
+  return count;
+}
+
+bool LazyValue::isMember(const char* key) const {
+  return find(key, key + strlen(key)).document_ != nullptr;
+}
+
+bool LazyValue::isMember(const String& key) const {
+  return find(key.data(), key.data() + key.length()).document_ != nullptr;
+}
+
+LazyValue LazyValue::operator[](const char* key) const {
+  return find(key, key + strlen(key));
+}
+
+LazyValue LazyValue::operator[](const String& key) const {
+  return find(key.data(), key.data() + key.length());
+}
+
+LazyValue LazyValue::find(const char* begin, const char* end) const {
+  const ValueType valueType = type();
+  JSON_ASSERT_MESSAGE(
+      valueType == nullValue || valueType == objectValue,
+      "in Json::LazyValue::operator[](char const*)const: requires "
+      "objectValue");
+  if (valueType == nullValue)
+    return LazyValue();
+  if (value_) {
+    const Value* member = value_->find(begin, end);
+    return member ? LazyValue(document_, 0, member) : LazyValue();
+  }
+  const size_t closing = document_->closings_[position_];
+  const auto length = static_cast<size_t>(end - begin);
+  size_t position = position_ + 1;
+  LazyValue found;
+  // The last member with the name wins, like in OurReader.
+  while (position != closing) {
+    const char* name;
+    const char* nameEnd;
+    document_->name(position, name, nameEnd);
+    if (static_cast<size_t>(nameEnd - name) == length &&
+        memcmp(name, begin, length) == 0)
+      found = LazyValue(document_, static_cast<ArrayIndex>(position + 3),
+                        nullptr);
+    position = document_->skip(position + 3);
+    if (position != closing)
+      ++position;
+  }
+  return found;
+}
+
+LazyValue LazyValue::operator[](ArrayIndex index) const {
+  const ValueType valueType = type();
+  JSON_ASSERT_MESSAGE(
+      valueType == nullValue || valueType == arrayValue,
+      "in Json::LazyValue::operator[](ArrayIndex)const: requires arrayValue");
+  if (valueType == nullValue)
+    return LazyValue();
+  if (value_) {
+    const Value& element = (*value_)[index];
+    return &element == &Value::nullSingleton()
+               ? LazyValue()
+               : LazyValue(document_, 0, &element);
+  }
+  const size_t closing = document_->closings_[position_];
+  size_t position = position_ + 1;
+  for (; position != closing && index != 0; --index) {
+    position = document_->skip(position);
+    if (position != closing)
+      ++position;
+  }
+  if (position == closing)
+    return LazyValue();
+  return LazyValue(document_, static_cast<ArrayIndex>(position), nullptr);
+}
+
+LazyValue LazyValue::operator[](int index) const {
+  JSON_ASSERT_MESSAGE(
+      index >= 0,
+      "in Json::LazyValue::operator[](int index) const: index cannot be "
+      "negative");
+  return (*this)[ArrayIndex(index)];
+}
+
+Value LazyValue::value() const {
+  if (!document_)
+    return Value();
+  if (value_)
+    return *value_;
+  return document_->parser_.parseAt(position_);
+}
+
+String LazyValue::asString() const {
+  if (document_ && !value_ && document_->at(position_) == '"') {
+    const char* begin;
+    const char* end;
+    document_->name(position_, begin, end);
+    return String(begin, end);
+  }
+  return value().asString();
+}
+
+Int LazyValue::asInt() const { return value().asInt(); }
+
+UInt LazyValue::asUInt() const { return value().asUInt(); }
+
+#if defined(JSON_HAS_INT64)
+Int64 LazyValue::asInt64() const { return value().asInt64(); }
+
+UInt64 LazyValue::asUInt64() const { return value().asUInt64(); }
+#endif // if defined(JSON_HAS_INT64)
+
+double LazyValue::asDouble() const { return value().asDouble(); }
+
+bool LazyValue::asBool() const { return value().asBool(); }
+
 //////////////////////////////////
 // global functions
 
@@ -14,6 +14,7 @@
 #include <cstddef>
 #include <cstring>
 #include <iostream>
+#include <new>
 #include <sstream>
 #include <utility>
 
@@ -222,6 +223,82 @@ JSONCPP_NORETURN void throwLogicError(String const& msg) {
 }
 #endif
 
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// class MonotonicBuffer
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+
+static thread_local MonotonicBuffer* currentBuffer = nullptr;
+
+MonotonicBuffer::MonotonicBuffer(size_t chunkSize) : chunkSize_(chunkSize) {}
+
+MonotonicBuffer::~MonotonicBuffer() { release(); }
+
+void* MonotonicBuffer::allocate(size_t size, size_t alignment) {
+  auto aligned = [this, alignment]() {
+    auto address = reinterpret_cast<uintptr_t>(cursor_);
+    return (address + alignment - 1U) & ~static_cast<uintptr_t>(alignment - 1U);
+  };
+  uintptr_t address = aligned();
+  if (!chunks_ || address + size > reinterpret_cast<uintptr_t>(end_)) {
+    // Every chunk is twice bigger than the previous one.
+    size_t chunkSize = chunks_ ? chunks_->size * 2U : chunkSize_;
+    chunkSize = std::max(chunkSize, sizeof(Chunk) + size + alignment);
+    auto chunk = static_cast<Chunk*>(::operator new(chunkSize));
+    chunk->next = chunks_;
+    chunk->size = chunkSize;
+    chunks_ = chunk;
+    capacity_ += chunkSize;
+    cursor_ = reinterpret_cast<char*>(chunk + 1);
+    end_ = reinterpret_cast<char*>(chunk) + chunkSize;
+    address = aligned();
+  }
+  cursor_ = reinterpret_cast<char*>(address + size);
+  ++allocations_;
+  return reinterpret_cast<void*>(address);
+}
+
+void MonotonicBuffer::release() {
+  while (chunks_) {
+    Chunk* next = chunks_->next;
+#if JSONCPP_USING_SECURE_MEMORY
+    memset(static_cast<void*>(chunks_), 0, chunks_->size);
+#endif
+    ::operator delete(chunks_);
+    chunks_ = next;
+  }
+  cursor_ = nullptr;
+  end_ = nullptr;
+  allocations_ = 0;
+  capacity_ = 0;
+}
+
+MonotonicBuffer* MonotonicBuffer::current() { return currentBuffer; }
+
+void MonotonicBuffer::setCurrent(MonotonicBuffer* buffer) {
+  currentBuffer = buffer;
+}
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// class Document
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+
+Document::Document(size_t chunkSize) : buffer_(chunkSize) {}
+
+Document::Scope::Scope(Document& document)
+    : previous_(MonotonicBuffer::current()) {
+  MonotonicBuffer::setCurrent(&document.buffer_);
+}
+
+Document::Scope::~Scope() { MonotonicBuffer::setCurrent(previous_); }
+
 // //////////////////////////////////////////////////////////////////
 // //////////////////////////////////////////////////////////////////
 // //////////////////////////////////////////////////////////////////
@@ -280,15 +357,13 @@ void Value::CZString::swap(CZString& other) {
 }
 
 Value::CZString& Value::CZString::operator=(const CZString& other) {
-  cstr_ = other.cstr_;
-  index_ = other.index_;
+  CZString(other).swap(*this);
   return *this;
 }
 
 Value::CZString& Value::CZString::operator=(CZString&& other) noexcept {
-  cstr_ = other.cstr_;
-  index_ = other.index_;
-  other.cstr_ = nullptr;
+  // The string of this key, if any, is released by other.
+  swap(other);
   return *this;
 }
 
@@ -363,7 +438,7 @@ Value::Value(ValueType type) {
     break;
   case arrayValue:
   case objectValue:
-    value_.map_ = new ObjectValues();
+    allocateMap(nullptr);
     break;
   case booleanValue:
     value_.bool_ = false;
@@ -399,23 +474,20 @@ Value::Value(double value) {
 }
 
 Value::Value(const char* value) {
-  initBasic(stringValue, true);
+  initBasic(stringValue);
   JSON_ASSERT_MESSAGE(value != nullptr,
                       "Null Value Passed to Value Constructor");
-  value_.string_ = duplicateAndPrefixStringValue(
-      value, static_cast<unsigned>(strlen(value)));
+  allocateString(value, static_cast<unsigned>(strlen(value)));
 }
 
 Value::Value(const char* begin, const char* end) {
-  initBasic(stringValue, true);
-  value_.string_ =
-      duplicateAndPrefixStringValue(begin, static_cast<unsigned>(end - begin));
+  initBasic(stringValue);
+  allocateString(begin, static_cast<unsigned>(end - begin));
 }
 
 Value::Value(const String& value) {
-  initBasic(stringValue, true);
-  value_.string_ = duplicateAndPrefixStringValue(
-      value.data(), static_cast<unsigned>(value.length()));
+  initBasic(stringValue);
+  allocateString(value.data(), static_cast<unsigned>(value.length()));
 }
 
 Value::Value(const StaticString& value) {
@@ -934,7 +1006,7 @@ Value& Value::operator[](ArrayIndex index) {
     return (*it).second;
 
   ObjectValues::value_type defaultValue(key, nullSingleton());
-  it = value_.map_->insert(it, defaultValue);
+  it = value_.map_->insert(it, std::move(defaultValue));
   return (*it).second;
 }
 
@@ -968,6 +1040,7 @@ const Value& Value::operator[](int index) const {
 void Value::initBasic(ValueType type, bool allocated) {
   setType(type);
   setIsAllocated(allocated);
+  setIsBuffered(false);
   comments_ = Comments{};
   start_ = 0;
   limit_ = 0;
@@ -976,6 +1049,7 @@ void Value::initBasic(ValueType type, bool allocated) {
 void Value::dupPayload(const Value& other) {
   setType(other.type());
   setIsAllocated(false);
+  setIsBuffered(false);
   switch (type()) {
   case nullValue:
   case intValue:
@@ -990,15 +1064,14 @@ void Value::dupPayload(const Value& other) {
       char const* str;
       decodePrefixedString(other.isAllocated(), other.value_.string_, &len,
                            &str);
-      value_.string_ = duplicateAndPrefixStringValue(str, len);
-      setIsAllocated(true);
+      allocateString(str, len);
     } else {
       value_.string_ = other.value_.string_;
     }
     break;
   case arrayValue:
   case objectValue:
-    value_.map_ = new ObjectValues(*other.value_.map_);
+    allocateMap(other.value_.map_);
     break;
   default:
     JSON_ASSERT_UNREACHABLE;
@@ -1014,18 +1087,55 @@ void Value::releasePayload() {
   case booleanValue:
     break;
   case stringValue:
-    if (isAllocated())
+    if (isAllocated() && !isBuffered())
       releasePrefixedStringValue(value_.string_);
     break;
   case arrayValue:
   case objectValue:
-    delete value_.map_;
+    if (isBuffered())
+      value_.map_->~ObjectValues();
+    else
+      delete value_.map_;
     break;
   default:
     JSON_ASSERT_UNREACHABLE;
   }
 }
 
+// Allocate from the buffer of this thread, if any.
+void Value::allocateString(char const* value, unsigned length) {
+  MonotonicBuffer* buffer = MonotonicBuffer::current();
+  if (buffer) {
+    JSON_ASSERT_MESSAGE(length <= static_cast<unsigned>(Value::maxInt) -
+                                      sizeof(unsigned) - 1U,
+                        "in Json::Value::allocateString(): "
+                        "length too big for prefixing");
+    auto string = static_cast<char*>(
+        buffer->allocate(sizeof(unsigned) + length + 1U, alignof(unsigned)));
+    memcpy(string, &length, sizeof(unsigned));
+    memcpy(string + sizeof(unsigned), value, length);
+    string[sizeof(unsigned) + length] = 0;
+    value_.string_ = string;
+  } else {
+    value_.string_ = duplicateAndPrefixStringValue(value, length);
+  }
+  setIsAllocated(true);
+  setIsBuffered(buffer != nullptr);
+}
+
+void Value::allocateMap(ObjectValues const* other) {
+  MonotonicBuffer* buffer = MonotonicBuffer::current();
+  ObjectValues::allocator_type allocator(buffer);
+  if (buffer) {
+    void* map = buffer->allocate(sizeof(ObjectValues), alignof(ObjectValues));
+    value_.map_ = other ? new (map) ObjectValues(*other, allocator)
+                        : new (map) ObjectValues(allocator);
+  } else {
+    value_.map_ = other ? new ObjectValues(*other) : new ObjectValues();
+  }
+  setIsBuffered(buffer != nullptr);
+}
+
 void Value::dupMeta(const Value& other) {
   comments_ = other.comments_;
   start_ = other.start_;
@@ -1048,7 +1158,7 @@ Value& Value::resolveReference(const char* key) {
     return (*it).second;
 
   ObjectValues::value_type defaultValue(actualKey, nullSingleton());
-  it = value_.map_->insert(it, defaultValue);
+  it = value_.map_->insert(it, std::move(defaultValue));
   Value& value = (*it).second;
   return value;
 }
@@ -1066,8 +1176,20 @@ Value& Value::resolveReference(char const* key, char const* end) {
   if (it != value_.map_->end() && (*it).first == actualKey)
     return (*it).second;
 
+  MonotonicBuffer* buffer = value_.map_->get_allocator().buffer();
+  if (buffer) {
+    // The name is released with the buffer, like the member.
+    unsigned length = static_cast<unsigned>(end - key);
+    auto name = static_cast<char*>(buffer->allocate(length + 1U, 1U));
+    memcpy(name, key, length);
+    name[length] = 0;
+    ObjectValues::value_type member(
+        CZString(name, length, CZString::duplicateInBuffer), Value());
+    it = value_.map_->insert(it, std::move(member));
+    return (*it).second;
+  }
   ObjectValues::value_type defaultValue(actualKey, nullSingleton());
-  it = value_.map_->insert(it, defaultValue);
+  it = value_.map_->insert(it, std::move(defaultValue));
   Value& value = (*it).second;
   return value;
 }
@@ -39,6 +39,9 @@ ValueIteratorBase::computeDistance(const SelfType& other) const {
     return 0;
   }
 
+#if JSONCPP_USING_FLAT_OBJECTS
+  return static_cast<difference_type>(other.current_ - current_);
+#else
   // Usage of std::distance is not portable (does not compile with Sun Studio 12
   // RogueWave STL,
   // which is the one used by default).
@@ -50,6 +53,7 @@ ValueIteratorBase::computeDistance(const SelfType& other) const {
     ++myDistance;
   }
   return myDistance;
+#endif
 }
 
 bool ValueIteratorBase::isEqual(const SelfType& other) const {
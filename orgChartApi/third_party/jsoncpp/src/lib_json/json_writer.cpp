@@ -17,6 +17,15 @@
 #include <sstream>
 #include <utility>
 
+#if defined(__SSE2__) || defined(_M_X64) ||                                    \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define JSONCPP_HAS_SSE2 1
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 #if __cplusplus >= 201103L
 #include <cmath>
 #include <cstdio>
@@ -124,6 +133,288 @@ String valueToString(UInt value) { return valueToString(LargestUInt(value)); }
 #endif // # if defined(JSON_HAS_INT64)
 
 namespace {
+// Shortest round-trip formatting of doubles with the Grisu2 algorithm of
+// Florian Loitsch, "Printing Floating-Point Numbers Quickly and Accurately
+// with Integers". The digits always read back as the same double, they are
+// the shortest ones in all but a few rare cases.
+
+/// A floating point number f * 2^e with a 64-bit significand.
+struct DiyFp {
+  uint64_t f;
+  int e;
+};
+
+DiyFp multiply(DiyFp x, DiyFp y) {
+  // The upper 64 bits of the 128-bit product, rounded.
+  const uint64_t xLo = x.f & 0xFFFFFFFFu;
+  const uint64_t xHi = x.f >> 32;
+  const uint64_t yLo = y.f & 0xFFFFFFFFu;
+  const uint64_t yHi = y.f >> 32;
+  const uint64_t lo = xLo * yLo;
+  const uint64_t mid1 = xLo * yHi;
+  const uint64_t mid2 = xHi * yLo;
+  const uint64_t hi = xHi * yHi;
+  uint64_t carry = (lo >> 32) + (mid1 & 0xFFFFFFFFu) + (mid2 & 0xFFFFFFFFu);
+  carry += uint64_t(1) << 31;
+  return {hi + (mid1 >> 32) + (mid2 >> 32) + (carry >> 32), x.e + y.e + 64};
+}
+
+DiyFp normalize(DiyFp x) {
+  while ((x.f >> 63) == 0) {
+    x.f <<= 1;
+    --x.e;
+  }
+  return x;
+}
+
+struct CachedPower {
+  uint64_t f;
+  int e;
+  int k;
+};
+
+/// Normalized 10^k for k = -300, -292, ..., 324.
+const CachedPower cachedPowers[] = {
+    {0xAB70FE17C79AC6CA, -1060, -300},
+    {0xFF77B1FCBEBCDC4F, -1034, -292},
+    {0xBE5691EF416BD60C, -1007, -284},
+    {0x8DD01FAD907FFC3C, -980, -276},
+    {0xD3515C2831559A83, -954, -268},
+    {0x9D71AC8FADA6C9B5, -927, -260},
+    {0xEA9C227723EE8BCB, -901, -252},
+    {0xAECC49914078536D, -874, -244},
+    {0x823C12795DB6CE57, -847, -236},
+    {0xC21094364DFB5637, -821, -228},
+    {0x9096EA6F3848984F, -794, -220},
+    {0xD77485CB25823AC7, -768, -212},
+    {0xA086CFCD97BF97F4, -741, -204},
+    {0xEF340A98172AACE5, -715, -196},
+    {0xB23867FB2A35B28E, -688, -188},
+    {0x84C8D4DFD2C63F3B, -661, -180},
+    {0xC5DD44271AD3CDBA, -635, -172},
+    {0x936B9FCEBB25C996, -608, -164},
+    {0xDBAC6C247D62A584, -582, -156},
+    {0xA3AB66580D5FDAF6, -555, -148},
+    {0xF3E2F893DEC3F126, -529, -140},
+    {0xB5B5ADA8AAFF80B8, -502, -132},
+    {0x87625F056C7C4A8B, -475, -124},
+    {0xC9BCFF6034C13053, -449, -116},
+    {0x964E858C91BA2655, -422, -108},
+    {0xDFF9772470297EBD, -396, -100},
+    {0xA6DFBD9FB8E5B88F, -369, -92},
+    {0xF8A95FCF88747D94, -343, -84},
+    {0xB94470938FA89BCF, -316, -76},
+    {0x8A08F0F8BF0F156B, -289, -68},
+    {0xCDB02555653131B6, -263, -60},
+    {0x993FE2C6D07B7FAC, -236, -52},
+    {0xE45C10C42A2B3B06, -210, -44},
+    {0xAA242499697392D3, -183, -36},
+    {0xFD87B5F28300CA0E, -157, -28},
+    {0xBCE5086492111AEB, -130, -20},
+    {0x8CBCCC096F5088CC, -103, -12},
+    {0xD1B71758E219652C, -77, -4},
+    {0x9C40000000000000, -50, 4},
+    {0xE8D4A51000000000, -24, 12},
+    {0xAD78EBC5AC620000, 3, 20},
+    {0x813F3978F8940984, 30, 28},
+    {0xC097CE7BC90715B3, 56, 36},
+    {0x8F7E32CE7BEA5C70, 83, 44},
+    {0xD5D238A4ABE98068, 109, 52},
+    {0x9F4F2726179A2245, 136, 60},
+    {0xED63A231D4C4FB27, 162, 68},
+    {0xB0DE65388CC8ADA8, 189, 76},
+    {0x83C7088E1AAB65DB, 216, 84},
+    {0xC45D1DF942711D9A, 242, 92},
+    {0x924D692CA61BE758, 269, 100},
+    {0xDA01EE641A708DEA, 295, 108},
+    {0xA26DA3999AEF774A, 322, 116},
+    {0xF209787BB47D6B85, 348, 124},
+    {0xB454E4A179DD1877, 375, 132},
+    {0x865B86925B9BC5C2, 402, 140},
+    {0xC83553C5C8965D3D, 428, 148},
+    {0x952AB45CFA97A0B3, 455, 156},
+    {0xDE469FBD99A05FE3, 481, 164},
+    {0xA59BC234DB398C25, 508, 172},
+    {0xF6C69A72A3989F5C, 534, 180},
+    {0xB7DCBF5354E9BECE, 561, 188},
+    {0x88FCF317F22241E2, 588, 196},
+    {0xCC20CE9BD35C78A5, 614, 204},
+    {0x98165AF37B2153DF, 641, 212},
+    {0xE2A0B5DC971F303A, 667, 220},
+    {0xA8D9D1535CE3B396, 694, 228},
+    {0xFB9B7CD9A4A7443C, 720, 236},
+    {0xBB764C4CA7A44410, 747, 244},
+    {0x8BAB8EEFB6409C1A, 774, 252},
+    {0xD01FEF10A657842C, 800, 260},
+    {0x9B10A4E5E9913129, 827, 268},
+    {0xE7109BFBA19C0C9D, 853, 276},
+    {0xAC2820D9623BF429, 880, 284},
+    {0x80444B5E7AA7CF85, 907, 292},
+    {0xBF21E44003ACDD2D, 933, 300},
+    {0x8E679C2F5E44FF8F, 960, 308},
+    {0xD433179D9C8CB841, 986, 316},
+    {0x9E19DB92B4E31BA9, 1013, 324},
+};
+
+/// Select c = 10^-k such that the product of c and a normalized DiyFp of
+/// exponent e has an exponent in [-60, -32].
+CachedPower cachedPowerFor(int e) {
+  const int f = -60 - e - 1;
+  const int k = (f * 78913) / (1 << 18) + (f > 0);
+  const auto index = static_cast<size_t>((300 + k + 7) / 8);
+  assert(index < sizeof(cachedPowers) / sizeof(cachedPowers[0]));
+  return cachedPowers[index];
+}
+
+void roundWeed(char* digits, int length, uint64_t distance, uint64_t delta,
+               uint64_t rest, uint64_t tenKappa) {
+  // Move the last digit down while it gets closer to the exact value and
+  // stays in the rounding interval.
+  while (rest < distance && delta - rest >= tenKappa &&
+         (rest + tenKappa < distance ||
+          distance - rest > rest + tenKappa - distance)) {
+    --digits[length - 1];
+    rest += tenKappa;
+  }
+}
+
+/// Generate the digits of w, with as few digits as the interval
+/// [low, high] allows. The value is digits * 10^exponent.
+void generateDigits(char* digits, int& length, int& exponent, DiyFp low,
+                    DiyFp w, DiyFp high) {
+  uint64_t delta = high.f - low.f;
+  uint64_t distance = high.f - w.f;
+  const int shift = -high.e;
+  const uint64_t one = uint64_t(1) << shift;
+  auto integral = static_cast<uint32_t>(high.f >> shift);
+  uint64_t fractional = high.f & (one - 1);
+
+  uint32_t divisor = 1000000000;
+  int kappa = 10;
+  while (kappa > 1 && divisor > integral) {
+    divisor /= 10;
+    --kappa;
+  }
+  while (kappa > 0) {
+    digits[length++] = static_cast<char>('0' + integral / divisor);
+    integral %= divisor;
+    --kappa;
+    const uint64_t rest = (uint64_t(integral) << shift) + fractional;
+    if (rest <= delta) {
+      exponent += kappa;
+      roundWeed(digits, length, distance, delta, rest,
+                uint64_t(divisor) << shift);
+      return;
+    }
+    divisor /= 10;
+  }
+  for (;;) {
+    fractional *= 10;
+    delta *= 10;
+    distance *= 10;
+    digits[length++] = static_cast<char>('0' + (fractional >> shift));
+    fractional &= one - 1;
+    --kappa;
+    if (fractional <= delta)
+      break;
+  }
+  exponent += kappa;
+  roundWeed(digits, length, distance, delta, fractional, one);
+}
+
+/// Write the shortest digits of a positive finite double, return their
+/// number. The value is digits * 10^exponent.
+int grisu2(double value, char* digits, int& exponent) {
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  const uint64_t hiddenBit = uint64_t(1) << 52;
+  const uint64_t fraction = bits & (hiddenBit - 1);
+  const auto biased = static_cast<int>(bits >> 52);
+  const DiyFp v = biased == 0 ? DiyFp{fraction, 1 - 1075}
+                              : DiyFp{fraction + hiddenBit, biased - 1075};
+
+  // The boundaries of the interval of the numbers rounding to v. The lower
+  // one is closer when v is a power of two.
+  const DiyFp high = normalize(DiyFp{2 * v.f + 1, v.e - 1});
+  DiyFp low = fraction == 0 && biased > 1 ? DiyFp{4 * v.f - 1, v.e - 2}
+                                          : DiyFp{2 * v.f - 1, v.e - 1};
+  low.f <<= low.e - high.e;
+  low.e = high.e;
+
+  const CachedPower power = cachedPowerFor(high.e);
+  const DiyFp c = {power.f, power.e};
+  const DiyFp w = multiply(normalize(v), c);
+  DiyFp scaledLow = multiply(low, c);
+  DiyFp scaledHigh = multiply(high, c);
+  // Shrink the interval by one unit for the error of the multiplications.
+  ++scaledLow.f;
+  --scaledHigh.f;
+
+  int length = 0;
+  exponent = -power.k;
+  generateDigits(digits, length, exponent, scaledLow, w, scaledHigh);
+  return length;
+}
+
+/// Write a finite double with the shortest digits, in the notation of
+/// printf("%.17g") followed by ".0" for integers, like valueToString().
+/// Return the end of the string.
+char* formatShortest(double value, char* out) {
+  if (std::signbit(value)) {
+    *out++ = '-';
+    value = -value;
+  }
+  if (value == 0) {
+    std::memcpy(out, "0.0", 3);
+    return out + 3;
+  }
+  char digits[18];
+  int exponent;
+  const int length = grisu2(value, digits, exponent);
+  // The exponent of the first digit in scientific notation.
+  const int scientific = length + exponent - 1;
+  if (scientific < -4 || scientific >= 17) {
+    *out++ = digits[0];
+    if (length > 1) {
+      *out++ = '.';
+      std::memcpy(out, digits + 1, static_cast<size_t>(length - 1));
+      out += length - 1;
+    }
+    *out++ = 'e';
+    *out++ = scientific < 0 ? '-' : '+';
+    unsigned e = static_cast<unsigned>(scientific < 0 ? -scientific
+                                                      : scientific);
+    if (e >= 100) {
+      *out++ = static_cast<char>('0' + e / 100);
+      e %= 100;
+    }
+    *out++ = static_cast<char>('0' + e / 10);
+    *out++ = static_cast<char>('0' + e % 10);
+  } else if (scientific < 0) {
+    *out++ = '0';
+    *out++ = '.';
+    for (int i = -1; i > scientific; --i)
+      *out++ = '0';
+    std::memcpy(out, digits, static_cast<size_t>(length));
+    out += length;
+  } else if (scientific + 1 >= length) {
+    std::memcpy(out, digits, static_cast<size_t>(length));
+    out += length;
+    for (int i = length; i <= scientific; ++i)
+      *out++ = '0';
+    *out++ = '.';
+    *out++ = '0';
+  } else {
+    const auto integral = static_cast<size_t>(scientific + 1);
+    std::memcpy(out, digits, integral);
+    out += integral;
+    *out++ = '.';
+    std::memcpy(out, digits + integral, static_cast<size_t>(length) - integral);
+    out += static_cast<size_t>(length) - integral;
+  }
+  return out;
+}
+
 String valueToString(double value, bool useSpecialFloats,
                      unsigned int precision, PrecisionType precisionType) {
   // Print into the buffer. We need not request the alternative representation
@@ -136,6 +427,11 @@ String valueToString(double value, bool useSpecialFloats,
                [isnan(value) ? 0 : (value < 0) ? 1 : 2];
   }
 
+  if (precisionType == PrecisionType::shortestRoundTrip) {
+    char buffer[32];
+    return String(buffer, formatShortest(value, buffer));
+  }
+
   String buffer(size_t(36), '\0');
   while (true) {
     int len = jsoncpp_snprintf(
@@ -177,12 +473,82 @@ String valueToString(double value, unsigned int precision,
 
 String valueToString(bool value) { return value ? "true" : "false"; }
 
-static bool doesAnyCharRequireEscaping(char const* s, size_t n) {
-  assert(s || !n);
+namespace {
+void appendInt(String& out, LargestInt value) {
+  UIntToStringBuffer buffer;
+  char* current = buffer + sizeof(buffer);
+  if (value < 0) {
+    uintToString(LargestUInt(0) - LargestUInt(value), current);
+    *--current = '-';
+  } else {
+    uintToString(LargestUInt(value), current);
+  }
+  out.append(current, buffer + sizeof(buffer) - 1);
+}
+
+void appendUInt(String& out, LargestUInt value) {
+  UIntToStringBuffer buffer;
+  char* current = buffer + sizeof(buffer);
+  uintToString(value, current);
+  out.append(current, buffer + sizeof(buffer) - 1);
+}
+
+void appendDouble(String& out, double value, bool useSpecialFloats,
+                  unsigned int precision, PrecisionType precisionType) {
+  if (precisionType == PrecisionType::shortestRoundTrip && isfinite(value)) {
+    char buffer[32];
+    out.append(buffer, formatShortest(value, buffer));
+    return;
+  }
+  out += valueToString(value, useSpecialFloats, precision, precisionType);
+}
+} // namespace
 
-  return std::any_of(s, s + n, [](unsigned char c) {
-    return c == '\\' || c == '"' || c < 0x20 || c > 0x7F;
-  });
+#if defined(JSONCPP_HAS_SSE2)
+static unsigned firstSetBit(unsigned bits) {
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward(&index, bits);
+  return static_cast<unsigned>(index);
+#else
+  return static_cast<unsigned>(__builtin_ctz(bits));
+#endif
+}
+#endif
+
+/// Return the first character of [s, end) that must be escaped, or end.
+static char const* findCharToEscape(char const* s, char const* end,
+                                    bool emitUTF8) {
+  assert(s || s == end);
+
+#if defined(JSONCPP_HAS_SSE2)
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i space = _mm_set1_epi8(0x20);
+  const __m128i lastControl = _mm_set1_epi8(0x1F);
+  while (end - s >= 16) {
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+    // The signed comparison also matches the bytes from 0x80, the unsigned
+    // one only the control characters.
+    const __m128i control =
+        emitUTF8
+            ? _mm_cmpeq_epi8(_mm_min_epu8(chunk, lastControl), chunk)
+            : _mm_cmplt_epi8(chunk, space);
+    const auto mask = static_cast<unsigned>(_mm_movemask_epi8(
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                                  _mm_cmpeq_epi8(chunk, backslash)),
+                     control)));
+    if (mask)
+      return s + firstSetBit(mask);
+    s += 16;
+  }
+#endif
+  for (; s != end; ++s) {
+    const auto c = static_cast<unsigned char>(*s);
+    if (c == '\\' || c == '"' || c < 0x20 || (c > 0x7F && !emitUTF8))
+      return s;
+  }
+  return end;
 }
 
 static unsigned int utf8ToCodepoint(const char*& s, const char* e) {
@@ -272,22 +638,22 @@ static void appendHex(String& result, unsigned ch) {
   result.append("\\u").append(toHex16Bit(ch));
 }
 
-static String valueToQuotedStringN(const char* value, size_t length,
-                                   bool emitUTF8 = false) {
+/// Append the quoted and escaped string to result.
+static void appendQuotedStringN(String& result, const char* value,
+                                size_t length, bool emitUTF8 = false) {
   if (value == nullptr)
-    return "";
-
-  if (!doesAnyCharRequireEscaping(value, length))
-    return String("\"") + value + "\"";
-  // We have to walk value and escape any special characters.
-  // Appending to String is not efficient, but this should be rare.
-  // (Note: forward slashes are *not* rare, but I am not escaping them.)
-  String::size_type maxsize = length * 2 + 3; // allescaped+quotes+NULL
-  String result;
-  result.reserve(maxsize); // to avoid lots of mallocs
-  result += "\"";
+    return;
+
+  result += '"';
   char const* end = value + length;
-  for (const char* c = value; c != end; ++c) {
+  char const* c = value;
+  for (;;) {
+    // Copy the runs of characters that need no escaping at once.
+    char const* special = findCharToEscape(c, end, emitUTF8);
+    result.append(c, special);
+    if (special == end)
+      break;
+    c = special;
     switch (*c) {
     case '\"':
       result += "\\\"";
@@ -344,8 +710,15 @@ static String valueToQuotedStringN(const char* value, size_t length,
       }
     } break;
     }
+    ++c;
   }
-  result += "\"";
+  result += '"';
+}
+
+static String valueToQuotedStringN(const char* value, size_t length,
+                                   bool emitUTF8 = false) {
+  String result;
+  appendQuotedStringN(result, value, length, emitUTF8);
   return result;
 }
 
@@ -882,11 +1255,13 @@ struct BuiltStyledStreamWriter : public StreamWriter {
                           bool emitUTF8, unsigned int precision,
                           PrecisionType precisionType);
   int write(Value const& root, OStream* sout) override;
+  int append(Value const& root, String* document) override;
 
 private:
   void writeValue(Value const& value);
   void writeArrayValue(Value const& value);
   bool isMultilineArray(Value const& value);
+  String& valueTarget();
   void pushValue(String const& value);
   void writeIndent();
   void writeWithIndent(String const& value);
@@ -898,6 +1273,7 @@ private:
 
   using ChildValues = std::vector<String>;
 
+  String* document_;
   ChildValues childValues_;
   String indentString_;
   unsigned int rightMargin_;
@@ -917,14 +1293,21 @@ BuiltStyledStreamWriter::BuiltStyledStreamWriter(
     String indentation, CommentStyle::Enum cs, String colonSymbol,
     String nullSymbol, String endingLineFeedSymbol, bool useSpecialFloats,
     bool emitUTF8, unsigned int precision, PrecisionType precisionType)
-    : rightMargin_(74), indentation_(std::move(indentation)), cs_(cs),
+    : document_(nullptr), rightMargin_(74),
+      indentation_(std::move(indentation)), cs_(cs),
       colonSymbol_(std::move(colonSymbol)), nullSymbol_(std::move(nullSymbol)),
       endingLineFeedSymbol_(std::move(endingLineFeedSymbol)),
       addChildValues_(false), indented_(false),
       useSpecialFloats_(useSpecialFloats), emitUTF8_(emitUTF8),
       precision_(precision), precisionType_(precisionType) {}
 int BuiltStyledStreamWriter::write(Value const& root, OStream* sout) {
-  sout_ = sout;
+  String document;
+  append(root, &document);
+  sout->write(document.data(), static_cast<std::streamsize>(document.size()));
+  return 0;
+}
+int BuiltStyledStreamWriter::append(Value const& root, String* document) {
+  document_ = document;
   addChildValues_ = false;
   indented_ = true;
   indentString_.clear();
@@ -934,8 +1317,8 @@ int BuiltStyledStreamWriter::write(Value const& root, OStream* sout) {
   indented_ = true;
   writeValue(root);
   writeCommentAfterValueOnSameLine(root);
-  *sout_ << endingLineFeedSymbol_;
-  sout_ = nullptr;
+  *document_ += endingLineFeedSymbol_;
+  document_ = nullptr;
   return 0;
 }
 void BuiltStyledStreamWriter::writeValue(Value const& value) {
@@ -944,54 +1327,58 @@ void BuiltStyledStreamWriter::writeValue(Value const& value) {
     pushValue(nullSymbol_);
     break;
   case intValue:
-    pushValue(valueToString(value.asLargestInt()));
+    appendInt(valueTarget(), value.asLargestInt());
     break;
   case uintValue:
-    pushValue(valueToString(value.asLargestUInt()));
+    appendUInt(valueTarget(), value.asLargestUInt());
     break;
   case realValue:
-    pushValue(valueToString(value.asDouble(), useSpecialFloats_, precision_,
-                            precisionType_));
+    appendDouble(valueTarget(), value.asDouble(), useSpecialFloats_,
+                 precision_, precisionType_);
     break;
   case stringValue: {
     // Is NULL is possible for value.string_? No.
     char const* str;
     char const* end;
     bool ok = value.getString(&str, &end);
+    String& target = valueTarget();
     if (ok)
-      pushValue(
-          valueToQuotedStringN(str, static_cast<size_t>(end - str), emitUTF8_));
-    else
-      pushValue("");
+      appendQuotedStringN(target, str, static_cast<size_t>(end - str),
+                          emitUTF8_);
     break;
   }
   case booleanValue:
-    pushValue(valueToString(value.asBool()));
+    valueTarget() += value.asBool() ? "true" : "false";
     break;
   case arrayValue:
     writeArrayValue(value);
     break;
   case objectValue: {
-    Value::Members members(value.getMemberNames());
-    if (members.empty())
+    if (value.empty())
       pushValue("{}");
     else {
       writeWithIndent("{");
       indent();
-      auto it = members.begin();
+      // Iterate the members in place rather than copying their names and
+      // looking each of them up.
+      auto it = value.begin();
       for (;;) {
-        String const& name = *it;
-        Value const& childValue = value[name];
+        char const* nameEnd;
+        char const* name = it.memberName(&nameEnd);
+        Value const& childValue = *it;
         writeCommentBeforeValue(childValue);
-        writeWithIndent(
-            valueToQuotedStringN(name.data(), name.length(), emitUTF8_));
-        *sout_ << colonSymbol_;
+        if (!indented_)
+          writeIndent();
+        appendQuotedStringN(*document_, name,
+                            static_cast<size_t>(nameEnd - name), emitUTF8_);
+        indented_ = false;
+        *document_ += colonSymbol_;
         writeValue(childValue);
-        if (++it == members.end()) {
+        if (++it == value.end()) {
           writeCommentAfterValueOnSameLine(childValue);
           break;
         }
-        *sout_ << ",";
+        *document_ += ',';
         writeCommentAfterValueOnSameLine(childValue);
       }
       unindent();
@@ -1006,7 +1393,9 @@ void BuiltStyledStreamWriter::writeArrayValue(Value const& value) {
   if (size == 0)
     pushValue("[]");
   else {
-    bool isMultiLine = (cs_ == CommentStyle::All) || isMultilineArray(value);
+    // Without indentation, both layouts give the same output.
+    bool isMultiLine = (cs_ == CommentStyle::All) || indentation_.empty() ||
+                       isMultilineArray(value);
     if (isMultiLine) {
       writeWithIndent("[");
       indent();
@@ -1028,7 +1417,7 @@ void BuiltStyledStreamWriter::writeArrayValue(Value const& value) {
           writeCommentAfterValueOnSameLine(childValue);
           break;
         }
-        *sout_ << ",";
+        *document_ += ',';
         writeCommentAfterValueOnSameLine(childValue);
       }
       unindent();
@@ -1036,17 +1425,17 @@ void BuiltStyledStreamWriter::writeArrayValue(Value const& value) {
     } else // output on a single line
     {
       assert(childValues_.size() == size);
-      *sout_ << "[";
+      *document_ += '[';
       if (!indentation_.empty())
-        *sout_ << " ";
+        *document_ += ' ';
       for (unsigned index = 0; index < size; ++index) {
         if (index > 0)
-          *sout_ << ((!indentation_.empty()) ? ", " : ",");
-        *sout_ << childValues_[index];
+          *document_ += (!indentation_.empty()) ? ", " : ",";
+        *document_ += childValues_[index];
       }
       if (!indentation_.empty())
-        *sout_ << " ";
-      *sout_ << "]";
+        *document_ += ' ';
+      *document_ += ']';
     }
   }
 }
@@ -1078,11 +1467,17 @@ bool BuiltStyledStreamWriter::isMultilineArray(Value const& value) {
   return isMultiLine;
 }
 
+/// Return the string to write the next scalar value to: a new child value
+/// while measuring an array, the document otherwise.
+String& BuiltStyledStreamWriter::valueTarget() {
+  if (!addChildValues_)
+    return *document_;
+  childValues_.emplace_back();
+  return childValues_.back();
+}
+
 void BuiltStyledStreamWriter::pushValue(String const& value) {
-  if (addChildValues_)
-    childValues_.push_back(value);
-  else
-    *sout_ << value;
+  valueTarget() += value;
 }
 
 void BuiltStyledStreamWriter::writeIndent() {
@@ -1093,14 +1488,15 @@ void BuiltStyledStreamWriter::writeIndent() {
 
   if (!indentation_.empty()) {
     // In this case, drop newlines too.
-    *sout_ << '\n' << indentString_;
+    *document_ += '\n';
+    *document_ += indentString_;
   }
 }
 
 void BuiltStyledStreamWriter::writeWithIndent(String const& value) {
   if (!indented_)
     writeIndent();
-  *sout_ << value;
+  *document_ += value;
   indented_ = false;
 }
 
@@ -1122,10 +1518,10 @@ void BuiltStyledStreamWriter::writeCommentBeforeValue(Value const& root) {
   const String& comment = root.getComment(commentBefore);
   String::const_iterator iter = comment.begin();
   while (iter != comment.end()) {
-    *sout_ << *iter;
+    *document_ += *iter;
     if (*iter == '\n' && ((iter + 1) != comment.end() && *(iter + 1) == '/'))
       // writeIndent();  // would write extra newline
-      *sout_ << indentString_;
+      *document_ += indentString_;
     ++iter;
   }
   indented_ = false;
@@ -1136,11 +1532,11 @@ void BuiltStyledStreamWriter::writeCommentAfterValueOnSameLine(
   if (cs_ == CommentStyle::None)
     return;
   if (root.hasComment(commentAfterOnSameLine))
-    *sout_ << " " + root.getComment(commentAfterOnSameLine);
+    document_->append(" ").append(root.getComment(commentAfterOnSameLine));
 
   if (root.hasComment(commentAfter)) {
     writeIndent();
-    *sout_ << root.getComment(commentAfter);
+    *document_ += root.getComment(commentAfter);
   }
 }
 
@@ -1156,6 +1552,12 @@ bool BuiltStyledStreamWriter::hasCommentForValue(const Value& value) {
 
 StreamWriter::StreamWriter() : sout_(nullptr) {}
 StreamWriter::~StreamWriter() = default;
+int StreamWriter::append(Value const& root, String* document) {
+  OStringStream sout;
+  int result = write(root, &sout);
+  *document += sout.str();
+  return result;
+}
 StreamWriter::Factory::~Factory() = default;
 StreamWriterBuilder::StreamWriterBuilder() { setDefaults(&settings_); }
 StreamWriterBuilder::~StreamWriterBuilder() = default;
@@ -1181,8 +1583,11 @@ StreamWriter* StreamWriterBuilder::newStreamWriter() const {
     precisionType = PrecisionType::significantDigits;
   } else if (pt_str == "decimal") {
     precisionType = PrecisionType::decimalPlaces;
+  } else if (pt_str == "shortest") {
+    precisionType = PrecisionType::shortestRoundTrip;
   } else {
-    throwRuntimeError("precisionType must be 'significant' or 'decimal'");
+    throwRuntimeError(
+        "precisionType must be 'significant', 'decimal' or 'shortest'");
   }
   String colonSymbol = " : ";
   if (eyc) {
@@ -1243,10 +1648,10 @@ void StreamWriterBuilder::setDefaults(Json::Value* settings) {
 }
 
 String writeString(StreamWriter::Factory const& factory, Value const& root) {
-  OStringStream sout;
+  String document;
   StreamWriterPtr const writer(factory.newStreamWriter());
-  writer->write(root, &sout);
-  return sout.str();
+  writer->append(root, &document);
+  return document;
 }
 
 OStream& operator<<(OStream& sout, Value const& root) {
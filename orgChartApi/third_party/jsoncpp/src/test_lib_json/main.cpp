@@ -14,6 +14,7 @@
 #include "jsontest.h"
 #include <algorithm>
 #include <cmath>
+#include <cstdlib>
 #include <cstring>
 #include <functional>
 #include <iomanip>
@@ -1625,6 +1626,65 @@ JSONTEST_FIXTURE_LOCAL(ValueTest, compareObject) {
   }
 }
 
+JSONTEST_FIXTURE_LOCAL(ValueTest, memberOrder) {
+  // Members are sorted by name whatever the storage of objects.
+  Json::Value object;
+  char const* const names[] = {"job", "id", "manager", "hire_date", "name"};
+  for (char const* name : names)
+    object[name] = name;
+  JSONTEST_ASSERT(object.removeMember("manager", nullptr));
+  object["department"] = 3;
+  Json::Value::Members expected{"department", "hire_date", "id", "job",
+                                "name"};
+  JSONTEST_ASSERT(expected == object.getMemberNames());
+  Json::ArrayIndex index = 0;
+  for (auto it = object.begin(); it != object.end(); ++it, ++index)
+    JSONTEST_ASSERT_STRING_EQUAL(expected[index], it.name());
+  JSONTEST_ASSERT_EQUAL(5, object.end() - object.begin());
+  JSONTEST_ASSERT_PRED(checkIsEqual(object, Json::Value(object)));
+
+  // Comments are kept on members read in any order.
+  Json::CharReaderBuilder b;
+  b.settings_["collectComments"] = true;
+  CharReaderPtr reader(b.newCharReader());
+  char const doc[] = "{\"b\": 1, // one\n \"a\": [2, // two\n 3]}";
+  Json::Value root;
+  JSONTEST_ASSERT(reader->parse(doc, doc + std::strlen(doc), &root, nullptr));
+  JSONTEST_ASSERT_STRING_EQUAL(
+      "// one", root["b"].getComment(Json::commentAfterOnSameLine));
+  JSONTEST_ASSERT_STRING_EQUAL(
+      "// two", root["a"][0].getComment(Json::commentAfterOnSameLine));
+}
+
+JSONTEST_FIXTURE_LOCAL(ValueTest, memberReferences) {
+  // References to members stay valid while others are added or removed,
+  // whatever the storage of objects.
+  Json::Value object;
+  Json::Value& a = object["a"];
+  for (int i = 0; i < 100; ++i)
+    object["b" + std::to_string(i)] = i;
+  a = 2;
+  JSONTEST_ASSERT_EQUAL(Json::Value(2), object["a"]);
+  Json::Value& b0 = object["b0"];
+  JSONTEST_ASSERT(object.removeMember("a", nullptr));
+  object["0"] = 0;
+  b0 = "b0";
+  JSONTEST_ASSERT_EQUAL(Json::Value("b0"), object["b0"]);
+
+  Json::Value array;
+  Json::Value& first = array.append(1);
+  for (int i = 0; i < 100; ++i)
+    array.append(i);
+  first = 2;
+  JSONTEST_ASSERT_EQUAL(Json::Value(2), array[0]);
+
+  // A copy keeps its own elements.
+  Json::Value copy(object);
+  copy["b1"] = "copy";
+  JSONTEST_ASSERT_EQUAL(Json::Value(1), object["b1"]);
+  JSONTEST_ASSERT_EQUAL(101u, copy.size());
+}
+
 JSONTEST_FIXTURE_LOCAL(ValueTest, compareType) {
   // object of different type are ordered according to their type
   JSONTEST_ASSERT_PRED(checkIsLess(Json::Value(), Json::Value(1)));
@@ -2743,6 +2803,75 @@ JSONTEST_FIXTURE_LOCAL(StreamWriterTest, escapeControlCharacters) {
   }
 }
 
+// The characters to escape are searched 16 bytes at a time, check all their
+// positions in and around a block.
+JSONTEST_FIXTURE_LOCAL(StreamWriterTest, escapeLongStrings) {
+  Json::StreamWriterBuilder b;
+  b.settings_["indentation"] = "";
+  for (bool emitUTF8 : {true, false}) {
+    b.settings_["emitUTF8"] = emitUTF8;
+    for (size_t i = 0; i != 40; ++i) {
+      Json::String raw(40, 'a');
+      Json::String escaped = raw;
+      raw.insert(i, "\"\xC3\xA9\x1F\x7F");
+      escaped.insert(i, emitUTF8 ? "\\\"\xC3\xA9\\u001f\x7F"
+                                 : "\\\"\\u00e9\\u001f\x7F");
+      JSONTEST_ASSERT_STRING_EQUAL("\"" + escaped + "\"",
+                                   Json::writeString(b, raw))
+          << ", emit=" << emitUTF8 << ", i=" << i;
+    }
+  }
+}
+
+JSONTEST_FIXTURE_LOCAL(StreamWriterTest, shortestFloats) {
+  Json::StreamWriterBuilder b;
+  b.settings_["precisionType"] = "shortest";
+  const struct {
+    double value;
+    const char* expected;
+  } tests[] = {{0.1, "0.1"},
+               {-0.0, "-0.0"},
+               {100.0, "100.0"},
+               {1.5, "1.5"},
+               {0.0001, "0.0001"},
+               {1e-5, "1e-05"},
+               {123456.789, "123456.789"},
+               {1e16, "10000000000000000.0"},
+               {1e17, "1e+17"},
+               {1e22, "1e+22"},
+               {5e-324, "5e-324"},
+               {1.7976931348623157e308, "1.7976931348623157e+308"},
+               {1234857476305.256345694873740545068, "1234857476305.2563"}};
+  for (const auto& test : tests) {
+    Json::String out = Json::writeString(b, test.value);
+    JSONTEST_ASSERT_STRING_EQUAL(test.expected, out);
+    JSONTEST_ASSERT_EQUAL(test.value, std::strtod(out.c_str(), nullptr));
+  }
+
+  // The precision is ignored.
+  b.settings_["precision"] = 3;
+  JSONTEST_ASSERT_STRING_EQUAL("3.14159", Json::writeString(b, 3.14159));
+  b.settings_["useSpecialFloats"] = true;
+  JSONTEST_ASSERT_STRING_EQUAL(
+      "-Infinity",
+      Json::writeString(b, -std::numeric_limits<double>::infinity()));
+}
+
+JSONTEST_FIXTURE_LOCAL(StreamWriterTest, append) {
+  Json::Value root;
+  root["name"] = "value";
+  root["numbers"].append(-1);
+  root["numbers"].append(2.5);
+  Json::StreamWriterBuilder b;
+  b.settings_["indentation"] = "";
+  std::unique_ptr<Json::StreamWriter> writer(b.newStreamWriter());
+  Json::String document = "body=";
+  JSONTEST_ASSERT_EQUAL(0, writer->append(root, &document));
+  JSONTEST_ASSERT_STRING_EQUAL("body=" + Json::writeString(b, root), document);
+  JSONTEST_ASSERT_STRING_EQUAL(R"(body={"name":"value","numbers":[-1,2.5]})",
+                               document);
+}
+
 #ifdef _WIN32
 JSONTEST_FIXTURE_LOCAL(StreamWriterTest, escapeTabCharacterWindows) {
   // Get the current locale before changing it
@@ -3879,6 +4008,234 @@ JSONTEST_FIXTURE_LOCAL(IteratorTest, constness) {
   JSONTEST_ASSERT_STRING_EQUAL(expected, out.str());
 }
 
+struct FastCharReaderTest : JsonTest::TestCase {
+  void checkSameAsReader(Json::CharReaderBuilder b, const Json::String& doc) {
+    b.settings_["fastParse"] = true;
+    CharReaderPtr fast(b.newCharReader());
+    b.settings_["fastParse"] = false;
+    CharReaderPtr reader(b.newCharReader());
+    Json::Value fastRoot;
+    Json::Value root;
+    Json::String fastErrs;
+    Json::String errs;
+    bool fastOk = fast->parse(doc.data(), doc.data() + doc.size(), &fastRoot,
+                              &fastErrs);
+    bool ok = reader->parse(doc.data(), doc.data() + doc.size(), &root, &errs);
+    JSONTEST_ASSERT_EQUAL(ok, fastOk) << doc;
+    JSONTEST_ASSERT_STRING_EQUAL(errs, fastErrs);
+    if (ok) {
+      JSONTEST_ASSERT_STRING_EQUAL(root.toStyledString(),
+                                   fastRoot.toStyledString());
+      JSONTEST_ASSERT_EQUAL(root.getOffsetStart(), fastRoot.getOffsetStart());
+      JSONTEST_ASSERT_EQUAL(root.getOffsetLimit(), fastRoot.getOffsetLimit());
+      if (root.isObject() && root.isMember("a")) {
+        JSONTEST_ASSERT_EQUAL(root["a"].getOffsetStart(),
+                              fastRoot["a"].getOffsetStart());
+        JSONTEST_ASSERT_EQUAL(root["a"].getOffsetLimit(),
+                              fastRoot["a"].getOffsetLimit());
+      }
+    }
+  }
+};
+
+JSONTEST_FIXTURE_LOCAL(FastCharReaderTest, sameAsReader) {
+  Json::String long64(60, 'x');
+  char const* const docs[] = {
+      R"({"a": 1, "b": [true, false, null], "c": {"d": "e"}})",
+      R"([0, -0, 1.5, -2e3, 1E+2, 12345678901234567890, 1e400, 0.1])",
+      R"([-9223372036854775808, 18446744073709551615, 9007199254740993])",
+      R"({"a": "é😀\n\t\"\\\/", "b": 2})",
+      R"({"a": 1, "a": 2})",
+      R"({"a": [1, 2,], "b": 3})",
+      R"({"a": 01})",
+      R"({"a": NaN, "b": -Infinity})",
+      R"({"a": 'single'})",
+      R"({"a": 1 // comment
+         , "b": /* comment */ 2})",
+      R"([1 2])",
+      R"({"a" 1})",
+      R"({"a": "unterminated)",
+      R"({"a": "\q"})",
+      R"({"a": tru})",
+      "\xEF\xBB\xBF{\"a\": 1}",
+      "  7  ",
+      "\"string\"",
+      "",
+      "[[[[[[[[[[[[[[[[[[[[1]]]]]]]]]]]]]]]]]]]]",
+  };
+  Json::CharReaderBuilder b;
+  for (char const* doc : docs)
+    checkSameAsReader(b, doc);
+  // Escapes and quotes across the 64-byte blocks of the index.
+  for (size_t padding = 0; padding < 70; ++padding) {
+    Json::String pad(padding, ' ');
+    checkSameAsReader(b, pad + R"({"a": ")" + long64 + R"(\\\"\\", "b": ")" +
+                             long64 + R"(\\\\"})");
+  }
+  Json::CharReaderBuilder::strictMode(&b.settings_);
+  for (char const* doc : docs)
+    checkSameAsReader(b, doc);
+  b.settings_["allowDroppedNullPlaceholders"] = true;
+  b.settings_["stackLimit"] = 4;
+  for (char const* doc : docs) {
+    if (doc[0] != '[' || doc[1] != '[')
+      checkSameAsReader(b, doc);
+  }
+  // Both readers throw when the stack limit is exceeded.
+  CharReaderPtr fast(b.newCharReader());
+  Json::Value root;
+  char const* deep = docs[19];
+  JSONTEST_ASSERT_THROWS(
+      fast->parse(deep, deep + std::strlen(deep), &root, nullptr));
+}
+
+JSONTEST_FIXTURE_LOCAL(FastCharReaderTest, denseDocuments) {
+  // Every other character or every character is structural, more than the
+  // index is first sized for.
+  Json::String numbers = "[";
+  Json::String nested = "[";
+  for (int i = 0; i < 20000; ++i) {
+    numbers += "1,";
+    nested += "[],{},";
+  }
+  numbers += "1]";
+  nested += "[]]";
+  Json::CharReaderBuilder b;
+  checkSameAsReader(b, numbers);
+  checkSameAsReader(b, nested);
+  // A reader is reused for documents of other sizes.
+  CharReaderPtr fast(b.newCharReader());
+  char const small[] = R"({"a": [1, 2]})";
+  for (const Json::String& doc : {numbers, Json::String(small), nested}) {
+    Json::Value root;
+    JSONTEST_ASSERT(
+        fast->parse(doc.data(), doc.data() + doc.size(), &root, nullptr));
+  }
+  Json::Value root;
+  JSONTEST_ASSERT(
+      fast->parse(small, small + std::strlen(small), &root, nullptr));
+  JSONTEST_ASSERT_EQUAL(2, root["a"][1].asInt());
+}
+
+struct LazyDocumentTest : JsonTest::TestCase {};
+
+JSONTEST_FIXTURE_LOCAL(LazyDocumentTest, access) {
+  Json::LazyDocument document;
+  char const doc[] = R"({"id": 42, "name": "Ann\nLee", "a": 1, "a": 2,
+      "tags": ["x", {"y": [1.5, true]}], "m": null})";
+  Json::String errs;
+  JSONTEST_ASSERT(document.parse(doc, doc + std::strlen(doc), &errs));
+  JSONTEST_ASSERT(errs.empty());
+  Json::LazyValue root = document.root();
+  JSONTEST_ASSERT(root.isObject());
+  JSONTEST_ASSERT_EQUAL(5, root.size());
+  JSONTEST_ASSERT_EQUAL(42, root["id"].asInt());
+  JSONTEST_ASSERT_STRING_EQUAL("Ann\nLee", root["name"].asString());
+  // The last of duplicate members is used, like in Reader.
+  JSONTEST_ASSERT_EQUAL(2, root["a"].asInt());
+  JSONTEST_ASSERT(root.isMember("m"));
+  JSONTEST_ASSERT(root["m"].isNull());
+  JSONTEST_ASSERT(!root.isMember("missing"));
+  JSONTEST_ASSERT(root["missing"].isNull());
+  Json::LazyValue tags = root["tags"];
+  JSONTEST_ASSERT(tags.isArray());
+  JSONTEST_ASSERT_EQUAL(2, tags.size());
+  JSONTEST_ASSERT_STRING_EQUAL("x", tags[0].asString());
+  JSONTEST_ASSERT_EQUAL(1.5, tags[1]["y"][0].asDouble());
+  JSONTEST_ASSERT(tags[1]["y"][1].asBool());
+  JSONTEST_ASSERT(tags[2].isNull());
+  Json::Value y = tags[1]["y"].value();
+  JSONTEST_ASSERT_EQUAL(2, y.size());
+}
+
+JSONTEST_FIXTURE_LOCAL(LazyDocumentTest, fallback) {
+  Json::LazyDocument document;
+  Json::String errs;
+  // Comments are parsed by Reader before any access.
+  char const comments[] = "[1 // one\n, 2 /* two */]";
+  JSONTEST_ASSERT(
+      document.parse(comments, comments + std::strlen(comments), &errs));
+  JSONTEST_ASSERT_EQUAL(2, document.root().size());
+  JSONTEST_ASSERT_EQUAL(2, document.root()[1].asInt());
+  // So are the syntax errors of the structure.
+  char const invalid[] = R"({"a": [1, 2})";
+  JSONTEST_ASSERT(!document.parse(invalid, invalid + std::strlen(invalid),
+                                  &errs));
+  JSONTEST_ASSERT(!errs.empty());
+  // Invalid values are only reported when they are accessed.
+  char const deferred[] = R"({"a": 1, "b": tru})";
+  JSONTEST_ASSERT(
+      document.parse(deferred, deferred + std::strlen(deferred), &errs));
+  JSONTEST_ASSERT_EQUAL(1, document.root()["a"].asInt());
+  JSONTEST_ASSERT_THROWS(document.root()["b"].asBool());
+}
+
+struct DocumentTest : JsonTest::TestCase {};
+
+JSONTEST_FIXTURE_LOCAL(DocumentTest, parse) {
+  Json::Value copy;
+  Json::Value kept("kept");
+  {
+    Json::Document document(64);
+    Json::CharReaderBuilder b;
+    CharReaderPtr reader(b.newCharReader());
+    char const doc[] = R"({"name": "a string longer than the small ones",
+        "list": [1, "two", {"three": [3]}], "empty": {}})";
+    Json::String errs;
+    {
+      Json::Document::Scope scope(document);
+      JSONTEST_ASSERT(reader->parse(doc, doc + std::strlen(doc),
+                                    &document.root(), &errs));
+    }
+    JSONTEST_ASSERT(errs.empty());
+    size_t allocations = document.buffer().allocations();
+    JSONTEST_ASSERT(allocations > 10);
+    JSONTEST_ASSERT(document.buffer().capacity() > 64);
+    Json::Value& root = document.root();
+    JSONTEST_ASSERT_STRING_EQUAL("a string longer than the small ones",
+                                 root["name"].asString());
+    JSONTEST_ASSERT_EQUAL(3, root["list"][2]["three"][0].asInt());
+
+    // Members added later are allocated from the buffer too.
+    root["list"][2]["four"] = 4;
+    JSONTEST_ASSERT(document.buffer().allocations() > allocations);
+    // Values from the heap can be added to the tree.
+    root["empty"]["kept"] = std::move(kept);
+    root["heap"] = Json::Value(Json::arrayValue);
+    root["heap"].append("element");
+    // Copies are allocated from the heap.
+    copy = root;
+  }
+  JSONTEST_ASSERT_STRING_EQUAL("a string longer than the small ones",
+                               copy["name"].asString());
+  JSONTEST_ASSERT_EQUAL(4, copy["list"][2]["four"].asInt());
+  JSONTEST_ASSERT_STRING_EQUAL("kept", copy["empty"]["kept"].asString());
+  JSONTEST_ASSERT_STRING_EQUAL("element", copy["heap"][0].asString());
+  JSONTEST_ASSERT_EQUAL(4, copy.size());
+}
+
+JSONTEST_FIXTURE_LOCAL(DocumentTest, scopes) {
+  JSONTEST_ASSERT(Json::MonotonicBuffer::current() == nullptr);
+  Json::Document outer;
+  Json::Document inner;
+  {
+    Json::Document::Scope outerScope(outer);
+    outer.root()["a"] = "outer";
+    {
+      Json::Document::Scope innerScope(inner);
+      JSONTEST_ASSERT(Json::MonotonicBuffer::current() == &inner.buffer());
+      inner.root() = Json::Value("inner");
+    }
+    JSONTEST_ASSERT(Json::MonotonicBuffer::current() == &outer.buffer());
+  }
+  JSONTEST_ASSERT(Json::MonotonicBuffer::current() == nullptr);
+  JSONTEST_ASSERT_EQUAL(1, inner.buffer().allocations());
+  JSONTEST_ASSERT_STRING_EQUAL("inner", inner.root().asString());
+  JSONTEST_ASSERT_STRING_EQUAL("outer", outer.root()["a"].asString());
+  outer.root().removeMember("a");
+  JSONTEST_ASSERT(outer.root().empty());
+}
+
 struct RValueTest : JsonTest::TestCase {};
 
 JSONTEST_FIXTURE_LOCAL(RValueTest, moveConstruction) {
@@ -0,0 +1,126 @@
+#ifndef JWT_CPP_JSONCPP_TRAITS_H
+#define JWT_CPP_JSONCPP_TRAITS_H
+
+#include "jwt-cpp/jwt.h"
+#include "json/json.h"
+
+#include <memory>
+
+namespace jwt {
+	namespace traits {
+		struct open_source_parsers_jsoncpp {
+			using value_type = Json::Value;
+			using string_type = std::string;
+			using number_type = double;
+			using integer_type = Json::Int64;
+			using boolean_type = bool;
+
+			// Json::Value is both the array and the object, these add the container interface jwt-cpp expects
+			class array_type : public Json::Value {
+			public:
+				using value_type = Json::Value;
+
+				array_type() : Json::Value(Json::arrayValue) {}
+				explicit array_type(const Json::Value& o) : Json::Value(o) {}
+				explicit array_type(Json::Value&& o) : Json::Value(std::move(o)) {}
+				template<typename Iterator>
+				array_type(Iterator begin, Iterator end) : Json::Value(Json::arrayValue) {
+					for (Iterator it = begin; it != end; ++it) {
+						append(Json::Value(*it));
+					}
+				}
+
+				const value_type& front() const { return (*this)[0u]; }
+			};
+
+			class object_type : public Json::Value {
+			public:
+				using key_type = std::string;
+				using mapped_type = Json::Value;
+				using size_type = size_t;
+
+				object_type() : Json::Value(Json::objectValue) {}
+				explicit object_type(const Json::Value& o) : Json::Value(o) {}
+				explicit object_type(Json::Value&& o) : Json::Value(std::move(o)) {}
+
+				const mapped_type& at(const key_type& key) const {
+					const Json::Value* found = find(key.data(), key.data() + key.size());
+					if (!found) throw std::out_of_range("invalid key");
+					return *found;
+				}
+
+				size_type count(const key_type& key) const {
+					return find(key.data(), key.data() + key.size()) != nullptr ? 1 : 0;
+				}
+			};
+
+			static jwt::json::type get_type(const value_type& val) {
+				using jwt::json::type;
+
+				switch (val.type()) {
+				case Json::booleanValue: return type::boolean;
+				// jsoncpp internally tracks two types of integers
+				case Json::intValue:
+				case Json::uintValue: return type::integer;
+				case Json::realValue: return type::number;
+				case Json::stringValue: return type::string;
+				case Json::arrayValue: return type::array;
+				case Json::objectValue: return type::object;
+				default: throw std::logic_error("invalid type");
+				}
+			}
+
+			static object_type as_object(const value_type& val) {
+				if (!val.isObject()) throw std::bad_cast();
+				return object_type(val);
+			}
+
+			static array_type as_array(const value_type& val) {
+				if (!val.isArray()) throw std::bad_cast();
+				return array_type(val);
+			}
+
+			static string_type as_string(const value_type& val) {
+				if (!val.isString()) throw std::bad_cast();
+				return val.asString();
+			}
+
+			static integer_type as_int(const value_type& val) {
+				switch (val.type()) {
+				case Json::intValue: return val.asInt64();
+				case Json::uintValue: return static_cast<integer_type>(val.asUInt64());
+				default: throw std::bad_cast();
+				}
+			}
+
+			static boolean_type as_bool(const value_type& val) {
+				if (!val.isBool()) throw std::bad_cast();
+				return val.asBool();
+			}
+
+			static number_type as_number(const value_type& val) {
+				if (val.type() != Json::realValue) throw std::bad_cast();
+				return val.asDouble();
+			}
+
+			static bool parse(value_type& val, const string_type& str) {
+				// A reader keeps no state between documents, one per thread saves building it for every token
+				thread_local std::unique_ptr<Json::CharReader> reader(Json::CharReaderBuilder().newCharReader());
+				return reader->parse(str.data(), str.data() + str.size(), &val, nullptr);
+			}
+
+			static string_type serialize(const value_type& val) {
+				static const Json::StreamWriterBuilder builder = [] {
+					Json::StreamWriterBuilder b;
+					b["commentStyle"] = "None";
+					b["indentation"] = "";
+					b["emitUTF8"] = true;
+					return b;
+				}();
+				return Json::writeString(builder, val);
+			}
+		};
+	} // namespace traits
+} // namespace jwt
+
+#endif // JWT_CPP_JSONCPP_TRAITS_H
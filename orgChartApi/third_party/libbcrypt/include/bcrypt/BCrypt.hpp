@@ -8,6 +8,7 @@
 #include "bcrypt.h"
 #include <string>
 #include <stdexcept>
+#include <vector>
 
 class BCrypt {
 public:
@@ -25,6 +26,21 @@ public:
     static bool validatePassword(const std::string & password, const std::string & hash){
         return (bcrypt_checkpw(password.c_str(), hash.c_str()) == 0);
     }
+
+    // Same as validatePassword for each pair, with the hashes computed together
+    static std::vector<bool> validatePasswords(const std::vector<std::string> & passwords, const std::vector<std::string> & hashes){
+        if(passwords.size() != hashes.size())throw std::invalid_argument{"bcrypt: passwords and hashes differ in size"};
+        std::vector<const char *> passwds, hashps;
+        for(size_t i = 0; i < passwords.size(); ++i){
+            passwds.push_back(passwords[i].c_str());
+            hashps.push_back(hashes[i].c_str());
+        }
+        std::vector<int> results(passwords.size());
+        bcrypt_checkpw_batch((int)passwords.size(), passwds.data(), hashps.data(), results.data());
+        std::vector<bool> valid;
+        for(int result : results)valid.push_back(result == 0);
+        return valid;
+    }
 };
 
 #endif
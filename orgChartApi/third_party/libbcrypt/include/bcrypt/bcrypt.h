@@ -59,6 +59,27 @@ int bcrypt_hashpw(const char *passwd, const char salt[BCRYPT_HASHSIZE],
  */
 int bcrypt_checkpw(const char *passwd, const char hash[BCRYPT_HASHSIZE]);
 
+/*
+ * These functions do the same as bcrypt_hashpw and bcrypt_checkpw for count
+ * passwords at once. Passwords whose salts or hashes have the same work
+ * factor are computed together, several per core, which gives more hashes per
+ * second than one call per password. The results are identical to the single
+ * password functions.
+ *
+ * bcrypt_hashpw_batch returns zero if every password could be hashed and
+ * nonzero otherwise.
+ *
+ * bcrypt_checkpw_batch stores in results[i] what bcrypt_checkpw would return
+ * for passwds[i] and hashes[i]. It returns zero if no errors were found and -1
+ * otherwise.
+ */
+int bcrypt_hashpw_batch(int count, const char * const passwds[],
+			const char * const salts[],
+			char hashes[][BCRYPT_HASHSIZE]);
+
+int bcrypt_checkpw_batch(int count, const char * const passwds[],
+			 const char * const hashes[], int results[]);
+
 /*
  * Brief Example
  * -------------
@@ -20,6 +20,9 @@
 extern int _crypt_output_magic(const char *setting, char *output, int size);
 extern char *_crypt_blowfish_rn(const char *key, const char *setting,
 	char *output, int size);
+extern int _crypt_blowfish_rn_batch(const char * const *keys,
+	const char * const *settings, char * const *outputs, int size,
+	int count);
 extern char *_crypt_gensalt_blowfish_rn(const char *prefix,
 	unsigned long count,
 	const char *input, int size, char *output, int output_size);
@@ -11,6 +11,7 @@
  * with this software. If not, see
  * <http://creativecommons.org/publicdomain/zero/1.0/>.
  */
+#include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -32,11 +33,13 @@ typedef __int64 ssize_t;
 #define BCRYPT_HASHSIZE 60
 
 #include "../include/bcrypt/bcrypt.h"
+#include "../include/bcrypt/crypt_blowfish.h"
 
 #include <windows.h>
 #include <wincrypt.h> /* CryptAcquireContext, CryptGenRandom */
 #else
 #include "bcrypt.h"
+#include "crypt_blowfish.h"
 #include "ow-crypt.h"
 #endif
 
@@ -179,6 +182,51 @@ int bcrypt_checkpw(const char *passwd, const char hash[BCRYPT_HASHSIZE])
 	return timing_safe_strcmp(hash, outhash);
 }
 
+int bcrypt_hashpw_batch(int count, const char * const passwds[],
+			const char * const salts[],
+			char hashes[][BCRYPT_HASHSIZE])
+{
+	char **outputs;
+	int i, ret;
+
+	outputs = malloc((count > 0 ? count : 1) * sizeof(*outputs));
+	if (outputs == NULL)
+		return 1;
+
+	for (i = 0; i < count; ++i)
+		outputs[i] = hashes[i];
+	ret = _crypt_blowfish_rn_batch(passwds, salts, outputs,
+				       BCRYPT_HASHSIZE, count);
+	free(outputs);
+	return (ret == 0)?0:1;
+}
+
+int bcrypt_checkpw_batch(int count, const char * const passwds[],
+			 const char * const hashes[], int results[])
+{
+	char (*outhashes)[BCRYPT_HASHSIZE];
+	int i, ret;
+
+	outhashes = malloc((count > 0 ? count : 1) * sizeof(*outhashes));
+	if (outhashes == NULL)
+		return -1;
+
+	bcrypt_hashpw_batch(count, passwds, hashes, outhashes);
+	ret = 0;
+	for (i = 0; i < count; ++i) {
+		/* Failed hashes start with '*', which a valid hash never does */
+		if (outhashes[i][0] == '*') {
+			results[i] = -1;
+			ret = -1;
+		} else {
+			results[i] = timing_safe_strcmp(hashes[i], outhashes[i]);
+		}
+	}
+
+	free(outhashes);
+	return ret;
+}
+
 #ifdef TEST_BCRYPT
 #include <assert.h>
 #include <stdio.h>
@@ -196,6 +244,10 @@ int main(void)
 	const char pass[] = "hi,mom";
 	const char hash1[] = "$2a$10$VEVmGHy4F4XQMJ3eOZJAUeb.MedU0W10pTPCuf53eHdKJPiSE8sMK";
 	const char hash2[] = "$2a$10$3F0BVk5t8/aoS.3ddaB3l.fxg5qvafQ9NybxcpXLzMeAt.nVWn.NO";
+	const char *passes[8] = {pass, "hi,dad", pass, "hi,dad", pass, "hi,dad", pass, "hi,dad"};
+	const char *hashes[8] = {hash1, hash1, hash2, hash2, hash1, hash1, hash2, hash2};
+	int results[8];
+	int i;
 
 	ret = bcrypt_gensalt(12, salt);
 	assert(ret == 0);
@@ -229,6 +281,23 @@ int main(void)
 	printf("Time taken: %f seconds\n",
 	       (double)(after - before) / CLOCKS_PER_SEC);
 
+	before = clock();
+	for (i = 0; i < 8; i++)
+		bcrypt_checkpw(passes[i], hashes[i]);
+	after = clock();
+	printf("Hashes per second on one core: %f\n",
+	       8 / ((double)(after - before) / CLOCKS_PER_SEC));
+
+	before = clock();
+	ret = bcrypt_checkpw_batch(8, passes, hashes, results);
+	assert(ret == 0);
+	after = clock();
+	for (i = 0; i < 8; i++)
+		ret |= (results[i] != 0) != (i % 2);
+	printf("Batch hash check with bcrypt_checkpw_batch: %s\n", ret?"FAIL":"OK");
+	printf("Hashes per second on one core: %f\n",
+	       8 / ((double)(after - before) / CLOCKS_PER_SEC));
+
 	return 0;
 }
 #endif
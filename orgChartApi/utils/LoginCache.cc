@@ -0,0 +1,87 @@
+#include "LoginCache.h"
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/rand.h>
+#include <stdexcept>
+
+namespace {
+void appendUint32(std::string &out, uint32_t value) {
+    out += static_cast<char>(value >> 24);
+    out += static_cast<char>(value >> 16);
+    out += static_cast<char>(value >> 8);
+    out += static_cast<char>(value);
+}
+}  // namespace
+
+LoginCache::LoginCache(std::chrono::seconds ttl, size_t maxEntries) : ttl{ttl}, maxEntries{maxEntries} {
+    if (RAND_bytes(key, sizeof(key)) != 1) {
+        throw std::runtime_error("failed to generate the login cache key");
+    }
+}
+
+auto LoginCache::contains(int32_t userId, const std::string &hash, const std::string &password) -> bool {
+    if (ttl.count() <= 0 || maxEntries == 0) {
+        return false;
+    }
+    auto wanted = digest(userId, hash, password);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(userId);
+    if (it == entries.end()) {
+        return false;
+    }
+    if (it->second.expiresAt <= Clock::now()) {
+        eraseEntry(it);
+        return false;
+    }
+    return CRYPTO_memcmp(it->second.digest.data(), wanted.data(), wanted.size()) == 0;
+}
+
+void LoginCache::insert(int32_t userId, const std::string &hash, const std::string &password) {
+    if (ttl.count() <= 0 || maxEntries == 0) {
+        return;
+    }
+    auto entry = Entry{digest(userId, hash, password), Clock::now() + ttl, {}};
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(userId);
+    if (it != entries.end()) {
+        eraseEntry(it);
+    }
+    // The ttl is the same for every entry, so the front expires first
+    auto now = Clock::now();
+    while (!order.empty() && (entries.size() >= maxEntries || entries.at(order.front()).expiresAt <= now)) {
+        eraseEntry(entries.find(order.front()));
+    }
+    entry.position = order.insert(order.end(), userId);
+    entries.emplace(userId, entry);
+}
+
+void LoginCache::erase(int32_t userId) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(userId);
+    if (it != entries.end()) {
+        eraseEntry(it);
+    }
+}
+
+auto LoginCache::digest(int32_t userId, const std::string &hash, const std::string &password) const -> Digest {
+    std::string data;
+    data.reserve(8 + hash.size() + password.size());
+    appendUint32(data, static_cast<uint32_t>(userId));
+    appendUint32(data, static_cast<uint32_t>(hash.size()));
+    data += hash;
+    data += password;
+    Digest out;
+    unsigned int length = 0;
+    auto ok = HMAC(EVP_sha256(), key, sizeof(key), reinterpret_cast<const unsigned char *>(data.data()), data.size(), out.data(), &length);
+    OPENSSL_cleanse(&data[0], data.size());
+    if (!ok || length != out.size()) {
+        throw std::runtime_error("failed to hash the login");
+    }
+    return out;
+}
+
+void LoginCache::eraseEntry(std::unordered_map<int32_t, Entry>::iterator it) {
+    order.erase(it->second.position);
+    entries.erase(it);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/// Remembers the passwords that were verified against a stored bcrypt hash, so
+/// a client that logs in again within the ttl does not pay for another bcrypt
+/// run. Only a keyed hash of the user id, stored hash and password is kept, the
+/// key is random and lives only in this process. A changed stored hash makes
+/// the entry miss, and erase() drops it right away.
+class LoginCache {
+ public:
+    /// A ttl or size of 0 turns the cache off.
+    LoginCache(std::chrono::seconds ttl, size_t maxEntries);
+    auto contains(int32_t userId, const std::string &hash, const std::string &password) -> bool;
+    void insert(int32_t userId, const std::string &hash, const std::string &password);
+    void erase(int32_t userId);
+
+ private:
+    using Digest = std::array<unsigned char, 32>;
+    using Clock = std::chrono::steady_clock;
+    struct Entry {
+        Digest digest;
+        Clock::time_point expiresAt;
+        // Position in order
+        std::list<int32_t>::iterator position;
+    };
+
+    auto digest(int32_t userId, const std::string &hash, const std::string &password) const -> Digest;
+    void eraseEntry(std::unordered_map<int32_t, Entry>::iterator it);
+
+    std::chrono::seconds ttl;
+    size_t maxEntries;
+    unsigned char key[32];
+    std::mutex mutex;
+    // One entry per user, the ids in order are oldest first so the expired
+    // and evicted entries are taken from the front.
+    std::unordered_map<int32_t, Entry> entries;
+    std::list<int32_t> order;
+};
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <drogon/drogon.h>
+#include <drogon/orm/JsonSerializer.h>
+#include <optional>
+#include <string>
 
 void badRequest (
     std::function<void(const drogon::HttpResponsePtr &)> &&callback,
@@ -9,3 +12,27 @@ void badRequest (
 );
 
 Json::Value makeErrResp(std::string err);
+
+/// Make a json response from a model (or a vector of models) written straight
+/// to text by drogon::orm::toJsonText(), without building a Json::Value.
+template <typename T>
+drogon::HttpResponsePtr makeJsonResp(const T &value) {
+    auto resp = drogon::HttpResponse::newHttpResponse();
+    resp->setContentTypeCode(drogon::CT_APPLICATION_JSON);
+    resp->setBody(drogon::orm::toJsonText(value, drogon::app().isUnicodeEscapingUsedInJson()));
+    return resp;
+}
+
+/// Read a model straight from the json body of a request with
+/// drogon::orm::fromJsonText(), gives nothing on a bad body so the handler can
+/// answer 400 instead of the 500 of an exception thrown out of the binder.
+template <typename T>
+std::optional<T> fromJsonBody(const drogon::HttpRequest &req) {
+    T value;
+    std::string err;
+    if (!drogon::orm::fromJsonText(req.body(), value, err)) {
+        LOG_DEBUG << "invalid json body: " << err;
+        return std::nullopt;
+    }
+    return value;
+}